@@ -18,14 +18,21 @@
 #include "scenegraph/sceneGraph.h"
 #include "game/vehicle.h"
 #include "platform/profiler.h"
+#include "game/proximityIndex.h"
 
 IMPLEMENT_CONOBJECT(AIConnection);
 
 static S32 gAIDetectionOffset = 0;
 
+bool AIConnection::smUseProximityIndex = true;
+bool AIConnection::smIndexedDetection = false;   //changes the detection timing, off until replays agree
+bool AIConnection::smCompareProximity = false;
+AIConnection::ProximityStats AIConnection::smProximityStats;
+
 AIConnection::AIConnection()
 {
    mAIControlled = true;
+   setLean();
    mMoveMode = mMoveModePending = ModeStop;
    mMoveLocation.set(0, 0, 0);
    mNodeLocation.set(0, 0, 0);
@@ -86,7 +93,10 @@ AIConnection::AIConnection()
    mTargPrevLocation[3].set(0, 0, 0);
 
    mPlayerDetectionIndex = 0;
+   mLastDetectedClient = 0;
+   mDetectionCandidates = 1;
    mPlayerDetectionCounter = gAIDetectionOffset;
+   mMovementCounter = gAIDetectionOffset;
    gAIDetectionOffset++;
    if (gAIDetectionOffset >= 3)
       gAIDetectionOffset = 0;
@@ -496,37 +506,41 @@ void AIConnection::process(ShapeBase *ctrlObject)
    PROFILE_START(AI_process);
 
    //update the task queue
-   AITask *highestWeightTask = NULL;
-   S32 i;
-   for (i = 0; i < mTaskList.size(); i++)
+   PROFILE_START(AI_Tasks);
    {
-      AITask *task = mTaskList[i];
-      task->calcWeight(this);
+      AIThinkCost thinkCost(AIThinkScheduler::Tasks);
+      AITask *highestWeightTask = NULL;
+      for (S32 i = 0; i < mTaskList.size(); i++)
+      {
+         AITask *task = mTaskList[i];
+         task->calcWeight(this);
+         
+         //see if it's the highest so far
+         if ((! highestWeightTask) || (task->getWeight() > highestWeightTask->getWeight()))
+            highestWeightTask = task;
+      }
       
-      //see if it's the highest so far
-      if ((! highestWeightTask) || (task->getWeight() > highestWeightTask->getWeight()))
-         highestWeightTask = task;
-   }
-   
-   // Path needs team for avoiding threats- 
-   mPath.setTeam(getSensorGroup());
-   
-   //now see if we have a new task
-   if (highestWeightTask && mCurrentTask != highestWeightTask)
-   {
-      if (bool(mCurrentTask))
-         mCurrentTask->retire(this);
-      highestWeightTask->assume(this);
-      mCurrentTask = highestWeightTask;
-      mCurrentTaskTime = Sim::getCurrentTime();
-   }
-   
-   //monitor the current task
-   if (mCurrentTask) {
-      PROFILE_START(AI_MonitorTask);
-      mCurrentTask->monitor(this);
-      PROFILE_END();
+      // Path needs team for avoiding threats- 
+      mPath.setTeam(getSensorGroup());
+      
+      //now see if we have a new task
+      if (highestWeightTask && mCurrentTask != highestWeightTask)
+      {
+         if (bool(mCurrentTask))
+            mCurrentTask->retire(this);
+         highestWeightTask->assume(this);
+         mCurrentTask = highestWeightTask;
+         mCurrentTaskTime = Sim::getCurrentTime();
+      }
+      
+      //monitor the current task
+      if (mCurrentTask) {
+         PROFILE_START(AI_MonitorTask);
+         mCurrentTask->monitor(this);
+         PROFILE_END();
+      }
    }
+   PROFILE_END();
 
    //see if our control object is a player
    Player *myPlayer = NULL;
@@ -547,9 +561,21 @@ void AIConnection::process(ShapeBase *ctrlObject)
          PROFILE_END();
       }
       
-      //finally, process the movement itself
+      //finally, process the movement itself.  Bots the scheduler holds off keep
+      // steering for the move location they have (see getMoveList()), unless they're
+      // in the middle of something that can't coast.
       if (!myPlayer->isMounted())
-         processMovement(myPlayer);
+      {
+         bool mustMove = (mNavUsingJet || mEvadingCounter > 0 ||
+                           mMoveMode == ModeStuck || mMoveMode == ModeGainHeight);
+         if (gAIThink.ready(this, mThink, AIThinkScheduler::Movement, mMovementCounter, 1) || mustMove)
+         {
+            PROFILE_START(AI_Movement);
+            AIThinkCost thinkCost(AIThinkScheduler::Movement);
+            processMovement(myPlayer);
+            PROFILE_END();
+         }
+      }
       else
          processVehicleMovement(myPlayer);
    }
@@ -892,35 +918,55 @@ void AIConnection::updateDetectionTable(Player *player)
    if (Sim::getCurrentTime() < mBlindedTimer)
       return;
 
-   //time slice the detection LOS calls...
-   mPlayerDetectionCounter--;
-   if (mPlayerDetectionCounter <= 0)
-   {
-      SimGroup *clientGroup = Sim::getClientGroup();
-      AssertFatal(clientGroup, "Unable to get the client group");
+   SimGroup *clientGroup = Sim::getClientGroup();
+   AssertFatal(clientGroup, "Unable to get the client group");
 
-      //make sure we have more than one client
-      if (clientGroup->size() <= 1)
-         return;
+   //make sure we have more than one client
+   if (clientGroup->size() <= 1)
+      return;
 
-      //find the next client index
-      mPlayerDetectionIndex++;
-      if (mPlayerDetectionIndex >= clientGroup->size())
-         mPlayerDetectionIndex = 0;
+   //the Kidney Bot sees everyone at any range, everyone else only the players within 300m -
+   //with indexed detection only those get a turn (it changes the timing, so it is off by default)
+   bool useIndex = smIndexedDetection && mSkillLevel < 1.0f;
 
-      //get the client from the group
-      GameConnection *targClient = static_cast<GameConnection*>((*clientGroup)[mPlayerDetectionIndex]);
+   //time slice the detection LOS calls - the scheduler spaces them by the client count...
+   S32 detectionPeriod;
+   if (useIndex)
+      detectionPeriod = getMax(30 / getMax(mDetectionCandidates, 1), 3);
+   else
+      detectionPeriod = getMax(30 / (clientGroup->size() - 1), 3);
+   if (gAIThink.ready(this, mThink, AIThinkScheduler::Detection, mPlayerDetectionCounter, detectionPeriod))
+   {
+      AIThinkCost thinkCost(AIThinkScheduler::Detection);
+      smProximityStats.detectionSlots++;
 
-      //make sure it's not me...
-      S32 targClientId = targClient->getId();
-      if (getId() == targClientId)
+      GameConnection *targClient;
+      if (useIndex)
+      {
+         targClient = nextDetectionClient();
+         if (!targClient)
+            return;
+      }
+      else
       {
+         //find the next client index
          mPlayerDetectionIndex++;
          if (mPlayerDetectionIndex >= clientGroup->size())
             mPlayerDetectionIndex = 0;
+
+         //get the client from the group
          targClient = static_cast<GameConnection*>((*clientGroup)[mPlayerDetectionIndex]);
-         targClientId = targClient->getId();
+
+         //make sure it's not me...
+         if (getId() == targClient->getId())
+         {
+            mPlayerDetectionIndex++;
+            if (mPlayerDetectionIndex >= clientGroup->size())
+               mPlayerDetectionIndex = 0;
+            targClient = static_cast<GameConnection*>((*clientGroup)[mPlayerDetectionIndex]);
+         }
       }
+      S32 targClientId = targClient->getId();
 
       //now find this target in the table
       PlayerDetectionEntry *targEntry = NULL;
@@ -950,6 +996,8 @@ void AIConnection::updateDetectionTable(Player *player)
             targEntry->playerLOS = false;
             targEntry->playerLOSTime = Sim::getCurrentTime();
          }
+         //no LOS to cast, so try the next client next tick
+         mPlayerDetectionCounter = 0;
          return;
       }
       targPlayer = dynamic_cast<Player*>(targClient->getControlObject());   
@@ -960,6 +1008,7 @@ void AIConnection::updateDetectionTable(Player *player)
             targEntry->playerLOS = false;
             targEntry->playerLOSTime = Sim::getCurrentTime();
          }
+         mPlayerDetectionCounter = 0;
          return;
       }
 
@@ -1004,6 +1053,7 @@ void AIConnection::updateDetectionTable(Player *player)
             Point3F startPt = myEyePosition;
             Point3F endPt = myEyePosition + (getMin(300.0f, distToTarg) * losVector);
             U32 mask = TerrainObjectType | InteriorObjectType;
+            smProximityStats.detectionCasts++;
             if (! gServerContainer.castRay(startPt, endPt, mask, &rayInfo))
                clearLOSToTarg = true;
             else
@@ -1021,12 +1071,72 @@ void AIConnection::updateDetectionTable(Player *player)
       //update the position if required
       if (clearLOSToTarg)
          targPlayer->getWorldBox().getCenter(&targEntry->playerLastPosition);
+   }
+}
+
+// The next player in detection range after the last one checked, going round by
+// client id.  Anyone in the table who isn't in range can't be seen now; the exact
+// range test is still the one in updateDetectionTable, the index is a little generous.
+GameConnection *AIConnection::nextDetectionClient()
+{
+   ProximityIndex::Filter filter;
+   filter.typeMask = PlayerObjectType;
+   filter.excludeClient = getId();
+   ProximityIndex::EntryList nearby;
+   gServerProximity.findRadius(mLocation, 300.0f + 10.0f, filter, nearby);
+   mDetectionCandidates = nearby.size();
+
+   for (S32 i = 0; i < mPlayerDetectionTable.size(); i++)
+   {
+      PlayerDetectionEntry &entry = mPlayerDetectionTable[i];
+      if (!entry.playerLOS)
+         continue;
+      S32 j;
+      for (j = 0; j < nearby.size(); j++)
+         if (nearby[j]->clientId == entry.playerId)
+            break;
+      if (j == nearby.size())
+      {
+         entry.playerLOS = false;
+         entry.playerLOSTime = Sim::getCurrentTime();
+         smProximityStats.detectionOutOfRange++;
+      }
+   }
 
-      //don't forget to set the timeslice counter
-      mPlayerDetectionCounter = 30 / (clientGroup->size() - 1);
-      if (mPlayerDetectionCounter < 3)
-         mPlayerDetectionCounter = 3;
+   S32 first = 0, next = 0;
+   for (S32 i = 0; i < nearby.size(); i++)
+   {
+      S32 id = nearby[i]->clientId;
+      if (!first || id < first)
+         first = id;
+      if (id > mLastDetectedClient && (!next || id < next))
+         next = id;
    }
+   if (!next)
+      next = first;
+   if (!next)
+      return NULL;
+
+   mLastDetectedClient = next;
+   return dynamic_cast<GameConnection*>(Sim::findObject(next));
+}
+
+void AIConnection::dumpProximityStats(bool reset)
+{
+   Con::printf("AI proximity index: avoidance %s, detection %s", smUseProximityIndex ? "on" : "off",
+                  smIndexedDetection ? "on" : "off");
+   Con::printf("   avoid queries: %d, compared: %d, mismatches: %d", smProximityStats.avoidQueries,
+                  smProximityStats.avoidCompared, smProximityStats.avoidMismatches);
+   Con::printf("   detection slots: %d, LOS casts: %d, lost out of range: %d",
+                  smProximityStats.detectionSlots, smProximityStats.detectionCasts,
+                  smProximityStats.detectionOutOfRange);
+   if (reset)
+      smProximityStats.clear();
+}
+
+ConsoleFunction(aiProximityStats, void, 1, 2, "aiProximityStats(<reset>);")
+{
+   AIConnection::dumpProximityStats(argc > 1 && dAtob(argv[1]));
 }
 
 void AIConnection::setBlinded(S32 duration)
@@ -1146,8 +1256,9 @@ bool AIConnection::hasLOSToClient(S32 clientId, S32 &losTime, Point3F &lastLocat
 //  Then added slicing since it was weighing in on profiles.  
 void AIConnection::scriptProcessEngagement()
 {
-   if (!gScriptEngageSlicer.ready(mPackCheckCounter, 6))
+   if (!gAIThink.ready(this, mThink, AIThinkScheduler::Engage, mPackCheckCounter, 7))
       return;
+   AIThinkCost thinkCost(AIThinkScheduler::Engage);
 
    char idStr[32], targetIdStr[32], targetTypeStr[32], projectileStr[64];
    dSprintf(idStr, sizeof(idStr), "%d", getId());
@@ -1808,23 +1919,34 @@ Point3F AIConnection::correctHeading()
    return newLocation;
 }
 
-Point3F AIConnection::avoidPlayers(Player *player, const Point3F &desiredDestination, bool destIsFinal)
+// The closest shape with aiAvoidThis set (or static shape) that's actually in the
+// way, from the server proximity index or the container.  The index has them as of
+// the start of the tick with room to move, so the hits are checked against the box
+// as it is now, the same test the container makes.
+ShapeBase *AIConnection::findAvoidObject(Player *player, const Box3F &queryBox, bool useIndex,
+                                             Point3F &closestLocation)
 {
-   F32 avoidObjectAngle = -1;
-   //see if we're near another player
-   Box3F queryBox;
-   queryBox.min = mLocation;
-   queryBox.max = mLocation;
-   queryBox.min -= Point3F(2.0f, 2.0f, 0.5f);
-   queryBox.max += Point3F(2.0f, 2.0f, 2.5f);
-   
    ShapeBase *closestObject = NULL;
    F32 closestDist = 32767;
-   Point3F closestLocation;
    SimpleQueryList result;
    //U32 mask = PlayerObjectType;
    U32 mask = ShapeBaseObjectType | StaticTSObjectType;
-   gServerContainer.findObjects(queryBox, mask, SimpleQueryList::insertionCallback, S32(&result));
+   if (useIndex)
+   {
+      ProximityIndex::Filter filter;
+      filter.typeMask = mask;
+      filter.clients = ProximityIndex::AllObjects;
+      ProximityIndex::EntryList hits;
+      gServerProximity.findBox(queryBox, filter, hits);
+      for (S32 i = 0; i < hits.size(); i++)
+      {
+         SceneObject *hit = dynamic_cast<SceneObject*>(Sim::findObject(hits[i]->objectId));
+         if (hit && (hit->getType() & mask) && hit->getWorldBox().isOverlapped(queryBox))
+            result.mList.push_back(hit);
+      }
+   }
+   else
+      gServerContainer.findObjects(queryBox, mask, SimpleQueryList::insertionCallback, S32(&result));
    if (result.mList.size() > 1)
    {
       //find out if the closest person is to the left or right...
@@ -1877,6 +1999,34 @@ Point3F AIConnection::avoidPlayers(Player *player, const Point3F &desiredDestina
          }
       }
    }
+   return closestObject;
+}
+
+Point3F AIConnection::avoidPlayers(Player *player, const Point3F &desiredDestination, bool destIsFinal)
+{
+   F32 avoidObjectAngle = -1;
+   //see if we're near another player
+   Box3F queryBox;
+   queryBox.min = mLocation;
+   queryBox.max = mLocation;
+   queryBox.min -= Point3F(2.0f, 2.0f, 0.5f);
+   queryBox.max += Point3F(2.0f, 2.0f, 2.5f);
+   
+   Point3F closestLocation;
+   ShapeBase *closestObject = findAvoidObject(player, queryBox, smUseProximityIndex, closestLocation);
+   smProximityStats.avoidQueries++;
+
+   //the container's answer is the reference
+   if (smUseProximityIndex && smCompareProximity)
+   {
+      Point3F location;
+      ShapeBase *reference = findAvoidObject(player, queryBox, false, location);
+      smProximityStats.avoidCompared++;
+      if (reference != closestObject)
+         smProximityStats.avoidMismatches++;
+      closestObject = reference;
+      closestLocation = location;
+   }
    
    //if we didn't find anyone, return the desired dest
    if (! closestObject)
@@ -32,6 +32,9 @@
 #ifndef _AINAVJETTING_H_
 #include "ai/aiNavJetting.h"
 #endif
+#ifndef _AITHINK_H_
+#include "ai/aiThink.h"
+#endif
 
 //#define DEBUG_AI 1
 
@@ -258,15 +261,42 @@ private:
    Vector<PlayerDetectionEntry> mPlayerDetectionTable;
    S32 mPlayerDetectionIndex;
    S32 mPlayerDetectionCounter;
+   S32 mLastDetectedClient;      //with the proximity index, round the clients in range by id
+   S32 mDetectionCandidates;     //how many were in range last time
    S32 mDetectHiddenPeriod;      //even without LOS, the player will know where the enemy is until
                                  //this detectHiddenPeriod is over... after that, they'll only use
                                  //the last known location...
    S32 mBlindedTimer;            //used 
 
+   //think scheduling (aiThink.h)
+   AIThinkState mThink;
+   S32 mMovementCounter;
+
+   //proximity index use, see avoidPlayers and updateDetectionTable
+   struct ProximityStats
+   {
+      U32 avoidQueries;
+      U32 avoidCompared;
+      U32 avoidMismatches;
+      U32 detectionSlots;
+      U32 detectionCasts;
+      U32 detectionOutOfRange;
+      void clear() { dMemset(this, 0, sizeof(*this)); }
+   };
+   static ProximityStats smProximityStats;
+
+   ShapeBase *findAvoidObject(Player *player, const Box3F &queryBox, bool useIndex, Point3F &closestLocation);
+   GameConnection *nextDetectionClient();
+
 public:
    AIConnection();
    ~AIConnection();
 
+   static bool smUseProximityIndex;
+   static bool smIndexedDetection;
+   static bool smCompareProximity;
+   static void dumpProximityStats(bool reset);
+
 public:   
    DECLARE_CONOBJECT(AIConnection);
    static void consoleInit();
@@ -396,7 +426,6 @@ class AISlicer
 };
 
 extern AISlicer gCalcWeightSlicer;
-extern AISlicer gScriptEngageSlicer;
 extern bool gAISystemEnabled;
 
 
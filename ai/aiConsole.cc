@@ -7,10 +7,12 @@
 
 #include "math/mMatrix.h"
 #include "console/console.h"
+#include "console/consoleTypes.h"
 #include "console/simBase.h"
 #include "game/gameBase.h"
 #include "game/moveManager.h"
 #include "game/player.h"
+#include "game/proximityIndex.h"
 #include "ai/aiConnection.h"
 #include "ai/aiStep.h"
 #include "ai/aiNavStep.h"
@@ -76,21 +78,45 @@ static F32 cAIGetGraphDistance(SimObject *, S32, const char** argv)
    return NavigationGraph::fastDistance(source, dest);
 }
 
+// The clients near a point, nearest first, from the server's proximity index rather
+// than a walk of the ClientGroup - for script target selection.
+static const char * cAIFindNearbyClients(SimObject *, S32 argc, const char** argv)
+{
+   Point3F point(0, 0, 0);
+   dSscanf(argv[1], "%f %f %f", &point.x, &point.y, &point.z);
+   F32 radius = dAtof(argv[2]);
+   S32 count = (argc >= 4 ? dAtoi(argv[3]) : 1);
+
+   ProximityIndex::Filter filter;
+   filter.typeMask = PlayerObjectType | VehicleObjectType;
+   if (argc >= 5)
+      filter.excludeTeam = dAtoi(argv[4]);
+
+   ProximityIndex::EntryList list;
+   gServerProximity.findNearest(point, count, radius, filter, list);
+
+   char *ret = Con::getReturnBuffer(list.size() * 12 + 1);
+   ret[0] = '\0';
+   char *pos = ret;
+   for (S32 i = 0; i < list.size(); i++)
+      pos += dSprintf(pos, 12, i ? " %d" : "%d", list[i]->clientId);
+   return ret;
+}
+
 // Intended for initialization of whatever management is central to all bots.  
 AISlicer gCalcWeightSlicer;
-AISlicer gScriptEngageSlicer;
 
 static bool cAISlicerInit(SimObject *, S32, const char**)
 {
    gCalcWeightSlicer.init(30, 1);
-   gScriptEngageSlicer.init(15, 2);
+   gAIThink.reset();
    return true;
 }
 
 static bool cAISlicerReset(SimObject *, S32, const char**)
 {
    gCalcWeightSlicer.reset();
-   gScriptEngageSlicer.reset();
+   gAIThink.reset();
    return true;
 }
 
@@ -108,9 +134,18 @@ void AIInit()
 {
    Con::addCommand("aiConnect", cAIConnect, "aiConnect(name [, team , skill, offense, voice, voicePitch]);", 2, 7);
    Con::addCommand("AIGetPathDistance", cAIGetGraphDistance, "AIGetPathDistance(fromPoint, toPoint);", 3, 3);
+   Con::addCommand("AIFindNearbyClients", cAIFindNearbyClients, "AIFindNearbyClients(point, radius [, count, excludeTeam]);", 3, 5);
    Con::addCommand("AISlicerInit", cAISlicerInit, "AISlicerInit();", 1, 1);
    Con::addCommand("AISlicerReset", cAISlicerReset, "AISlicerReset();", 1, 1);
    Con::addCommand("AISystemEnabled", cAISystemEnabled, "AISystemEnabled([bool]);", 1, 2);
+
+   Con::addVariable("$pref::AI::thinkBudget", TypeS32, &AIThinkScheduler::smBudgetUS);
+   Con::addVariable("$pref::AI::thinkNearDist", TypeF32, &AIThinkScheduler::smNearDist);
+   Con::addVariable("$pref::AI::thinkFarDist", TypeF32, &AIThinkScheduler::smFarDist);
+   Con::addVariable("$pref::AI::thinkMaxStretch", TypeS32, &AIThinkScheduler::smMaxStretch);
+   Con::addVariable("$pref::AI::useProximityIndex", TypeBool, &AIConnection::smUseProximityIndex);
+   Con::addVariable("$pref::AI::indexedDetection", TypeBool, &AIConnection::smIndexedDetection);
+   Con::addVariable("$AI::compareProximity", TypeBool, &AIConnection::smCompareProximity);
 }
 
 static void cAISetSkillLevel(SimObject *obj, S32, const char** argv)
@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/aiConnection.h"
+#include "ai/aiThink.h"
+#include "console/console.h"
+#include "game/proximityIndex.h"
+
+S32   AIThinkScheduler::smBudgetUS = 2000;
+F32   AIThinkScheduler::smNearDist = 100.0f;
+F32   AIThinkScheduler::smFarDist = 400.0f;
+S32   AIThinkScheduler::smMaxStretch = 4;
+
+AIThinkScheduler  gAIThink;
+
+static const char * sStageNames[AIThinkScheduler::NumStages] = {
+   "tasks", "detection", "engage", "movement"
+};
+
+// How often a bot's distance to the humans is looked at-
+#define  PriorityPeriodMS     500
+
+//-------------------------------------------------------------------------------------
+
+AIThinkScheduler::AIThinkScheduler()
+{
+   mTickTime = 0;
+   mSpentUS = 0;
+   mTicksPerUS = 1;
+   mStats.clear();
+}
+
+void AIThinkScheduler::reset()
+{
+   mTickTime = 0;
+   mSpentUS = 0;
+   mStats.clear();
+}
+
+// The budget starts over with each sim tick.
+void AIThinkScheduler::checkTick()
+{
+   U32   now = Sim::getCurrentTime();
+   if (now != mTickTime)
+   {
+      if (mStats.ticks) {
+         mStats.overBudget += (mSpentUS > smBudgetUS);
+         mStats.maxTickUS = getMax(mStats.maxTickUS, mSpentUS);
+      }
+      mStats.ticks++;
+      mTickTime = now;
+      mSpentUS = 0;
+      mTicksPerUS = getMax(F64(Platform::SystemInfo.processor.mhz), 1.0);
+   }
+}
+
+void AIThinkScheduler::charge(Stage stage, U32 ticks)
+{
+   checkTick();
+   F64   us = ticks / mTicksPerUS;
+   mSpentUS += us;
+   mStats.totalUS[stage] += us;
+}
+
+// Stretch the periods of bots far from all the human players.  With no humans playing
+// there's nobody to notice, so everyone gets the most stretch.
+void AIThinkScheduler::updatePriority(AIConnection * ai, AIThinkState & state)
+{
+   U32   now = Sim::getCurrentTime();
+   if (state.mPriorityTime && now - state.mPriorityTime < PriorityPeriodMS)
+      return;
+   state.mPriorityTime = now;
+
+   ProximityIndex::Filter  humans;
+   humans.clients = ProximityIndex::HumanClients;
+   const ProximityIndex::Entry * human = gServerProximity.findNearest(ai->mLocation, smFarDist, humans);
+   F32   nearest = (human ? (human->position - ai->mLocation).len() : smFarDist);
+
+   S32   maxStretch = getMax(smMaxStretch, 1);
+   if (nearest <= smNearDist)
+      state.mStretch = 1;
+   else if (nearest >= smFarDist)
+      state.mStretch = maxStretch;
+   else
+   {
+      F32   along = (nearest - smNearDist) / (smFarDist - smNearDist);
+      state.mStretch = 1 + S32(along * (maxStretch - 1) + 0.5f);
+   }
+}
+
+// Like AISlicer::ready(), the counter is in ticks and the stage runs when it's out.
+// Once it's been out a whole period the budget doesn't hold it back.
+bool AIThinkScheduler::ready(AIConnection * ai, AIThinkState & state, Stage stage,
+                              S32 & counter, S32 period)
+{
+   checkTick();
+   if (--counter > 0)
+      return false;
+
+   if (mSpentUS >= smBudgetUS)
+   {
+      if (-counter < period) {
+         mStats.deferred[stage]++;
+         return false;
+      }
+      mStats.forced[stage]++;
+   }
+
+   updatePriority(ai, state);
+   counter = period * state.mStretch;
+   mStats.runs[stage]++;
+   return true;
+}
+
+//-------------------------------------------------------------------------------------
+
+void AIThinkScheduler::dumpStats(bool reset)
+{
+   U32   ticks = getMax(mStats.ticks, U32(1));
+   F64   totalUS = 0;
+   for (S32 i = 0; i < NumStages; i++)
+      totalUS += mStats.totalUS[i];
+
+   Con::printf("AI think: %d ticks, budget %d us, avg %.1f us, max %.1f us, %d over budget",
+               mStats.ticks, smBudgetUS, totalUS / ticks, mStats.maxTickUS, mStats.overBudget);
+   for (S32 j = 0; j < NumStages; j++)
+      Con::printf("   %-10s runs: %7d  deferred: %7d  forced: %5d  avg/tick: %8.1f us",
+                  sStageNames[j], mStats.runs[j], mStats.deferred[j], mStats.forced[j],
+                  mStats.totalUS[j] / ticks);
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(aiThinkStats, void, 1, 2, "aiThinkStats(<reset>);")
+{
+   gAIThink.dumpStats(argc > 1 && dAtob(argv[1]));
+}
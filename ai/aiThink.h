@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _AITHINK_H_
+#define _AITHINK_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PROFILER_H_
+#include "platform/profiler.h"
+#endif
+
+//-------------------------------------------------------------------------------------
+// Budgeted scheduling of the expensive bot thinking.
+//
+// Each stage asks the scheduler if it's ready, the way AISlicer is asked: the bot's
+// counter runs down over its period, which is stretched for bots far from any human
+// player, and once it's out the stage runs if this tick's budget isn't used up.  A
+// stage that's waited a whole period past due runs regardless, so nobody starves.
+// Bots that skip their movement keep steering at the move location they last worked
+// out, which getMoveList() does every tick anyway.
+
+class AIConnection;
+
+struct AIThinkState
+{
+   U32   mPriorityTime;       // when the stretch was last worked out
+   S32   mStretch;            // period multiplier, 1 near humans
+
+   AIThinkState() : mPriorityTime(0), mStretch(1) {}
+};
+
+class AIThinkScheduler
+{
+   public:
+      enum Stage {Tasks, Detection, Engage, Movement, NumStages};
+
+      static S32  smBudgetUS;          // per tick, for all the bots
+      static F32  smNearDist;          // bots this close to a human aren't stretched
+      static F32  smFarDist;           //    and this far get the most stretch
+      static S32  smMaxStretch;
+
+   protected:
+      U32   mTickTime;
+      F64   mSpentUS;
+      F64   mTicksPerUS;
+
+      struct Stats {
+         U32   ticks;
+         U32   overBudget;
+         F64   maxTickUS;
+         U32   runs[NumStages];
+         U32   deferred[NumStages];
+         U32   forced[NumStages];
+         F64   totalUS[NumStages];
+         void  clear() { dMemset(this, 0, sizeof(*this)); }
+      } mStats;
+
+      void  checkTick();
+      void  updatePriority(AIConnection * ai, AIThinkState & state);
+
+   public:
+      AIThinkScheduler();
+
+      bool  ready(AIConnection * ai, AIThinkState & state, Stage stage, S32 & counter, S32 period);
+      void  charge(Stage stage, U32 ticks);
+      void  reset();
+      void  dumpStats(bool reset);
+};
+
+extern AIThinkScheduler gAIThink;
+
+// Charges the time it's in scope to a stage.
+class AIThinkCost
+{
+      AIThinkScheduler::Stage mStage;
+      U32                     mStart[2];
+
+   public:
+      AIThinkCost(AIThinkScheduler::Stage stage) : mStage(stage)  {startHighResolutionTimer(mStart);}
+      ~AIThinkCost()    {gAIThink.charge(mStage, endHighResolutionTimer(mStart));}
+};
+
+#endif
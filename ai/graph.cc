@@ -14,6 +14,7 @@
 #include "game/player.h"
 #include "game/gameConnection.h"
 #include "ai/graphLOS.h"
+#include "ai/graphThreadPool.h"
 
 IMPLEMENT_CONOBJECT(NavigationGraph);
 
@@ -27,6 +28,7 @@ bool  NavigationGraph::sDrawIndoorNodes = true;
 bool  NavigationGraph::sDrawJetConnections = true;
 bool  NavigationGraph::sSeedDropOffs = false;
 F32   NavigationGraph::sProcessPercent = 0.0f;
+S32   NavigationGraph::sLOSThreads = 4;
 S32   NavigationGraph::sTotalEdgeCount = 0;
 S32   NavigationGraph::sEdgeRenderMaxOutdoor = 300;
 S32   NavigationGraph::sEdgeRenderMaxIndoor = 300;
@@ -50,11 +52,13 @@ enum Updates {
    ChangedToFloorPlan,
    TrimmedBridges, 
    RevisedLOSToHash, 
-   BetterSpawnMode 
+   BetterSpawnMode, 
+   AddedHierarchy, 
+   AddedLOSBlocks
    // AddedChuteHints
 };
 
-S32 NavigationGraph::sVersion = BetterSpawnMode;
+S32 NavigationGraph::sVersion = AddedLOSBlocks;
 
 //-------------------------------------------------------------------------------------
 
@@ -91,6 +95,8 @@ NavigationGraph::NavigationGraph()
    mValidPathTable = false;
    mIsSpawnGraph = false;
    mCheckNode = 0;
+   mEdgeGeneration = 0;
+   mNodeGeneration = 0;
    mDeadlyLiquid = false;
    mSubmergedScale = 1.0;
    mShoreLineScale = 1.0;
@@ -110,6 +116,7 @@ NavigationGraph::~NavigationGraph()
             delete transientNode;
 
    newIncarnation();       // (This deletes the searchers)
+   gPathQueue.stopThreads();
    
    delete [] mEdgePool;
    delete [] mOutdoorNodes;
@@ -176,6 +183,7 @@ bool NavigationGraph::onAdd()
       {
          makeGraph(true);
          pushBridges();
+         makeHierarchy();
          clearLoadData();        // remove load data not needed at run time.
       }
    }
@@ -217,11 +225,10 @@ void NavigationGraph::newIncarnation()
    mIncarnation = mIncarnation + 1;
 
    // Searchers-    
-   delete mTableBuilder;
+   stopLOSTableWork();
    delete mMainSearcher;
    delete mLOSSearcher;
    delete mDistSearcher;
-   mTableBuilder = NULL;
    mMainSearcher = NULL;
    mLOSSearcher = NULL;
    mDistSearcher = NULL;
@@ -312,6 +319,28 @@ U32 NavigationGraph::makeLOSHashTable()
    
    return memUsage;
 }
+
+// Move whatever table we have over to blocks.  Needs the nodes for the ordering.  
+U32 NavigationGraph::makeLOSBlockTable()
+{
+   Vector<Point3F>   locations;
+   getNodeLocations(locations);
+   
+   U32   memUsage = mLOSBlockTable.convertTable(*mLOSTable, locations);
+   if (mLOSTable != & mLOSBlockTable)
+      mLOSTable->clear();
+   mLOSTable = & mLOSBlockTable;
+   mLOSBlockTable.dumpStats();
+   
+   return memUsage;
+}
+
+void NavigationGraph::getNodeLocations(Vector<Point3F>& locations) const
+{
+   locations.setSize(numNodes());
+   for (S32 i = 0; i < mNonTransient.size(); i++)
+      locations[mNonTransient[i]->getIndex()] = mNonTransient[i]->location();
+}
    
 //-------------------------------------------------------------------------------------
 
@@ -501,7 +530,12 @@ bool NavigationGraph::load(Stream & s, bool isSpawn)
    
    if(mVersion >= AddedLOSTable) 
    {
-      if (mVersion >= RevisedLOSToHash)
+      if (mVersion >= AddedLOSBlocks)
+      {
+         Ok &= mLOSBlockTable.read(s);
+         mLOSTable = & mLOSBlockTable;
+      }
+      else if (mVersion >= RevisedLOSToHash)
       {
          Ok &= mLOSHashTable.read(s);
          mLOSTable = & mLOSHashTable;
@@ -526,6 +560,10 @@ bool NavigationGraph::load(Stream & s, bool isSpawn)
       }
    }
       
+   // Clusters for long searches- 
+   if (mVersion >= AddedHierarchy)
+      Ok &= mHierarchy.read(s);
+   
    // if(mVersion >= AddedChuteHints)
    //    Ok &= mChutes.read(s);
    
@@ -568,8 +606,13 @@ bool NavigationGraph::save(Stream & s)
    // Write out the table-    
    if (sVersion < RevisedLOSToHash)
       Ok &= mLOSXRef.write(s);
-   else 
+   else if (sVersion < AddedLOSBlocks)
       Ok &= mLOSHashTable.write(s);
+   else 
+      Ok &= mLOSBlockTable.write(s);
+   
+   // Clusters for long searches- 
+   Ok &= mHierarchy.write(s);
    
    // Chute hints- 
    // Ok &= mChutes.write(s);
@@ -696,6 +739,14 @@ static bool cMakeTables(SimObject * ptr, S32, const char* * )
 
 //-------------------------------------------------------------------------------------
 
+static bool cMakeHierarchy(SimObject * ptr, S32, const char* * )
+{
+   NavigationGraph * navGraph = static_cast<NavigationGraph*>(ptr);
+   return navGraph->makeHierarchy();
+}
+
+//-------------------------------------------------------------------------------------
+
 static bool cAssemble(SimObject * ptr, S32, const char* *)
 {
    NavigationGraph * navGraph = static_cast<NavigationGraph*>(ptr);
@@ -704,6 +755,14 @@ static bool cAssemble(SimObject * ptr, S32, const char* *)
 
 //-------------------------------------------------------------------------------------
 
+static bool cBuildGraph(SimObject * ptr, S32, const char* *)
+{
+   NavigationGraph * navGraph = static_cast<NavigationGraph*>(ptr);
+   return navGraph->buildGraph();
+}
+
+//-------------------------------------------------------------------------------------
+
 static S32 cNumNodes(SimObject* ptr, S32, const char* [])
 {
    NavigationGraph * navGraph = static_cast<NavigationGraph*>(ptr);
@@ -1437,6 +1496,13 @@ static void addGraphVariables()
    GraphVar1("$pref::NavGraph::drawIndoor",     TypeBool,   sDrawIndoorNodes);
    GraphVar1("$pref::NavGraph::drawJetEdges",   TypeBool,   sDrawJetConnections);
    GraphVar1("graphProcessPercent",             TypeF32,    sProcessPercent);
+   GraphVar2("$pref::NavGraph::losThreads",     TypeS32,    NavigationGraph::sLOSThreads);
+   GraphVar2("$pref::NavGraph::buildThreads",   TypeS32,    GraphThreadPool::smThreadCount);
+   GraphVar2("$pref::NavGraph::pathThreads",    TypeS32,    GraphPathQueue::smThreadCount);
+   GraphVar2("$pref::NavGraph::pathCacheSize",  TypeS32,    GraphPathCache::smSize);
+   GraphVar2("$pref::NavGraph::hierarchical",   TypeBool,   GraphHierarchy::smEnabled);
+   GraphVar2("$pref::NavGraph::hierarchyMinDist", TypeF32,  GraphHierarchy::smMinDist);
+   GraphVar2("$NavGraph::clusterSize",          TypeF32,    GraphHierarchy::smClusterSize);
 
    // Average MS per call to patch functions-    
    GraphVar2("patch1Avg",                       TypeF32,    gTrackProfPatch1.average);
@@ -1486,7 +1552,9 @@ void NavigationGraph::consoleInit()
    GraphCmd1("pushBridges", cPushBridges, "navGraph.pushBridges();", 2, 2);
    GraphCmd1("cullIslands", cCullIslands, "navGraph.cullIslands();", 2, 2);
    GraphCmd1("makeTables", cMakeTables, "navGraph.makeTables();", 2, 2);
+   GraphCmd1("makeHierarchy", cMakeHierarchy, "navGraph.makeHierarchy();", 2, 2);
    GraphCmd1("assemble", cAssemble, "navGraph.assemble();", 2, 2);
+   GraphCmd1("build", cBuildGraph, "navGraph.build();", 2, 2);
 
    // Tests / diagnostics
    GraphCmd1("timeTest", cTimeTest, "navGraph.timeTest(iterations[, doAStar])", 2, 4);
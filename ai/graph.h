@@ -42,6 +42,15 @@
 #ifndef _GRAPHSEARCHES_H_
 #include "ai/graphSearches.h"
 #endif
+#ifndef _GRAPHHIERARCHY_H_
+#include "ai/graphHierarchy.h"
+#endif
+#ifndef _GRAPHPATHCACHE_H_
+#include "ai/graphPathCache.h"
+#endif
+#ifndef _GRAPHPATHQUEUE_H_
+#include "ai/graphPathQueue.h"
+#endif
 #ifndef _GRAPHPATH_H_
 #include "ai/graphPath.h"
 #endif
@@ -56,6 +65,8 @@
 #include "console/simBase.h"
 #endif
 
+class MakeLOSEntries;
+
 class NavigationGraph : public SimObject 
 {
       typedef  SimObject Parent;
@@ -68,6 +79,7 @@ class NavigationGraph : public SimObject
       static   S32   sProfCtrl0, sProfCtrl1;
       static   S32   sTotalEdgeCount;
       static   F32   sProcessPercent;
+      static   S32   sLOSThreads;
       static   U32   sLoadMemUsed;
       static   S32   sShowThreatened;
       static   bool  sSeedDropOffs;
@@ -99,6 +111,8 @@ class NavigationGraph : public SimObject
       PathXRefTable           mPathXRef;
       ChuteHints              mChutes;
       LOSHashTable            mLOSHashTable;
+      LOSBlockTable           mLOSBlockTable;
+      GraphHierarchy          mHierarchy;
       
       // Run time node / edge lists:
       GraphNodeList           mNodeList;
@@ -121,6 +135,8 @@ class NavigationGraph : public SimObject
       S32                     mTransientStart;
       static S32              mIncarnation;
       S32                     mCheckNode;
+      U32                     mEdgeGeneration;
+      U32                     mNodeGeneration;
       const S32               mMaxTransients;
       bool                    mValidLOSTable;
       bool                    mValidPathTable;
@@ -130,7 +146,7 @@ class NavigationGraph : public SimObject
       bool                    mDeadlyLiquid;
       F32                     mSubmergedScale;
       F32                     mShoreLineScale;
-      GraphSearch *           mTableBuilder;
+      MakeLOSEntries *        mTableBuilder;
       GraphSearch *           mMainSearcher;
       GraphSearchLOS *        mLOSSearcher;
       GraphSearchDist *       mDistSearcher;
@@ -143,6 +159,7 @@ class NavigationGraph : public SimObject
       SearchThreats           mThreats;
       MonitorForceFields      mForceFields;
       JetManager              mJetManager;
+      GraphPathCache          mPathCache;
 
       // Temp buffers returned (as const T &) by misc fetch methods-
       Vector<S32>             mTempNodeBuf;
@@ -177,6 +194,8 @@ class NavigationGraph : public SimObject
       void           getOutdoorList(GraphNodeList& list);
       void           newIncarnation();
       S32            hookTransient(TransientNode&);
+      S32            captureTransient(const TransientNode&, const GraphNode*, S32, 
+                              GraphPathRequest::Hook&, GraphPathRequest&, const GraphNode*&);
       void           unhookTransient(TransientNode&);
       S32            floodPartition (U32 seed, bool needBoth, F32 jetRating);
       S32            partitionOneArmor(PartitionList& list, F32 jetRating);
@@ -222,6 +241,8 @@ class NavigationGraph : public SimObject
       bool           canReachLoc(const FindGraphNode& src, const FindGraphNode& dst, 
                               U32 team, const JetManager::ID& jetCaps);
       void           popTransientPair(TransientNode& src, TransientNode& dst);
+      bool           captureTransientPair(const TransientNode& src, const TransientNode& dst, 
+                              U32 team, const JetManager::ID& jetCaps, GraphPathRequest& R);
 
       // Graph construction methods called from console, console queries, ...
       bool           load(Stream&, bool isSpawn = false);
@@ -229,6 +250,7 @@ class NavigationGraph : public SimObject
       bool           loadGraph();
       bool           saveGraph();
       bool           assemble();
+      bool           buildGraph();
       bool           makeGraph(bool usePool=false);
       S32            makeTables();
       const char *   findBridges();
@@ -239,6 +261,7 @@ class NavigationGraph : public SimObject
       void           setGenMagnify(const SphereF*,const Point3F*,const Point3F*,F32 xy=1,F32 z=2);
       bool           prepLOSTableWork(Point3F viewLoc);
       bool           makeLOSTableEntries();
+      void           stopLOSTableWork();
       S32            cullIslands();
       bool           setGround(GroundPlan * gp);
       S32            randNode(const Point3F& P, F32 R, bool in, bool out);
@@ -248,6 +271,9 @@ class NavigationGraph : public SimObject
       const Point3F* getRandSpawnLoc(S32 nodeIndex);
       const Point3F* getSpawnLoc(S32 nodeIndex);
       U32            makeLOSHashTable();
+      U32            makeLOSBlockTable();
+      void           getNodeLocations(Vector<Point3F>& locations) const;
+      bool           makeHierarchy();
       void           makeSpawnList();
       U32            reckonMemory() const;
 
@@ -322,12 +348,22 @@ class NavigationGraph : public SimObject
       void        monitorForceFields()          {mForceFields.monitor();}
       Vector<S32>&  tempNodeBuff()              {return mTempNodeBuf;}
       const LOSTable* getLOSXref() const        {return mValidLOSTable ? mLOSTable : NULL;}
+      const LOSBlockTable& losBlockTable() const {return mLOSBlockTable;}
       const GraphBoundary& getBoundary(S32 i)   {return mBoundaries[i];}
       GraphThreatSet getThreatSet(S32 T) const  {return mThreats.getThreatSet(T);}
       void newPartition(GraphSearch* S, U32 T)  {mForceFields.informSearchFailed(S, T);}
+      void newPartition(const GraphPartition& P, U32 T) {mForceFields.informSearchFailed(P, T);}
       SearchThreats* threats()                  {return &mThreats;}
       JetManager& jetManager()                  {return mJetManager;}
       ChuteHints& getChutes()                   {return mChutes;}
+      GraphHierarchy& hierarchy()               {return mHierarchy;}
+      GraphPathCache& pathCache()               {return mPathCache;}
+      
+      // Bumped when what the path queue copies out of the graph changes- 
+      U32         edgeGeneration() const        {return mEdgeGeneration;}
+      U32         nodeGeneration() const        {return mNodeGeneration;}
+      void        edgesChanged()                {mEdgeGeneration++;}
+      void        nodesChanged()                {mNodeGeneration++;}
 
       // We manage the data that is shared (for memory optimization) among searchers
       GraphSearch::Globals    mSharedSearchLists;
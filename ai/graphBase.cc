@@ -293,6 +293,7 @@ void GraphNode::setAvoid(U32 duration, bool isImportant)
    {
       mAvoidUntil = curTime + duration;
       mFlags.set(StuckAvoid, isImportant);
+      gNavGraph->nodesChanged();
 
       // On avoidance, also mark neighbors-    
       if (isImportant) 
@@ -8,6 +8,7 @@
 #include "ai/graph.h"
 #include "ai/graphLOS.h"
 #include "ai/graphBridge.h"
+#include "ai/graphThreadPool.h"
 
 //-------------------------------------------------------------------------------------
 
@@ -127,6 +128,10 @@ GraphBridge::GraphBridge(const GraphNodeList& mainList, S32 islands,
       mBridgesOut(listOut)
 {
    heedSeeds(false);
+   mBatchCount = 0;
+   mBatchCandidates = NULL;
+   mBatchBridges = NULL;
+   mIslandCross = NULL;
 }
 
 //-------------------------------------------------------------------------------------
@@ -162,9 +167,10 @@ F32 GraphBridge::getEdgeTime(const GraphEdge * edge)
 
 //-------------------------------------------------------------------------------------
 
-// Here's where we do all the work - try to see if a bridge exists.  
-// 
-bool GraphBridge::tryToBridge(const GraphNode* from, const GraphNode* to, F32 heuristic)
+// Here's where we do all the work - try to see if a bridge exists.  This runs on the
+// build pool, so it only reads the graph, and its bridge goes on the given list.  
+bool GraphBridge::tryToBridge(const GraphNode* from, const GraphNode* to, 
+                                    BridgeDataList& out, F32 heuristic)
 {
    // This is actually where the separate passes (normal, then seeding) is controlled- 
    if (!heedThese(from, to))
@@ -406,7 +412,7 @@ bool GraphBridge::tryToBridge(const GraphNode* from, const GraphNode* to, F32 he
          if (hopOver)
             bridge1.setHop(wall);
 
-         mBridgesOut.push_back(bridge1);
+         out.push_back(bridge1);
          return true;
       }
    }
@@ -452,100 +458,149 @@ void GraphBridge::onQExtraction()
    }
 }
 
-// Do all the bridging.  Has two modes- spawn and regular nav.  Each iteration performs
-// one loop of bridging- from one source node to all nodes that need to be bridged.  
-S32 GraphBridge::findAllBridges()
+// Get the candidates for one source, in order of best-ness heuristic.  
+void GraphBridge::gatherCandidates(GraphNode* source)
 {
-   S32            nodeCount = mMainList.size();
-   Vector<S32>    islandCross(mIslands);
    GraphNodeList  considerList;
    
+   mCurrent = source;
+   mStartLoc = mCurrent->location();
+
+   Point3F  boxOff = (sSpawnGraph ? sBoxOffSPN : sBoxOffNAV);
+   Box3F    area(mStartLoc - boxOff, mStartLoc + boxOff);
+   S32      curIsland = mCurrent->island();
+   
+   gNavGraph->getNodesInBox(area, considerList);
+
+   // Divy out those in separate island, and mark those in the same island for 
+   // consideration by the special seacher.  
+   mCandidates.clear();
+   mSameIslandCount = 0;
+   for (S32 j = 0; j < considerList.size(); j++) {
+      GraphNode   *  consider = considerList[j];
+      if (consider != mCurrent) {
+         if (consider->island() == curIsland) {
+            if (!sSpawnGraph) {
+               mSameIslandMark.set(consider->getIndex());
+               mSameIslandCount++;
+            }
+         }
+         else {
+            // Bridges to different islands sorted by distance
+            F32         dist = (mStartLoc - consider->location()).lenSquared();
+            Candidate   candidate(consider, dist);
+            mCandidates.push_back(candidate);
+         }
+      }
+   }
+      
+   // Special search to find which same-island nodes need consideration.  We want
+   // to bridge same-island nodes if their ground travel distance is far relative
+   // to their straight-line distance.  
+   if (!sSpawnGraph) 
+   {
+      setEarlyOut(false);
+      mFromOutdoor = mCurrent->outdoor();
+      performSearch(mCurrent, NULL);
+   }
+   
+   // Candidates considered in order of best-ness heuristic
+   mCandidates.sort();
+}
+
+// Try to bridge one source to all its candidates.  
+void GraphBridge::bridgeSource(S32 job, S32 worker)
+{
+   const GraphNode   *  source = mBatchSources[job];
+   CandidateList &      candidates = mBatchCandidates[job];
+   BridgeDataList &     out = mBatchBridges[job];
+   Vector<S32> &        islandCross = mIslandCross[worker];
+   
+   setSizeAndClear(islandCross, mIslands);
+   for (CandidateList::iterator c = candidates.begin(); c != candidates.end(); c++)
+   {
+      if (sSpawnGraph) 
+      {
+         // For spawn we only need to cross to an island once.  
+         if (!islandCross[c->node->island()])
+            if (tryToBridge(source, c->node, out))
+               islandCross[c->node->island()] = true;
+      }
+      else 
+      {
+         // For regular graph, allow a certain number of bridges to each island. 
+         // Need to sort list, and vary base on island size.  We pass in the 
+         // heuristic # for avoiding too many walking connections.
+         if (islandCross[c->node->island()] < 3)
+            if (tryToBridge(source, c->node, out, -(c->heuristic)))
+               islandCross[c->node->island()]++;
+      }
+   }
+}
+
+void GraphBridge::bridgeJob(void* data, S32 job, S32 worker)
+{
+   ((GraphBridge *) data)->bridgeSource(job, worker);
+}
+
+// Bridges are kept in source order, which is the order they were found in serially.  
+void GraphBridge::runBatch(GraphThreadPool& pool)
+{
+   pool.run(bridgeJob, this, mBatchCount);
+   for (S32 i = 0; i < mBatchCount; i++) {
+      for (S32 j = 0; j < mBatchBridges[i].size(); j++)
+         mBridgesOut.push_back(mBatchBridges[i][j]);
+      mBatchBridges[i].clear();
+   }
+   mBatchCount = 0;
+}
+
+// Do all the bridging.  Has two modes- spawn and regular nav.  Each source node is 
+// bridged to all nodes that need to be bridged, independently of the others, so the
+// tries are spread over the build pool.  
+S32 GraphBridge::findAllBridges()
+{
+   S32               nodeCount = mMainList.size();
+   GraphThreadPool   pool;
+   
    mSameIslandMark.setSize(nodeCount);
    mSameIslandMark.clear();
    
    mRatios[1] = 1.6;      // Outdoor-to-outdoor- try a little smaller ratio than- 
    mRatios[0] = 2.2;      //    Other combinations of connections
    
-   setSizeAndClear(islandCross, mIslands);
+   mBatchCount = 0;
+   mBatchCandidates = new CandidateList[BatchSize];
+   mBatchBridges = new BridgeDataList[BatchSize];
+   mIslandCross = new Vector<S32>[pool.numWorkers()];
    
    for (S32 i = 0; i < nodeCount; i++) 
    {
-      if ((mCurrent = mMainList[i]) != NULL) 
+      if (GraphNode * source = mMainList[i]) 
       {
-         // Get list of all possibilities (bound box query)
-         mStartLoc = mCurrent->location();
-
          if (sMagSphere)
          {
             Point3F  pt = sMagSphere->center;
-            if ((pt -= mStartLoc).lenSquared() > SquareOf(sMagSphere->radius))
+            if ((pt -= source->location()).lenSquared() > SquareOf(sMagSphere->radius))
                continue;
          }
          
-         Point3F  boxOff = (sSpawnGraph ? sBoxOffSPN : sBoxOffNAV);
-         Box3F    area(mStartLoc - boxOff, mStartLoc + boxOff);
-         S32      curIsland = mCurrent->island();
-         
-         gNavGraph->getNodesInBox(area, considerList);
-      
-         // Divy out those in separate island, and mark those in the same island for 
-         // consideration by the special seacher.  
-         mCandidates.clear();
-         mSameIslandCount = 0;
-         for (S32 j = 0; j < considerList.size(); j++) {
-            GraphNode   *  consider = considerList[j];
-            if (consider != mCurrent) {
-               if (consider->island() == curIsland) {
-                  if (!sSpawnGraph) {
-                     mSameIslandMark.set(consider->getIndex());
-                     mSameIslandCount++;
-                  }
-               }
-               else {
-                  // Bridges to different islands sorted by distance
-                  F32         dist = (mStartLoc - consider->location()).lenSquared();
-                  Candidate   candidate(consider, dist);
-                  mCandidates.push_back(candidate);
-               }
-            }
-         }
-            
-         // Special search to find which same-island nodes need consideration.  We want
-         // to bridge same-island nodes if their ground travel distance is far relative
-         // to their straight-line distance.  
-         if (!sSpawnGraph) 
-         {
-            setEarlyOut(false);
-            mFromOutdoor = mCurrent->outdoor();
-            performSearch(mCurrent, NULL);
-         }
+         gatherCandidates(source);
          
-         // Candidates considered in order of best-ness heuristic
-         mCandidates.sort();
-      
-         // Try to bridge to all candidates which remain.  
-         setSizeAndClear(islandCross, mIslands);
-         for (CandidateList::iterator c = mCandidates.begin(); c != mCandidates.end(); c++)
-         {
-            if (sSpawnGraph) 
-            {
-               // For spawn we only need to cross to an island once.  
-               if (!islandCross[c->node->island()])
-                  if (tryToBridge(mCurrent, c->node))
-                     islandCross[c->node->island()] = true;
-            }
-            else 
-            {
-               // For regular graph, allow a certain number of bridges to each island. 
-               // Need to sort list, and vary base on island size.  We pass in the 
-               // heuristic # for avoiding too many walking connections.
-               if (islandCross[c->node->island()] < 3)
-                  if (tryToBridge(mCurrent, c->node, -(c->heuristic)))
-                     islandCross[c->node->island()]++;
-            }
-         }
+         mBatchSources[mBatchCount] = source;
+         mBatchCandidates[mBatchCount] = mCandidates;
+         if (++mBatchCount == BatchSize)
+            runBatch(pool);
       }
    }
+   runBatch(pool);
+   
+   delete [] mBatchCandidates;
+   delete [] mBatchBridges;
+   delete [] mIslandCross;
+   mBatchCandidates = NULL;
+   mBatchBridges = NULL;
+   mIslandCross = NULL;
    
    return mBridgesOut.size();
 }
@@ -968,6 +1023,7 @@ bool NavigationGraph::assemble()
    mBridgeList.merge(bridges);
    makeGraph();
    pushBridges();
+   makeHierarchy();
 
    // Done
    return 0;
@@ -8,6 +8,8 @@
 #ifndef _GRAPHBRIDGE_H_
 #define _GRAPHBRIDGE_H_
 
+class GraphThreadPool;
+
 class GraphBridge : public GraphSearch
 {
    protected:
@@ -40,12 +42,26 @@ class GraphBridge : public GraphSearch
       CandidateList     mCandidates;
       ChutePtrList      mChuteList;
 
+      // Sources are gathered on the main thread (the searcher isn't shareable) a 
+      // batch at a time, and their candidates are then tried on the build pool.  
+      enum {BatchSize = 256};
+      S32               mBatchCount;
+      GraphNode      *  mBatchSources[BatchSize];
+      CandidateList  *  mBatchCandidates;
+      BridgeDataList *  mBatchBridges;
+      Vector<S32>    *  mIslandCross;         // one per pool worker
+
    protected:   
       void  onQExtraction();
       F32   getEdgeTime(const GraphEdge* e);
       bool  earlyOut() {return true;}
       bool  heedThese(const GraphNode* from, const GraphNode* to);
-      bool  tryToBridge(const GraphNode* from, const GraphNode* to, F32 ratio=1e13);
+      bool  tryToBridge(const GraphNode* from, const GraphNode* to, BridgeDataList& out, 
+                              F32 ratio=1e13);
+      void  gatherCandidates(GraphNode* source);
+      void  bridgeSource(S32 job, S32 worker);
+      void  runBatch(GraphThreadPool& pool);
+      static void bridgeJob(void* data, S32 job, S32 worker);
       void  checkOutdoor(const GraphNode* from, const GraphNode* to);
       
    public:
@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/graph.h"
+#include "ai/graphBuild.h"
+#include "ai/graphFloorPlan.h"
+#include "ai/graphThreadPool.h"
+#include "console/console.h"
+#include "game/missionArea.h"
+#include "platform/event.h"
+#include "platform/gameInterface.h"
+#include "platform/platformAudio.h"
+
+//-------------------------------------------------------------------------------------
+
+static void reportStage(const char * stage, U32& stageMS)
+{
+   U32   now = Platform::getRealMilliseconds();
+   Con::printf("Graph build: %-12s %8d ms", stage, now - stageMS);
+   stageMS = now;
+}
+
+// The whole build, from the mission as loaded to the saved graph.  This is what
+// script drove a step at a time (gp.inspect(), fp.generate(), fp.upload(),
+// navGraph.assemble(), makeLOS, makeTables, saveGraph), with the terrain squares
+// inspected on the build pool while the interiors are worked out here on the main
+// thread, since that calls into script.  The jetting bridges and the LOS table are
+// made on threads of their own as well.
+bool NavigationGraph::buildGraph()
+{
+   U32   buildMS = Platform::getRealMilliseconds();
+   U32   stageMS = buildMS;
+
+   {
+      GraphThreadPool   pool;
+      GroundPlan     *  groundPlan = NULL;
+
+      Con::printf("Graph build: %d build threads", pool.numWorkers());
+
+      if (haveTerrain())
+      {
+         Point2I  point = MissionArea::smMissionArea.point;
+         Point2I  extent = MissionArea::smMissionArea.extent;
+
+         groundPlan = new GroundPlan;
+         groundPlan->registerObject();
+         if (!groundPlan->startExterior(point, extent, this, pool))
+         {
+            groundPlan->deleteObject();
+            groundPlan = NULL;
+         }
+      }
+
+      FloorPlan * floorPlan = new FloorPlan;
+      floorPlan->registerObject();
+      floorPlan->generate();
+      floorPlan->upload2NavGraph(this);
+      floorPlan->deleteObject();
+      reportStage("floor plan", stageMS);
+
+      if (groundPlan)
+      {
+         groundPlan->finishInspect(pool);
+         setGround(groundPlan);
+         groundPlan->deleteObject();
+         reportStage("ground plan", stageMS);
+      }
+   }
+
+   assemble();
+   reportStage("jet edges", stageMS);
+
+   prepLOSTableWork(Point3F(0, 0, 100));
+   while (makeLOSTableEntries())
+      ;
+   reportStage("LOS table", stageMS);
+
+   makeTables();
+   reportStage("roam table", stageMS);
+
+   bool  Ok = saveGraph();
+   reportStage("save", stageMS);
+
+   Con::printf("Graph build: %d nodes, %s in %d ms", numNodes(),
+                     Ok ? "saved" : "NOT saved", Platform::getRealMilliseconds() - buildMS);
+   return Ok;
+}
+
+//-------------------------------------------------------------------------------------
+
+namespace GraphBuild
+{
+   static bool sActive = false;
+   static U32  sStartMS = 0;
+   static U32  sTimeoutMS = 120000;
+   static S32  sExitCode = Saved;
+
+   void start(S32 argc, const char **argv)
+   {
+      for (S32 i = 1; i < argc; i++)
+      {
+         if (!dStricmp(argv[i], "-navBuild"))
+            sActive = true;
+         else if (!dStricmp(argv[i], "-navBuildThreads") && i < argc - 1)
+            GraphThreadPool::smThreadCount = NavigationGraph::sLOSThreads = dAtoi(argv[++i]);
+         else if (!dStricmp(argv[i], "-navBuildTimeout") && i < argc - 1)
+            sTimeoutMS = U32(getMax(dAtoi(argv[++i]), 1)) * 1000;
+      }
+      if (!sActive)
+         return;
+
+      // The graph loads whatever is there to build from, not just the spawn graph-
+      Con::setBoolVariable("$OFFLINE_NAV_BUILD", true);
+
+      // nobody is listening...
+      Audio::setDriver("none");
+      Con::printf("Graph build: waiting for the mission to load.");
+      sStartMS = Platform::getRealMilliseconds();
+   }
+
+   static void finish(S32 exitCode)
+   {
+      sActive = false;
+      sExitCode = exitCode;
+      Game->setRunning(false);
+   }
+
+   // The mission file makes the graph and the mission group in one go, so once the
+   // mission group is here between frames the mission has loaded, and the graph is 
+   // either there too or the mission doesn't have one.  
+   void process()
+   {
+      if (!sActive)
+         return;
+
+      if (!Sim::findObject("MissionGroup"))
+      {
+         if (Platform::getRealMilliseconds() - sStartMS >= sTimeoutMS) {
+            Con::errorf("Graph build: no mission loaded after %d seconds.", sTimeoutMS / 1000);
+            finish(NoMission);
+         }
+         return;
+      }
+      if (!gNavGraph)
+      {
+         Con::errorf("Graph build: the mission has no NavigationGraph.");
+         finish(NoGraph);
+         return;
+      }
+
+      finish(gNavGraph->buildGraph() ? Saved : NotSaved);
+   }
+
+   bool isActive()
+   {
+      return sActive;
+   }
+
+   S32 getExitCode()
+   {
+      return sExitCode;
+   }
+}
@@ -0,0 +1,43 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GRAPHBUILD_H_
+#define _GRAPHBUILD_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+//-------------------------------------------------------------------------------------
+// Headless navigation graph build.
+//
+//    -navBuild [-navBuildThreads <n>] [-navBuildTimeout <seconds>]
+//
+// Once the mission named on the command line has loaded, its graph is built with
+// navGraph.build() (graphBuild.cc) and saved, with the time each stage took printed
+// to the console, and the game quits.  The build stages run on the build pool
+// (graphThreadPool.h), which -navBuildThreads sizes along with the LOS table threads.
+// The game exits with one of the codes below, so a build script can tell a mission
+// without a NavigationGraph, or one that never loaded (within the timeout, two
+// minutes unless given), from a good build.
+
+namespace GraphBuild
+{
+   enum ExitCode {
+      Saved       = 0,
+      NotSaved    = 1,
+      NoGraph     = 2,
+      NoMission   = 3
+   };
+
+   void start(S32 argc, const char **argv);
+   void process();
+   bool isActive();
+   S32  getExitCode();
+}
+
+#endif
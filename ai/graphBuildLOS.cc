@@ -6,6 +6,14 @@
 //-----------------------------------------------------------------------------
 
 #include "ai/graph.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "platform/profiler.h"
+#include "sceneGraph/sceneGraph.h"
+#include "terrain/terrData.h"
 
 #define  MuzzleHt    0.82f
 #define  HeadHt      2.2f
@@ -29,180 +37,523 @@ static void makeScrambler(Vector<S32>& vec, S32 size)
    }
 }
 
-static RayInfo sColl;
-static bool haveLOS(Point3F src, Point3F dst, F32 above)
+//-------------------------------------------------------------------------------------
+// The rows of the table (one source node against all higher numbered nodes within 
+// a path distance) don't depend on each other, so worker threads each take rows off 
+// the scrambled list and run them with their own container query context.  The main
+// thread does rows too between frames.  Rows come back as lists of the non-Hidden 
+// entries, which the block table is made from at the end.  A row's LOS rays go out
+// as one batch (see castRow()).  
+// 
+// The container isn't safe to query while the sim moves objects around in it, so the
+// threads only run during workAWhile(): they're started on a slice with the main 
+// thread, and it waits for them to finish their rows before going back to the sim.  
+
+class LOSRowThread;
+
+class MakeLOSEntries
 {
-   static const U32 sMask = InteriorObjectType|TerrainObjectType;
-   src.z += above;
-   dst.z += above;
-   return !gServerContainer.castRay(src, dst, sMask, &sColl);
-}
+   public:
+      enum {MaxThreads = 8};
       
-class MakeLOSEntries : public GraphSearch
-{
+      // What one thread needs to run rows- 
+      struct Worker 
+      {
+         struct QEntry {F32 mDist; S32 mNode;};
+         Vector<F32>       mDist;
+         Vector<S32>       mTouched;
+         Vector<QEntry>    mHeap;
+         GraphEdge         mEdgeBuffer[MaxOnDemandEdges];
+         LOSBlockTable::EntryList   mEntries;
+         Vector<S32>       mTargets;         // nodes the row needs LOS to
+         Vector<Point3F>   mStarts;
+         Vector<Point3F>   mEnds;
+         Vector<Point3F>   mTerrStarts;
+         Vector<Point3F>   mTerrEnds;
+         Vector<RayInfo>   mInfos;
+         Vector<bool>      mHits;
+         S32               mLOSCalls;
+         S32               mLowButNotHigh;
+         
+         Worker();
+         void  push(F32 dist, S32 node);
+         void  pop();
+      };
+      
+   protected:
       const GraphNodeList& mList;
-      LOSXRefTable&        mLOSTable;
-      S32                  mCurrent;
-      GraphNode         *  mFromNode;
-      Point3F              mFromLoc;
       F32                  mThreshDist;
-      U32                  mStartTime, mSaveMS;
-      S32                  mLowButNotHigh;
-      S32                  mFromIndex;
+      U32                  mSaveMS;
       Vector<S32>          mScramble;
-      S32                  mLOSCalls;
+      S32                  mNextRow;         // guarded by mMutex
+      S32                  mRowsDone;        // guarded by mMutex
+      void  *              mMutex;
+      Worker               mMainWorker;
+      Worker *             mWorkers[MaxThreads];
+      LOSRowThread *       mThreads[MaxThreads];
+      U32                  mNumThreads;
+      Vector<LineSegment>  mRenderSegs;      // guarded by mMutex
+      TerrainBlock *       mTerrain;
+      void  *              mSliceStart;
+      void  *              mSliceDone;
+      U32                  mStopTime;        // of the current slice
+      volatile bool        mStopping;
+      
+      void  runRow(S32 fromIndex, Worker& W);
+      void  castRow(S32 fromIndex, Worker& W);
       
    public:
-      Vector<LineSegment>  mRenderSegs;
       Point3F              mViewLoc;
    
-   protected:  
-      // virtuals- 
-      void  onQExtraction();
-      F32   getEdgeTime(const GraphEdge*);
-      bool  earlyOut();
-
    public:
-      MakeLOSEntries(const GraphNodeList& list, LOSXRefTable& xRef, Point3F view);
+      MakeLOSEntries(const GraphNodeList& list, Point3F view);
+      ~MakeLOSEntries();
 
-      bool  isDone() const          {return mCurrent>=mList.size();}
+      bool  isDone();
       U32   elapsedTime()  const    {return Platform::getRealMilliseconds()-mSaveMS;}
-      S32   lowNotHigh()  const     {return mLowButNotHigh;}
-      S32   numLOSCalls()  const    {return mLOSCalls;}
-      bool  nextOneReady();
+      bool  runRows(Worker& W, U32 stopTime = 0);
+      void  runSlices(Worker& W);
       void  workAWhile();
+      void  takeRenderSegs(Vector<LineSegment>& segs);
+      void  finish(LOSBlockTable::EntryList& entries, S32& losCalls, S32& lowNotHigh);
 };
 
-MakeLOSEntries::MakeLOSEntries(const GraphNodeList& list, LOSXRefTable& los, Point3F v)
-   :  mList(list), mLOSTable(los), mViewLoc(v)
+class LOSRowThread : public Thread
+{
+      MakeLOSEntries *           mBuilder;
+      MakeLOSEntries::Worker *   mWorker;
+      ContainerQueryContext *    mContext;
+      S32                        mIndex;
+
+   public:
+      LOSRowThread(MakeLOSEntries * builder, MakeLOSEntries::Worker * worker, 
+                        ContainerQueryContext * context, S32 index) 
+         :  Thread(0, index, false)
+      {
+         mBuilder = builder;
+         mWorker = worker;
+         mContext = context;
+         mIndex = index;
+         start();
+      }
+      ~LOSRowThread()
+      {
+         delete mContext;
+      }
+      
+      void run(S32)
+      {
+         if (gProfiler) {
+            char name[32];
+            dSprintf(name, sizeof(name), "LOS %d", mIndex);
+            gProfiler->setThreadName(name);
+         }
+         ContainerQueryContext::Scope scope(mContext);
+         mBuilder->runSlices(* mWorker);
+      }
+};
+
+//-------------------------------------------------------------------------------------
+
+MakeLOSEntries::Worker::Worker()
+{
+   mLOSCalls = mLowButNotHigh = 0;
+}
+
+void MakeLOSEntries::Worker::push(F32 dist, S32 node)
+{
+   S32   i = mHeap.size();
+   mHeap.increment();
+   while (i > 0 && mHeap[(i - 1) >> 1].mDist > dist) {
+      mHeap[i] = mHeap[(i - 1) >> 1];
+      i = (i - 1) >> 1;
+   }
+   mHeap[i].mDist = dist;
+   mHeap[i].mNode = node;
+}
+
+void MakeLOSEntries::Worker::pop()
+{
+   QEntry   last = mHeap.last();
+   S32      i = 0, child, size = mHeap.size() - 1;
+   
+   while ((child = (i << 1) + 1) < size) {
+      if (child + 1 < size && mHeap[child + 1].mDist < mHeap[child].mDist)
+         child++;
+      if (mHeap[child].mDist >= last.mDist)
+         break;
+      mHeap[i] = mHeap[child];
+      i = child;
+   }
+   mHeap[i] = last;
+   mHeap.decrement();
+}
+
+MakeLOSEntries::MakeLOSEntries(const GraphNodeList& list, Point3F v)
+   :  mList(list), mViewLoc(v)
 {
-   S32   N = list.size();
-   mLOSTable.setDims(N * (N + 1) >> 1, 2);      // Alloc our 2-bit table
    mViewLoc.set(-44,-31,90);
    mThreshDist = 700.0f;
-   mCurrent = -1;
    mSaveMS = Platform::getRealMilliseconds();
-   mLOSCalls = mLowButNotHigh = 0;
+   mNextRow = mRowsDone = 0;
    makeScrambler(mScramble, list.size());
+   mMutex = Mutex::createMutex();
+   mSliceStart = Semaphore::createSemaphore(0);
+   mSliceDone = Semaphore::createSemaphore(0);
+   mStopTime = 0;
+   mStopping = false;
+   mTerrain = gServerSceneGraph ? gServerSceneGraph->getCurrentTerrain() : NULL;
+   if (mTerrain && !mTerrain->isCollisionEnabled())
+      mTerrain = NULL;
+   
+   // Each thread needs a container context, there may not be as many as we want- 
+   S32   want = mClamp(NavigationGraph::sLOSThreads, 0, MaxThreads);
+   for (mNumThreads = 0; mNumThreads < want; mNumThreads++) {
+      ContainerQueryContext * context = ContainerQueryContext::create();
+      if (!context)
+         break;
+      mWorkers[mNumThreads] = new Worker();
+      mThreads[mNumThreads] = new LOSRowThread(this, mWorkers[mNumThreads], context, mNumThreads);
+   }
+   Con::printf("Making LOS table on %d threads", mNumThreads + 1);
 }
 
-// Run LOS from base to this node.  We truncate the search at a certain path distance, 
-// which should make sense in all but a few cases that we should be aware of.  It 
-// will make the search quicker for most worlds though.  
-void MakeLOSEntries::onQExtraction()
+// The threads are between slices here.  
+MakeLOSEntries::~MakeLOSEntries()
 {
-   S32   toIndex = extractedNode()->getIndex();
+   U32   i;
+   mStopping = true;
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::releaseSemaphore(mSliceStart);
    
-   if (mFromIndex < toIndex) {
-      //==> Path distance really not right- just need a better local query.  
-      if (distSoFar() < mThreshDist) {
-         Point3F  toLoc = extractedNode()->location();
-         bool     losLow = haveLOS(mFromLoc, toLoc, MuzzleHt);
-         bool     losHigh = haveLOS(mFromLoc, toLoc, HeadHt);
-         U32      tabEntry = LOSXRefTable::Hidden;
+   for (i = 0; i < mNumThreads; i++) {
+      mThreads[i]->join();
+      delete mThreads[i];
+      delete mWorkers[i];
+   }
+   Semaphore::destroySemaphore(mSliceStart);
+   Semaphore::destroySemaphore(mSliceDone);
+   Mutex::destroyMutex(mMutex);
+}
 
-         // Speed tracking         
-         mLOSCalls += 2;
+// Run LOS from base to the higher numbered nodes.  We truncate the search at a certain 
+// path distance, which should make sense in all but a few cases that we should be 
+// aware of.  It will make the search quicker for most worlds though.  
+void MakeLOSEntries::runRow(S32 fromIndex, Worker& W)
+{
+   S32         numNodes = mList.size();
+   S32         i;
+   
+   if (W.mDist.size() != numNodes) {
+      W.mDist.setSize(numNodes);
+      for (i = 0; i < numNodes; i++)
+         W.mDist[i] = SearchFailureAssure;
+   }
+   
+   W.mDist[fromIndex] = 0;
+   W.mTouched.push_back(fromIndex);
+   W.push(0, fromIndex);
+   
+   while (W.mHeap.size())
+   {
+      F32   dist = W.mHeap[0].mDist;
+      S32   toIndex = W.mHeap[0].mNode;
+      W.pop();
+      if (dist > W.mDist[toIndex])
+         continue;
       
-         // These are strange- add to list of warning log for graph maker
-         mLowButNotHigh += (losLow && !losHigh);
-         
-         // Crude calc of entry for now- 
-         if(losLow)
-            tabEntry = LOSXRefTable::FullLOS;
-         else if (losHigh)
-            tabEntry = LOSXRefTable::MinorLOS;
-
-         // Enter into table-             
-         mLOSTable.setEntry(mFromIndex, toIndex, tabEntry);
-
-         // Stuff to render-       
-         if (mRenderSegs.size() < 600) {
-            LineSegment segment(mFromLoc, tabEntry ? toLoc : sColl.point);
-            if (segment.distance(mViewLoc) < 120.0f)
-               mRenderSegs.push_back(segment);
+      //==> Path distance really not right- just need a better local query.  
+      if (dist >= mThreshDist)
+         break;
+      
+      GraphNode * toNode = mList[toIndex];
+      if (fromIndex < toIndex) 
+         W.mTargets.push_back(toIndex);
+      
+      // Relax by edge distance- 
+      GraphEdgeArray edges = toNode->getEdges(W.mEdgeBuffer);
+      while (GraphEdge * edge = edges++)
+         if (edge->mDest < numNodes)
+         {
+            F32   newDist = dist + edge->mDist;
+            if (newDist < W.mDist[edge->mDest]) {
+               if (W.mDist[edge->mDest] == SearchFailureAssure)
+                  W.mTouched.push_back(edge->mDest);
+               W.mDist[edge->mDest] = newDist;
+               W.push(newDist, edge->mDest);
+            }
          }
-      }
-      else // outside
-         setDone();
    }
+   
+   castRow(fromIndex, W);
+   
+   // Reset for the next row- 
+   W.mTargets.clear();
+   for (i = 0; i < W.mTouched.size(); i++)
+      W.mDist[W.mTouched[i]] = SearchFailureAssure;
+   W.mTouched.clear();
+   W.mHeap.clear();
 }
 
-// Virtual - this will cause graph time to equal distance.  
-F32 MakeLOSEntries::getEdgeTime(const GraphEdge * edge)
+// Cast the muzzle and head height rays from the row's node to each target.  The 
+// terrain takes the whole batch in packets (TerrainBlock::castRays()), and only 
+// the rays it doesn't block go to the container for the interiors.  TerrainBlock
+// is the only TerrainObjectType, so the answers are the same as casting each ray 
+// against both.  
+void MakeLOSEntries::castRow(S32 fromIndex, Worker& W)
 {
-   return edge->mDist;
+   S32      numTargets = W.mTargets.size();
+   S32      numRays = numTargets * 2;
+   Point3F  fromLoc = mList[fromIndex]->location();
+   S32      i;
+   
+   if (!numTargets)
+      return;
+   
+   // Rays 2i and 2i+1 are the muzzle and head height rays to target i- 
+   W.mStarts.setSize(numRays);
+   W.mEnds.setSize(numRays);
+   W.mInfos.setSize(numRays);
+   W.mHits.setSize(numRays);
+   for (i = 0; i < numTargets; i++) {
+      Point3F  toLoc = mList[W.mTargets[i]]->location();
+      W.mStarts[i * 2].set(fromLoc.x, fromLoc.y, fromLoc.z + MuzzleHt);
+      W.mEnds[i * 2].set(toLoc.x, toLoc.y, toLoc.z + MuzzleHt);
+      W.mStarts[i * 2 + 1].set(fromLoc.x, fromLoc.y, fromLoc.z + HeadHt);
+      W.mEnds[i * 2 + 1].set(toLoc.x, toLoc.y, toLoc.z + HeadHt);
+   }
+   
+   U32   mask = InteriorObjectType|TerrainObjectType;
+   if (mTerrain) 
+   {
+      // Into terrain space the way the container does it- 
+      const MatrixF& worldToObj = mTerrain->getWorldTransform();
+      const Point3F& scale = mTerrain->getScale();
+      W.mTerrStarts.setSize(numRays);
+      W.mTerrEnds.setSize(numRays);
+      for (i = 0; i < numRays; i++) {
+         worldToObj.mulP(W.mStarts[i], &W.mTerrStarts[i]);
+         worldToObj.mulP(W.mEnds[i], &W.mTerrEnds[i]);
+         W.mTerrStarts[i].convolveInverse(scale);
+         W.mTerrEnds[i].convolveInverse(scale);
+      }
+      mTerrain->castRays(numRays, W.mTerrStarts.address(), W.mTerrEnds.address(), 
+                           W.mInfos.address(), W.mHits.address());
+      for (i = 0; i < numRays; i++)
+         if (W.mHits[i])
+            W.mInfos[i].point.interpolate(W.mStarts[i], W.mEnds[i], W.mInfos[i].t);
+      mask = InteriorObjectType;
+   }
+   else 
+   {
+      for (i = 0; i < numRays; i++)
+         W.mHits[i] = false;
+   }
+   
+   for (i = 0; i < numRays; i++)
+      if (!W.mHits[i])
+         W.mHits[i] = gServerContainer.castRay(W.mStarts[i], W.mEnds[i], mask, &W.mInfos[i]);
+   
+   for (i = 0; i < numTargets; i++)
+   {
+      S32      toIndex = W.mTargets[i];
+      Point3F  toLoc = mList[toIndex]->location();
+      bool     losLow = !W.mHits[i * 2];
+      bool     losHigh = !W.mHits[i * 2 + 1];
+      U32      tabEntry = LOSTable::Hidden;
+
+      // Speed tracking         
+      W.mLOSCalls += 2;
+   
+      // These are strange- add to list of warning log for graph maker
+      W.mLowButNotHigh += (losLow && !losHigh);
+      
+      // Crude calc of entry for now- 
+      if(losLow)
+         tabEntry = LOSTable::FullLOS;
+      else if (losHigh)
+         tabEntry = LOSTable::MinorLOS;
+
+      // Enter into table-             
+      if (tabEntry != LOSTable::Hidden) {
+         LOSBlockTable::Entry    entry;
+         entry.mFrom = fromIndex;
+         entry.mTo = toIndex;
+         entry.mCode = tabEntry;
+         W.mEntries.push_back(entry);
+      }
+
+      // Stuff to render-       
+      LineSegment segment(fromLoc, tabEntry ? toLoc : W.mInfos[i * 2 + 1].point);
+      if (segment.distance(mViewLoc) < 120.0f) {
+         Mutex::lockMutex(mMutex);
+         if (mRenderSegs.size() < 600)
+            mRenderSegs.push_back(segment);
+         Mutex::unlockMutex(mMutex);
+      }
+   }
 }
 
-// Prepare a new search.  Note mCurrent constructs at -1 for proper entry.  
-bool MakeLOSEntries::nextOneReady()
+// Take rows until there are none left, or until the stop time if one is given.  
+// Returns true if we ran out of rows.  
+bool MakeLOSEntries::runRows(Worker& W, U32 stopTime)
 {
-   if (++mCurrent < mList.size()) {
-      mFromNode = mList[mScramble[mCurrent]];
-      mFromLoc = mFromNode->location();
-      mFromIndex = mFromNode->getIndex();
-      return true;
+   while (!stopTime || Platform::getRealMilliseconds() < stopTime)
+   {
+      Mutex::lockMutex(mMutex);
+      S32   row = (mNextRow < mList.size() ? mNextRow++ : -1);
+      Mutex::unlockMutex(mMutex);
+      
+      if (row < 0)
+         return true;
+      
+      runRow(mScramble[row], W);
+      
+      Mutex::lockMutex(mMutex);
+      mRowsDone++;
+      Mutex::unlockMutex(mMutex);
    }
    return false;
 }
 
-#define  MillisecondWorkShift    90
+void MakeLOSEntries::runSlices(Worker& W)
+{
+   while (1)
+   {
+      Semaphore::acquireSemaphore(mSliceStart);
+      if (mStopping)
+         return;
+      runRows(W, mStopTime);
+      Semaphore::releaseSemaphore(mSliceDone);
+   }
+}
 
-// Virtual - runSearch() can be stopped in the middle.  
-bool MakeLOSEntries::earlyOut()
+bool MakeLOSEntries::isDone()
 {
-   U32   timeElapsed = (Platform::getRealMilliseconds() - mStartTime);
-   return (timeElapsed > MillisecondWorkShift);
+   Mutex::lockMutex(mMutex);
+   bool  done = (mRowsDone >= mList.size());
+   Mutex::unlockMutex(mMutex);
+   return done;
 }
 
+#define  MillisecondWorkShift    90
+
 void MakeLOSEntries::workAWhile()
 {
-   mStartTime = Platform::getRealMilliseconds();
-   
-   while (!isDone() && !earlyOut())
-      if (inProgress())
-         runSearch(mFromNode);
-      else if (nextOneReady())
-         runSearch(mFromNode);
+   U32   i;
+   mStopTime = Platform::getRealMilliseconds() + MillisecondWorkShift;
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::releaseSemaphore(mSliceStart);
+   runRows(mMainWorker, mStopTime);
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::acquireSemaphore(mSliceDone);
 
-   NavigationGraph::sProcessPercent = F32(mCurrent) / F32(mList.size());
+   Mutex::lockMutex(mMutex);
+   NavigationGraph::sProcessPercent = F32(mRowsDone) / F32(getMax(mList.size(), 1));
+   Mutex::unlockMutex(mMutex);
 }
 
-bool NavigationGraph::prepLOSTableWork(Point3F viewLoc)
+void MakeLOSEntries::takeRenderSegs(Vector<LineSegment>& segs)
 {
-   if (mTableBuilder) {
-      delete mTableBuilder;
-      mTableBuilder = NULL;
-   }
+   Mutex::lockMutex(mMutex);
+   segs = mRenderSegs;
+   mRenderSegs.clear();
+   Mutex::unlockMutex(mMutex);
+}
+
+// All rows are done (the threads have nothing more to add)- gather up the entries.  
+void MakeLOSEntries::finish(LOSBlockTable::EntryList& entries, S32& losCalls, S32& lowNotHigh)
+{
+   U32   i;
+   S32   total = mMainWorker.mEntries.size();
+   for (i = 0; i < mNumThreads; i++)
+      total += mWorkers[i]->mEntries.size();
    
-   mTableBuilder = new MakeLOSEntries(mNonTransient, mLOSXRef, viewLoc);
+   entries.reserve(total);
+   entries = mMainWorker.mEntries;
+   losCalls = mMainWorker.mLOSCalls;
+   lowNotHigh = mMainWorker.mLowButNotHigh;
+   for (i = 0; i < mNumThreads; i++) {
+      const Worker * W = mWorkers[i];
+      for (S32 j = 0; j < W->mEntries.size(); j++)
+         entries.push_back(W->mEntries[j]);
+      losCalls += W->mLOSCalls;
+      lowNotHigh += W->mLowButNotHigh;
+   }
+}
+
+//-------------------------------------------------------------------------------------
+
+bool NavigationGraph::prepLOSTableWork(Point3F viewLoc)
+{
+   stopLOSTableWork();
+   mTableBuilder = new MakeLOSEntries(mNonTransient, viewLoc);
    return true;
 }
 
+void NavigationGraph::stopLOSTableWork()
+{
+   delete mTableBuilder;
+   mTableBuilder = NULL;
+}
+
 // This gets called repeatedly until the table is built.  Idea here is to slice
 // the process so that some rendering can occur during this lengthy process.  
 bool NavigationGraph::makeLOSTableEntries()
 {
-   MakeLOSEntries *  makeEntries = dynamic_cast<MakeLOSEntries*>(mTableBuilder);
+   MakeLOSEntries *  makeEntries = mTableBuilder;
    AssertFatal(makeEntries, "Graph preprocess:  prepLOSTable() needed");
    
    makeEntries->workAWhile();
-
-   mRenderThese = makeEntries->mRenderSegs;
-   makeEntries->mRenderSegs.clear();
+   makeEntries->takeRenderSegs(mRenderThese);
    
    if (makeEntries->isDone()) {
+      LOSBlockTable::EntryList   entries;
+      Vector<Point3F>            locations;
+      S32                        losCalls, lowNotHigh;
+      
+      makeEntries->finish(entries, losCalls, lowNotHigh);
       clearRenderSegs();
-      Con::printf("Total table size = %d", mLOSXRef.numBytes());
-      Con::printf("Performed %d LOS calls", makeEntries->numLOSCalls());
+      Con::printf("Performed %d LOS calls", losCalls);
       Con::printf("Elapsed time = %d milliseconds", makeEntries->elapsedTime());
-      if (makeEntries->lowNotHigh()) 
-         Con::printf("%d Low-not-high entries found", makeEntries->lowNotHigh());
-      delete mTableBuilder;
-      mTableBuilder = NULL;
-      // Convert data to better hasher- 
-      makeLOSHashTable();
+      if (lowNotHigh) 
+         Con::printf("%d Low-not-high entries found", lowNotHigh);
+      stopLOSTableWork();
+      
+      // Make the table from the entries-  
+      getNodeLocations(locations);
+      mLOSBlockTable.build(locations, entries);
+      mLOSBlockTable.dumpStats();
+      mLOSTable = & mLOSBlockTable;
       return false;
    }
    return true;
 }
+
+//-------------------------------------------------------------------------------------
+
+ConsoleFunction(navLOSTableStats, void, 1, 2, "navLOSTableStats(<lookups>);")
+{
+   if (!NavigationGraph::gotOneWeCanUse() || !gNavGraph->getLOSXref()) {
+      Con::printf("navLOSTableStats: no LOS table");
+      return;
+   }
+   gNavGraph->losBlockTable().dumpStats();
+   
+   // Time random lookups- 
+   if (argc > 1)
+   {
+      const LOSTable *  table = gNavGraph->getLOSXref();
+      S32   lookups = dAtoi(argv[1]);
+      S32   numNodes = gNavGraph->numNodes();
+      U32   counts[4] = {0, 0, 0, 0};
+      U32   startMS = Platform::getRealMilliseconds();
+      
+      for (S32 i = 0; i < lookups; i++)
+         counts[table->value(gRandGen.randI(0, numNodes - 1), gRandGen.randI(0, numNodes - 1))]++;
+      
+      Con::printf("%d lookups in %d ms (%d hidden, %d minor, %d muzzle, %d full)", lookups, 
+                  Platform::getRealMilliseconds() - startMS, 
+                  counts[0], counts[1], counts[2], counts[3]);
+   }
+}
@@ -507,14 +507,15 @@ bool ChuteHints::write(Stream& s) const
 // Given the verticle line of a (potential) jetting hop, see if it is one of the 
 // chute types.  Build a box up as far as LOS goes to do this.  We're at the 
 // top if the highest found chute hint is level with the given top point.  
-ChuteHints::Info ChuteHints::info(Point3F bottom, const Point3F& top)
+ChuteHints::Info ChuteHints::info(Point3F bottom, const Point3F& top) const
 {
    const F32   boxR = 1.4;
+   ChutePtrList   query;    // local, the bridger calls this from the build pool
    
    if (mFabs(top.z - bottom.z) > 4.0 * /*Take out for moment-*/1e9) { 
       // Do these queries as a first pass to avoid LOS calls- 
-      if (findNear(bottom, boxR, 2.0, mQuery) > 0) {
-         if (findNear(top, boxR, 2.0, mQuery) > 0) {
+      if (findNear(bottom, boxR, 2.0, query) > 0) {
+         if (findNear(top, boxR, 2.0, query) > 0) {
          
             bottom.z += 1.0;
          
@@ -531,11 +532,11 @@ ChuteHints::Info ChuteHints::info(Point3F bottom, const Point3F& top)
             Box3F    theBox(boxMin, boxMax, true);
 
             // Well, this should always return something at this point.. 
-            if (S32 numHints = findNear(theBox, mQuery)) {
+            if (S32 numHints = findNear(theBox, query)) {
                // Find max- 
                F32   maxZ = -1e12, z;
                for (S32 i = 0; i < numHints; i++)
-                  if ((z = mQuery[i]->z) > maxZ) 
+                  if ((z = query[i]->z) > maxZ) 
                      maxZ = z;
             
                if (mFabs(maxZ - top.z) < 2.0)
@@ -922,6 +923,302 @@ bool LOSHashTable::write(Stream& s) const
    return false;
 }
 
+//-------------------------------------------------------------------------------------
+//                                  LOS Block Table
+
+LOSBlockTable::LOSBlockTable()
+{
+   mNumNodes = mNumUnique = mNumWords = 0;
+   mData = NULL;
+   mRank = NULL;
+   mIndex = mBlocks = NULL;
+}
+
+LOSBlockTable::~LOSBlockTable()
+{
+   delete [] mData;
+}
+
+// Block pairs in the upper triangle, diagonal included.
+U32 LOSBlockTable::numPairs(U32 numNodes)
+{
+   U32   numBlocks = (numNodes + BlockMask) >> BlockShift;
+   return (numBlocks * (numBlocks + 1)) >> 1;
+}
+
+void LOSBlockTable::alloc(U32 numNodes, U32 numUnique)
+{
+   U32   rankWords = (numNodes + 1) >> 1;
+   mNumNodes = numNodes;
+   mNumUnique = numUnique;
+   mNumWords = rankWords + numPairs(numNodes) + numUnique * BlockSize;
+
+   delete [] mData;
+   mData = new U32[getMax(mNumWords, U32(1))];
+   mRank = (const U16 *) mData;
+   mIndex = mData + rankWords;
+   mBlocks = mIndex + numPairs(numNodes);
+}
+
+bool LOSBlockTable::valid(S32 numNodes) const
+{
+   return (mData && mNumNodes == numNodes);
+}
+
+U32 LOSBlockTable::value(S32 i1, S32 i2) const
+{
+   if (i1 == i2)
+      return FullLOS;
+   else
+   {
+      U32   a = mRank[i1], b = mRank[i2];
+      if (a > b) {
+         U32   t = a;   a = b;   b = t;
+      }
+
+      U32   row = (a >> BlockShift), col = (b >> BlockShift);
+      U32   block = mIndex[((col * (col + 1)) >> 1) + row];
+      AssertFatal(block < mNumUnique + Uniform, "LOSBlockTable::value() bad index");
+
+      if (block < Uniform)
+         return block;
+      const U32 * bits = &mBlocks[(block - Uniform) << BlockShift];
+      return 3 & (bits[a & BlockMask] >> ((b & BlockMask) << 1));
+   }
+}
+
+//-------------------------------------------------------------------------------------
+
+// Spread the low ten bits out to every third bit for the Morton code.
+static U32 spreadBits(U32 x)
+{
+   x &= 0x3FF;
+   x = (x | (x << 16)) & 0x030000FF;
+   x = (x | (x <<  8)) & 0x0300F00F;
+   x = (x | (x <<  4)) & 0x030C30C3;
+   x = (x | (x <<  2)) & 0x09249249;
+   return x;
+}
+
+struct LOSNodeCode
+{
+   U32   mCode;
+   U32   mNode;
+};
+
+static S32 QSORT_CALLBACK cmpNodeCodes(const void * a, const void * b)
+{
+   const LOSNodeCode * A = (const LOSNodeCode *) a;
+   const LOSNodeCode * B = (const LOSNodeCode *) b;
+   if (A->mCode != B->mCode)
+      return (A->mCode < B->mCode ? -1 : 1);
+   return S32(A->mNode) - S32(B->mNode);
+}
+
+S32 QSORT_CALLBACK LOSBlockTable::cmpCells(const void * a, const void * b)
+{
+   const Cell * A = (const Cell *) a;
+   const Cell * B = (const Cell *) b;
+   if (A->mPair != B->mPair)
+      return (A->mPair < B->mPair ? -1 : 1);
+   if (A->mRow != B->mRow)
+      return S32(A->mRow) - S32(B->mRow);
+   return S32(A->mCol) - S32(B->mCol);
+}
+
+// Make the table from the (non-Hidden) entries.  Locations are by node index and give
+// the ordering.  The entry list is used up.  Returns memory size.
+U32 LOSBlockTable::build(const Vector<Point3F>& locations, EntryList& entries)
+{
+   U32   numNodes = locations.size();
+   U32   i;
+
+   // Rank nodes along a Morton curve through the bounding box-
+   Box3F    bounds(Point3F(1e9, 1e9, 1e9), Point3F(-1e9, -1e9, -1e9));
+   for (i = 0; i < numNodes; i++) {
+      bounds.min.setMin(locations[i]);
+      bounds.max.setMax(locations[i]);
+   }
+   Point3F  extent = bounds.max - bounds.min;
+   F32      scale = 1023.0f / getMax(getMax(extent.x, extent.y), getMax(extent.z, 1.0f));
+
+   Vector<LOSNodeCode>  codes;
+   Vector<U16>          rank;
+   codes.setSize(numNodes);
+   rank.setSize(numNodes);
+   for (i = 0; i < numNodes; i++) {
+      Point3F  q = (locations[i] - bounds.min) * scale;
+      codes[i].mCode = spreadBits(U32(q.x)) | (spreadBits(U32(q.y)) << 1) | (spreadBits(U32(q.z)) << 2);
+      codes[i].mNode = i;
+   }
+   dQsort((void *)codes.address(), codes.size(), sizeof(LOSNodeCode), cmpNodeCodes);
+   for (i = 0; i < numNodes; i++)
+      rank[codes[i].mNode] = i;
+
+   // Place the entries in their blocks, and sort them by block-
+   Vector<Cell>   cells;
+   cells.reserve(entries.size());
+   for (i = 0; i < entries.size(); i++)
+   {
+      const Entry &  entry = entries[i];
+      if (entry.mCode != Hidden && entry.mFrom != entry.mTo)
+      {
+         U32   a = rank[entry.mFrom], b = rank[entry.mTo];
+         if (a > b) {
+            U32   t = a;   a = b;   b = t;
+         }
+         U32   row = (a >> BlockShift), col = (b >> BlockShift);
+         Cell  cell;
+         cell.mPair = ((col * (col + 1)) >> 1) + row;
+         cell.mBlockRow = row;
+         cell.mBlockCol = col;
+         cell.mRow = (a & BlockMask);
+         cell.mCol = (b & BlockMask);
+         cell.mCode = entry.mCode;
+         cells.push_back(cell);
+      }
+   }
+   entries.clear();
+   entries.compact();
+   dQsort((void *)cells.address(), cells.size(), sizeof(Cell), cmpCells);
+
+   // Fill in each block that has entries.  Those that are full of the same code go
+   // in the index as the code, the others are kept once each.
+   Vector<U32>    index;
+   Vector<U32>    unique;
+   Vector<S32>    buckets, chain;
+   index.setSize(numPairs(numNodes));
+   dMemset(index.address(), 0, index.memSize());
+   buckets.setSize(1024);
+   for (i = 0; i < buckets.size(); i++)
+      buckets[i] = -1;
+
+   U32   lastRow = (numNodes - 1) >> BlockShift;
+   U32   lastSize = numNodes - (lastRow << BlockShift);
+
+   for (i = 0; i < cells.size(); )
+   {
+      U32   pair = cells[i].mPair;
+      U32   bits[BlockSize];
+      U32   count = 0;
+      bool  same = true;
+      dMemset(bits, 0, sizeof(bits));
+
+      const Cell & first = cells[i];
+      U32   colSize = (first.mBlockCol == lastRow ? lastSize : BlockSize);
+      U32   rowSize = (first.mBlockRow == lastRow ? lastSize : BlockSize);
+
+      // Number of cells lookups can reach in this block-
+      U32   numCells = (first.mBlockRow == first.mBlockCol ? (colSize * (colSize - 1)) >> 1
+                                                           : rowSize * colSize);
+
+      for ( ; i < cells.size() && cells[i].mPair == pair; i++)
+      {
+         const Cell & cell = cells[i];
+         if (count && cell.mRow == cells[i - 1].mRow && cell.mCol == cells[i - 1].mCol)
+            continue;
+         bits[cell.mRow] |= (U32(cell.mCode) << (cell.mCol << 1));
+         same &= (cell.mCode == first.mCode);
+         count++;
+      }
+
+      if (same && count == numCells)
+         index[pair] = first.mCode;
+      else
+      {
+         U32   hash = 0;
+         for (U32 w = 0; w < BlockSize; w++)
+            hash = (hash * 0x9E3779B1) ^ bits[w];
+         S32 &    bucket = buckets[(hash ^ (hash >> 16)) & (buckets.size() - 1)];
+         S32      found = bucket;
+         while (found >= 0 && dMemcmp(&unique[found << BlockShift], bits, sizeof(bits)))
+            found = chain[found];
+         if (found < 0)
+         {
+            found = chain.size();
+            chain.push_back(bucket);
+            bucket = found;
+            for (U32 w = 0; w < BlockSize; w++)
+               unique.push_back(bits[w]);
+         }
+         index[pair] = found + Uniform;
+      }
+   }
+
+   // Lay it all out in the one array-
+   alloc(numNodes, unique.size() >> BlockShift);
+   dMemcpy((void *)mRank, rank.address(), rank.memSize());
+   dMemcpy((void *)mIndex, index.address(), index.memSize());
+   dMemcpy((void *)mBlocks, unique.address(), unique.memSize());
+
+   return memSize();
+}
+
+// Move over from another table.
+U32 LOSBlockTable::convertTable(const LOSTable& from, const Vector<Point3F>& locations)
+{
+   EntryList   entries;
+   S32         numNodes = locations.size();
+
+   for (S32 i = 0; i < numNodes; i++)
+      for (S32 j = i + 1; j < numNodes; j++)
+         if (U32 code = from.value(i, j))
+         {
+            Entry    entry;
+            entry.mFrom = i;
+            entry.mTo = j;
+            entry.mCode = code;
+            entries.push_back(entry);
+         }
+
+   return build(locations, entries);
+}
+
+void LOSBlockTable::dumpStats() const
+{
+   U32   numUniform[Uniform] = {0, 0, 0, 0};
+   U32   pairs = numPairs(mNumNodes);
+
+   for (U32 i = 0; i < pairs; i++)
+      if (mIndex[i] < Uniform)
+         numUniform[mIndex[i]]++;
+
+   U32   denseSize = (mNumNodes * (mNumNodes + 1) >> 1) / 4;
+   Con::printf("LOS blocks: %d nodes, %d block pairs, %d unique blocks",
+                  mNumNodes, pairs, mNumUnique);
+   Con::printf("   uniform: %d hidden, %d minor, %d muzzle, %d full",
+                  numUniform[Hidden], numUniform[MinorLOS], numUniform[MuzzleLOS], numUniform[FullLOS]);
+   Con::printf("   %d bytes (%d as a 2-bit table)", memSize(), denseSize);
+}
+
+void LOSBlockTable::clear()
+{
+   delete [] mData;
+   mData = NULL;
+   mRank = NULL;
+   mIndex = mBlocks = NULL;
+   mNumNodes = mNumUnique = mNumWords = 0;
+}
+
+// Read straight into the array, which the lookups use as it sits.
+bool LOSBlockTable::read(Stream& s)
+{
+   U32   numNodes, numUnique;
+   if (s.read(&numNodes) && s.read(&numUnique))
+   {
+      alloc(numNodes, numUnique);
+      return s.read(memSize(), mData);
+   }
+   return false;
+}
+
+bool LOSBlockTable::write(Stream& s) const
+{
+   if (s.write(mNumNodes) && s.write(mNumUnique))
+      return s.write(memSize(), mData);
+   return false;
+}
+
 //-------------------------------------------------------------------------------------
 // Header info for the Terrain Data.
 
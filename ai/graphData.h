@@ -297,14 +297,13 @@ typedef VectorPtr<ChuteHint*>       ChutePtrList;
 class ChuteHints : public Vector<ChuteHint>
 {
       ChuteBSP mBSP;
-      ChutePtrList   mQuery;
       void     makeBSP();
   public:
       enum Info {NotAChute, ChuteTop, ChuteMid};
       S32      findNear(const Point3F& P, S32 xy, S32 z, ChutePtrList& list) const;
       S32      findNear(const Box3F& box, ChutePtrList& list) const;
       void     init(const Vector<Point3F>& list);
-      Info     info(Point3F bot, const Point3F& top);
+      Info     info(Point3F bot, const Point3F& top) const;
       bool     read(Stream& s);
       bool     write(Stream& s) const;
 };
@@ -414,6 +413,66 @@ class LOSHashTable : public LOSTable
       void  clear();
 };
 
+//-------------------------------------------------------------------------------------
+// LOS in 16x16 blocks of node pairs, upper triangle only.  Nodes are first put in
+// spatial order (Morton code of the location) so that nodes which see each other
+// share blocks, and the rest of the table is blocks that are all Hidden.  The index
+// has one word per block pair - a uniform block is just its code, and others point
+// into a list of unique blocks (a 2-bit row of 16 in each of 16 words).  Lookups are
+// the two node ranks, the index word and the row word.
+//
+// Everything lives in one array of words that is read in a single gulp on load.
+
+class LOSBlockTable : public LOSTable
+{
+   public:
+      enum{ BlockShift = 4,
+            BlockSize = (1 << BlockShift),
+            BlockMask = (BlockSize - 1),
+            Uniform = 4                      // index values below are whole blocks
+         };
+
+      struct Entry {
+         U16   mFrom, mTo;
+         U32   mCode;
+      };
+      typedef Vector<Entry>   EntryList;
+
+   protected:
+      struct Cell {
+         U32   mPair;
+         U16   mBlockRow, mBlockCol;
+         U8    mRow, mCol;
+         U16   mCode;
+      };
+
+      U32         mNumNodes;
+      U32         mNumUnique;
+      U32         mNumWords;
+      U32   *     mData;
+      const U16 * mRank;                     // per node, into mData
+      const U32 * mIndex;                    // per block pair
+      const U32 * mBlocks;                   // BlockSize words per unique block
+
+      static U32  numPairs(U32 numNodes);
+      static S32 QSORT_CALLBACK cmpCells(const void* ,const void* );
+      void        alloc(U32 numNodes, U32 numUnique);
+
+   public:
+      LOSBlockTable();
+      ~LOSBlockTable();
+      U32   build(const Vector<Point3F>& locations, EntryList& entries);
+      U32   convertTable(const LOSTable& from, const Vector<Point3F>& locations);
+      U32   memSize() const            {return mNumWords * sizeof(U32);}
+      void  dumpStats() const;
+
+      U32   value(S32 ind1, S32 ind2) const;
+      bool  valid(S32 numNodes) const;
+      bool  write(Stream& s) const;
+      bool  read(Stream& s);
+      void  clear();
+};
+
 //-------------------------------------------------------------------------------------
 // Data saved on graph object in MIS file- 
 
@@ -41,6 +41,9 @@ GraphSearch::GraphSearch()
    mInformThreats = 0;
    mInformTeam = 0;
    mInformRatings = NULL;
+   mInformCorridor = NULL;
+   mCorridor = NULL;
+   mClusterOf = NULL;
    mInProgress = false;
    mAStar = false;
    mTargetLoc.set(0,0,0);
@@ -244,6 +247,11 @@ bool GraphSearch::runDijkstra()
          
          if (! NodeExtracted(queueInd))
          {
+            // Searches through the hierarchy keep to the clusters of the corridor
+            if (mCorridor && edge->mDest < mTransientStart)
+               if (!mCorridor->test(mClusterOf[edge->mDest]))
+                  continue;
+               
             F32   newDist = mHead.mDist + edge->mDist;
             F32   edgeTime = getEdgeTime(edge);
             if (nodeThreatened)
@@ -299,11 +307,13 @@ void GraphSearch::initSearch(GraphNode * S, GraphNode * D)
    else 
       mTargetNode = -1, mInformAStar = false; 
    
-   // These four search-modifying variables hold their value for only one search- 
+   // These search-modifying variables hold their value for only one search- 
    mAStar         = mInformAStar;      /*---------*/     mInformAStar      = false;
    mThreatSet     = mInformThreats;    /*---------*/     mInformThreats    = 0;
    mTeam          = mInformTeam;       /*---------*/     mInformTeam       = 0;
    mJetRatings    = mInformRatings;    /*---------*/     mInformRatings    = NULL;
+   mCorridor      = mInformCorridor;   /*---------*/     mInformCorridor   = NULL;
+   mClusterOf     = (mCorridor ? gNavGraph->hierarchy().clusterList() : NULL);
    
    // Avoid bad inlining in debug build...
    mHeuristicsPtr = mHeuristicsVec.address();
@@ -375,3 +385,349 @@ bool GraphSearch::runSearch(GraphNode * S, GraphNode * D)
    return runDijkstra();
 }
 
+
+//-------------------------------------------------------------------------------------
+//                Path Queue Searcher - see graphPathQueue.h
+
+// Everything here mirrors the corresponding GraphSearch code for the path searcher's 
+// settings (A*, randomize, threats, team, ratings), but reads the snapshots and the 
+// request instead of the graph.  Keep the two in step.  
+
+void GraphFlatEdges::clear()
+{
+   mDest.clear();
+   mDist.clear();
+   mTime.clear();
+   mTeam.clear();
+   mFlags.clear();
+   mEdges.clear();
+}
+
+void GraphFlatEdges::push(const GraphEdge& edge)
+{
+   AssertFatal(!edge.problems(), edge.problems());
+   mDest.push_back(edge.mDest);
+   mDist.push_back(edge.mDist);
+   mTime.push_back(edge.getTime());
+   mTeam.push_back(edge.getTeam());
+   mFlags.push_back(edge.isJetting() ? Jetting : 0);
+   mEdges.push_back(edge);
+}
+
+void GraphEdgeRun::set(const GraphFlatEdges& flat, S32 first, S32 num)
+{
+   dest = flat.mDest.address() + first;
+   dist = flat.mDist.address() + first;
+   time = flat.mTime.address() + first;
+   team = flat.mTeam.address() + first;
+   flags = flat.mFlags.address() + first;
+   edges = flat.mEdges.address() + first;
+   count = num;
+}
+
+//-------------------------------------------------------------------------------------
+
+GraphSnapshotSearch::GraphSnapshotSearch()
+{
+   mStamp = 0;
+   mEdgeSnap = NULL;
+   mNodeSnap = NULL;
+   mRequest = NULL;
+   mCorridor = NULL;
+   mClusterOf = NULL;
+   mIterations = 0;
+   mRandomize = false;
+   mTargetLoc.set(0,0,0);
+}
+
+// The node state is good for the search stamped on it, so there's nothing to clear 
+// between searches until the stamp wraps.  
+void GraphSnapshotSearch::resetNodes(S32 totalNodes)
+{
+   if (totalNodes != mNodes.size() || ++mStamp == 0) 
+   {
+      AssertFatal(totalNodes < (1 << 15), "Graph size can't exceed 32K");
+      mNodes.setSize(totalNodes);
+      dMemset(mNodes.address(), 0, mNodes.memSize());
+      mPartition.setSize(totalNodes);
+      mQueue.setItems(totalNodes);
+      mQueue.reserve(mEdgeSnap->mNumNodes + 2);
+      mStamp = 1;
+   }
+   mPartition.clear();
+   
+   if (mJoined.size() != mEdgeSnap->mNumNodes) {
+      mJoined.setSize(mEdgeSnap->mNumNodes);
+      dMemset(mJoined.address(), 0xff, mJoined.memSize());
+   }
+}
+
+// Hooking in the transients appends an edge back to them on the nodes they hook to.  
+// Those nodes get their graph edges copied with the ones from the request added.  The 
+// transients' own edges go on the end.  
+void GraphSnapshotSearch::joinEdges()
+{
+   const Vector<S16>&   backFrom = mRequest->mBackFrom;
+   const GraphFlatEdges& edges = mEdgeSnap->mEdges;
+   
+   mSpans.clear();
+   mJoinedEdges.clear();
+   for (S32 i = 0; i < backFrom.size(); i++) 
+   {
+      S32   node = backFrom[i];
+      if (mJoined[node] >= 0)
+         continue;
+         
+      mJoined[node] = mSpans.size();
+      mSpans.increment();
+      Span& span = mSpans.last();
+      span.first = mJoinedEdges.size();
+      
+      for (S32 e = mEdgeSnap->mFirstEdge[node]; e < mEdgeSnap->mFirstEdge[node + 1]; e++)
+         mJoinedEdges.push(edges.mEdges[e]);
+      for (S32 j = i; j < backFrom.size(); j++)
+         if (backFrom[j] == node)
+            mJoinedEdges.push(mRequest->mBackEdges[j]);
+      
+      span.count = mJoinedEdges.size() - span.first;
+   }
+   
+   const GraphPathRequest::Hook * hooks[2] = {&mRequest->mSrc, &mRequest->mDst};
+   for (S32 h = 0; h < 2; h++) 
+   {
+      mHooks[h].first = mJoinedEdges.size();
+      for (S32 e = 0; e < hooks[h]->edges.size(); e++)
+         mJoinedEdges.push(hooks[h]->edges[e]);
+      mHooks[h].count = mJoinedEdges.size() - mHooks[h].first;
+   }
+}
+
+void GraphSnapshotSearch::unjoinEdges()
+{
+   const Vector<S16>&   backFrom = mRequest->mBackFrom;
+   for (S32 i = 0; i < backFrom.size(); i++)
+      mJoined[backFrom[i]] = -1;
+}
+
+void GraphSnapshotSearch::getEdges(S32 node, GraphEdgeRun& run) const
+{
+   if (node < mEdgeSnap->mNumNodes) 
+   {
+      if (mJoined[node] >= 0) {
+         const Span& span = mSpans[mJoined[node]];
+         run.set(mJoinedEdges, span.first, span.count);
+      }
+      else {
+         S32   first = mEdgeSnap->mFirstEdge[node];
+         run.set(mEdgeSnap->mEdges, first, mEdgeSnap->mFirstEdge[node + 1] - first);
+      }
+      return;
+   }
+   
+   AssertFatal(node == mRequest->mSrc.index || node == mRequest->mDst.index, 
+                  "GraphSnapshotSearch: edge to another transient");
+   const Span& hook = mHooks[node == mRequest->mSrc.index ? 0 : 1];
+   run.set(mJoinedEdges, hook.first, hook.count);
+}
+
+const Point3F& GraphSnapshotSearch::nodeLoc(S32 node) const
+{
+   if (node < mEdgeSnap->mNumNodes)
+      return mEdgeSnap->mLocs[node];
+   return (node == mRequest->mSrc.index ? mRequest->mSrc.loc : mRequest->mDst.loc);
+}
+
+bool GraphSnapshotSearch::nodeThreatened(S32 node) const
+{
+   GraphThreatSet threats;
+   if (node < mEdgeSnap->mNumNodes)
+      threats = mNodeSnap->mThreats[node];
+   else
+      threats = (node == mRequest->mSrc.index ? mRequest->mSrc.threats : mRequest->mDst.threats);
+   return (threats & mRequest->mThreatSet) != 0;
+}
+
+S32 GraphSnapshotSearch::getAvoidFactor(S32 node)
+{
+   if (mIterations > 80)
+      mRandomize = false;
+   else {
+      U32   avoidUntil;
+      bool  stuckAvoid;
+      if (node < mEdgeSnap->mNumNodes) {
+         avoidUntil = mNodeSnap->mAvoidUntil[node];
+         stuckAvoid = mNodeSnap->mStuckAvoid[node];
+      }
+      else {
+         const GraphPathRequest::Hook& hook = (node == mRequest->mSrc.index ? 
+                                                mRequest->mSrc : mRequest->mDst);
+         avoidUntil = hook.avoidUntil;
+         stuckAvoid = hook.stuckAvoid;
+      }
+      U32   timeDiff = (avoidUntil - mRequest->mSimTime);
+      if (timeDiff < GraphMaxNodeAvoidMS)
+         if (stuckAvoid)
+            return 400;
+         else
+            return 25;
+   }
+   return 0;
+}
+
+// The A* loop.  Edges GraphSearch::getEdgeTime() fails (SearchFailureAssure) are just 
+// skipped - there they go into the queue, and the search stops if one comes out, 
+// which leaves the same nodes visited.  
+template <bool Threats, bool Rules>
+void GraphSnapshotSearch::search(S32 source, S32 target)
+{
+   GraphPathRequest &   request = * mRequest;
+   NodeState *          nodes = mNodes.address();
+   U32                  stamp = mStamp;
+   S32                  numGraphNodes = mEdgeSnap->mNumNodes;
+   GraphEdgeRun         run;
+
+   NodeState & first = nodes[source];
+   first.stamp = stamp;
+   first.dist = first.time = first.heuristic = 0;
+   first.prev = -1;
+   first.closed = false;
+   mQueue.clear();
+   mQueue.insert(source, 0);
+
+   while (!mQueue.empty())
+   {
+      S32         node = mQueue.removeHead();
+      NodeState & head = nodes[node];
+      head.closed = true;
+
+      mPartition.set(node);
+      
+      if (target == node) {
+         request.mSearchDist = head.dist;
+         break;
+      }
+
+      S32   avoidThisNode = (mRandomize ? getAvoidFactor(node) : 0);
+      bool  threatened = (Threats && nodeThreatened(node));
+
+      getEdges(node, run);
+      for (S32 i = 0; i < run.count; i++)
+      {
+         S32         dest = run.dest[i];
+         NodeState & next = nodes[dest];
+         bool        reached = (next.stamp == stamp);
+         
+         if (reached && next.closed)
+            continue;
+         if (mCorridor && dest < numGraphNodes && !mCorridor->test(mClusterOf[dest]))
+            continue;
+            
+         F32   edgeTime = run.time[i];
+         if (Rules) 
+         {
+            if (request.mHaveRatings && (run.flags[i] & GraphFlatEdges::Jetting))
+               if (dest < numGraphNodes && !run.edges[i].canJet(request.mRatings))
+                  continue;
+            if (request.mTeam && run.team[i])
+               if (run.team[i] != request.mTeam)
+                  continue;
+               else
+                  edgeTime *= 1.3;
+         }
+         if (threatened)
+            edgeTime *= 10;
+         if (avoidThisNode)
+            edgeTime += avoidThisNode;
+            
+         F32   newTime = head.time + edgeTime;
+         if (newTime > SearchFailureThresh)
+            continue;
+         
+         if (!reached) {
+            next.stamp = stamp;
+            next.closed = false;
+            next.heuristic = (nodeLoc(dest) - mTargetLoc).len();
+            next.time = newTime;
+            next.dist = head.dist + run.dist[i];
+            next.prev = node;
+            mQueue.insert(dest, newTime + next.heuristic);
+         }
+         else {
+            F32   sortOnThis = newTime + next.heuristic;
+            if (sortOnThis < mQueue.keyOf(dest)) {
+               next.time = newTime;
+               next.dist = head.dist + run.dist[i];
+               next.prev = node;
+               mQueue.improveKey(dest, sortOnThis);
+            }
+         }
+      }
+      
+      mIterations++;
+   }
+}
+
+// Runs the request's search and fills in its results.  
+void GraphSnapshotSearch::performSearch(GraphPathRequest& request)
+{
+   mRequest = &request;
+   mEdgeSnap = request.mEdgeSnap;
+   mNodeSnap = request.mNodeSnap;
+   mClusterOf = mEdgeSnap->mClusterOf.address();
+   mTargetLoc = request.mDst.loc;
+   
+   S32   source = request.mSrc.index;
+   S32   target = request.mDst.index;
+   
+   resetNodes(request.mNumNodesAll);
+   joinEdges();
+   
+   request.mPath.clear();
+   request.mFound = false;
+   request.mIterations = 0;
+   request.mCorridorIterations = 0;
+   request.mCorridorFound = false;
+
+   bool  threats = (request.mThreatSet != 0);
+   bool  rules = (request.mTeam || request.mHaveRatings);
+   bool  corridor = (request.mCorridor.getSize() != 0 && 
+                     mEdgeSnap->mClusterOf.size() == mEdgeSnap->mNumNodes);
+   for (S32 pass = (corridor ? 0 : 1); pass < 2 && !request.mFound; pass++)
+   {
+      if (pass == 1 && corridor)
+         resetNodes(request.mNumNodesAll);
+      mCorridor = (pass == 0 ? &request.mCorridor : NULL);
+      mIterations = 0;
+      mRandomize = true;
+      request.mSearchDist = 0.0f;
+      
+      if (threats)
+         rules ? search<true, true>(source, target) : search<true, false>(source, target);
+      else
+         rules ? search<false, true>(source, target) : search<false, false>(source, target);
+      
+      request.mIterations += mIterations;
+      if (pass == 0) {
+         request.mCorridorIterations = mIterations;
+         request.mCorridorFound = mPartition.test(target);
+      }
+   
+      // Path back from the target, as in getPathIndices()- 
+      if (mPartition.test(target)) 
+      {
+         for (S32 node = target; node != source; node = mNodes[node].prev)
+            request.mPath.push_back(node);
+         request.mPath.push_back(source);
+         reverseVec(request.mPath);
+         request.mFound = true;
+      }
+   }
+   mCorridor = NULL;
+   
+   // Nodes visited (by the whole graph search) go into the team's force field 
+   // partitions when it fails.  
+   if (!request.mFound)
+      request.mVisited.install(mPartition);
+   
+   unjoinEdges();
+}
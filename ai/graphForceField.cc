@@ -58,6 +58,7 @@ void MonitorForceFields::ForceField::updateEdges()
    U32   team = (mActive ? mTeam : 0);
    while( --count >= 0 )
       (* e++)->setTeam(team);
+   gNavGraph->edgesChanged();
 }
 
 void MonitorForceFields::atMissionStart()
@@ -108,7 +109,14 @@ void MonitorForceFields::clearPartitions(U32 exceptTeam)
 void MonitorForceFields::informSearchFailed(GraphSearch * searcher, U32 team)
 {
    AssertFatal(team >= 0 && team < GraphMaxTeams, "Bad team index in FF monitor");
-   mTeamPartitions[team].pushPartition(searcher->getPartition());
+   informSearchFailed(searcher->getPartition(), team);
+}
+
+// Same, for searches run on the path queue.  
+void MonitorForceFields::informSearchFailed(const GraphPartition& visited, U32 team)
+{
+   AssertFatal(team >= 0 && team < GraphMaxTeams, "Bad team index in FF monitor");
+   mTeamPartitions[team].pushPartition(visited);
 }
 
 GraphPartition::Answer MonitorForceFields::reachable(U32 team, S32 from, S32 to)
@@ -37,6 +37,7 @@ class MonitorForceFields
       GraphPartition::Answer reachable(U32 team, S32 from, S32 to);
       void  clearPartitions(U32 allBut);
       void  informSearchFailed(GraphSearch * searcher, U32 team);
+      void  informSearchFailed(const GraphPartition& visited, U32 team);
       S32   count() const  {return mCount;}
       void  atMissionStart();
       void  monitor();
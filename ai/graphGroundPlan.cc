@@ -12,6 +12,7 @@
 #include "console/consoleTypes.h"
 #include "Collision/clippedPolyList.h"
 #include "ai/graphGroundVisit.h"
+#include "ai/graphThreadPool.h"
 #include "terrain/waterBlock.h"
 
 GroundPlan *gGroundPlanTest = NULL;
@@ -177,6 +178,20 @@ TerrainBlock *GroundPlan::getTerrainObj()
 //----------------------------------------------------------------------------
 
 bool GroundPlan::inspect(GridArea &area)
+{
+   GraphThreadPool   pool;
+   
+   if (!startInspect(area, pool))
+      return false;
+   finishInspect(pool);
+   return true;
+}
+
+//----------------------------------------------------------------------------
+
+// The visitor picks out the level zero squares that need a close look, and those 
+// are inspected on the pool.  The caller can do other work before finishInspect().  
+bool GroundPlan::startInspect(GridArea &area, GraphThreadPool &pool)
 {
    if(!mTerrainBlock)
    {
@@ -213,14 +228,29 @@ bool GroundPlan::inspect(GridArea &area)
    // perform mission area inspection
    GridArea inspectionArea(mGridOrigin, mGridDims);
    InspectionVisitor inspector(inspectionArea, *this);
+   mInspectList.clear();
    inspector.traverse();
+   pool.start(inspectJob, this, mInspectList.size());
+   return true;
+}
+
+void GroundPlan::finishInspect(GraphThreadPool &pool)
+{
+   pool.finish();
+   mInspectList.clear();
    computeNavFlags();
    findNeighbors();
    
    Con::printf("total zero squares inspected: %d\n", mTotalVisited);
-   
-   // were done!
-   return true;
+}
+
+// Squares only write their own detail, and the casts and poly lists are made on the 
+// worker's container context.  
+void GroundPlan::inspectJob(void *data, S32 job, S32)
+{
+   GroundPlan *plan = (GroundPlan *) data;
+   GridArea square(plan->mInspectList[job], Point2I(1, 1));
+   plan->inspectSquare(square, plan->mGridDatabase[plan->gridToIndex(square.point)]);
 }
 
 //-------------------------------------------------------------------------------------
@@ -1024,6 +1054,15 @@ GridArea GroundPlan::alignTheArea(const GridArea& areaIn)
 //----------------------------------------------------------------------------
 
 void GroundPlan::genExterior(Point2I &min, Point2I &max, NavigationGraph *nav)
+{
+   GraphThreadPool   pool;
+   
+   if (startExterior(min, max, nav, pool))
+      finishInspect(pool);
+}
+
+bool GroundPlan::startExterior(Point2I &min, Point2I &max, NavigationGraph *nav, 
+                                 GraphThreadPool &pool)
 {
    GridArea area;
    
@@ -1034,7 +1073,7 @@ void GroundPlan::genExterior(Point2I &min, Point2I &max, NavigationGraph *nav)
       area.extent = max;
    }
    area = alignTheArea(area);
-   inspect(area);
+   return startInspect(area, pool);
 }         
 
 //----------------------------------------------------------------------------
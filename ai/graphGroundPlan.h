@@ -20,6 +20,7 @@
 
 class WaterBlock;
 class NavigationGraph;
+class GraphThreadPool;
 
 //---------------------------------------------------------------
 
@@ -34,6 +35,7 @@ class GroundPlan: public SimObject
    Point2I                    mGridOrigin;
    Point2I                    mGridDims;
    S32                        mTotalVisited;
+   Vector<Point2I>            mInspectList;
    
    // static members
    static Point2I gridOffset[8];
@@ -73,6 +75,7 @@ class GroundPlan: public SimObject
    // inspection details
    private:
       void        inspectSquare(const GridArea &gridArea, GridDetail &square);
+      static void inspectJob(void *data, S32 job, S32 worker);
       S32         getNeighborDetails(S32 index, S32 key);
       void        packTriangleBits(const GridDetail &g, BitSet32 &bits, S32 bitType, S32 index, bool isLeftEdge, bool isBottomRow);
       F32         lowestShadowHt(const GridDetail &g, BitSet32 &bits, S32 index);   
@@ -89,6 +92,8 @@ class GroundPlan: public SimObject
       Point2I              getOrigin() const;
       Point2I              *getPosition(S32 index);
       bool                 inspect(GridArea &area);
+      bool                 startInspect(GridArea &area, GraphThreadPool &pool);
+      void                 finishInspect(GraphThreadPool &pool);
       S32                  getNavigable(Vector<U8> &navFlags, Vector<F32> &shadowHts);
       Vector<U8>           &getNeighbors(Vector<U8> &neighbors); 
       static TerrainBlock  *getTerrainObj();
@@ -97,6 +102,8 @@ class GroundPlan: public SimObject
       void                 render(Point3F &camPos, bool drawClipped);
       bool                 setTerrainGraphInfo(TerrainGraphInfo* info);
       void                 genExterior(Point2I &min, Point2I &max, NavigationGraph *nav);
+      bool                 startExterior(Point2I &min, Point2I &max, NavigationGraph *nav,
+                                 GraphThreadPool &pool);
 };
 
 extern GroundPlan *gGroundPlanTest;
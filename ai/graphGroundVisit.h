@@ -81,9 +81,7 @@ bool InspectionVisitor::atLevelZero(const GridArea& R)
 {
    AssertFatal(R.extent.x == 1 && R.extent.y == 1, "inspection visitor error!");
    mGPlan.mTotalVisited++;
-   S32 index = mGPlan.gridToIndex(R.point);
-   GridDetail &detail = mGPlan.mGridDatabase[index];
-   mGPlan.inspectSquare(R, detail);
+   mGPlan.mInspectList.push_back(R.point);
    return true;
 }
 
@@ -0,0 +1,860 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/graph.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "platform/profiler.h"
+
+F32   GraphHierarchy::smClusterSize = 96.0f;
+F32   GraphHierarchy::smMinDist = 200.0f;
+bool  GraphHierarchy::smEnabled = true;
+
+#define  ClusterFailed(cost)     ((cost) > SearchFailureThresh)
+
+//-------------------------------------------------------------------------------------
+
+bool GraphHierarchy::Entrance::read(Stream& s)
+{
+   return s.read(&mNode) && s.read(&mCluster) && s.read(&mFirstLink) && s.read(&mNumLinks);
+}
+
+bool GraphHierarchy::Entrance::write(Stream& s) const
+{
+   return s.write(mNode) && s.write(mCluster) && s.write(mFirstLink) && s.write(mNumLinks);
+}
+
+bool GraphHierarchy::Link::read(Stream& s)
+{
+   bool  Ok = s.read(&mTo);
+   for (S32 i = 0; i < NumLevels && Ok; i++)
+      Ok = s.read(&mCost[i]);
+   return Ok;
+}
+
+bool GraphHierarchy::Link::write(Stream& s) const
+{
+   bool  Ok = s.write(mTo);
+   for (S32 i = 0; i < NumLevels && Ok; i++)
+      Ok = s.write(mCost[i]);
+   return Ok;
+}
+
+bool GraphHierarchy::read(Stream& s)
+{
+   mValid = false;
+   bool  Ok = s.read(&mNumNodes) && s.read(&mSignature) && s.read(&mCellSize);
+   for (S32 i = 0; i < NumLevels && Ok; i++)
+      Ok = s.read(&mLevels[i][0]) && s.read(&mLevels[i][1]);
+   Ok = Ok && readVector2(s, mClusterOf) && readVector2(s, mFirstEntrance);
+   return Ok && readVector1(s, mEntrances) && readVector1(s, mLinks);
+}
+
+bool GraphHierarchy::write(Stream& s) const
+{
+   bool  Ok = s.write(mNumNodes) && s.write(mSignature) && s.write(mCellSize);
+   for (S32 i = 0; i < NumLevels && Ok; i++)
+      Ok = s.write(mLevels[i][0]) && s.write(mLevels[i][1]);
+   Ok = Ok && writeVector2(s, mClusterOf) && writeVector2(s, mFirstEntrance);
+   return Ok && writeVector1(s, mEntrances) && writeVector1(s, mLinks);
+}
+
+//-------------------------------------------------------------------------------------
+
+GraphHierarchy::GraphHierarchy()
+{
+   mNumNodes = 0;
+   mSignature = 0;
+   mCellSize = smClusterSize;
+   mValid = false;
+   mExpansions = 0;
+   dMemset(mLevels, 0, sizeof(mLevels));
+   mFirstEntrance.push_back(0);
+   mStats.clear();
+}
+
+// Sum of a hash of each edge, so it doesn't matter what order the edges come in.
+U32 GraphHierarchy::calcSignature(S32 numNodes)
+{
+   GraphEdge   edgeBuffer[MaxOnDemandEdges];
+   U32         signature = numNodes;
+
+   for (S32 i = 0; i < numNodes; i++)
+      if (GraphNode * node = gNavGraph->lookupNode(i))
+      {
+         GraphEdgeArray edges = node->getEdges(edgeBuffer);
+         while (GraphEdge * edge = edges++)
+         {
+            U32   bits = * (U32 *) & edge->mDist;
+            U32   hash = (i * 0x9E3779B1) ^ (edge->mDest * 0x85EBCA77) ^ bits;
+            hash ^= (edge->isJetting() ? 0xC2B2AE3D : 0);
+            signature += (hash ^ (hash >> 15)) * 0x27D4EB2F;
+         }
+      }
+
+   return signature;
+}
+
+// Keep the saved hierarchy if it was made for this graph, otherwise build it.
+bool GraphHierarchy::install()
+{
+   S32   numNodes = gNavGraph->numNodes();
+
+   if (numNodes == mNumNodes && mClusterOf.size() == numNodes &&
+            calcSignature(numNodes) == mSignature)
+   {
+      mValid = true;
+      Con::printf("Graph hierarchy: %d clusters, %d entrances", numClusters(),
+                  mEntrances.size());
+   }
+   else
+   {
+      U32   startMS = Platform::getRealMilliseconds();
+      build();
+      Con::printf("Graph hierarchy: built %d clusters, %d entrances, %d links in %d ms",
+                  numClusters(), mEntrances.size(), mLinks.size(),
+                  Platform::getRealMilliseconds() - startMS);
+   }
+   return mValid;
+}
+
+//-------------------------------------------------------------------------------------
+// Jet abilities.  Level 0 doesn't jet, the top level can take every jetting edge,
+// and those between take the easier part of them.
+
+static S32 QSORT_CALLBACK needCompare(const void* a,const void* b)
+{
+   F32   needA = * (const F32 *) a;
+   F32   needB = * (const F32 *) b;
+   return (needA < needB ? -1 : (needA > needB ? 1 : 0));
+}
+
+void GraphHierarchy::makeLevels(S32 numNodes)
+{
+   GraphEdge   edgeBuffer[MaxOnDemandEdges];
+   Vector<F32> needs[2];
+   S32         i, j;
+
+   // What each edge needs of the rating it's checked against (see canJet())-
+   for (i = 0; i < numNodes; i++)
+      if (GraphNode * node = gNavGraph->lookupNode(i))
+      {
+         GraphEdgeArray edges = node->getEdges(edgeBuffer);
+         while (GraphEdge * edge = edges++)
+            if (edge->isJetting() && edge->mDest < numNodes)
+            {
+               F32   need = edge->isDown() ? F32(edge->getLateral()) + 0.01f : edge->mDist;
+               needs[edge->isJump()].push_back(need);
+            }
+      }
+
+   dMemset(mLevels, 0, sizeof(mLevels));
+   for (j = 0; j < 2; j++)
+   {
+      S32   count = needs[j].size();
+      if (count)
+      {
+         dQsort(needs[j].address(), count, sizeof(F32), needCompare);
+         for (i = 1; i < NumLevels; i++)
+         {
+            S32   which = (count * i) / (NumLevels - 1) - 1;
+            mLevels[i][j] = needs[j][mClamp(which, 0, count - 1)];
+         }
+      }
+   }
+}
+
+// Lowest level that can take the edge.
+S32 GraphHierarchy::edgeLevel(const GraphEdge& edge) const
+{
+   if (edge.isJetting())
+   {
+      for (S32 level = 1; level < NumLevels; level++)
+         if (edge.canJet(mLevels[level]))
+            return level;
+      return NumLevels;
+   }
+   return 0;
+}
+
+// Highest level the ratings cover.
+S32 GraphHierarchy::getLevel(const F32* ratings) const
+{
+   if (!ratings)
+      return NumLevels - 1;
+
+   for (S32 level = NumLevels - 1; level > 0; level--)
+      if (ratings[0] >= mLevels[level][0] && ratings[1] >= mLevels[level][1])
+         return level;
+   return 0;
+}
+
+//-------------------------------------------------------------------------------------
+// Each cell is split up by what its walking edges join.
+
+S32 GraphHierarchy::makeClusters(S32 numNodes)
+{
+   GraphEdge         edgeBuffer[MaxOnDemandEdges];
+   Vector<Point2I>   cells;
+   Vector<S32>       stack;
+   S32               numClusters = 0, i;
+
+   cells.setSize(numNodes);
+   mClusterOf.setSize(numNodes);
+   for (i = 0; i < numNodes; i++)
+   {
+      mClusterOf[i] = -1;
+      if (GraphNode * node = gNavGraph->lookupNode(i))
+      {
+         const Point3F& loc = node->location();
+         cells[i].set(S32(mFloor(loc.x / mCellSize)), S32(mFloor(loc.y / mCellSize)));
+      }
+   }
+
+   for (i = 0; i < numNodes; i++)
+   {
+      if (mClusterOf[i] >= 0)
+         continue;
+
+      mClusterOf[i] = numClusters;
+      stack.push_back(i);
+      while (stack.size())
+      {
+         S32   index = stack.last();
+         stack.decrement();
+         if (GraphNode * node = gNavGraph->lookupNode(index))
+         {
+            GraphEdgeArray edges = node->getEdges(edgeBuffer);
+            while (GraphEdge * edge = edges++)
+            {
+               S32   dest = edge->mDest;
+               if (dest < numNodes && !edge->isJetting() && mClusterOf[dest] < 0)
+                  if (cells[dest].x == cells[index].x && cells[dest].y == cells[index].y)
+                  {
+                     mClusterOf[dest] = numClusters;
+                     stack.push_back(dest);
+                  }
+            }
+         }
+      }
+      numClusters++;
+   }
+
+   return numClusters;
+}
+
+//-------------------------------------------------------------------------------------
+// Crossings between two clusters.  For walking we keep one crossing in the middle of
+// the border the clusters share, and use it both ways.  Jetting crossings are one way,
+// and we keep the one the most bots can make.
+
+struct ClusterCrossing
+{
+   S32      key[2];
+   S32      jet;
+   S32      src, dst;
+   S32      level;
+   Point3F  mid;
+};
+
+static S32 QSORT_CALLBACK crossingCompare(const void* a,const void* b)
+{
+   const ClusterCrossing * crossA = (const ClusterCrossing *) a;
+   const ClusterCrossing * crossB = (const ClusterCrossing *) b;
+   if (crossA->key[0] != crossB->key[0])
+      return crossA->key[0] - crossB->key[0];
+   if (crossA->key[1] != crossB->key[1])
+      return crossA->key[1] - crossB->key[1];
+   if (crossA->jet != crossB->jet)
+      return crossA->jet - crossB->jet;
+   if (crossA->src != crossB->src)
+      return crossA->src - crossB->src;
+   return crossA->dst - crossB->dst;
+}
+
+static S32 QSORT_CALLBACK transitionCompare(const void* a,const void* b)
+{
+   const S32 * transA = (const S32 *) a;
+   const S32 * transB = (const S32 *) b;
+   return (transA[0] != transB[0] ? transA[0] - transB[0] : transA[1] - transB[1]);
+}
+
+// Best way from the entrance to each of the other entrances of its cluster, at each
+// level.  Clusters without jetting in them get the same answer at all levels.
+void GraphHierarchy::crossCluster(S32 entrance, const BitVector& jetClusters, Vector<Link>& links)
+{
+   GraphEdge   edgeBuffer[MaxOnDemandEdges];
+   S32         source = mEntrances[entrance].mNode;
+   S32         cluster = mEntrances[entrance].mCluster;
+   S32         first = mFirstEntrance[cluster], last = mFirstEntrance[cluster + 1];
+   S32         numLevels = jetClusters.test(cluster) ? NumLevels : 1;
+   S32         linkStart = links.size();
+   S32         i;
+
+   for (i = first; i < last; i++)
+      if (i != entrance)
+      {
+         links.increment();
+         links.last().mTo = i;
+         for (S32 level = 0; level < NumLevels; level++)
+            links.last().mCost[level] = SearchFailureAssure;
+      }
+
+   for (S32 level = 0; level < numLevels; level++)
+   {
+      mQueue.clear();
+      mQueue.insert(SearchRef(source, 0, 0));
+      mQueue.buildHeap();
+      mQIndices[source] = 0;
+
+      while (SearchRef * head = mQueue.head())
+      {
+         SearchRef   cur = * head;
+         mQueue.removeHead();
+         mClosed.set(cur.mIndex);
+
+         GraphEdgeArray edges = gNavGraph->lookupNode(cur.mIndex)->getEdges(edgeBuffer);
+         while (GraphEdge * edge = edges++)
+         {
+            S32   dest = edge->mDest;
+            if (dest >= mNumNodes || mClusterOf[dest] != cluster || mClosed.test(dest))
+               continue;
+            if (edgeLevel(* edge) > level)
+               continue;
+            F32   edgeTime = edge->getTime();
+            if (ClusterFailed(edgeTime))
+               continue;
+
+            F32   newTime = cur.mSort + edgeTime;
+            S32   queueInd = mQIndices[dest];
+            if (queueInd < 0) {
+               mQIndices[dest] = mQueue.size();
+               mQueue.insert(SearchRef(dest, 0, newTime));
+            }
+            else if (newTime < mQueue[queueInd].mSort) {
+               mQueue[queueInd].mSort = newTime;
+               mQueue.changeKey(queueInd);
+            }
+         }
+      }
+
+      for (i = first; i < last; i++)
+         if (i != entrance)
+         {
+            Link &   link = links[linkStart + i - first - (i > entrance)];
+            S32      queueInd = mQIndices[mEntrances[i].mNode];
+            if (queueInd >= 0)
+               link.mCost[level] = mQueue[queueInd].mSort;
+         }
+
+      for (i = 0; i < mQueue.size(); i++) {
+         mQIndices[mQueue[i].mIndex] = -1;
+         mClosed.clear(mQueue[i].mIndex);
+      }
+   }
+
+   // Fill in the levels that weren't searched, and drop what can't be reached.
+   for (i = links.size() - 1; i >= linkStart; i--)
+   {
+      for (S32 level = numLevels; level < NumLevels; level++)
+         links[i].mCost[level] = links[i].mCost[0];
+      if (ClusterFailed(links[i].mCost[NumLevels - 1]))
+         links.erase(i);
+   }
+}
+
+void GraphHierarchy::build()
+{
+   GraphEdge   edgeBuffer[MaxOnDemandEdges];
+   S32         numNodes = gNavGraph->numNodes();
+   S32         i, j;
+
+   mValid = false;
+   mCellSize = smClusterSize;
+   mNumNodes = numNodes;
+   mSignature = calcSignature(numNodes);
+   mEntrances.clear();
+   mLinks.clear();
+   mFirstEntrance.clear();
+
+   makeLevels(numNodes);
+   S32   numClusters = makeClusters(numNodes);
+
+   // Find all the crossings, and note clusters with jetting in them-
+   Vector<ClusterCrossing> crossings;
+   BitVector   jetClusters(numClusters);
+   jetClusters.clear();
+   for (i = 0; i < numNodes; i++)
+      if (GraphNode * node = gNavGraph->lookupNode(i))
+      {
+         GraphEdgeArray edges = node->getEdges(edgeBuffer);
+         while (GraphEdge * edge = edges++)
+         {
+            S32   dest = edge->mDest;
+            if (dest >= numNodes || ClusterFailed(edge->getTime()))
+               continue;
+            S32   from = mClusterOf[i], to = mClusterOf[dest];
+            if (from == to) {
+               if (edge->isJetting())
+                  jetClusters.set(from);
+               continue;
+            }
+
+            crossings.increment();
+            ClusterCrossing & cross = crossings.last();
+            cross.jet = edge->isJetting();
+            cross.key[0] = cross.jet ? from : getMin(from, to);
+            cross.key[1] = cross.jet ? to : getMax(from, to);
+            cross.src = i;
+            cross.dst = dest;
+            cross.level = edgeLevel(* edge);
+            cross.mid = (node->location() + gNavGraph->lookupNode(dest)->location()) * 0.5;
+         }
+      }
+   dQsort(crossings.address(), crossings.size(), sizeof(ClusterCrossing), crossingCompare);
+
+   // Pick the transitions (as src, dst pairs)-
+   Vector<S32> transitions;
+   for (i = 0; i < crossings.size(); i = j)
+   {
+      Point3F  centroid(0, 0, 0);
+      for (j = i; j < crossings.size(); j++)
+      {
+         if (crossings[j].key[0] != crossings[i].key[0] ||
+               crossings[j].key[1] != crossings[i].key[1] || crossings[j].jet != crossings[i].jet)
+            break;
+         centroid += crossings[j].mid;
+      }
+      centroid /= F32(j - i);
+
+      S32   best = i;
+      F32   bestDist = 1e20;
+      for (S32 k = i; k < j; k++)
+      {
+         F32   dist = (crossings[k].mid - centroid).lenSquared();
+         if (crossings[k].level < crossings[best].level ||
+               (crossings[k].level == crossings[best].level && dist < bestDist))
+            best = k, bestDist = dist;
+      }
+
+      transitions.push_back(crossings[best].src);
+      transitions.push_back(crossings[best].dst);
+      if (!crossings[best].jet) {
+         transitions.push_back(crossings[best].dst);
+         transitions.push_back(crossings[best].src);
+      }
+   }
+   S32   numTransitions = transitions.size() >> 1;
+   dQsort(transitions.address(), numTransitions, sizeof(S32) * 2, transitionCompare);
+
+   // Entrances in cluster order-
+   Vector<S32> entranceOf;
+   entranceOf.setSize(numNodes);
+   for (i = 0; i < numNodes; i++)
+      entranceOf[i] = -1;
+   for (i = 0; i < transitions.size(); i++)
+      entranceOf[transitions[i]] = 0;
+
+   mFirstEntrance.setSize(numClusters + 1);
+   dMemset(mFirstEntrance.address(), 0, mFirstEntrance.memSize());
+   for (i = 0; i < numNodes; i++)
+      if (entranceOf[i] == 0)
+         mFirstEntrance[mClusterOf[i] + 1]++;
+   for (i = 0; i < numClusters; i++)
+      mFirstEntrance[i + 1] += mFirstEntrance[i];
+
+   S32   numEntrances = mFirstEntrance[numClusters];
+   if (numEntrances >= (1 << 15) - 1)
+   {
+      Con::errorf("Graph hierarchy: too many entrances (%d)", numEntrances);
+      mFirstEntrance.setSize(1);
+      mFirstEntrance[0] = 0;
+      return;
+   }
+
+   Vector<S32> fill;
+   fill.setSize(numClusters);
+   dMemcpy(fill.address(), mFirstEntrance.address(), fill.memSize());
+   mEntrances.setSize(numEntrances);
+   for (i = 0; i < numNodes; i++)
+      if (entranceOf[i] == 0)
+      {
+         S32   entrance = fill[mClusterOf[i]]++;
+         entranceOf[i] = entrance;
+         mEntrances[entrance].mNode = i;
+         mEntrances[entrance].mCluster = mClusterOf[i];
+      }
+
+   // Links: across the cluster, then out over the transitions-
+   mQIndices.setSize(numNodes);
+   for (i = 0; i < numNodes; i++)
+      mQIndices[i] = -1;
+   mClosed.setSize(numNodes);
+   mClosed.clear();
+   mQueue.reserve(numNodes);
+
+   for (i = 0; i < numEntrances; i++)
+   {
+      Entrance &  entrance = mEntrances[i];
+      entrance.mFirstLink = mLinks.size();
+      crossCluster(i, jetClusters, mLinks);
+
+      // Transitions are sorted by source, find ours with a binary search-
+      GraphNode * node = gNavGraph->lookupNode(entrance.mNode);
+      S32   lo = 0, hi = numTransitions;
+      while (lo < hi) {
+         S32   mid = (lo + hi) >> 1;
+         if (transitions[mid * 2] < entrance.mNode)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      for (S32 trans = lo; trans < numTransitions && transitions[trans * 2] == entrance.mNode; trans++)
+      {
+         S32   dest = transitions[trans * 2 + 1];
+         if (trans > lo && dest == transitions[trans * 2 - 1])
+            continue;
+         GraphEdge * edge = node->getEdgeTo(dest);
+         S32   level = edge ? edgeLevel(* edge) : NumLevels;
+         if (level < NumLevels)
+         {
+            mLinks.increment();
+            mLinks.last().mTo = entranceOf[dest];
+            for (j = 0; j < NumLevels; j++)
+               mLinks.last().mCost[j] = (j >= level ? edge->getTime() : SearchFailureAssure);
+         }
+      }
+      entrance.mNumLinks = mLinks.size() - entrance.mFirstLink;
+   }
+
+   mValid = true;
+}
+
+//-------------------------------------------------------------------------------------
+// Clusters a search end is in.  Transients are in those of the nodes they hook to.
+
+void GraphHierarchy::nodeClusters(GraphNode* node, Vector<S32>& list) const
+{
+   list.clear();
+   S32   index = node->getIndex();
+
+   if (index < mNumNodes)
+      list.push_back(mClusterOf[index]);
+   else
+   {
+      GraphEdge      edgeBuffer[MaxOnDemandEdges];
+      GraphEdgeArray edges = node->getEdges(edgeBuffer);
+      while (GraphEdge * edge = edges++)
+         if (edge->mDest < mNumNodes)
+         {
+            S32   cluster = mClusterOf[edge->mDest];
+            S32   i;
+            for (i = 0; i < list.size(); i++)
+               if (list[i] == cluster)
+                  break;
+            if (i == list.size())
+               list.push_back(cluster);
+         }
+   }
+}
+
+void GraphHierarchy::relax(S32 index, F32 dist, F32 sort, S32 prevQ)
+{
+   S32   queueInd = mQIndices[index];
+
+   if (queueInd < 0) {
+      mQIndices[index] = mQueue.size();
+      SearchRef   assemble(index, dist, sort);
+      assemble.mPrev = prevQ;
+      mQueue.insert(assemble);
+   }
+   else if (!mClosed.test(index) && sort < mQueue[queueInd].mSort) {
+      mQueue[queueInd].mDist = dist;
+      mQueue[queueInd].mSort = sort;
+      mQueue[queueInd].mPrev = prevQ;
+      mQueue.changeKey(queueInd);
+   }
+}
+
+void GraphHierarchy::edgeClusters(const GraphEdgeList& edges, Vector<S32>& list) const
+{
+   list.clear();
+   for (S32 e = 0; e < edges.size(); e++)
+      if (edges[e].mDest < mNumNodes)
+      {
+         S32   cluster = mClusterOf[edges[e].mDest];
+         S32   i;
+         for (i = 0; i < list.size(); i++)
+            if (list[i] == cluster)
+               break;
+         if (i == list.size())
+            list.push_back(cluster);
+      }
+}
+
+bool GraphHierarchy::startQuery(const Point3F& srcLoc, const Point3F& dstLoc)
+{
+   mExpansions = 0;
+   if (!mValid || !smEnabled)
+      return false;
+
+   mStats.queries++;
+   if ((dstLoc - srcLoc).lenSquared() < smMinDist * smMinDist) {
+      mStats.tooClose++;
+      return false;
+   }
+   return true;
+}
+
+bool GraphHierarchy::findCorridor(GraphNode* S, GraphNode* D, const F32* ratings)
+{
+   if (!startQuery(S->location(), D->location()))
+      return false;
+
+   nodeClusters(S, mSources);
+   nodeClusters(D, mTargetList);
+   return searchCorridor(S->location(), D->location(), ratings);
+}
+
+// For searches on the path queue, the transients aren't hooked in.
+bool GraphHierarchy::findCorridor(const Point3F& srcLoc, const GraphEdgeList& srcEdges,
+                                  const Point3F& dstLoc, const GraphEdgeList& dstEdges,
+                                  const F32* ratings)
+{
+   if (!startQuery(srcLoc, dstLoc))
+      return false;
+
+   edgeClusters(srcEdges, mSources);
+   edgeClusters(dstEdges, mTargetList);
+   return searchCorridor(srcLoc, dstLoc, ratings);
+}
+
+// A* over the entrances.  The ends get to and from the entrances of their clusters
+// by straight line, and the corridor is those clusters plus the ones the way out of
+// the source clusters goes through.
+bool GraphHierarchy::searchCorridor(const Point3F& srcLoc, const Point3F& dstLoc,
+                                    const F32* ratings)
+{
+   if (!mSources.size() || !mTargetList.size()) {
+      mStats.noWay++;
+      return false;
+   }
+
+   S32   numClusters = this->numClusters();
+   S32   numEntrances = mEntrances.size();
+   S32   goal = numEntrances;
+   S32   i;
+
+   if (mTargets.getSize() != numClusters) {
+      mTargets.setSize(numClusters);
+      mTargets.clear();
+      mCorridor.setSize(numClusters);
+   }
+   if (mQIndices.size() != numEntrances + 1) {
+      mQIndices.setSize(numEntrances + 1);
+      for (i = 0; i <= numEntrances; i++)
+         mQIndices[i] = -1;
+      mClosed.setSize(numEntrances + 1);
+      mClosed.clear();
+      mQueue.reserve(numEntrances + 1);
+   }
+
+   for (i = 0; i < mTargetList.size(); i++)
+      mTargets.set(mTargetList[i]);
+   bool  sharing = false;
+   for (i = 0; i < mSources.size(); i++)
+      sharing |= mTargets.test(mSources[i]);
+
+   bool  found = false;
+   if (!sharing)
+   {
+      PROFILE_START(GraphHierarchySearch);
+      S32   level = getLevel(ratings);
+
+      mQueue.clear();
+      for (i = 0; i < mSources.size(); i++)
+         for (S32 e = mFirstEntrance[mSources[i]]; e < mFirstEntrance[mSources[i] + 1]; e++)
+         {
+            const Point3F& loc = gNavGraph->lookupNode(mEntrances[e].mNode)->location();
+            F32   dist = (loc - srcLoc).len();
+            relax(e, dist, dist + (dstLoc - loc).len(), -1);
+         }
+      mQueue.buildHeap();
+
+      while (SearchRef * head = mQueue.head())
+      {
+         SearchRef   cur = * head;
+         mQueue.removeHead();
+         mClosed.set(cur.mIndex);
+         if (cur.mIndex == goal) {
+            found = true;
+            break;
+         }
+         mExpansions++;
+
+         const Entrance &  entrance = mEntrances[cur.mIndex];
+         S32   curQ = mQIndices[cur.mIndex];
+         if (mTargets.test(entrance.mCluster))
+         {
+            const Point3F& loc = gNavGraph->lookupNode(entrance.mNode)->location();
+            F32   dist = cur.mDist + (dstLoc - loc).len();
+            relax(goal, dist, dist, curQ);
+         }
+
+         const Link *   link = &mLinks[entrance.mFirstLink];
+         for (S32 k = 0; k < entrance.mNumLinks; k++, link++)
+            if (!ClusterFailed(link->mCost[level]) && !mClosed.test(link->mTo))
+            {
+               const Point3F& loc = gNavGraph->lookupNode(mEntrances[link->mTo].mNode)->location();
+               F32   dist = cur.mDist + link->mCost[level];
+               relax(link->mTo, dist, dist + (dstLoc - loc).len(), curQ);
+            }
+      }
+
+      // The corridor-
+      if (found)
+      {
+         mCorridor.clear();
+         for (i = 0; i < mSources.size(); i++)
+            mCorridor.set(mSources[i]);
+         for (i = 0; i < mTargetList.size(); i++)
+            mCorridor.set(mTargetList[i]);
+         for (S32 q = mQueue[mQIndices[goal]].mPrev; q >= 0; q = mQueue[q].mPrev)
+            mCorridor.set(mEntrances[mQueue[q].mIndex].mCluster);
+      }
+
+      for (i = 0; i < mQueue.size(); i++) {
+         mQIndices[mQueue[i].mIndex] = -1;
+         mClosed.clear(mQueue[i].mIndex);
+      }
+      PROFILE_END();
+   }
+
+   for (i = 0; i < mTargetList.size(); i++)
+      mTargets.clear(mTargetList[i]);
+
+   mStats.expansions += mExpansions;
+   if (found)
+      mStats.corridors++;
+   else if (sharing)
+      mStats.tooClose++;
+   else
+      mStats.noWay++;
+   return found;
+}
+
+// Told how the search in the corridor went.
+void GraphHierarchy::corridorSearched(S32 iterations, bool found)
+{
+   mStats.refineIterations += iterations;
+   if (!found)
+      mStats.fallbacks++;
+}
+
+void GraphHierarchy::dumpStats(bool reset)
+{
+   U32   corridors = getMax(mStats.corridors, U32(1));
+   Con::printf("Graph hierarchy: %d clusters, %d entrances, %d links%s", numClusters(),
+               mEntrances.size(), mLinks.size(), mValid ? "" : " (not in use)");
+   Con::printf("   queries: %d, corridors: %d, too close: %d, no way: %d, fallbacks: %d",
+               mStats.queries, mStats.corridors, mStats.tooClose, mStats.noWay,
+               mStats.fallbacks);
+   Con::printf("   per corridor: %.1f entrances expanded, %.1f corridor search iterations",
+               F32(mStats.expansions) / corridors, F32(mStats.refineIterations) / corridors);
+   if (reset)
+      mStats.clear();
+}
+
+//-------------------------------------------------------------------------------------
+
+ConsoleFunction(navHierarchyStats, void, 1, 2, "navHierarchyStats(<reset>);")
+{
+   if (!NavigationGraph::gotOneWeCanUse()) {
+      Con::printf("navHierarchyStats: no graph");
+      return;
+   }
+   gNavGraph->hierarchy().dumpStats(argc > 1 && dAtob(argv[1]));
+}
+
+// Long searches between random nodes, done flat and through the hierarchy, at one
+// of the jet levels (the top one by default).
+ConsoleFunction(navHierarchyBench, void, 1, 4, "navHierarchyBench(<searches>, <minDist>, <level>);")
+{
+   if (!NavigationGraph::gotOneWeCanUse() || !gNavGraph->hierarchy().valid()) {
+      Con::printf("navHierarchyBench: no graph hierarchy");
+      return;
+   }
+
+   GraphHierarchy &  hierarchy = gNavGraph->hierarchy();
+   S32   numSearches = (argc > 1) ? getMax(dAtoi(argv[1]), 1) : 200;
+   F32   minDist = (argc > 2) ? dAtof(argv[2]) : 400.0f;
+   S32   level = (argc > 3) ? mClamp(dAtoi(argv[3]), 0, GraphHierarchy::NumLevels - 1)
+                            : GraphHierarchy::NumLevels - 1;
+   const F32 * ratings = hierarchy.levelRatings(level);
+   S32   numNodes = gNavGraph->numNodes();
+
+   MRandomLCG     random(0x4321);
+   GraphSearch *  searcher = gNavGraph->getMainSearcher();
+   Vector<S32>    path;
+   S32   searches = 0, flatFound = 0, hierFound = 0, fallbacks = 0;
+   S32   flatIters = 0, hierIters = 0, hierExpansions = 0;
+   U32   flatMS = 0, hierMS = 0;
+   F64   distRatio = 0;
+
+   F32   saveMinDist = GraphHierarchy::smMinDist;
+   GraphHierarchy::smMinDist = 0;
+
+   for (S32 tries = 0; searches < numSearches && tries < numSearches * 50; tries++)
+   {
+      GraphNode * src = gNavGraph->lookupNode(random.randI(0, numNodes - 1));
+      GraphNode * dst = gNavGraph->lookupNode(random.randI(0, numNodes - 1));
+      if (!src || !dst || src->island() != dst->island())
+         continue;
+      if ((src->location() - dst->location()).len() < minDist)
+         continue;
+      searches++;
+
+      U32   startMS = Platform::getRealMilliseconds();
+      searcher->setAStar(true);
+      searcher->setRatings(ratings);
+      flatIters += searcher->performSearch(src, dst);
+      bool  found = searcher->getPathIndices(path);
+      F32   flatDist = searcher->searchDist();
+      flatMS += Platform::getRealMilliseconds() - startMS;
+      flatFound += found;
+
+      startMS = Platform::getRealMilliseconds();
+      bool  corridor = hierarchy.findCorridor(src, dst, ratings);
+      hierExpansions += hierarchy.expansions();
+      searcher->setAStar(true);
+      searcher->setRatings(ratings);
+      if (corridor)
+         searcher->setCorridor(&hierarchy.corridor());
+      hierIters += searcher->performSearch(src, dst);
+      found = searcher->getPathIndices(path);
+      if (corridor && !found) {
+         fallbacks++;
+         searcher->setAStar(true);
+         searcher->setRatings(ratings);
+         hierIters += searcher->performSearch(src, dst);
+         found = searcher->getPathIndices(path);
+      }
+      hierMS += Platform::getRealMilliseconds() - startMS;
+      hierFound += found;
+      if (found && flatDist > 0)
+         distRatio += searcher->searchDist() / flatDist;
+   }
+   GraphHierarchy::smMinDist = saveMinDist;
+
+   S32   count = getMax(searches, 1);
+   Con::printf("navHierarchyBench: %d searches over %.0f, level %d, found %d flat, %d hierarchical",
+               searches, minDist, level, flatFound, hierFound);
+   Con::printf("   flat: %.1f nodes expanded, %d ms", F32(flatIters) / count, flatMS);
+   Con::printf("   hierarchical: %.1f nodes + %.1f entrances expanded, %d ms, %d fallbacks",
+               F32(hierIters) / count, F32(hierExpansions) / count, hierMS, fallbacks);
+   Con::printf("   path length vs flat: %.3f", hierFound ? F32(distRatio / hierFound) : 0.0f);
+}
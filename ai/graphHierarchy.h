@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GRAPHHIERARCHY_H_
+#define _GRAPHHIERARCHY_H_
+
+//-------------------------------------------------------------------------------------
+// Clusters of nodes for long path searches.
+//
+// Nodes are grouped by XY cell, and each cell is split into the pieces its walking
+// edges connect.  Where edges cross from one cluster into another a few of them are
+// kept as transitions, and their end nodes are the cluster's entrances.  Links join
+// entrances: the transition edges themselves, and the best way across each cluster
+// between its entrances, costed at each of NumLevels jet abilities.
+//
+// A long search first finds the way over the entrances, then runs the usual A* with
+// only the nodes of the clusters along that way (the corridor) open to it.  Abilities
+// are taken a level down from what the bot really has, so any corridor is one the
+// bot can get through.  When the corridor search still fails (force fields, or the
+// ends aren't joined within their own clusters) the full search is run.
+//
+// Built after the bridges are in (NavigationGraph::makeHierarchy()), and saved with
+// the graph.  A signature of the edges tells if the saved data fits the graph.
+
+class GraphHierarchy
+{
+   public:
+      enum {NumLevels = 4};
+      static F32     smClusterSize;
+      static F32     smMinDist;
+      static bool    smEnabled;
+
+   protected:
+      struct Entrance {
+         S16      mNode;
+         S16      mCluster;
+         S32      mFirstLink;
+         S32      mNumLinks;
+         bool     read(Stream& s);
+         bool     write(Stream& s) const;
+      };
+      struct Link {
+         S16      mTo;                       // entrance index
+         F32      mCost[NumLevels];          // SearchFailureAssure if not at level
+         bool     read(Stream& s);
+         bool     write(Stream& s) const;
+      };
+
+      // Saved-
+      S32               mNumNodes;
+      U32               mSignature;
+      F32               mCellSize;
+      F32               mLevels[NumLevels][2];
+      Vector<S16>       mClusterOf;          // per node
+      Vector<S32>       mFirstEntrance;      // per cluster, plus one
+      Vector<Entrance>  mEntrances;          // in cluster order
+      Vector<Link>      mLinks;
+      bool              mValid;
+
+      // Search-
+      GraphQueue        mQueue;
+      Vector<S32>       mQIndices;           // per entrance + goal
+      BitVector         mClosed;
+      BitVector         mCorridor;           // by cluster
+      BitVector         mTargets;
+      Vector<S32>       mSources;
+      Vector<S32>       mTargetList;
+      S32               mExpansions;
+
+      struct Stats {
+         U32   queries;
+         U32   corridors;
+         U32   tooClose;
+         U32   noWay;
+         U32   fallbacks;
+         U32   expansions;
+         U32   refineIterations;
+         void  clear() { dMemset(this, 0, sizeof(*this)); }
+      } mStats;
+
+      static U32     calcSignature(S32 numNodes);
+      void           makeLevels(S32 numNodes);
+      S32            edgeLevel(const GraphEdge& edge) const;
+      S32            makeClusters(S32 numNodes);
+      void           crossCluster(S32 entrance, const BitVector& cluster, Vector<Link>& links);
+      void           nodeClusters(GraphNode* node, Vector<S32>& list) const;
+      void           edgeClusters(const GraphEdgeList& edges, Vector<S32>& list) const;
+      bool           startQuery(const Point3F& srcLoc, const Point3F& dstLoc);
+      bool           searchCorridor(const Point3F& srcLoc, const Point3F& dstLoc,
+                                    const F32* ratings);
+      void           relax(S32 index, F32 dist, F32 sort, S32 prevQ);
+
+   public:
+      GraphHierarchy();
+      void           build();
+      bool           install();
+      void           invalidate()                  {mValid = false;}
+      bool           valid() const                 {return mValid;}
+      S32            numClusters() const           {return mFirstEntrance.size() - 1;}
+      const S16 *    clusterList() const           {return mClusterOf.address();}
+      const BitVector& corridor() const            {return mCorridor;}
+      const F32 *    levelRatings(S32 L) const     {return mLevels[L];}
+      S32            expansions() const            {return mExpansions;}
+      S32            getLevel(const F32* ratings) const;
+
+      bool           findCorridor(GraphNode* S, GraphNode* D, const F32* ratings);
+      bool           findCorridor(const Point3F& srcLoc, const GraphEdgeList& srcEdges,
+                                  const Point3F& dstLoc, const GraphEdgeList& dstEdges,
+                                  const F32* ratings);
+      void           corridorSearched(S32 iterations, bool found);
+      void           dumpStats(bool reset);
+
+      bool           read(Stream& s);
+      bool           write(Stream& s) const;
+};
+
+#endif
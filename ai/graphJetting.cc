@@ -369,6 +369,7 @@ void JetManager::replaceEdge(GraphBridgeData & B)
    GraphEdge   *  edge = src->getEdgeTo(dst);
    
    AssertFatal(src && dst && edge, "JetManager::replaceEdge()");
+   gNavGraph->edgesChanged();
    
    if (B.isUnreachable())
    {
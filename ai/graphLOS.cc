@@ -8,7 +8,7 @@
 #include "ai/graph.h"
 #include "ai/graphLOS.h"
 
-U32 Loser::mCasts = 0;     // Just for informal profiling, counting casts. 
+THREAD_LOCAL U32 Loser::mCasts = 0;     // Just for informal profiling, counting casts. 
 static const F32 scGraphStepCheck = 0.75;
                            
 Loser::Loser(U32 mask, bool checkFF)
@@ -8,9 +8,13 @@
 #ifndef _GRAPHLOS_H_
 #define _GRAPHLOS_H_
 
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+
 struct Loser 
 {
-   static U32  mCasts;
+   static THREAD_LOCAL U32 mCasts;     // bridges are found on the build pool
    const bool  mCheckingFF;
    const U32   mMask;
    RayInfo     mColl;
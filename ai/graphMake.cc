@@ -122,7 +122,11 @@ S32 NavigationGraph::doFinalFixups()
    newIncarnation();
    
    mValidLOSTable = (mLOSTable && mLOSTable->valid(numNodes()));
-   
+
+   // Tables from older files go over to blocks now that there are nodes to order.
+   if (mValidLOSTable && mLOSTable != & mLOSBlockTable)
+      makeLOSBlockTable();
+
    mValidPathTable = false;      // this has been dropped...  
    
    return numberHanging; 
@@ -136,6 +140,7 @@ S32 NavigationGraph::doFinalFixups()
 bool NavigationGraph::makeGraph(bool needEdgePool)
 {
    mPushedBridges = 0;
+   mHierarchy.invalidate();
    
    makeRunTimeNodes(needEdgePool);     // (graphOutdoors.cc)
    Con::printf("MakeGraph: %d indoor, %d outdoor", mNumIndoor, mNumOutdoor);
@@ -167,6 +172,16 @@ S32 NavigationGraph::makeTables()
    return 0;
 }
 
+//-------------------------------------------------------------------------------------
+// The clusters for long searches (graphHierarchy.h) go on the graph as the bots will
+// have it, so this follows pushBridges().  A hierarchy loaded with the graph is kept 
+// if it still fits.  
+
+bool NavigationGraph::makeHierarchy()
+{
+   return mHierarchy.install();
+}
+
 //-------------------------------------------------------------------------------------
 // Initialize the terrain info data from the ground plan.  
 
@@ -13,9 +13,16 @@
 // Go through the construct function since we want to reconstruct on mission cycle. 
 NavigationPath::NavigationPath()
 {
+   mRequest = NULL;
+   mHaveCacheKey = false;
    constructThis();
 }
 
+NavigationPath::~NavigationPath()
+{
+   dropRequest();
+}
+
 void NavigationPath::constructThis()
 {
    mState.constructThis();
@@ -119,6 +126,29 @@ void NavigationPath::markRenderPath()
       getNode(i)->setOnPath();
 }
 
+// Paths are shared through the cache by the nodes closest to the ends, our team, and 
+// what we can jet.  
+bool NavigationPath::makeCacheKey(const TransientNode& srcNode, const TransientNode& dstNode)
+{
+   const GraphNode * srcClosest = srcNode.getClosest();
+   const GraphNode * dstClosest = dstNode.getClosest();
+   mHaveCacheKey = (srcClosest && dstClosest && !srcClosest->transient() && !dstClosest->transient());
+   
+   if (mHaveCacheKey)
+   {
+      mCacheKey.mSrc = srcClosest->getIndex();
+      mCacheKey.mDst = dstClosest->getIndex();
+      mCacheKey.mTeam = mTeam;
+      mCacheKey.mRatings[0] = mCacheKey.mRatings[1] = 0;
+      #if _GRAPH_PART_
+      const F32 * ratings = gNavGraph->jetManager().getRatings(mJetCaps);
+      mCacheKey.mRatings[0] = ratings[0];
+      mCacheKey.mRatings[1] = ratings[1];
+      #endif
+   }
+   return mHaveCacheKey;
+}
+
 // Revised path search to go off of the transient nodes.  
 void NavigationPath::computePath(TransientNode& srcNode, TransientNode& dstNode)
 {
@@ -133,23 +163,44 @@ void NavigationPath::computePath(TransientNode& srcNode, TransientNode& dstNode)
       mState.path.clear();
       mState.curSeekNode = 0;
       GraphSearch * searcher = gNavGraph->getMainSearcher();
-      searcher->setAStar(true);
-      searcher->setTeam(mTeam);
-      searcher->setThreats(gNavGraph->getThreatSet(mTeam));
-      searcher->setRandomize(true);
+      const F32 * ratings = NULL;
       #if _GRAPH_PART_
-      searcher->setRatings(gNavGraph->jetManager().getRatings(mJetCaps));
+      ratings = gNavGraph->jetManager().getRatings(mJetCaps);
       #endif
       
-      searcher->performSearch(&srcNode, &dstNode);
+      // Another bot may have just found this path- 
+      GraphPathCache & cache = gNavGraph->pathCache();
+      bool  cached = makeCacheKey(srcNode, dstNode) && 
+                     cache.lookup(mCacheKey, srcNode, dstNode, mState.path, mSearchDist);
+      
+      // Long searches try the corridor the hierarchy finds first.  
+      GraphHierarchy & hierarchy = gNavGraph->hierarchy();
+      bool  corridor = !cached && hierarchy.findCorridor(&srcNode, &dstNode, ratings);
+      bool  found = cached;
+      for (S32 pass = (corridor ? 0 : 1); pass < 2 && !found; pass++)
+      {
+         searcher->setAStar(true);
+         searcher->setTeam(mTeam);
+         searcher->setThreats(gNavGraph->getThreatSet(mTeam));
+         searcher->setRandomize(true);
+         searcher->setRatings(ratings);
+         if (pass == 0)
+            searcher->setCorridor(&hierarchy.corridor());
+         
+         S32   iterations = searcher->performSearch(&srcNode, &dstNode);
+         found = searcher->getPathIndices(mState.path);
+         if (pass == 0)
+            hierarchy.corridorSearched(iterations, found);
+         if (found) {
+            mSearchDist = searcher->searchDist();
+            if (mHaveCacheKey)
+               cache.store(mCacheKey, mState.path);
+         }
+      }
 
       // Path fetcher tells us if search failed. 
-      if (searcher->getPathIndices(mState.path))
+      if (found)
       {
-      
-      
-      
-         mSearchDist = searcher->searchDist();
          setSizeAndClear(mState.visit, mState.path.size());
          saveEndpoints(&srcNode, &dstNode);
          mState.curSeekNode = 1;
@@ -188,16 +239,131 @@ void NavigationPath::computePath(TransientNode& srcNode, TransientNode& dstNode)
    gNavGraph->popTransientPair(srcNode, dstNode);
 }
 
+//-------------------------------------------------------------------------------------
+// Searches on the path queue (graphPathQueue.h).  Set up from the same state as 
+// computePath() above, while the path we have is followed until the answer comes.  
+
+void NavigationPath::submitPath(TransientNode& srcNode, TransientNode& dstNode)
+{
+   GraphPathRequest * request = gPathQueue.newRequest();
+   
+   if (gNavGraph->captureTransientPair(srcNode, dstNode, mTeam, mJetCaps, * request))
+   {
+      request->mTeam = mTeam;
+      request->mThreatSet = gNavGraph->getThreatSet(mTeam);
+      const F32 * ratings = NULL;
+      #if _GRAPH_PART_
+      ratings = gNavGraph->jetManager().getRatings(mJetCaps);
+      request->mRatings[0] = ratings[0];
+      request->mRatings[1] = ratings[1];
+      request->mHaveRatings = true;
+      #endif
+      
+      // The corridor goes along if the snapshot has the clusters it's made of.  
+      GraphHierarchy & hierarchy = gNavGraph->hierarchy();
+      const GraphEdgeSnapshot * snap = request->mEdgeSnap;
+      if (snap->mClusterOf.size() && snap->mNumClusters == hierarchy.numClusters())
+         if (hierarchy.findCorridor(request->mSrc.loc, request->mSrc.edges, 
+                                    request->mDst.loc, request->mDst.edges, ratings))
+            request->mCorridor.copy(hierarchy.corridor());
+      makeCacheKey(srcNode, dstNode);
+      gPathQueue.submit(request);
+      mRequest = request;
+   }
+   else 
+   {
+      gPathQueue.release(request, false);
+      mSearchDist = 0.0f;
+      mSearchWasValid = false;
+      #if _GRAPH_WARNINGS_
+         NavigationGraph::warning("Search tried across islands or partitions");
+      #endif
+   }
+}
+
+// Take the answer as computePath() would have.  The transients are hooked in as they
+// were for the search so the edges along the path can be found.  
+void NavigationPath::applyPath(TransientNode& srcNode, TransientNode& dstNode)
+{
+   GraphPathRequest * request = mRequest;
+   mRequest = NULL;
+   
+   if (request->mIncarnation != gNavGraph->incarnation())
+   {
+      gPathQueue.release(request, false);
+      mForceSearch = true;
+      return;
+   }
+   
+   mSearchDist = 0.0f;
+   mSearchWasValid = false;
+   mState.path.clear();
+   mState.curSeekNode = 0;
+   
+   if (request->mCorridor.getSize())
+      gNavGraph->hierarchy().corridorSearched(request->mCorridorIterations, 
+                                              request->mCorridorFound);
+   
+   if (request->mFound)
+   {
+      srcNode.setEdges(request->mSrc.edges);
+      dstNode.setEdges(request->mDst.edges);
+      srcNode.setLoc(request->mSrc.loc);
+      dstNode.setLoc(request->mDst.loc);
+      gNavGraph->hookTransient(dstNode);
+      gNavGraph->hookTransient(srcNode);
+      
+      mState.path = request->mPath;
+      mSearchDist = request->mSearchDist;
+      
+      // Only cache it if the graph hasn't changed under the search- 
+      if (mHaveCacheKey && request->mEdgeSnap->mGeneration == gNavGraph->edgeGeneration() &&
+               request->mNodeSnap->mGeneration == gNavGraph->nodeGeneration())
+         gNavGraph->pathCache().store(mCacheKey, mState.path);
+      setSizeAndClear(mState.visit, mState.path.size());
+      saveEndpoints(&srcNode, &dstNode);
+      mState.curSeekNode = 1;
+      setEdgeConstraints();
+      mAwaitingSearch = false;
+      mSearchWasValid = true;
+      setPctThresh();
+      
+      gNavGraph->popTransientPair(srcNode, dstNode);
+   }
+   else if (gNavGraph->haveForceFields())
+   {
+      gNavGraph->newPartition(request->mVisited, request->mTeam);
+   }
+   
+   gPathQueue.release(request, true);
+}
+
+// Let go of a search still on the queue.  
+void NavigationPath::dropRequest()
+{
+   if (mRequest) {
+      gPathQueue.release(mRequest, false);
+      mRequest = NULL;
+   }
+}
+
+//-------------------------------------------------------------------------------------
+
+void NavigationPath::setPctThresh()
+{
+   if ( mRedoMode == OnPercent ) {
+      F32   pctThresh = (mRedoPercent * mSearchDist);
+      mPctThreshSqrd = (pctThresh * pctThresh);
+   }
+}
+
 // Just want all the post-pathCompute stuff separated out:
 void NavigationPath::afterCompute()
 {
    mSaveDest = mState.destLoc;
    mForceSearch = false;
    mRepathCounter = 0;
-   if ( mRedoMode == OnPercent ) {
-      F32   pctThresh = (mRedoPercent * mSearchDist);
-      mPctThreshSqrd = (pctThresh * pctThresh);
-   }
+   setPctThresh();
    mUserStuck = false;
 }
 
@@ -243,6 +409,10 @@ bool NavigationPath::updateTransients(TransientNode& hereNode,
 
 bool NavigationPath::checkPathUpdate(TransientNode& hereNode, TransientNode& destNode)
 {
+   // Answer from the path queue is taken before the transients move on.  
+   if (mRequest && gPathQueue.isDone(mRequest))
+      applyPath(hereNode, destNode);
+
    bool  recompute =  mForceSearch;
    // bool  recompute =  false;
    
@@ -268,11 +438,20 @@ bool NavigationPath::checkPathUpdate(TransientNode& hereNode, TransientNode& des
    }
    if (recompute)
       mAwaitingSearch = true;
+      
+   // One search at a time on the queue- 
+   if (mRequest)
+      recompute = false;
    
    updateTransients(hereNode, destNode, recompute);
    
    if (recompute) {
-      computePath(hereNode, destNode);
+      // Paths in the cache are taken right away- 
+      if (gPathQueue.active() && 
+               !(makeCacheKey(hereNode, destNode) && gNavGraph->pathCache().contains(mCacheKey)))
+         submitPath(hereNode, destNode);
+      else
+         computePath(hereNode, destNode);
       afterCompute();
    }
 
@@ -820,6 +999,7 @@ bool NavigationPath::canReachLoc(const Point3F& dst)
 
 void NavigationPath::missionCycleCleanup()
 {
+   dropRequest();
    constructThis();
    mJetCaps.reset();
    mNavJetting.init();
@@ -46,11 +46,16 @@ class NavigationPath
       bool        updateTransients(TransientNode& src, TransientNode& dst, bool redo);
       void        saveEndpoints(TransientNode* from, TransientNode* to);
       void        computePath(TransientNode& from, TransientNode& to);
+      void        submitPath(TransientNode& from, TransientNode& to);
+      void        applyPath(TransientNode& from, TransientNode& to);
+      void        dropRequest();
+      bool        makeCacheKey(const TransientNode& from, const TransientNode& to);
       F32         estimateEnergy(const GraphEdge * edge);
       void        checkWallAvoid();
       void        randomization();
       void        markRenderPath();
       void        afterCompute();
+      void        setPctThresh();
       bool        canAdvance();
       void        setEdgeConstraints();
       void        advanceByOne();
@@ -93,9 +98,13 @@ class NavigationPath
       Point3F           mCastAverage;
       const GraphEdge * mEstimatedEdge;
       F32               mEstimatedEnergy;
+      GraphPathRequest* mRequest;
+      GraphPathCache::Key mCacheKey;
+      bool              mHaveCacheKey;
 
    public:
       NavigationPath();
+      ~NavigationPath();
       
       bool        updateLocations(const Point3F& src, const Point3F& dst);
       F32         checkOpenTerrain(const Point3F& from, Point3F& to);
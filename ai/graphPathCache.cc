@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/graph.h"
+#include "console/console.h"
+
+S32   GraphPathCache::smSize = 256;
+
+//-------------------------------------------------------------------------------------
+
+bool GraphPathCache::Key::operator==(const Key& key) const
+{
+   return mSrc == key.mSrc && mDst == key.mDst && mTeam == key.mTeam &&
+            mRatings[0] == key.mRatings[0] && mRatings[1] == key.mRatings[1];
+}
+
+U32 GraphPathCache::Key::hash() const
+{
+   U32   hash = (U32(mSrc) * 0x9E3779B1) ^ (U32(mDst) * 0x85EBCA77) ^ (mTeam << 24);
+   hash ^= (* (const U32 *) & mRatings[0]) * 0xC2B2AE3D;
+   hash ^= (* (const U32 *) & mRatings[1]);
+   return hash ^ (hash >> 16);
+}
+
+//-------------------------------------------------------------------------------------
+
+GraphPathCache::GraphPathCache()
+{
+   mEntries = NULL;
+   mCapacity = 0;
+   mUsed = 0;
+   mHead = mTail = -1;
+   mIncarnation = -1;
+   mThreatGeneration = 0;
+   mEdgeGeneration = 0;
+   mStats.clear();
+}
+
+GraphPathCache::~GraphPathCache()
+{
+   delete [] mEntries;
+}
+
+void GraphPathCache::flush()
+{
+   if (mCapacity != smSize)
+   {
+      delete [] mEntries;
+      mCapacity = getMax(smSize, 0);
+      mEntries = (mCapacity ? new Entry[mCapacity] : NULL);
+
+      // Buckets a power of two, at least twice the entries-
+      S32   numBuckets = 16;
+      while (numBuckets < mCapacity * 2)
+         numBuckets <<= 1;
+      mBuckets.setSize(numBuckets);
+   }
+
+   for (S32 i = 0; i < mBuckets.size(); i++)
+      mBuckets[i] = -1;
+   for (S32 j = 0; j < mUsed; j++)
+      mEntries[j].mPath.clear();
+   mUsed = 0;
+   mHead = mTail = -1;
+}
+
+// Everything goes when the graph, its threats or its edges have changed.
+void GraphPathCache::checkState()
+{
+   S32   incarnation = gNavGraph->incarnation();
+   U32   threatGeneration = gNavGraph->threats()->generation();
+   U32   edgeGeneration = gNavGraph->edgeGeneration();
+
+   if (incarnation != mIncarnation || threatGeneration != mThreatGeneration ||
+            edgeGeneration != mEdgeGeneration || mCapacity != smSize)
+   {
+      if (mUsed)
+         mStats.flushes++;
+      flush();
+      mIncarnation = incarnation;
+      mThreatGeneration = threatGeneration;
+      mEdgeGeneration = edgeGeneration;
+   }
+}
+
+S32 GraphPathCache::find(const Key& key) const
+{
+   if (mBuckets.size())
+      for (S32 i = mBuckets[key.hash() & (mBuckets.size() - 1)]; i >= 0; i = mEntries[i].mChain)
+         if (mEntries[i].mKey == key)
+            return i;
+   return -1;
+}
+
+void GraphPathCache::unlink(S32 entry)
+{
+   Entry &  E = mEntries[entry];
+   if (E.mPrev >= 0)
+      mEntries[E.mPrev].mNext = E.mNext;
+   else
+      mHead = E.mNext;
+   if (E.mNext >= 0)
+      mEntries[E.mNext].mPrev = E.mPrev;
+   else
+      mTail = E.mPrev;
+}
+
+void GraphPathCache::linkAtHead(S32 entry)
+{
+   Entry &  E = mEntries[entry];
+   E.mPrev = -1;
+   E.mNext = mHead;
+   if (mHead >= 0)
+      mEntries[mHead].mPrev = entry;
+   else
+      mTail = entry;
+   mHead = entry;
+}
+
+void GraphPathCache::unchain(S32 entry)
+{
+   S32 *    link = &mBuckets[mEntries[entry].mKey.hash() & (mBuckets.size() - 1)];
+   while (* link != entry)
+      link = &mEntries[* link].mChain;
+   * link = mEntries[entry].mChain;
+}
+
+//-------------------------------------------------------------------------------------
+
+// Path searches check this to know if they can skip the path queue.
+bool GraphPathCache::contains(const Key& key)
+{
+   checkState();
+   return find(key) >= 0;
+}
+
+// The path goes into the list with the transients on the ends.  It's only good if the
+// transients hook to its ends, and the bots aren't avoiding any node on it.
+bool GraphPathCache::lookup(const Key& key, const TransientNode& src, const TransientNode& dst,
+                  Vector<S32>& path, F32& dist)
+{
+   checkState();
+   if (!mCapacity)
+      return false;
+
+   mStats.lookups++;
+   S32   entry = find(key);
+   if (entry < 0)
+      return false;
+
+   const Entry &  E = mEntries[entry];
+   const GraphEdge * first = src.getEdgeTo(E.mPath.first());
+   const GraphEdge * last = dst.getEdgeTo(E.mPath.last());
+   bool  Ok = (first && last);
+
+   U32   curTime = Sim::getCurrentTime();
+   for (S32 i = 0; i < E.mPath.size() && Ok; i++)
+      if ((gNavGraph->lookupNode(E.mPath[i])->avoidUntil() - curTime) < GraphMaxNodeAvoidMS)
+         Ok = false;
+
+   if (!Ok) {
+      mStats.rejected++;
+      return false;
+   }
+
+   path.setSize(E.mPath.size() + 2);
+   path.first() = src.getIndex();
+   dMemcpy(&path[1], E.mPath.address(), E.mPath.memSize());
+   path.last() = dst.getIndex();
+   dist = first->mDist + E.mDist + last->mDist;
+
+   unlink(entry);
+   linkAtHead(entry);
+   mStats.hits++;
+   return true;
+}
+
+// Keep the graph nodes between the two transients of a path that was just found.
+void GraphPathCache::store(const Key& key, const Vector<S32>& path)
+{
+   checkState();
+   if (!mCapacity || path.size() < 3)
+      return;
+
+   S32   numNodes = gNavGraph->numNodes();
+   for (S32 i = 1; i < path.size() - 1; i++)
+      if (path[i] >= numNodes)
+         return;
+
+   S32   entry = find(key);
+   if (entry >= 0) {
+      unlink(entry);
+   }
+   else {
+      if (mUsed < mCapacity)
+         entry = mUsed++;
+      else {
+         entry = mTail;
+         unlink(entry);
+         unchain(entry);
+         mStats.evicted++;
+      }
+      S32 &    bucket = mBuckets[key.hash() & (mBuckets.size() - 1)];
+      mEntries[entry].mKey = key;
+      mEntries[entry].mChain = bucket;
+      bucket = entry;
+   }
+
+   Entry &  E = mEntries[entry];
+   E.mPath.setSize(path.size() - 2);
+   dMemcpy(E.mPath.address(), &path[1], E.mPath.memSize());
+   E.mDist = 0;
+   for (S32 j = 0; j < E.mPath.size() - 1; j++)
+      if (const GraphEdge * edge = gNavGraph->lookupNode(E.mPath[j])->getEdgeTo(E.mPath[j + 1]))
+         E.mDist += edge->mDist;
+
+   linkAtHead(entry);
+   mStats.stored++;
+}
+
+void GraphPathCache::dumpStats(bool reset)
+{
+   U32   lookups = getMax(mStats.lookups, U32(1));
+   Con::printf("Path cache: %d of %d paths", mUsed, mCapacity);
+   Con::printf("   lookups: %d, hits: %d (%.1f%%), rejected: %d", mStats.lookups,
+               mStats.hits, 100.0f * mStats.hits / lookups, mStats.rejected);
+   Con::printf("   stored: %d, evicted: %d, flushes: %d", mStats.stored, mStats.evicted,
+               mStats.flushes);
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(navPathCacheStats, void, 1, 2, "navPathCacheStats(<reset>);")
+{
+   if (!NavigationGraph::gotOneWeCanUse()) {
+      Con::printf("navPathCacheStats: no graph");
+      return;
+   }
+   gNavGraph->pathCache().dumpStats(argc > 1 && dAtob(argv[1]));
+}
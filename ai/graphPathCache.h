@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GRAPHPATHCACHE_H_
+#define _GRAPHPATHCACHE_H_
+
+//-------------------------------------------------------------------------------------
+// Paths bots have found, shared by all bots.
+//
+// Bots on a team mostly run between the same flags, generators and stations, so the
+// searches repeat.  Paths are kept by the nodes closest to the two ends, the team and
+// the jet ratings, as the graph nodes between the two transients.  A bot that finds
+// one hooks its own transients onto the ends, which they must connect to.
+//
+// All of it is thrown out when the threats change, or the edges do (force fields
+// going up or down), or the graph is remade.  Least recently used paths go first
+// when it's full.
+
+class GraphPathCache
+{
+   public:
+      static S32  smSize;
+
+      struct Key
+      {
+         S32      mSrc, mDst;
+         U32      mTeam;
+         F32      mRatings[2];
+         bool     operator==(const Key& key) const;
+         U32      hash() const;
+      };
+
+   protected:
+      struct Entry
+      {
+         Key            mKey;
+         Vector<S32>    mPath;
+         F32            mDist;         // between the two ends of mPath
+         S32            mPrev, mNext;  // LRU order, mHead is the most recent
+         S32            mChain;        // next in the bucket
+      };
+
+      Entry *           mEntries;      // (entries own vectors, so new[]'d)
+      S32               mCapacity;
+      S32               mUsed;
+      Vector<S32>       mBuckets;
+      S32               mHead, mTail;
+      S32               mIncarnation;
+      U32               mThreatGeneration;
+      U32               mEdgeGeneration;
+
+      struct Stats {
+         U32   lookups;
+         U32   hits;
+         U32   rejected;
+         U32   stored;
+         U32   evicted;
+         U32   flushes;
+         void  clear() { dMemset(this, 0, sizeof(*this)); }
+      } mStats;
+
+      void     checkState();
+      S32      find(const Key& key) const;
+      void     unlink(S32 entry);
+      void     linkAtHead(S32 entry);
+      void     unchain(S32 entry);
+
+   public:
+      GraphPathCache();
+      ~GraphPathCache();
+
+      void     flush();
+      bool     contains(const Key& key);
+      bool     lookup(const Key& key, const TransientNode& src, const TransientNode& dst,
+                           Vector<S32>& path, F32& dist);
+      void     store(const Key& key, const Vector<S32>& path);
+      void     dumpStats(bool reset);
+};
+
+#endif
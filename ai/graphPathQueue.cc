@@ -0,0 +1,499 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/graph.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "platform/profiler.h"
+
+S32               GraphPathQueue::smThreadCount = 2;
+GraphPathQueue    gPathQueue;
+
+//-------------------------------------------------------------------------------------
+//                   Snapshots
+
+GraphEdgeSnapshot::GraphEdgeSnapshot()
+{
+   mRefCount = 0;
+   mIncarnation = -1;
+   mGeneration = 0;
+   mNumNodes = 0;
+   mNumClusters = 0;
+}
+
+void GraphEdgeSnapshot::build()
+{
+   mIncarnation = gNavGraph->incarnation();
+   mGeneration = gNavGraph->edgeGeneration();
+   mNumNodes = gNavGraph->numNodes();
+
+   mLocs.setSize(mNumNodes);
+   mFirstEdge.setSize(mNumNodes + 1);
+   mEdges.clear();
+   for (S32 i = 0; i < mNumNodes; i++)
+   {
+      GraphNode * node = gNavGraph->lookupNode(i);
+      mLocs[i] = node->location();
+      mFirstEdge[i] = mEdges.size();
+
+      GraphEdgeArray edgeList = node->getEdges(NULL);
+      while (GraphEdge * edge = edgeList++)
+         mEdges.push(* edge);
+   }
+   mFirstEdge[mNumNodes] = mEdges.size();
+
+   GraphHierarchy & hierarchy = gNavGraph->hierarchy();
+   if (hierarchy.valid()) {
+      mClusterOf.setSize(mNumNodes);
+      dMemcpy(mClusterOf.address(), hierarchy.clusterList(), mNumNodes * sizeof(S16));
+      mNumClusters = hierarchy.numClusters();
+   }
+   else {
+      mClusterOf.clear();
+      mNumClusters = 0;
+   }
+}
+
+GraphNodeSnapshot::GraphNodeSnapshot()
+{
+   mRefCount = 0;
+   mIncarnation = -1;
+   mGeneration = 0;
+}
+
+void GraphNodeSnapshot::build()
+{
+   mIncarnation = gNavGraph->incarnation();
+   mGeneration = gNavGraph->nodeGeneration();
+
+   S32   numNodes = gNavGraph->numNodes();
+   mAvoidUntil.setSize(numNodes);
+   mStuckAvoid.setSize(numNodes);
+   mThreats.setSize(numNodes);
+   for (S32 i = 0; i < numNodes; i++)
+   {
+      GraphNode * node = gNavGraph->lookupNode(i);
+      mAvoidUntil[i] = node->avoidUntil();
+      mStuckAvoid[i] = node->stuckAvoid();
+      mThreats[i] = node->threats();
+   }
+}
+
+GraphPathRequest::GraphPathRequest()
+{
+   mEdgeSnap = NULL;
+   mNodeSnap = NULL;
+   mIncarnation = -1;
+   mNumNodesAll = 0;
+   mTeam = 0;
+   mThreatSet = 0;
+   mRatings[0] = mRatings[1] = 0.0f;
+   mHaveRatings = false;
+   mSimTime = 0;
+   mSubmitMS = 0;
+   mStatus = Pending;
+   mAbandoned = false;
+   mFound = false;
+   mSearchDist = 0.0f;
+   mIterations = 0;
+   mCorridorIterations = 0;
+   mCorridorFound = false;
+   mSearchMS = 0;
+}
+
+//-------------------------------------------------------------------------------------
+//                   Worker Threads
+
+class GraphPathThread : public Thread
+{
+      GraphPathQueue *     mQueue;
+      S32                  mIndex;
+      GraphSnapshotSearch  mSearcher;
+
+   public:
+      GraphPathThread(GraphPathQueue * queue, S32 index) : Thread(0, index, false)
+      {
+         mQueue = queue;
+         mIndex = index;
+         start();
+      }
+
+      void run(S32)
+      {
+         if (gProfiler) {
+            char name[32];
+            dSprintf(name, sizeof(name), "Path %d", mIndex);
+            gProfiler->setThreadName(name);
+         }
+         mQueue->runRequests(mSearcher);
+      }
+};
+
+GraphPathQueue::GraphPathQueue()
+{
+   mNumThreads = 0;
+   mMutex = NULL;
+   mWakeSemaphore = NULL;
+   mStopping = false;
+   mEdgeSnap = NULL;
+   mNodeSnap = NULL;
+   mStats.clear();
+}
+
+GraphPathQueue::~GraphPathQueue()
+{
+   stopThreads();
+   if (mEdgeSnap && --mEdgeSnap->mRefCount == 0)
+      delete mEdgeSnap;
+   if (mNodeSnap && --mNodeSnap->mRefCount == 0)
+      delete mNodeSnap;
+}
+
+void GraphPathQueue::startThreads(U32 count)
+{
+   stopThreads();
+   count = getMin(count, U32(MaxThreads));
+   if (!count)
+      return;
+
+   mMutex = Mutex::createMutex();
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mStopping = false;
+   for (U32 i = 0; i < count; i++)
+      mThreads[mNumThreads++] = new GraphPathThread(this, i);
+}
+
+// Requests still waiting are searched here, so any path that has one gets its answer.
+void GraphPathQueue::stopThreads()
+{
+   if (!mNumThreads)
+      return;
+
+   mStopping = true;
+   U32   i;
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+   for (i = 0; i < mNumThreads; i++) {
+      mThreads[i]->join();
+      delete mThreads[i];
+   }
+   mNumThreads = 0;
+
+   Mutex::destroyMutex(mMutex);
+   Semaphore::destroySemaphore(mWakeSemaphore);
+   mMutex = NULL;
+   mWakeSemaphore = NULL;
+
+   if (mPending.size()) {
+      GraphSnapshotSearch  searcher;
+      for (i = 0; i < mPending.size(); i++) {
+         searcher.performSearch(* mPending[i]);
+         mPending[i]->mStatus = GraphPathRequest::Done;
+      }
+      mPending.clear();
+   }
+   freeAbandoned();
+}
+
+// Threads are (re)started here when the preference changes.  Zero threads means
+// paths are searched in place, as they always were.
+bool GraphPathQueue::active()
+{
+   U32   want = U32(mClamp(smThreadCount, 0, MaxThreads));
+   if (want != mNumThreads)
+      startThreads(want);
+   return (mNumThreads != 0);
+}
+
+//-------------------------------------------------------------------------------------
+
+GraphPathRequest * GraphPathQueue::newRequest()
+{
+   freeAbandoned();
+
+   if (!mEdgeSnap || mEdgeSnap->mIncarnation != gNavGraph->incarnation() ||
+            mEdgeSnap->mGeneration != gNavGraph->edgeGeneration())
+   {
+      PROFILE_START(PathQueueEdgeSnapshot);
+      if (mEdgeSnap && --mEdgeSnap->mRefCount == 0)
+         delete mEdgeSnap;
+      mEdgeSnap = new GraphEdgeSnapshot;
+      mEdgeSnap->mRefCount = 1;
+      mEdgeSnap->build();
+      mStats.edgeSnaps++;
+      PROFILE_END();
+   }
+
+   if (!mNodeSnap || mNodeSnap->mIncarnation != gNavGraph->incarnation() ||
+            mNodeSnap->mGeneration != gNavGraph->nodeGeneration())
+   {
+      PROFILE_START(PathQueueNodeSnapshot);
+      if (mNodeSnap && --mNodeSnap->mRefCount == 0)
+         delete mNodeSnap;
+      mNodeSnap = new GraphNodeSnapshot;
+      mNodeSnap->mRefCount = 1;
+      mNodeSnap->build();
+      mStats.nodeSnaps++;
+      PROFILE_END();
+   }
+
+   GraphPathRequest * request = new GraphPathRequest;
+   request->mEdgeSnap = mEdgeSnap;
+   request->mNodeSnap = mNodeSnap;
+   mEdgeSnap->mRefCount++;
+   mNodeSnap->mRefCount++;
+   request->mIncarnation = gNavGraph->incarnation();
+   request->mNumNodesAll = gNavGraph->numNodesAll();
+   request->mSimTime = Sim::getCurrentTime();
+   return request;
+}
+
+void GraphPathQueue::submit(GraphPathRequest * request)
+{
+   AssertFatal(mNumThreads, "GraphPathQueue::submit: no threads");
+   request->mStatus = GraphPathRequest::Pending;
+   request->mSubmitMS = Platform::getRealMilliseconds();
+   mStats.submitted++;
+
+   Mutex::lockMutex(mMutex);
+   mPending.push_back(request);
+   mStats.maxPending = getMax(mStats.maxPending, U32(mPending.size()));
+   Mutex::unlockMutex(mMutex);
+
+   Semaphore::releaseSemaphore(mWakeSemaphore);
+}
+
+bool GraphPathQueue::isDone(const GraphPathRequest * request) const
+{
+   if (!mMutex)
+      return (request->mStatus == GraphPathRequest::Done);
+
+   Mutex::lockMutex(mMutex);
+   bool  done = (request->mStatus == GraphPathRequest::Done);
+   Mutex::unlockMutex(mMutex);
+   return done;
+}
+
+// The path is done with the request- it either took the answer or gave up on it.  A
+// request that's being searched is freed once the search is done.
+void GraphPathQueue::release(GraphPathRequest * request, bool applied)
+{
+   if (mMutex)
+   {
+      Mutex::lockMutex(mMutex);
+      if (request->mStatus == GraphPathRequest::Running) {
+         request->mAbandoned = true;
+         Mutex::unlockMutex(mMutex);
+         mStats.abandoned++;
+         return;
+      }
+      for (S32 i = 0; i < mPending.size(); i++)
+         if (mPending[i] == request) {
+            mPending.erase(i);
+            break;
+         }
+      Mutex::unlockMutex(mMutex);
+   }
+   else
+   {
+      AssertFatal(request->mStatus != GraphPathRequest::Running, "Path search left running");
+   }
+
+   if (applied) {
+      U32   waitMS = Platform::getRealMilliseconds() - request->mSubmitMS;
+      mStats.applied++;
+      mStats.searchMS += request->mSearchMS;
+      mStats.waitMS += waitMS;
+      mStats.maxWaitMS = getMax(mStats.maxWaitMS, waitMS);
+      if (!request->mFound)
+         mStats.failed++;
+   }
+   else
+      mStats.abandoned++;
+
+   freeRequest(request);
+}
+
+void GraphPathQueue::freeRequest(GraphPathRequest * request)
+{
+   if (--request->mEdgeSnap->mRefCount == 0)
+      delete request->mEdgeSnap;
+   if (--request->mNodeSnap->mRefCount == 0)
+      delete request->mNodeSnap;
+   delete request;
+}
+
+// Snapshot reference counts are only touched on the main thread, so requests that
+// finished after being abandoned are handed back here.
+void GraphPathQueue::freeAbandoned()
+{
+   Vector<GraphPathRequest*>  abandoned;
+   if (mMutex) {
+      Mutex::lockMutex(mMutex);
+      abandoned = mAbandoned;
+      mAbandoned.clear();
+      Mutex::unlockMutex(mMutex);
+   }
+   else {
+      abandoned = mAbandoned;
+      mAbandoned.clear();
+   }
+
+   for (S32 i = 0; i < abandoned.size(); i++)
+      freeRequest(abandoned[i]);
+}
+
+void GraphPathQueue::runRequests(GraphSnapshotSearch& searcher)
+{
+   while (1)
+   {
+      Semaphore::acquireSemaphore(mWakeSemaphore);
+      if (mStopping)
+         return;
+
+      // Requests abandoned while pending are gone, so there may be nothing.
+      Mutex::lockMutex(mMutex);
+      GraphPathRequest * request = NULL;
+      if (mPending.size()) {
+         request = mPending[0];
+         mPending.erase(U32(0));
+         request->mStatus = GraphPathRequest::Running;
+      }
+      Mutex::unlockMutex(mMutex);
+
+      if (!request)
+         continue;
+
+      PROFILE_START(PathQueueSearch);
+      U32   startMS = Platform::getRealMilliseconds();
+      searcher.performSearch(* request);
+      request->mSearchMS = Platform::getRealMilliseconds() - startMS;
+      PROFILE_END();
+
+      Mutex::lockMutex(mMutex);
+      request->mStatus = GraphPathRequest::Done;
+      if (request->mAbandoned)
+         mAbandoned.push_back(request);
+      Mutex::unlockMutex(mMutex);
+   }
+}
+
+//-------------------------------------------------------------------------------------
+
+void GraphPathQueue::dumpStats(bool reset)
+{
+   U32   applied = getMax(mStats.applied, U32(1));
+   Con::printf("Path queue: %d threads, %d submitted, %d applied, %d abandoned, %d failed",
+               mNumThreads, mStats.submitted, mStats.applied, mStats.abandoned,
+               mStats.failed);
+   Con::printf("   snapshots: %d edge, %d node, most pending: %d",
+               mStats.edgeSnaps, mStats.nodeSnaps, mStats.maxPending);
+   Con::printf("   per path: %.2f ms searching, %.2f ms waiting (max %d ms)",
+               F32(mStats.searchMS) / applied, F32(mStats.waitMS) / applied,
+               mStats.maxWaitMS);
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(navPathQueueStats, void, 1, 2, "navPathQueueStats(<reset>);")
+{
+   gPathQueue.dumpStats(argc > 1 && dAtob(argv[1]));
+}
+
+// Searches between random nodes on the main searcher and on a snapshot of the graph,
+// using the threat set of a random team (or none, for the plain search).  The paths
+// must cost the same, though where two routes tie the heaps can pick differently.
+ConsoleFunction(navPathQueueCompare, void, 1, 3, "navPathQueueCompare(<searches>, <plain>);")
+{
+   if (!NavigationGraph::gotOneWeCanUse() || gNavGraph->numNodes() < 2) {
+      Con::printf("navPathQueueCompare: no graph");
+      return;
+   }
+
+   S32   numSearches = (argc > 1) ? getMax(dAtoi(argv[1]), 1) : 1000;
+   bool  plain = (argc > 2 && dAtob(argv[2]));
+   S32   numNodes = gNavGraph->numNodes();
+
+   GraphPathRequest  request;
+   GraphEdgeSnapshot edgeSnap;
+   GraphNodeSnapshot nodeSnap;
+   U32   snapTime = Platform::getRealMilliseconds();
+   edgeSnap.build();
+   nodeSnap.build();
+   snapTime = Platform::getRealMilliseconds() - snapTime;
+   request.mEdgeSnap = &edgeSnap;
+   request.mNodeSnap = &nodeSnap;
+   request.mNumNodesAll = gNavGraph->numNodesAll();
+   request.mSimTime = Sim::getCurrentTime();
+
+   MRandomLCG           random(0x1234);
+   GraphSnapshotSearch  snapSearcher;
+   GraphSearch *        searcher = gNavGraph->getMainSearcher();
+   Vector<S32>          path;
+   S32   searches = 0, found = 0, mismatches = 0, sameDist = 0;
+   S32   mainIters = 0, snapIters = 0;
+   F64   mainTicks = 0, snapTicks = 0;
+   U32   timer[2];
+
+   for (S32 i = 0; i < numSearches; i++)
+   {
+      GraphNode * src = gNavGraph->lookupNode(random.randI(0, numNodes - 1));
+      GraphNode * dst = gNavGraph->lookupNode(random.randI(0, numNodes - 1));
+      if (src == dst || src->island() != dst->island())
+         continue;
+
+      U32   team = (plain ? 0 : random.randI(0, GraphMaxTeams - 1));
+      GraphThreatSet threats = (plain ? 0 : gNavGraph->getThreatSet(team));
+
+      startHighResolutionTimer(timer);
+      searcher->setAStar(true);
+      searcher->setTeam(team);
+      searcher->setThreats(threats);
+      searcher->setRandomize(true);
+      mainIters += searcher->performSearch(src, dst);
+      bool  mainFound = searcher->getPathIndices(path);
+      mainTicks += endHighResolutionTimer(timer);
+
+      request.mSrc.index = src->getIndex();
+      request.mDst.index = dst->getIndex();
+      request.mDst.loc = dst->location();
+      request.mTeam = team;
+      request.mThreatSet = threats;
+      startHighResolutionTimer(timer);
+      snapSearcher.performSearch(request);
+      snapTicks += endHighResolutionTimer(timer);
+      snapIters += request.mIterations;
+
+      searches++;
+      if (mainFound)
+         found++;
+      if (mainFound != request.mFound || path.size() != request.mPath.size() ||
+            (mainFound && searcher->searchDist() != request.mSearchDist) ||
+            dMemcmp(path.address(), request.mPath.address(), path.memSize()))
+      {
+         // A tie broken the other way still has to come out as long-
+         if (mainFound == request.mFound &&
+               mFabs(searcher->searchDist() - request.mSearchDist) <= 0.001f * request.mSearchDist)
+            sameDist++;
+         else
+            mismatches++;
+      }
+   }
+
+   F64   ticksPerUS = getMax(F64(Platform::SystemInfo.processor.mhz), 1.0);
+   S32   count = getMax(searches, 1);
+   Con::printf("navPathQueueCompare: %d %s searches, %d found, %d mismatches, %d other paths as long",
+               searches, plain ? "plain" : "team/threat", found, mismatches, sameDist);
+   Con::printf("   main searcher: %.1f us, %.1f nodes per search",
+               mainTicks / ticksPerUS / count, F32(mainIters) / count);
+   Con::printf("   snapshot:      %.1f us, %.1f nodes per search (%d ms to copy %d nodes, %d edges)",
+               snapTicks / ticksPerUS / count, F32(snapIters) / count, snapTime, numNodes,
+               edgeSnap.mEdges.size());
+}
@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GRAPHPATHQUEUE_H_
+#define _GRAPHPATHQUEUE_H_
+
+//-------------------------------------------------------------------------------------
+// Path searches off the main thread.
+//
+// Bots hand their path searches to the queue and keep following the path they have
+// until the answer comes back.  The worker threads never look at the graph, they
+// search copies of it:
+//
+// -  GraphEdgeSnapshot has the node locations and edges.  It's redone for a new
+//    incarnation, or when force fields or bridges change the edges.
+// -  GraphNodeSnapshot has the node avoidance and threat state, redone when any of
+//    that has changed since the last request.
+// -  The request carries the two transients as hooking them in would leave them,
+//    along with the edges hooking pushes onto the graph nodes they connect to.
+// -  Long searches carry the corridor the hierarchy found when they were submitted,
+//    and the edge snapshot has the cluster of each node.  The worker searches the
+//    corridor first and the whole graph if that fails, as computePath() does.
+//
+// Snapshots are shared by all requests made while they're current, so a dozen bots
+// repathing on one tick copy the graph once.  The search (GraphSnapshotSearch) is the
+// same A* computePath() runs, so the path costs what the bot would have gotten by
+// searching on the tick it asked (equal cost routes can come out either way).
+
+struct GraphEdgeSnapshot
+{
+   S32                     mRefCount;        // main thread only
+   S32                     mIncarnation;
+   U32                     mGeneration;
+   S32                     mNumNodes;        // transients follow
+   Vector<Point3F>         mLocs;
+   Vector<S32>             mFirstEdge;       // mNumNodes + 1 of them
+   GraphFlatEdges          mEdges;
+   Vector<S16>             mClusterOf;       // per node, empty with no hierarchy
+   S32                     mNumClusters;
+
+   GraphEdgeSnapshot();
+   void  build();
+};
+
+struct GraphNodeSnapshot
+{
+   S32                     mRefCount;
+   S32                     mIncarnation;
+   U32                     mGeneration;
+   Vector<U32>             mAvoidUntil;
+   Vector<U8>              mStuckAvoid;
+   Vector<GraphThreatSet>  mThreats;
+
+   GraphNodeSnapshot();
+   void  build();
+};
+
+struct GraphPathRequest
+{
+   enum Status {Pending, Running, Done};
+
+   struct Hook
+   {
+      S32                  index;
+      Point3F              loc;
+      GraphEdgeList        edges;            // hooked edges when submitted
+      U32                  avoidUntil;
+      bool                 stuckAvoid;
+      GraphThreatSet       threats;
+   };
+
+   // Search input, filled in on the main thread-
+   GraphEdgeSnapshot *     mEdgeSnap;
+   GraphNodeSnapshot *     mNodeSnap;
+   S32                     mIncarnation;
+   S32                     mNumNodesAll;
+   Hook                    mSrc, mDst;
+   Vector<S16>             mBackFrom;        // graph nodes hooking pushed an edge onto
+   Vector<GraphEdge>       mBackEdges;       //    and those edges, in push order
+   U32                     mTeam;
+   GraphThreatSet          mThreatSet;
+   F32                     mRatings[2];
+   bool                    mHaveRatings;
+   U32                     mSimTime;
+   U32                     mSubmitMS;
+   BitVector               mCorridor;        // by cluster, empty for none
+
+   // Results, valid once Done-
+   volatile Status         mStatus;
+   bool                    mAbandoned;
+   bool                    mFound;
+   Vector<S32>             mPath;
+   F32                     mSearchDist;
+   S32                     mIterations;
+   S32                     mCorridorIterations;
+   bool                    mCorridorFound;
+   U32                     mSearchMS;
+   GraphPartition          mVisited;         // for force field partitions on failure
+
+   GraphPathRequest();
+};
+
+class GraphPathThread;
+
+class GraphPathQueue
+{
+   public:
+      enum {MaxThreads = 8};
+      static S32  smThreadCount;
+
+   protected:
+      GraphPathThread *          mThreads[MaxThreads];
+      U32                        mNumThreads;
+      void *                     mMutex;
+      void *                     mWakeSemaphore;
+      volatile bool              mStopping;
+      Vector<GraphPathRequest*>  mPending;
+      Vector<GraphPathRequest*>  mAbandoned;   // finished after their path let go
+      GraphEdgeSnapshot *        mEdgeSnap;
+      GraphNodeSnapshot *        mNodeSnap;
+
+      struct Stats {
+         U32   submitted;
+         U32   applied;
+         U32   abandoned;
+         U32   failed;
+         U32   edgeSnaps;
+         U32   nodeSnaps;
+         U32   maxPending;
+         U32   searchMS;
+         U32   waitMS;
+         U32   maxWaitMS;
+         void  clear() { dMemset(this, 0, sizeof(*this)); }
+      } mStats;
+
+      void     freeRequest(GraphPathRequest* request);
+      void     freeAbandoned();
+
+   public:
+      GraphPathQueue();
+      ~GraphPathQueue();
+
+      void     startThreads(U32 count);
+      void     stopThreads();
+      bool     active();
+
+      // Main thread.  A request is released once it's Done, or to abandon it.
+      GraphPathRequest* newRequest();
+      void     submit(GraphPathRequest* request);
+      bool     isDone(const GraphPathRequest* request) const;
+      void     release(GraphPathRequest* request, bool applied);
+
+      // Worker threads-
+      void     runRequests(GraphSnapshotSearch& searcher);
+
+      void     dumpStats(bool reset);
+};
+
+extern   GraphPathQueue    gPathQueue;
+
+#endif
@@ -11,6 +11,9 @@
 #ifndef _TBINHEAP_H_
 #include "ai/tBinHeap.h"
 #endif
+#ifndef _TQUADHEAP_H_
+#include "ai/tQuadHeap.h"
+#endif
 
 #define  SearchFailureThresh  1e17
 #define  SearchFailureAssure  1e19
@@ -31,6 +34,10 @@ struct SearchRef
 typedef Vector<GraphQIndex>  QIndexList;
 typedef BinHeap<SearchRef>   GraphQueue;
 
+struct GraphEdgeSnapshot;
+struct GraphNodeSnapshot;
+struct GraphPathRequest;
+
 class GraphSearch                   // graphDijkstra.cc
 {
       GraphQueue  &  mQueue;
@@ -50,6 +57,8 @@ class GraphSearch                   // graphDijkstra.cc
       U32            mCurrentSimTime;
       U32            mTeam, mInformTeam;
       const F32   *  mInformRatings, * mJetRatings;
+      const BitVector * mInformCorridor, * mCorridor;
+      const S16   *  mClusterOf;
       GraphThreatSet mThreatSet, mInformThreats;
       GraphEdge      mEdgeBuffer[MaxOnDemandEdges];
       bool           mVisitOnExtract, mVisitOnRelax;
@@ -89,6 +98,7 @@ class GraphSearch                   // graphDijkstra.cc
       void        setThreats(GraphThreatSet T)           {mInformThreats = T;}
       void        setRatings(const F32* r)               {mInformRatings = r;}
       void        setTeam(U32 team)                      {mInformTeam = team;}
+      void        setCorridor(const BitVector* c)        {mInformCorridor = c;}
       const       GraphPartition& getPartition() const   {return mPartition;}
       bool        inProgress() const                     {return mInProgress;}
       F32         searchDist() const                     {return mSearchDist;}
@@ -108,6 +118,91 @@ class GraphSearch                   // graphDijkstra.cc
       };
 };
 
+// Edges laid out flat for the searcher, each field in an array of its own, so the
+// relax loop reads only what it needs.  The time is the edge's dist * inverse speed.
+// The whole edge is kept for the jet check, which few edges need.
+struct GraphFlatEdges
+{
+   enum {Jetting = BIT(0)};
+
+   Vector<S16>             mDest;
+   Vector<F32>             mDist;
+   Vector<F32>             mTime;
+   Vector<U8>              mTeam;
+   Vector<U8>              mFlags;
+   Vector<GraphEdge>       mEdges;
+
+   void  clear();
+   void  push(const GraphEdge& edge);
+   S32   size() const      {return mDest.size();}
+};
+
+// A run of edges out of one node, see GraphSnapshotSearch::getEdges().
+struct GraphEdgeRun
+{
+   const S16 *             dest;
+   const F32 *             dist;
+   const F32 *             time;
+   const U8 *              team;
+   const U8 *              flags;
+   const GraphEdge *       edges;
+   S32                     count;
+
+   void  set(const GraphFlatEdges& flat, S32 first, S32 num);
+};
+
+// The path searcher's A* run on a worker thread, against a copy of the graph and 
+// the transients handed over with a path request (see graphPathQueue.h).  Has its 
+// own lists, and must cost edges the same as GraphSearch::runDijkstra() so the paths 
+// come out as good.  The edges are read from the flat arrays of the snapshot, and 
+// the queue is a 4-ary heap of node indices, with what goes with each node kept in 
+// mNodes.  The loop is a template on whether there are threats to avoid and team or 
+// jetting rules to check, so plain searches don't pay for them.  A request with a
+// corridor is searched inside it first, then on the whole graph if that fails.  
+class GraphSnapshotSearch                       // graphDijkstra.cc
+{
+      struct NodeState {
+         U32         stamp;                     // search it was reached on
+         F32         dist;
+         F32         time;
+         F32         heuristic;
+         S16         prev;
+         bool        closed;
+      };
+      QuadHeap<F32>  mQueue;
+      Vector<NodeState> mNodes;
+      U32            mStamp;
+      GraphPartition mPartition;
+      struct Span    {S32 first, count;};
+      Vector<S32>    mJoined;                   // per node, into mSpans, or -1
+      Vector<Span>   mSpans;                    // into mJoinedEdges
+      Span           mHooks[2];                 //    as are the transients' edges
+      GraphFlatEdges mJoinedEdges;              // graph edges + edges back to transients
+      
+      const GraphEdgeSnapshot *  mEdgeSnap;
+      const GraphNodeSnapshot *  mNodeSnap;
+      GraphPathRequest  *        mRequest;
+      const BitVector *          mCorridor;     // for this pass, or NULL
+      const S16 *                mClusterOf;
+      Point3F        mTargetLoc;
+      S32            mIterations;
+      bool           mRandomize;
+
+      void           resetNodes(S32 numNodesAll);
+      void           joinEdges();
+      void           unjoinEdges();
+      void           getEdges(S32 node, GraphEdgeRun& run) const;
+      S32            getAvoidFactor(S32 node);
+      bool           nodeThreatened(S32 node) const;
+      const Point3F& nodeLoc(S32 node) const;
+      template <bool Threats, bool Rules> 
+      void           search(S32 source, S32 target);
+      
+   public:
+      GraphSnapshotSearch();
+      void        performSearch(GraphPathRequest& request);
+};
+
 class GraphSearchLOS : public GraphSearch       // graphSearchLOS.cc
 {
       typedef GraphSearch Parent;
@@ -0,0 +1,155 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ai/graphThreadPool.h"
+#include "console/console.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "platform/profiler.h"
+#include "sim/sceneObject.h"
+
+S32   GraphThreadPool::smThreadCount = 4;
+
+//-------------------------------------------------------------------------------------
+
+class GraphPoolThread : public Thread
+{
+      GraphThreadPool *          mPool;
+      ContainerQueryContext *    mContext;
+      S32                        mWorker;
+
+   public:
+      GraphPoolThread(GraphThreadPool * pool, ContainerQueryContext * context, S32 worker)
+         :  Thread(0, worker, false)
+      {
+         mPool = pool;
+         mContext = context;
+         mWorker = worker;
+         start();
+      }
+      ~GraphPoolThread()
+      {
+         delete mContext;
+      }
+
+      void run(S32)
+      {
+         if (gProfiler) {
+            char name[32];
+            dSprintf(name, sizeof(name), "Graph build %d", mWorker);
+            gProfiler->setThreadName(name);
+         }
+         ContainerQueryContext::Scope scope(mContext);
+         mPool->runThread(mWorker);
+      }
+};
+
+//-------------------------------------------------------------------------------------
+
+GraphThreadPool::GraphThreadPool()
+{
+   mStopping = false;
+   mStarted = false;
+   mFunc = NULL;
+   mData = NULL;
+   mNumJobs = mNextJob = mBusy = 0;
+   mMutex = Mutex::createMutex();
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mDoneSemaphore = Semaphore::createSemaphore(0);
+
+   // Each thread needs a container context, there may not be as many as we want-
+   S32   want = mClamp(smThreadCount, 0, MaxThreads);
+   for (mNumThreads = 0; mNumThreads < want; mNumThreads++) {
+      ContainerQueryContext * context = ContainerQueryContext::create();
+      if (!context)
+         break;
+      mThreads[mNumThreads] = new GraphPoolThread(this, context, mNumThreads + 1);
+   }
+}
+
+GraphThreadPool::~GraphThreadPool()
+{
+   finish();
+
+   mStopping = true;
+   S32   i;
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+   for (i = 0; i < mNumThreads; i++) {
+      mThreads[i]->join();
+      delete mThreads[i];
+   }
+   Mutex::destroyMutex(mMutex);
+   Semaphore::destroySemaphore(mWakeSemaphore);
+   Semaphore::destroySemaphore(mDoneSemaphore);
+}
+
+//-------------------------------------------------------------------------------------
+
+// The threads start taking jobs right away, the main thread joins in at finish().
+void GraphThreadPool::start(JobFunc func, void * data, S32 numJobs)
+{
+   AssertFatal(!mStarted, "GraphThreadPool::start: already running");
+   mFunc = func;
+   mData = data;
+   mNumJobs = numJobs;
+   mNextJob = 0;
+   mBusy = mNumThreads;
+   mStarted = true;
+   for (S32 i = 0; i < mNumThreads; i++)
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+}
+
+// Returns once every job has been run.
+void GraphThreadPool::finish()
+{
+   if (!mStarted)
+      return;
+   runJobs(0);
+   if (mNumThreads)
+      Semaphore::acquireSemaphore(mDoneSemaphore);
+   mStarted = false;
+}
+
+void GraphThreadPool::run(JobFunc func, void * data, S32 numJobs)
+{
+   start(func, data, numJobs);
+   finish();
+}
+
+void GraphThreadPool::runJobs(S32 worker)
+{
+   for (;;)
+   {
+      Mutex::lockMutex(mMutex);
+      S32   job = (mNextJob < mNumJobs ? mNextJob++ : -1);
+      Mutex::unlockMutex(mMutex);
+      if (job < 0)
+         break;
+      (* mFunc)(mData, job, worker);
+   }
+}
+
+// Each wake-up is one thread's share of a start(), the last one done lets finish() go.
+void GraphThreadPool::runThread(S32 worker)
+{
+   for (;;)
+   {
+      Semaphore::acquireSemaphore(mWakeSemaphore);
+      if (mStopping)
+         return;
+
+      runJobs(worker);
+
+      Mutex::lockMutex(mMutex);
+      bool  last = (--mBusy == 0);
+      Mutex::unlockMutex(mMutex);
+      if (last)
+         Semaphore::releaseSemaphore(mDoneSemaphore);
+   }
+}
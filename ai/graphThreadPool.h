@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GRAPHTHREADPOOL_H_
+#define _GRAPHTHREADPOOL_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+//-------------------------------------------------------------------------------------
+// Worker threads for the graph build stages.
+//
+// A stage hands the pool a job function and a job count, and the jobs are taken in
+// order by the threads and by the main thread once it calls finish().  The worker
+// index passed to a job is 0 for the main thread, so a stage can keep per-worker
+// scratch in an array of numWorkers().  Each thread has its own container context
+// for its ray casts and poly lists, and there may be fewer threads than asked for
+// if the contexts run out.  With no threads the jobs all run in finish().
+//
+// The main thread is free between start() and finish() to do work of its own that
+// has to stay there, such as anything which calls into script.
+
+class GraphPoolThread;
+
+class GraphThreadPool
+{
+   public:
+      enum {MaxThreads = 7};
+      typedef void (*JobFunc)(void * data, S32 job, S32 worker);
+      static S32  smThreadCount;
+
+   protected:
+      GraphPoolThread *    mThreads[MaxThreads];
+      S32                  mNumThreads;
+      void *               mMutex;
+      void *               mWakeSemaphore;
+      void *               mDoneSemaphore;
+      volatile bool        mStopping;
+      bool                 mStarted;
+      JobFunc              mFunc;
+      void *               mData;
+      S32                  mNumJobs;
+      S32                  mNextJob;
+      S32                  mBusy;
+
+      void  runJobs(S32 worker);
+
+   public:
+      GraphThreadPool();
+      ~GraphThreadPool();
+
+      S32   numWorkers() const      {return mNumThreads + 1;}
+      void  start(JobFunc func, void * data, S32 numJobs);
+      void  finish();
+      void  run(JobFunc func, void * data, S32 numJobs);
+
+      // Worker threads-
+      void  runThread(S32 worker);
+};
+
+#endif
@@ -40,6 +40,7 @@ void SearchThreat::updateNodes()
    GraphThreatSet             threatSetOff = ~(threatSetOn <<= mSlot);
    S32                        count = mEffects.size(); 
 
+   gNavGraph->nodesChanged();
    if (mActive)
       while( --count >= 0 )
          (* n++)->threats() |= threatSetOn;
@@ -76,6 +77,7 @@ SearchThreats::SearchThreats()
    mThreats[0].mActive = false;
    
    mSaveTimeMS = Sim::getCurrentTime();
+   mGeneration = 0;
 }
 
 // Inform all other teams of this threat's active status (update their care-about set).
@@ -120,6 +122,7 @@ bool SearchThreats::add(const SearchThreat& threat)
       informOtherTeams(threat.mTeam, mThreats[X].mSlot = X, true);
       mThreats[X].mEffects = gNavGraph->getVisibleNodes(threat.center, threat.radius);
       mThreats[X].updateNodes();
+      mGeneration++;
       return true;
    }
    return false;
@@ -167,6 +170,7 @@ bool SearchThreats::checkOne()
       
          if (mThreats[mCheck].checkEnableChange()) {
             canCheckMore = false;
+            mGeneration++;
             informOtherTeams(mThreats[mCheck].mTeam, mCheck, mThreats[mCheck].mActive);
          }
       }
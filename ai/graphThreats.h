@@ -39,6 +39,7 @@ class SearchThreats
       GraphThreatSet mTeamCaresAbout[GraphMaxTeams];
       S32            mCheck, mCount;
       U32            mSaveTimeMS;
+      U32            mGeneration;
       
    public:
       SearchThreats();
@@ -51,6 +52,7 @@ class SearchThreats
       bool           sanction(const Point3F& from, const Point3F& to, S32 team) const;
       void           monitorThreats();
       S32            numThreats() const         {return mCount;}
+      U32            generation() const         {return mGeneration;}
 };
 
 #endif
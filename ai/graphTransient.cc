@@ -237,6 +237,93 @@ void NavigationGraph::popTransientPair(TransientNode& srcNode, TransientNode& ds
    unhookTransient(dstNode);
 }
 
+//-------------------------------------------------------------------------------------
+// The path queue searches a copy of the graph, so instead of hooking the transients 
+// in we record what hooking would do (same order as above- destination first).  
+
+S32 NavigationGraph::captureTransient(const TransientNode& transient, 
+         const GraphNode* other, S32 otherIsland, GraphPathRequest::Hook& hook, GraphPathRequest& request, const GraphNode*& firstHook)
+{
+   S32            retIsland = -7;
+   S32            thisIndex = transient.getIndex();
+   GraphEdgeArray edgeList = transient.getHookedEdges();
+   
+   hook.index = thisIndex;
+   hook.loc = transient.mLoc;
+   hook.avoidUntil = transient.mAvoidUntil;
+   hook.stuckAvoid = transient.stuckAvoid();
+   hook.threats = transient.mThreats;
+   hook.edges.clear();
+   firstHook = NULL;
+   
+   while (GraphEdge * edge = edgeList++) 
+   {
+      GraphNode * hookTo = lookupNode(edge->mDest);
+      
+      // Hooking the destination first will have given it an island.  
+      S32         hookIsland = (hookTo == other ? otherIsland : hookTo->mIsland);
+      
+      if((retIsland != -7) && (hookIsland != retIsland))
+         mayBeFineButTrapIt();
+      else
+         retIsland = hookIsland;
+
+      if (!firstHook && !hookTo->transient())
+         firstHook = hookTo;
+
+      // Edges pushed onto transients aren't searched (they use their search edges).
+      if (!hookTo->transient())
+      {
+         GraphEdge   edgeBack;
+         edgeBack.mDest = thisIndex;
+         edgeBack.mDist = (hookTo->mLoc - transient.mLoc).len();
+         if (edge->isBorder())
+            edgeBack.mBorder = (edge->mBorder ^ 1);
+         if (edge->isJetting())
+            edgeBack.setJetting();
+         if (edge->getTeam())
+            edgeBack.setTeam(edge->getTeam());
+         request.mBackFrom.push_back(edge->mDest);
+         request.mBackEdges.push_back(edgeBack);
+      }
+      hook.edges.push_back(*edge);
+   }
+   
+   return retIsland;
+}
+
+// Same answer as pushTransientPair(), without touching the graph.  
+bool NavigationGraph::captureTransientPair(const TransientNode& srcNode, 
+         const TransientNode& dstNode, U32 team, const JetManager::ID& jetCaps, 
+         GraphPathRequest& request)
+{
+   const GraphNode * srcHook, * dstHook;
+   
+   request.mBackFrom.clear();
+   request.mBackEdges.clear();
+   S32   island0 = captureTransient(dstNode, NULL, 0, request.mDst, request, dstHook);
+   S32   island1 = captureTransient(srcNode, &dstNode, island0, request.mSrc, request, srcHook);
+   
+   if (island0 == island1 && island0 >= 0)
+   {
+      S32   srcInd = srcHook->getIndex();
+      S32   dstInd = dstHook->getIndex();
+      
+      GraphPartition::Answer  answer;
+      
+      #if _GRAPH_PART_
+      answer = mJetManager.reachable(jetCaps, srcInd, dstInd);
+      if (answer == GraphPartition::CanReach)
+      #endif
+      {
+         answer = mForceFields.reachable(team, srcInd, dstInd);
+         if (answer == GraphPartition::CanReach || answer == GraphPartition::Ambiguous)
+            return true;
+      }
+   }
+   return false;
+}
+
 //-------------------------------------------------------------------------------------
 
 bool NavigationGraph::canReachLoc(const FindGraphNode& src, const FindGraphNode& dst, 
@@ -26,6 +26,7 @@ class TransientNode : public RegularNode
       void     setLoc(const Point3F& loc)             {mLoc = loc;}
       void     setEdges(const GraphEdgeList& edges)   {mEdges=edges;}
       void     setClosest(const GraphNode* closest)   {mClosest=closest;}
+      const GraphNode* getClosest() const             {return mClosest;}
       Point3F  getRenderPos() const;
       S32      volumeIndex() const;
 };
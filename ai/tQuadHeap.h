@@ -0,0 +1,149 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TQUADHEAP_H_
+#define _TQUADHEAP_H_
+
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+//
+// Indexed 4-ary min heap of small items (node indices) on a key.
+//
+// Unlike BinHeap the entries are just the key and the item, with whatever else goes
+// with the item kept by the user in its own arrays.  With four children per parent
+// the heap is half as deep, and the children sit together in memory, so removeHead()
+// looks at one run of entries per level.  Items must be in [0, setItems()).
+//
+#define  QuadHeapParent(child)         (((child) - 1) >> 2)
+#define  QuadHeapFirst(parent)         (((parent) << 2) + 1)
+
+template <class K>
+class QuadHeap
+{
+   protected:
+      struct Entry {
+         K     key;
+         S32   item;
+      };
+      Vector<Entry>     mHeap;
+      Vector<S32>       mPos;          // heap index per item, valid while it's in
+
+      void     siftUp(S32 pos, Entry entry);
+      void     siftDown(S32 pos, Entry entry);
+
+   public:
+      void     setItems(S32 numItems)     {mPos.setSize(numItems);}
+      void     reserve(S32 amount)        {mHeap.reserve(amount);}
+      void     clear()                    {mHeap.clear();}
+      bool     empty() const              {return mHeap.empty();}
+      S32      count() const              {return mHeap.size();}
+      S32      head() const               {return mHeap[0].item;}
+      K        headKey() const            {return mHeap[0].key;}
+      K        keyOf(S32 item) const      {return mHeap[mPos[item]].key;}
+
+      void     insert(S32 item, K key);
+      void     improveKey(S32 item, K key);
+      S32      removeHead();
+      bool     validate();
+};
+
+//--------------------------------------------------------------------------------
+
+template <class K>
+inline void QuadHeap<K>::siftUp(S32 pos, Entry entry)
+{
+   Entry *  heap = mHeap.address();
+   S32   *  back = mPos.address();
+   while (pos > 0)
+   {
+      S32   parent = QuadHeapParent(pos);
+      if (!(entry.key < heap[parent].key))
+         break;
+      heap[pos] = heap[parent];
+      back[heap[pos].item] = pos;
+      pos = parent;
+   }
+   heap[pos] = entry;
+   back[entry.item] = pos;
+}
+
+template <class K>
+inline void QuadHeap<K>::siftDown(S32 pos, Entry entry)
+{
+   Entry *  heap = mHeap.address();
+   S32   *  back = mPos.address();
+   S32      count = mHeap.size();
+
+   for (S32 first; (first = QuadHeapFirst(pos)) < count; )
+   {
+      // Smallest of the (up to) four children-
+      S32   last = getMin(first + 4, count);
+      S32   best = first;
+      for (S32 c = first + 1; c < last; c++)
+         if (heap[c].key < heap[best].key)
+            best = c;
+
+      if (!(heap[best].key < entry.key))
+         break;
+      heap[pos] = heap[best];
+      back[heap[pos].item] = pos;
+      pos = best;
+   }
+   heap[pos] = entry;
+   back[entry.item] = pos;
+}
+
+//--------------------------------------------------------------------------------
+
+template <class K>
+inline void QuadHeap<K>::insert(S32 item, K key)
+{
+   AssertFatal(item >= 0 && item < mPos.size(), "QuadHeap::insert: item out of range");
+   Entry entry;
+   entry.key = key;
+   entry.item = item;
+   mHeap.increment();
+   siftUp(mHeap.size() - 1, entry);
+}
+
+// Key can only go down, as with relaxing an edge.
+template <class K>
+inline void QuadHeap<K>::improveKey(S32 item, K key)
+{
+   S32   pos = mPos[item];
+   AssertFatal(pos < mHeap.size() && mHeap[pos].item == item, "QuadHeap::improveKey: not in heap");
+   AssertFatal(!(mHeap[pos].key < key), "QuadHeap::improveKey: key got worse");
+   Entry entry;
+   entry.key = key;
+   entry.item = item;
+   siftUp(pos, entry);
+}
+
+template <class K>
+inline S32 QuadHeap<K>::removeHead()
+{
+   AssertFatal(!mHeap.empty(), "QuadHeap::removeHead: empty");
+   S32   item = mHeap[0].item;
+   Entry last = mHeap.last();
+   mHeap.decrement();
+   if (mHeap.size())
+      siftDown(0, last);
+   return item;
+}
+
+template <class K>
+bool QuadHeap<K>::validate()
+{
+   for (S32 i = 1; i < mHeap.size(); i++)
+      if (mHeap[i].key < mHeap[QuadHeapParent(i)].key || mPos[mHeap[i].item] != i)
+         return false;
+   return true;
+}
+
+#endif
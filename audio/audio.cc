@@ -12,6 +12,7 @@
 #include "console/consoleTypes.h"
 #include "game/gameConnection.h"
 #include "audio/audioCodec.h"
+#include "audio/voiceKernels.h"
 #include "core/fileStream.h"
 #include "audio/audioThread.h"
 
@@ -699,8 +700,6 @@ AUDIOHANDLE alxCreateSource(const AudioProfile *profile, const MatrixF *transfor
 }   
 
 //--------------------------------------------------------------------------
-extern void threadPlay(AudioBuffer * buffer, AUDIOHANDLE handle);
-
 AUDIOHANDLE alxPlay(AUDIOHANDLE handle)
 {
    U32 index = alxFindIndex(handle);
@@ -710,27 +709,15 @@ AUDIOHANDLE alxPlay(AUDIOHANDLE handle)
       // play if not already playing
       if(mHandle[index] & AUDIOHANDLE_INACTIVE_BIT)
       {
-      // jff: thread stuff
-//         // have the thread play this once the buffer is loaded
-//         if(bool(mBuffer[index]) && mBuffer[index]->isLoading())
-//         {
-//            // move loopers into the inactive list
-//            LoopingList::iterator itr = mLoopingList.findImage(handle);
-//            if(itr)
-//            {
-//               mHandle[index] = NULL_AUDIOHANDLE;
-//               mBuffer[index] = 0;
-//
-//               (*itr)->mHandle |= AUDIOHANDLE_LOADING_BIT;
-//               mLoopingInactiveList.push_back(*itr);
-//            }
-//
-//            mHandle[index] |= AUDIOHANDLE_LOADING_BIT;
-//
-//            if(gAudioThread)
-//               gAudioThread->setBufferPlayHandle(mBuffer[index], handle);
-//            return(handle);
-//         }
+#ifndef DISABLE_AUDIO_THREAD
+         // have the load thread play this once the buffer is loaded
+         if(gAudioThread && bool(mBuffer[index]) && mBuffer[index]->isLoading())
+         {
+            mHandle[index] |= AUDIOHANDLE_LOADING_BIT;
+            gAudioThread->setBufferPlayHandle(mBuffer[index], handle);
+            return(handle);
+         }
+#endif
 
          mHandle[index] &= ~(AUDIOHANDLE_INACTIVE_BIT | AUDIOHANDLE_LOADING_BIT);
 
@@ -764,7 +751,54 @@ AUDIOHANDLE alxPlay(AUDIOHANDLE handle)
    }
 
    return(handle);
-}   
+}
+
+#ifndef DISABLE_AUDIO_THREAD
+//--------------------------------------------------------------------------
+// - called by the audio thread for every handle played while its buffer was
+//   loading.  the source was bound to the buffer before it had any data, so
+//   bind it again and restore the looping/description state before playing
+void alxPlayLoaded(AUDIOHANDLE handle)
+{
+   U32 index = alxFindIndex(handle);
+
+   // stopped (or culled looper) while loading: alxPlay sorts it out
+   if(index == MAX_AUDIOSOURCES || !(mHandle[index] & AUDIOHANDLE_LOADING_BIT))
+   {
+      alxPlay(handle);
+      return;
+   }
+
+   mHandle[index] &= ~AUDIOHANDLE_LOADING_BIT;
+   if(!bool(mBuffer[index]))
+      return;
+
+   ALuint source = mSource[index];
+   alGetError();
+
+   LoopingList::iterator itr = mLoopingList.findImage(handle);
+   if(itr)
+   {
+      alxSourcePlay(source, *itr);
+      if(mEnvironmentEnabled)
+         alxSourceEnvironment(source, *itr);
+   }
+   else
+   {
+      alSourcei(source, AL_BUFFER, mBuffer[index]->getALBuffer());
+      alSourcei(source, AL_SOURCE_LOOPING, AL_FALSE);
+      alSourcef(source, AL_GAIN_LINEAR, mSourceVolume[index] * mAudioTypeVolume[mType[index]] * mMasterVolume);
+   }
+
+   alxPlay(handle);
+}
+
+bool alxIsLoading(AUDIOHANDLE handle)
+{
+   U32 index = alxFindIndex(handle);
+   return(index != MAX_AUDIOSOURCES && (mHandle[index] & AUDIOHANDLE_LOADING_BIT));
+}
+#endif
 
 //--------------------------------------------------------------------------
 // helper function.. create a source and play it
@@ -3102,6 +3136,8 @@ void init()
    // default all channels to full gain
    for(U32 i = 0; i < Audio::NumAudioTypes; i++)
       mAudioTypeVolume[i] = 1.f;
+
+   voiceInstallKernels();
       
 #ifndef DISABLE_AUDIO_THREAD
    AudioThread::create();
@@ -56,22 +56,17 @@ ResourceInstance* AudioBuffer::construct(Stream &)
 //-----------------------------------------------------------------
 ALuint AudioBuffer::getALBuffer(bool block)
 {
-// jff: block until thread is completely stable (resourcemanager is not
-// thread safe yet (though it never seems to crash there...) )
-   block = true;
-// sol: if the above "block = true" is removed, uncomment the following
-// error so that the Linux build maintainer knows to re-enable the audio
-// thread.  It's disabled at the moment as an optimization.
-//#ifdef __linux
-//#error Linux version needs to re-enable audio thread in platformLinux/audio.cc
-//#endif
-
    // clear the error state
    alGetError();
 
    if (alIsBuffer(malBuffer))
       return malBuffer;
 
+   // The load threads never touch the resource manager or the allocator,
+   // but loads only go through them when asked to.
+   if(!Con::getBoolVariable("$pref::Audio::threadedLoads", false))
+      block = true;
+
    alGenBuffers(1, &malBuffer);
    if(alGetError() != AL_NO_ERROR)
       return(AL_INVALID);
@@ -88,11 +83,10 @@ ALuint AudioBuffer::getALBuffer(bool block)
          if(readWavSuccess)
             return(malBuffer);
       }
-      else if(gAudioThread)
-      {
-         gAudioThread->loadResource(obj, this);
+      else if(gAudioThread && gAudioThread->loadResource(obj, this))
+         return(malBuffer);
+      else if(readWAV(obj))
          return(malBuffer);
-      }
    }
 
    alDeleteBuffers(1, &malBuffer);
@@ -6,6 +6,11 @@
 //-----------------------------------------------------------------------------
 
 #include "audio/audioCodec.h"
+#include "audio/voiceKernels.h"
+#include "platform/profiler.h"
+#include "console/console.h"
+#include "core/tVector.h"
+#include "math/mMathFn.h"
 //#include "audio/audioCodecGSM.h"
 
 #ifndef __linux
@@ -309,3 +314,109 @@ void VoiceDecoderStream::process(bool flush)
          break;
    }
 }
+
+//-------------------------------------------------------------------------
+// Codec benchmark:
+//-------------------------------------------------------------------------
+// Runs a fixed synthetic corpus through the resampling kernels, the C ones
+// and the ones picked for this processor, and checks both against the loops
+// the GSM codec used before the kernels went in.  libgsm isn't in the tree,
+// so the codec itself isn't part of this.
+enum {
+   VoiceBenchFrameSize = 160,    // samples per GSM frame at 4kHz
+};
+
+static void voiceBenchCorpus(S16 * corpus, U32 samples)
+{
+   // a couple of tones with some noise on top, clipped now and then so
+   // the saturated ends get exercised too
+   U32 seed = 0x1234567;
+   for(U32 i = 0; i < samples; i++)
+   {
+      seed = seed * 1664525 + 1013904223;
+      S32 tone = S32(mSin(F32(i) * 0.0785f) * 12000.f + mSin(F32(i) * 0.3141f) * 9000.f);
+      S32 noise = S32(seed >> 16) - 32768;
+      S32 samp = tone + noise / 4;
+      corpus[i] = S16(mClamp(samp, S16_MIN, S16_MAX));
+   }
+}
+
+// the per frame loops from GSMEncoderCodec/GSMDecoderCodec::process, as
+// they were
+static void voiceBenchOriginal(const S16 * corpus, S16 * down, S16 * up, U32 frames)
+{
+   for(U32 f = 0; f < frames; f++)
+   {
+      const S16 * samples = corpus + f * VoiceBenchFrameSize * 2;
+      S16 * gsmdata = down + f * VoiceBenchFrameSize;
+      for ( int i=0, j=0; i<VoiceBenchFrameSize; i += 1, j += 2 ) {
+         gsmdata[i] = ((S32)samples[j]+samples[j+1])/2;
+      }
+
+      S16 * output = up + f * VoiceBenchFrameSize * 2;
+      for ( int i=0, j=0; i<VoiceBenchFrameSize; i += 1, j += 2 ) {
+         output[j] = gsmdata[i];
+         if ( i == (VoiceBenchFrameSize-1) ) {
+            output[j+1] = gsmdata[i];
+         } else {
+            output[j+1] = ((S32)gsmdata[i]+gsmdata[i+1])/2;
+         }
+      }
+   }
+}
+
+static U32 voiceBenchKernels(const S16 * corpus, S16 * down, S16 * up, U32 frames, U32 passes)
+{
+   U32 time[2];
+   startHighResolutionTimer(time);
+   for(U32 pass = 0; pass < passes; pass++)
+      for(U32 i = 0; i < frames; i++)
+      {
+         voice_downsample2x(corpus + i * VoiceBenchFrameSize * 2, down + i * VoiceBenchFrameSize, VoiceBenchFrameSize);
+         voice_upsample2x(down + i * VoiceBenchFrameSize, up + i * VoiceBenchFrameSize * 2, VoiceBenchFrameSize);
+      }
+   return(endHighResolutionTimer(time));
+}
+
+ConsoleFunction(voiceCodecBenchmark, bool, 1, 3, "voiceCodecBenchmark(<frames>, <passes>);")
+{
+   U32 frames = argc > 1 ? getMax(dAtoi(argv[1]), 1) : 500;
+   U32 passes = argc > 2 ? getMax(dAtoi(argv[2]), 1) : 20;
+   U32 samples = frames * VoiceBenchFrameSize * 2;
+
+   // [0] is the original loops, [1] the C kernels, [2] whatever this
+   // processor gets
+   Vector<S16> corpus;
+   Vector<S16> down[3];
+   Vector<S16> up[3];
+   corpus.setSize(samples);
+   voiceBenchCorpus(corpus.address(), samples);
+
+   U32 i;
+   for(i = 0; i < 3; i++)
+   {
+      down[i].setSize(frames * VoiceBenchFrameSize);
+      up[i].setSize(samples);
+   }
+   voiceBenchOriginal(corpus.address(), down[0].address(), up[0].address(), frames);
+
+   F64 ticksPerMs = Platform::SystemInfo.processor.mhz * 1000.0;
+   if(ticksPerMs <= 0)
+      ticksPerMs = 1;
+
+   U32 ticks[3];
+   bool exact[3];
+   for(i = 1; i < 3; i++)
+   {
+      voiceInstallKernels(i == 1 ? CPU_PROP_C : 0);
+      ticks[i] = voiceBenchKernels(corpus.address(), down[i].address(), up[i].address(), frames, passes);
+      exact[i] = !dMemcmp(down[0].address(), down[i].address(), down[0].size() * sizeof(S16)) &&
+                 !dMemcmp(up[0].address(), up[i].address(), up[0].size() * sizeof(S16));
+   }
+
+   Con::printf("Voice resample: %d frames x %d passes, C: %.3f ms (%s), %s: %.3f ms (%s)",
+               frames, passes,
+               ticks[1] / ticksPerMs, exact[1] ? "bit-exact" : "MISMATCH",
+               voiceGetKernelName(), ticks[2] / ticksPerMs, exact[2] ? "bit-exact" : "MISMATCH");
+   return(exact[1] && exact[2]);
+}
@@ -12,6 +12,7 @@ extern "C"
 #include "inc/gsm.h"
 }
 #include "audio/audioCodecGSM.h"
+#include "audio/voiceKernels.h"
 
 // The number of samples encoded at once in the GSM spec
 #define GSM_FRAMESIZE		160
@@ -89,9 +90,7 @@ U32 GSMEncoderCodec::process(void * stream, BufferQueue * queue, const U8 * data
       queue->dequeue((U8*)samples, (sizeof samples));
 
       // Convert the samples to 4000 Hz
-      for ( int i=0, j=0; i<GSM_FRAMESIZE; i += 1, j += 2 ) {
-         gsmdata[i] = ((S32)samples[j]+samples[j+1])/2;
-      }
+      voice_downsample2x(samples, gsmdata, GSM_FRAMESIZE);
       gsm_encode((gsm)stream, gsmdata, frame);
 
       dMemcpy(output, frame, framesize);
@@ -179,14 +178,7 @@ U32 GSMDecoderCodec::process(void * stream, BufferQueue * queue, const U8 * data
       gsm_decode((gsm)stream, frame, gsmdata);
 
       // Convert the samples from 4000 Hz
-      for ( int i=0, j=0; i<GSM_FRAMESIZE; i += 1, j += 2 ) {
-         samples[j] = gsmdata[i];
-         if ( i == (GSM_FRAMESIZE-1) ) {
-            samples[j+1] = gsmdata[i];
-         } else {
-            samples[j+1] = ((S32)gsmdata[i]+gsmdata[i+1])/2;
-         }
-      }
+      voice_upsample2x(gsmdata, samples, GSM_FRAMESIZE);
       decoded += framesize;
       output += framesize;
       maxLen -= framesize;
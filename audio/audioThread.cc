@@ -6,171 +6,266 @@
 //-----------------------------------------------------------------------------
 
 #include "audio/audioThread.h"
+#include "audio/audioBuffer.h"
+#include "Core/resManager.h"
+#include "console/console.h"
+#include "platform/profiler.h"
+#include "audio/audioDataBlock.h"
+#include "console/simBase.h"
 
-// AudioResourceQueue: -----------------------------------------------------
-AudioResourceQueue::AudioResourceQueue()
-{
-   mHead = mTail = 0;
-}
+extern void alxPlayLoaded(AUDIOHANDLE handle);
 
-void AudioResourceQueue::enqueue(AudioResourceEntry * entry)
+// AudioLoadThread: --------------------------------------------------------
+AudioLoadThread::AudioLoadThread(S32 index) : Thread(0, index, false)
 {
-   AssertFatal(entry, "AudioResourceQueue::enqueue: invalid entry");
-   entry->mNext = 0;
-
-   if(!mHead)
-      mHead = mTail = entry;
-   else
-   {
-      mTail->mNext = entry;
-      mTail = entry;
-   }
-}
-
-AudioResourceEntry * AudioResourceQueue::dequeue()
-{
-   AudioResourceEntry * entry = mHead;
-   
-   if(mHead == mTail)
-      mHead = mTail = 0;
-   else
-      mHead = mHead->mNext;
-
-   return(entry);
-}
-
-// AudioThread: ------------------------------------------------------------
-AudioThread * gAudioThread = 0;
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mStopping = false;
+   mIndex = index;
+   mInFlight = 0;
 
-AudioThread::AudioThread() : Thread(0, 0, false)
-{
-   mStopSemaphore = Semaphore::createSemaphore(0);
-   mWakeSemaphore = Semaphore::createSemaphore();
-   mMutex = Mutex::createMutex();
-
-   // Now that the semaphores are created, start up the thread
+   // Now that the semaphore is created, start up the thread
    start();
 }
 
-AudioThread::~AudioThread()
+AudioLoadThread::~AudioLoadThread()
 {
-   Semaphore::destroySemaphore(mStopSemaphore);
    Semaphore::destroySemaphore(mWakeSemaphore);
-   Mutex::destroyMutex(mMutex);
 }
 
-void AudioThread::wake()
+void AudioLoadThread::wake()
 {
-   if(!isAlive())
-      return;
-
+   // keep the count at one at most
+   Semaphore::acquireSemaphore(mWakeSemaphore, false);
    Semaphore::releaseSemaphore(mWakeSemaphore);
 }
 
-void AudioThread::stop()
+void AudioLoadThread::stop()
 {
    if(!isAlive())
       return;
 
-   Semaphore::releaseSemaphore(mStopSemaphore);
+   mStopping = true;
    wake();
    join();
 }
 
-void AudioThread::run(S32)
+bool AudioLoadThread::request(AudioResourceEntry * entry)
 {
+   // completions can never back up as long as no more than QueueSize
+   // requests are out at a time
+   if(mInFlight == QueueSize || !mRequests.push(entry))
+      return(false);
+
+   mInFlight++;
+   wake();
+   return(true);
+}
+
+void AudioLoadThread::run(S32)
+{
+   if(gProfiler)
+   {
+      char name[32];
+      dSprintf(name, sizeof(name), "Audio %d", mIndex);
+      gProfiler->setThreadName(name);
+   }
+
    while(1)
    {
       Semaphore::acquireSemaphore(mWakeSemaphore);
 
-      if(Semaphore::acquireSemaphore(mStopSemaphore, false))
+      if(mStopping)
          return;
 
-      lock();
-      AudioResourceEntry * entry = mLoadingQueue.mHead;
-      
-      if(!entry)
+      // the stream and the buffer were set up by the main thread, all
+      // that's left here is the (slow) read.
+      AudioResourceEntry * entry;
+      while(mRequests.pop(entry))
       {
-         unlock();
-         continue;
+         PROFILE_START(AudioThreadLoad);
+         U32 start = Platform::getRealMilliseconds();
+         entry->mStream->read(entry->mSize, entry->mData);
+         entry->mReadTime = Platform::getRealMilliseconds() - start;
+         PROFILE_END();
+
+         bool pushed = mCompleted.push(entry);
+         AssertFatal(pushed, "AudioLoadThread::run: completion queue overflow");
       }
-      
-      // load it in   
-      Stream * stream = ResourceManager->openStream(entry->mResourceObj);
-      stream->read(entry->mResourceObj->fileSize, entry->mData);
-      ResourceManager->closeStream(stream);
-
-      mLoadedQueue.enqueue(mLoadingQueue.dequeue());
-      unlock();      
    }
 }
 
+// AudioThread: ------------------------------------------------------------
+AudioThread * gAudioThread = 0;
+
+AudioThread::AudioThread()
+{
+   S32 count = Con::getIntVariable("$pref::Audio::loadThreads", 2);
+   mNumLoadThreads = U32(mClamp(count, 1, MaxLoadThreads));
+
+   for(U32 i = 0; i < mNumLoadThreads; i++)
+      mLoadThreads[i] = new AudioLoadThread(i);
+
+   mStats.clear();
+}
+
+AudioThread::~AudioThread()
+{
+   for(U32 i = 0; i < mNumLoadThreads; i++)
+      delete mLoadThreads[i];
+}
+
+void AudioThread::stop()
+{
+   for(U32 i = 0; i < mNumLoadThreads; i++)
+      mLoadThreads[i]->stop();
+
+   // anything still out there was read (or never started), either way
+   // the threads are done with it
+   for(U32 j = 0; j < mPending.size(); j++)
+   {
+      AudioResourceEntry * entry = mPending[j];
+      entry->mBuffer->mLoading = false;
+      ResourceManager->closeStream(entry->mStream);
+      dFree(entry->mData);
+      delete entry;
+   }
+   mPending.clear();
+}
+
 //--------------------------------------------------------------------------
-void AudioThread::loadResource(ResourceObject * obj, AudioBuffer * buffer)
+bool AudioThread::loadResource(ResourceObject * obj, AudioBuffer * buffer)
 {
    AssertFatal(!buffer->mLoading, "AudioThread::loadResource: buffer already loading");
-   AudioResourceEntry * entry = new AudioResourceEntry();
 
+   // pick the least busy load thread
+   AudioLoadThread * thread = mLoadThreads[0];
+   for(U32 i = 1; i < mNumLoadThreads; i++)
+      if(mLoadThreads[i]->mInFlight < thread->mInFlight)
+         thread = mLoadThreads[i];
+
+   if(thread->mInFlight == AudioLoadThread::QueueSize)
+   {
+      mStats.mQueueFull++;
+      return(false);
+   }
+
+   // The resource manager and the memory manager are main thread only, so
+   // the stream and the buffer are set up here.
+   Stream * stream = ResourceManager->openStream(obj);
+   if(!stream)
+      return(false);
+
+   AudioResourceEntry * entry = new AudioResourceEntry();
    entry->mResourceObj = obj;
    entry->mBuffer = buffer;
-   entry->mData = dMalloc(obj->fileSize);
-   dMemset(entry->mData, 0, obj->fileSize);
+   entry->mStream = stream;
+   entry->mSize = obj->fileSize;
+   entry->mData = dMalloc(entry->mSize);
+   entry->mRequestTime = Platform::getRealMilliseconds();
 
+   thread->request(entry);
    buffer->mLoading = true;
-   
-   lock();
-   mLoadingQueue.enqueue(entry);   
-   unlock();
+   mPending.push_back(entry);
 
-   Semaphore::acquireSemaphore(mWakeSemaphore, false);
-   Semaphore::releaseSemaphore(mWakeSemaphore);
+   mStats.mRequests++;
+   mStats.mMaxQueueDepth = getMax(mStats.mMaxQueueDepth, thread->mInFlight);
+   return(true);
 }
 
 void AudioThread::setBufferPlayHandle(AudioBuffer * buffer, AUDIOHANDLE handle)
 {
-   lock();
-   
-   // search the loading list
-   AudioResourceEntry * entry = mLoadingQueue.mHead;
-   bool found = false;
+   for(U32 i = 0; i < mPending.size(); i++)
+   {
+      if(mPending[i]->mBuffer == buffer)
+      {
+         Vector<AUDIOHANDLE> & handles = mPending[i]->mPlayHandles;
+         for(U32 j = 0; j < handles.size(); j++)
+            if(handles[j] == handle)
+               return;
+         handles.push_back(handle);
+         return;
+      }
+   }
+}
+
+void AudioThread::processCompleted()
+{
+   AudioResourceEntry * batch[MaxCompletionBatch];
+   U32 count = 0;
 
-   while(entry && !found)
+   // collect what's done...
+   for(U32 i = 0; i < mNumLoadThreads; i++)
    {
-      if(entry->mBuffer == buffer)
+      AudioLoadThread * thread = mLoadThreads[i];
+      while(count < MaxCompletionBatch && thread->getCompleted(batch[count]))
       {
-         entry->mPlayHandle = handle;
-         found = true;
+         thread->mInFlight--;
+         count++;
       }
-      entry = entry->mNext;
    }
-   
-   // search the loaded list
-   if(!found)
+   if(!count)
+      return;
+
+   PROFILE_START(AudioThreadProcess);
+   U32 now = Platform::getRealMilliseconds();
+   mStats.mCompleted += count;
+   mStats.mLargestBatch = getMax(mStats.mLargestBatch, count);
+
+   // ...sync all the loaded buffers...
+   U32 i;
+   for(i = 0; i < count; i++)
    {
-      entry = mLoadedQueue.mHead;
+      AudioResourceEntry * entry = batch[i];
+      ResourceManager->closeStream(entry->mStream);
+      entry->mStream = 0;
+      entry->mBuffer->mLoading = false;
+
+      // still play on failure, it clears the loading bit on the handle
+      if(!alBufferSyncData_EXT(entry->mBuffer->malBuffer, AL_FORMAT_WAVE_EXT, entry->mData, entry->mSize, 0))
+         dFree(entry->mData);
 
-      while(entry && !found)
+      U32 latency = now - entry->mRequestTime;
+      mStats.mTotalLatency += latency;
+      mStats.mMaxLatency = getMax(mStats.mMaxLatency, latency);
+      mStats.mTotalReadTime += entry->mReadTime;
+
+      for(U32 j = 0; j < mPending.size(); j++)
       {
-         if(entry->mBuffer == buffer)
+         if(mPending[j] == entry)
          {
-            entry->mPlayHandle = handle;
-            found = true;
+            mPending.erase_fast(j);
+            break;
          }
-         entry = entry->mNext;
       }
    }
-   
-   unlock();
+
+   // ...and play those marked
+   for(i = 0; i < count; i++)
+   {
+      for(U32 j = 0; j < batch[i]->mPlayHandles.size(); j++)
+         alxPlayLoaded(batch[i]->mPlayHandles[j]);
+      delete batch[i];
+   }
+   PROFILE_END();
 }
 
-AudioResourceEntry * AudioThread::getLoadedList()
+void AudioThread::dumpStats(bool reset)
 {
-   lock();
-   AudioResourceEntry * list = mLoadedQueue.mHead;
-   mLoadedQueue.mHead = mLoadedQueue.mTail = 0;
-   unlock();
-
-   return(list);
+   Con::printf("Audio load threads: %d, pending: %d", mNumLoadThreads, mPending.size());
+   for(U32 i = 0; i < mNumLoadThreads; i++)
+      Con::printf("   thread %d: %d queued, %d in flight", i,
+                  mLoadThreads[i]->getQueueDepth(), mLoadThreads[i]->mInFlight);
+
+   U32 completed = getMax(mStats.mCompleted, U32(1));
+   Con::printf("   requests: %d, completed: %d, queue full: %d, max depth: %d, largest batch: %d",
+               mStats.mRequests, mStats.mCompleted, mStats.mQueueFull,
+               mStats.mMaxQueueDepth, mStats.mLargestBatch);
+   Con::printf("   latency avg: %.1f ms, max: %d ms, read avg: %.1f ms",
+               F32(mStats.mTotalLatency) / completed, mStats.mMaxLatency,
+               F32(mStats.mTotalReadTime) / completed);
+
+   if(reset)
+      mStats.clear();
 }
 
 // static methods: --------------------------------------------------------
@@ -186,7 +281,7 @@ void AudioThread::destroy()
 {
    if(!gAudioThread)
       return;
-   
+
    gAudioThread->stop();
    delete gAudioThread;
    gAudioThread = 0;
@@ -196,23 +291,96 @@ void AudioThread::process()
 {
    if(!gAudioThread)
       return;
-   
-   AudioResourceEntry * entry = gAudioThread->getLoadedList();
 
-   // sync all the loaded buffers and play those marked   
-   while(entry)
+   gAudioThread->processCompleted();
+}
+
+ConsoleFunction(audioThreadStats, void, 1, 2, "audioThreadStats(<reset>);")
+{
+   if(gAudioThread)
+      gAudioThread->dumpStats(argc > 1 && dAtob(argv[1]));
+   else
+      Con::printf("Audio load threads are not running.");
+}
+
+//--------------------------------------------------------------------------
+// Plays the same buffer from two sources while it loads, then checks that
+// both come out of the load playing with the description's looping state.
+extern bool alxIsLoading(AUDIOHANDLE handle);
+
+ConsoleFunction(audioThreadTest, bool, 3, 3, "audioThreadTest(description, filename);")
+{
+   if(!gAudioThread || !Con::getBoolVariable("$pref::Audio::threadedLoads", false))
    {
-      entry->mBuffer->mLoading = false;
-      
-      if(alBufferSyncData_EXT(entry->mBuffer->malBuffer, AL_FORMAT_WAVE_EXT, entry->mData,
-         entry->mResourceObj->fileSize, 0))
+      Con::printf("audioThreadTest: threaded loads are not enabled.");
+      return(false);
+   }
+
+   AudioDescription * descObject = dynamic_cast<AudioDescription*>(Sim::findObject(argv[1]));
+   if(!descObject)
+   {
+      Con::printf("audioThreadTest: unable to find description '%s'.", argv[1]);
+      return(false);
+   }
+
+   AUDIOHANDLE handles[2];
+   handles[0] = alxCreateSource(descObject, argv[2]);
+   handles[1] = alxCreateSource(descObject, argv[2]);
+   if(handles[0] == NULL_AUDIOHANDLE || handles[1] == NULL_AUDIOHANDLE)
+   {
+      Con::printf("audioThreadTest: unable to create two sources for '%s'.", argv[2]);
+      alxStop(handles[0]);
+      alxStop(handles[1]);
+      return(false);
+   }
+
+   Resource<AudioBuffer> buffer = AudioBuffer::find(argv[2]);
+   if(!bool(buffer) || !buffer->isLoading())
+   {
+      Con::printf("audioThreadTest: '%s' is already loaded, pick a file not played yet.", argv[2]);
+      alxStop(handles[0]);
+      alxStop(handles[1]);
+      return(false);
+   }
+
+   U32 i;
+   bool pass = true;
+   for(i = 0; i < 2; i++)
+   {
+      alxPlay(handles[i]);
+      if(!alxIsLoading(handles[i]))
       {
-         if(entry->mPlayHandle != NULL_AUDIOHANDLE)     
-            alxPlay(entry->mPlayHandle);
+         Con::printf("audioThreadTest: source %d did not wait for the load.", i);
+         pass = false;
       }
+   }
 
-      AudioResourceEntry * next = entry->mNext;
-      delete entry;
-      entry = next;
+   U32 start = Platform::getRealMilliseconds();
+   while(buffer->isLoading() && Platform::getRealMilliseconds() - start < 5000)
+      AudioThread::process();
+   if(buffer->isLoading())
+   {
+      Con::printf("audioThreadTest: load did not complete in 5 seconds.");
+      pass = false;
+   }
+
+   for(i = 0; i < 2; i++)
+   {
+      ALint looping = AL_FALSE;
+      alxGetSourcei(handles[i], AL_SOURCE_LOOPING, &looping);
+      if(alxIsLoading(handles[i]) || !alxIsPlaying(handles[i]))
+      {
+         Con::printf("audioThreadTest: source %d is not playing after the load.", i);
+         pass = false;
+      }
+      else if((looping == AL_TRUE) != descObject->getDescription()->mIsLooping)
+      {
+         Con::printf("audioThreadTest: source %d lost its looping state.", i);
+         pass = false;
+      }
+      alxStop(handles[i]);
    }
+
+   Con::printf("audioThreadTest: %s", pass ? "passed" : "FAILED");
+   return(pass);
 }
@@ -14,70 +14,124 @@
 #ifndef _PLATFORMSEMAPHORE_H_
 #include "Platform/platformSemaphore.h"
 #endif
-#ifndef _PLATFORMMUTEX_H_
-#include "Platform/platformMutex.h"
-#endif
 #ifndef _AUDIO_H_
 #include "audio/audio.h"
 #endif
+#ifndef _TSPSCQUEUE_H_
+#include "Core/tSPSCQueue.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+
+class Stream;
 
+// Everything in an entry is owned by the main thread.  The load thread
+// only reads the stream into mData and fills in mReadTime.  Every source
+// played while the buffer loads is kept in mPlayHandles.
 struct AudioResourceEntry
 {
    ResourceObject *        mResourceObj;
    AudioBuffer *           mBuffer;
+   Stream *                mStream;
    void *                  mData;
-   AUDIOHANDLE             mPlayHandle;
-   AudioResourceEntry *    mNext;
+   U32                     mSize;
+   Vector<AUDIOHANDLE>     mPlayHandles;
+   U32                     mRequestTime;
+   U32                     mReadTime;
    
    AudioResourceEntry()
    {
       mResourceObj   = 0;
       mBuffer        = 0;
+      mStream        = 0;
       mData          = 0;
-      mPlayHandle    = NULL_AUDIOHANDLE;
-      mNext          = 0;
+      mSize          = 0;
+      mRequestTime   = 0;
+      mReadTime      = 0;
    }
 };
 
-struct AudioResourceQueue
+//--------------------------------------------------------------------------
+// One load thread.  Requests come in from the main thread and completions
+// go back to it through a pair of single producer/single consumer queues,
+// so neither side ever takes a lock.
+
+class AudioLoadThread : public Thread
 {
-   AudioResourceEntry *    mHead;
-   AudioResourceEntry *    mTail;
-  
-   AudioResourceQueue();
-   
-   void enqueue(AudioResourceEntry * entry);
-   AudioResourceEntry * dequeue();
+   public:
+      enum {
+         QueueSize = 64,
+      };
+
+   private:
+      void *            mWakeSemaphore;
+      volatile bool     mStopping;
+      S32               mIndex;
+
+      SPSCQueue<AudioResourceEntry *, QueueSize>  mRequests;     // main -> load thread
+      SPSCQueue<AudioResourceEntry *, QueueSize>  mCompleted;    // load thread -> main
+
+   public:
+      // main thread only: requests not yet picked up by process()
+      U32               mInFlight;
+
+      AudioLoadThread(S32 index);
+      ~AudioLoadThread();
+
+      void wake();
+      void stop();
+      void run(S32 arg);
+
+      bool request(AudioResourceEntry * entry);
+      bool getCompleted(AudioResourceEntry *& entry) { return(mCompleted.pop(entry)); }
+      U32 getQueueDepth() { return(mRequests.size()); }
 };
 
-class AudioThread : public Thread
+//--------------------------------------------------------------------------
+class AudioThread
 {
+   public:
+      enum {
+         MaxLoadThreads = 4,
+         MaxCompletionBatch = 64,
+      };
+
+      struct Stats
+      {
+         U32      mRequests;
+         U32      mCompleted;
+         U32      mQueueFull;
+         U32      mMaxQueueDepth;
+         U32      mLargestBatch;
+         U32      mTotalLatency;
+         U32      mMaxLatency;
+         U32      mTotalReadTime;
+
+         void clear() { dMemset(this, 0, sizeof(Stats)); }
+      };
+
    private:
+      AudioLoadThread *       mLoadThreads[MaxLoadThreads];
+      U32                     mNumLoadThreads;
+
+      // main thread only
+      Vector<AudioResourceEntry *>  mPending;
+      Stats                         mStats;
 
-      void *      mStopSemaphore;
-      void *      mWakeSemaphore;
-      void *      mMutex;
+      void processCompleted();
 
-      // accessed in both threads. memory must be managed in main thread
-      AudioResourceQueue       mLoadingQueue;
-      AudioResourceQueue       mLoadedQueue;
-      
    public:
 
       AudioThread();
       ~AudioThread();
 
-      void wake();
       void stop();
 
-      void lock()    { Mutex::lockMutex(mMutex); }
-      void unlock()  { Mutex::unlockMutex(mMutex); }
-
-      void run(S32 arg);
-
       void setBufferPlayHandle(AudioBuffer * buffer, AUDIOHANDLE handle);
-      void loadResource(ResourceObject * resourceObj, AudioBuffer * buffer);
-      AudioResourceEntry * getLoadedList();
+      bool loadResource(ResourceObject * resourceObj, AudioBuffer * buffer);
+
+      void dumpStats(bool reset);
 
       // static methods      
       static void create();
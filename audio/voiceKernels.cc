@@ -0,0 +1,120 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "audio/voiceKernels.h"
+
+#ifdef VOICE_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+void (*voice_downsample2x)(const S16 *src, S16 *dst, U32 count) = voice_downsample2x_C;
+void (*voice_upsample2x)(const S16 *src, S16 *dst, U32 count) = voice_upsample2x_C;
+
+static const char *sKernelName = "C";
+
+//--------------------------------------------------------------------------
+// C
+//--------------------------------------------------------------------------
+void voice_downsample2x_C(const S16 *src, S16 *dst, U32 count)
+{
+   for(U32 i = 0; i < count; i++, src += 2)
+      dst[i] = ((S32)src[0] + src[1]) / 2;
+}
+
+void voice_upsample2x_C(const S16 *src, S16 *dst, U32 count)
+{
+   if(!count)
+      return;
+
+   for(U32 i = 0; i < count - 1; i++, dst += 2)
+   {
+      dst[0] = src[i];
+      dst[1] = ((S32)src[i] + src[i+1]) / 2;
+   }
+   dst[0] = dst[1] = src[count - 1];
+}
+
+//--------------------------------------------------------------------------
+// SSE2
+//--------------------------------------------------------------------------
+#ifdef VOICE_KERNELS_SSE2
+
+// (a + b) / 2 for 4 S32s, rounding toward zero like the C divide
+static inline __m128i halveSum(__m128i a, __m128i b)
+{
+   __m128i sum = _mm_add_epi32(a, b);
+   return _mm_srai_epi32(_mm_add_epi32(sum, _mm_srli_epi32(sum, 31)), 1);
+}
+
+void voice_downsample2x_SSE2(const S16 *src, S16 *dst, U32 count)
+{
+   U32 i = 0;
+   for(; i + 8 <= count; i += 8, src += 16)
+   {
+      // each 32 bit lane holds an (even, odd) sample pair
+      __m128i lo = _mm_loadu_si128((const __m128i *)src);
+      __m128i hi = _mm_loadu_si128((const __m128i *)(src + 8));
+
+      __m128i sumLo = halveSum(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(lo, 16));
+      __m128i sumHi = halveSum(_mm_srai_epi32(_mm_slli_epi32(hi, 16), 16), _mm_srai_epi32(hi, 16));
+
+      // results are always in S16 range so the saturation never kicks in
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(sumLo, sumHi));
+   }
+   voice_downsample2x_C(src, dst + i, count - i);
+}
+
+void voice_upsample2x_SSE2(const S16 *src, S16 *dst, U32 count)
+{
+   // src[i+8] is read for each block, so the last sample is left to the C
+   // version along with the tail
+   U32 i = 0;
+   for(; i + 9 <= count; i += 8, dst += 16)
+   {
+      __m128i cur = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i next = _mm_loadu_si128((const __m128i *)(src + i + 1));
+
+      __m128i avgLo = halveSum(_mm_srai_epi32(_mm_unpacklo_epi16(cur, cur), 16),
+                               _mm_srai_epi32(_mm_unpacklo_epi16(next, next), 16));
+      __m128i avgHi = halveSum(_mm_srai_epi32(_mm_unpackhi_epi16(cur, cur), 16),
+                               _mm_srai_epi32(_mm_unpackhi_epi16(next, next), 16));
+      __m128i avg = _mm_packs_epi32(avgLo, avgHi);
+
+      _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(cur, avg));
+      _mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi16(cur, avg));
+   }
+   voice_upsample2x_C(src + i, dst, count - i);
+}
+
+#endif
+
+//--------------------------------------------------------------------------
+void voiceInstallKernels(U32 properties)
+{
+   if(!properties)
+      properties = Platform::SystemInfo.processor.properties;
+   else
+      properties &= Platform::SystemInfo.processor.properties;
+
+   voice_downsample2x = voice_downsample2x_C;
+   voice_upsample2x = voice_upsample2x_C;
+   sKernelName = "C";
+
+#ifdef VOICE_KERNELS_SSE2
+   if(properties & CPU_PROP_SSE2)
+   {
+      voice_downsample2x = voice_downsample2x_SSE2;
+      voice_upsample2x = voice_upsample2x_SSE2;
+      sKernelName = "SSE2";
+   }
+#endif
+}
+
+const char *voiceGetKernelName()
+{
+   return(sKernelName);
+}
@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _VOICEKERNELS_H_
+#define _VOICEKERNELS_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+//--------------------------------------------------------------------------
+// Sample rate conversion between the 8kHz capture rate and the 4kHz rate
+// the GSM codec runs at.  The C versions are the reference, every other
+// version must produce the exact same samples.  Installed the same way as
+// the math library: the C versions are always there and voiceInstallKernels
+// replaces them with whatever the processor supports.
+
+// dst[i] = (src[2i] + src[2i+1]) / 2, for count output samples
+extern void (*voice_downsample2x)(const S16 *src, S16 *dst, U32 count);
+// dst[2i] = src[i], dst[2i+1] = (src[i] + src[i+1]) / 2 (src[i] for the
+// last sample), for count input samples
+extern void (*voice_upsample2x)(const S16 *src, S16 *dst, U32 count);
+
+extern void voice_downsample2x_C(const S16 *src, S16 *dst, U32 count);
+extern void voice_upsample2x_C(const S16 *src, S16 *dst, U32 count);
+
+#if defined(__SSE2__) || (defined(_MSC_VER) && (_MSC_VER >= 1300))
+#define VOICE_KERNELS_SSE2
+extern void voice_downsample2x_SSE2(const S16 *src, S16 *dst, U32 count);
+extern void voice_upsample2x_SSE2(const S16 *src, S16 *dst, U32 count);
+#endif
+
+// properties are CPU_PROP_* flags, 0 means use what the processor has
+extern void voiceInstallKernels(U32 properties = 0);
+extern const char *voiceGetKernelName();
+
+#endif   // _VOICEKERNELS_H_
@@ -55,6 +55,31 @@ void AbstractPolyList::addBox(const Box3F &box)
    }
 }
 
+U32 AbstractPolyList::addPoints(const Point3F* points, U32 count)
+{
+   AssertFatal(count != 0, "AbstractPolyList::addPoints: no points");
+   U32 base = addPoint(points[0]);
+   for (U32 i = 1; i < count; i++)
+      addPoint(points[i]);
+   return base;
+}
+
+void AbstractPolyList::addPolys(U32 material, U32 count, const U32* numVerts, const U32* vertices,
+                                const U32* planes, const U32* surfaceKeys)
+{
+   for (U32 i = 0; i < count; i++) {
+      begin(material, surfaceKeys[i]);
+      for (U32 j = 0; j < numVerts[i]; j++)
+         vertex(vertices[j]);
+      if (planes[i] == PlaneFromVerts)
+         plane(vertices[0], vertices[1], vertices[2]);
+      else
+         plane(planes[i]);
+      end();
+      vertices += numVerts[i];
+   }
+}
+
 bool AbstractPolyList::getMapping(MatrixF *, Box3F *)
 {
    // return list transform and bounds in list space...optional
@@ -62,6 +62,16 @@ public:
    virtual void end() = 0;
    virtual bool getMapping(MatrixF *, Box3F *);
 
+   // Batch functionality.  addPoints returns the index of the first point,
+   // the rest follow it.  addPolys adds count polys whose vertex indices
+   // follow each other in vertices, numVerts[i] at a time; a plane index of
+   // PlaneFromVerts takes the plane from the first three vertices.  The
+   // defaults go through the calls above one at a time.
+   enum { PlaneFromVerts = 0xFFFFFFFF };
+   virtual U32  addPoints(const Point3F* points, U32 count);
+   virtual void addPolys(U32 material, U32 count, const U32* numVerts, const U32* vertices,
+                         const U32* planes, const U32* surfaceKeys);
+
    // Interest functionality
    void setInterestNormal(const Point3F& /*normal*/);
    void clearInterestNormal()                        { mInterestNormalRegistered = false; }
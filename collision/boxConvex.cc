@@ -44,11 +44,7 @@ struct Face {
 
 Point3F BoxConvex::support(const VectorF& v) const
 {
-   Point3F p = mCenter;
-   p.x += (v.x >= 0)? mSize.x: -mSize.x;
-   p.y += (v.y >= 0)? mSize.y: -mSize.y;
-   p.z += (v.z >= 0)? mSize.z: -mSize.z;
-   return p;
+   return supportInline(v);
 }
 
 Point3F BoxConvex::getVertex(S32 v)
@@ -31,6 +31,15 @@ public:
    Point3F support(const VectorF& v) const;
    void getFeatures(const MatrixF& mat,const VectorF& n, ConvexFeature* cf);
    void getPolyList(AbstractPolyList* list);
+
+   // Non virtual, for the GJK loops specialized on box convexes
+   Point3F supportInline(const VectorF& v) const {
+      Point3F p = mCenter;
+      p.x += (v.x >= 0)? mSize.x: -mSize.x;
+      p.y += (v.y >= 0)? mSize.y: -mSize.y;
+      p.z += (v.z >= 0)? mSize.z: -mSize.z;
+      return p;
+   }
 };
 
 
@@ -0,0 +1,498 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "Collision/boxTree.h"
+#include "Core/stream.h"
+#include "Core/resManager.h"
+
+#if defined(__SSE__) || (defined(_MSC_VER) && (_MSC_VER >= 1300))
+#define BOX_TREE_SSE
+#include <xmmintrin.h>
+#endif
+
+typedef BoxTree::Node BoxTreeNode;
+
+//--------------------------------------------------------------------------
+// Segment in the form the ray kernels want it: lo is the start moved up by
+// the padding and hi the start moved down by it, so a slab is
+// [(min - lo) * inv, (max - hi) * inv] for the padded box.  Axes the
+// segment doesn't move along get a huge inverse instead of an infinite one,
+// which keeps 0 * inv out of the picture.
+
+struct BoxTreeRay
+{
+   F32 lo[3];
+   F32 hi[3];
+   F32 inv[3];
+};
+
+//--------------------------------------------------------------------------
+// Lane tests.  Each returns a bit per child whose box passes, children not
+// in use are masked off by the traversal.  Box overlap is inclusive, the
+// same as Box3F::isOverlapped.
+
+struct BoxTreeBoxTest_C
+{
+   const Box3F& box;
+   BoxTreeBoxTest_C(const Box3F& query) : box(query) { }
+
+   U32 operator()(const BoxTreeNode& node) const
+   {
+      U32 mask = 0;
+      for (U32 i = 0; i < BoxTree::Width; i++) {
+         if (box.min.x <= node.maxX[i] && box.max.x >= node.minX[i] &&
+             box.min.y <= node.maxY[i] && box.max.y >= node.minY[i] &&
+             box.min.z <= node.maxZ[i] && box.max.z >= node.minZ[i])
+            mask |= 1 << i;
+      }
+      return mask;
+   }
+};
+
+struct BoxTreeRayTest_C
+{
+   const BoxTreeRay& ray;
+   BoxTreeRayTest_C(const BoxTreeRay& r) : ray(r) { }
+
+   U32 operator()(const BoxTreeNode& node) const
+   {
+      U32 mask = 0;
+      for (U32 i = 0; i < BoxTree::Width; i++) {
+         F32 t0 = (node.minX[i] - ray.lo[0]) * ray.inv[0];
+         F32 t1 = (node.maxX[i] - ray.hi[0]) * ray.inv[0];
+         F32 tNear = getMax(0.0f, getMin(t0, t1));
+         F32 tFar  = getMin(1.0f, getMax(t0, t1));
+
+         t0 = (node.minY[i] - ray.lo[1]) * ray.inv[1];
+         t1 = (node.maxY[i] - ray.hi[1]) * ray.inv[1];
+         tNear = getMax(tNear, getMin(t0, t1));
+         tFar  = getMin(tFar,  getMax(t0, t1));
+
+         t0 = (node.minZ[i] - ray.lo[2]) * ray.inv[2];
+         t1 = (node.maxZ[i] - ray.hi[2]) * ray.inv[2];
+         tNear = getMax(tNear, getMin(t0, t1));
+         tFar  = getMin(tFar,  getMax(t0, t1));
+
+         if (tNear <= tFar)
+            mask |= 1 << i;
+      }
+      return mask;
+   }
+};
+
+#ifdef BOX_TREE_SSE
+struct BoxTreeBoxTest_SSE
+{
+   __m128 minX, minY, minZ;
+   __m128 maxX, maxY, maxZ;
+
+   BoxTreeBoxTest_SSE(const Box3F& box)
+   {
+      minX = _mm_set1_ps(box.min.x);
+      minY = _mm_set1_ps(box.min.y);
+      minZ = _mm_set1_ps(box.min.z);
+      maxX = _mm_set1_ps(box.max.x);
+      maxY = _mm_set1_ps(box.max.y);
+      maxZ = _mm_set1_ps(box.max.z);
+   }
+
+   U32 operator()(const BoxTreeNode& node) const
+   {
+      __m128 x = _mm_and_ps(_mm_cmple_ps(minX, _mm_loadu_ps(node.maxX)),
+                            _mm_cmpge_ps(maxX, _mm_loadu_ps(node.minX)));
+      __m128 y = _mm_and_ps(_mm_cmple_ps(minY, _mm_loadu_ps(node.maxY)),
+                            _mm_cmpge_ps(maxY, _mm_loadu_ps(node.minY)));
+      __m128 z = _mm_and_ps(_mm_cmple_ps(minZ, _mm_loadu_ps(node.maxZ)),
+                            _mm_cmpge_ps(maxZ, _mm_loadu_ps(node.minZ)));
+      return _mm_movemask_ps(_mm_and_ps(x, _mm_and_ps(y, z)));
+   }
+};
+
+struct BoxTreeRayTest_SSE
+{
+   __m128 loX, loY, loZ;
+   __m128 hiX, hiY, hiZ;
+   __m128 invX, invY, invZ;
+   __m128 zero, one;
+
+   BoxTreeRayTest_SSE(const BoxTreeRay& ray)
+   {
+      loX  = _mm_set1_ps(ray.lo[0]);
+      loY  = _mm_set1_ps(ray.lo[1]);
+      loZ  = _mm_set1_ps(ray.lo[2]);
+      hiX  = _mm_set1_ps(ray.hi[0]);
+      hiY  = _mm_set1_ps(ray.hi[1]);
+      hiZ  = _mm_set1_ps(ray.hi[2]);
+      invX = _mm_set1_ps(ray.inv[0]);
+      invY = _mm_set1_ps(ray.inv[1]);
+      invZ = _mm_set1_ps(ray.inv[2]);
+      zero = _mm_setzero_ps();
+      one  = _mm_set1_ps(1.0f);
+   }
+
+   U32 operator()(const BoxTreeNode& node) const
+   {
+      __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), loX), invX);
+      __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), hiX), invX);
+      __m128 tNear = _mm_max_ps(zero, _mm_min_ps(t0, t1));
+      __m128 tFar  = _mm_min_ps(one,  _mm_max_ps(t0, t1));
+
+      t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), loY), invY);
+      t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), hiY), invY);
+      tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+      tFar  = _mm_min_ps(tFar,  _mm_max_ps(t0, t1));
+
+      t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), loZ), invZ);
+      t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), hiZ), invZ);
+      tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+      tFar  = _mm_min_ps(tFar,  _mm_max_ps(t0, t1));
+
+      return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+   }
+};
+#endif
+
+
+//--------------------------------------------------------------------------
+// Traversals
+
+template <class Test>
+static U32 boxTreeFindBoxes(const BoxTreeNode* nodes, const Test& test, U16* boxIndices)
+{
+   U32 stack[BoxTree::StackSize];
+   U32 depth = 0;
+   U32 numBoxes = 0;
+
+   stack[depth++] = 0;
+   while (depth) {
+      const BoxTreeNode& node = nodes[stack[--depth]];
+      U32 mask = test(node) & node.mask;
+      for (U32 i = 0; mask; i++, mask >>= 1) {
+         if (!(mask & 1))
+            continue;
+         if (node.child[i] & BoxTree::LeafFlag)
+            boxIndices[numBoxes++] = U16(node.child[i] & ~BoxTree::LeafFlag);
+         else
+            stack[depth++] = node.child[i];
+      }
+   }
+   return numBoxes;
+}
+
+template <class Test>
+static bool boxTreeAnyHit(const BoxTreeNode* nodes, const Test& test)
+{
+   U32 stack[BoxTree::StackSize];
+   U32 depth = 0;
+
+   stack[depth++] = 0;
+   while (depth) {
+      const BoxTreeNode& node = nodes[stack[--depth]];
+      U32 mask = test(node) & node.mask;
+      for (U32 i = 0; mask; i++, mask >>= 1) {
+         if (!(mask & 1))
+            continue;
+         if (node.child[i] & BoxTree::LeafFlag)
+            return true;
+         stack[depth++] = node.child[i];
+      }
+   }
+   return false;
+}
+
+static U32 boxTreeFindBoxes_C(const BoxTreeNode* nodes, const Box3F& query, U16* boxIndices)
+{
+   return boxTreeFindBoxes(nodes, BoxTreeBoxTest_C(query), boxIndices);
+}
+
+static bool boxTreeTouchesSegment_C(const BoxTreeNode* nodes, const BoxTreeRay& ray)
+{
+   return boxTreeAnyHit(nodes, BoxTreeRayTest_C(ray));
+}
+
+#ifdef BOX_TREE_SSE
+static U32 boxTreeFindBoxes_SSE(const BoxTreeNode* nodes, const Box3F& query, U16* boxIndices)
+{
+   return boxTreeFindBoxes(nodes, BoxTreeBoxTest_SSE(query), boxIndices);
+}
+
+static bool boxTreeTouchesSegment_SSE(const BoxTreeNode* nodes, const BoxTreeRay& ray)
+{
+   return boxTreeAnyHit(nodes, BoxTreeRayTest_SSE(ray));
+}
+#endif
+
+static U32  (*sBoxTreeFind)(const BoxTreeNode* nodes, const Box3F& query, U16* boxIndices) = boxTreeFindBoxes_C;
+static bool (*sBoxTreeTouchesSegment)(const BoxTreeNode* nodes, const BoxTreeRay& ray) = boxTreeTouchesSegment_C;
+static const char* sBoxTreeKernelName = "C";
+
+void BoxTree::installKernels(U32 properties)
+{
+   if (!properties)
+      properties = Platform::SystemInfo.processor.properties;
+   else
+      properties &= Platform::SystemInfo.processor.properties;
+
+   sBoxTreeFind = boxTreeFindBoxes_C;
+   sBoxTreeTouchesSegment = boxTreeTouchesSegment_C;
+   sBoxTreeKernelName = "C";
+
+#ifdef BOX_TREE_SSE
+   if (properties & CPU_PROP_SSE) {
+      sBoxTreeFind = boxTreeFindBoxes_SSE;
+      sBoxTreeTouchesSegment = boxTreeTouchesSegment_SSE;
+      sBoxTreeKernelName = "SSE";
+   }
+#endif
+}
+
+const char* BoxTree::getKernelName()
+{
+   return sBoxTreeKernelName;
+}
+
+
+//--------------------------------------------------------------------------
+// Construction
+//
+// Top down, median splits on the longest axis of the hull centers.  Each
+// node halves its boxIndices and halves the halves again, which fills all four
+// children of every node with more than four boxIndices below it.
+
+static const Box3F* sSortBoxes;
+static U32 sSortAxis;
+
+static inline void growBox(Box3F& box, const Point3F& min, const Point3F& max)
+{
+   box.min.x = getMin(box.min.x, min.x);
+   box.min.y = getMin(box.min.y, min.y);
+   box.min.z = getMin(box.min.z, min.z);
+   box.max.x = getMax(box.max.x, max.x);
+   box.max.y = getMax(box.max.y, max.y);
+   box.max.z = getMax(box.max.z, max.z);
+}
+
+static S32 QSORT_CALLBACK cmpBoxCenter(const void* a, const void* b)
+{
+   const Box3F& boxA = sSortBoxes[*(const U16*)a];
+   const Box3F& boxB = sSortBoxes[*(const U16*)b];
+   F32 ca = (&boxA.min.x)[sSortAxis] + (&boxA.max.x)[sSortAxis];
+   F32 cb = (&boxB.min.x)[sSortAxis] + (&boxB.max.x)[sSortAxis];
+   return (ca < cb)? -1: ((ca > cb)? 1: 0);
+}
+
+static U32 splitBoxes(const Vector<Box3F>& boxes, U16* boxIndices, U32 count)
+{
+   Box3F centers;
+   for (U32 i = 0; i < count; i++) {
+      const Box3F& box = boxes[boxIndices[i]];
+      Point3F center = box.min + box.max;
+      if (i == 0)
+         centers.min = centers.max = center;
+      else
+         growBox(centers, center, center);
+   }
+
+   Point3F extent = centers.max - centers.min;
+   sSortAxis = (extent.x >= extent.y && extent.x >= extent.z)? 0: ((extent.y >= extent.z)? 1: 2);
+   sSortBoxes = boxes.address();
+   dQsort(boxIndices, count, sizeof(U16), cmpBoxCenter);
+   return count >> 1;
+}
+
+BoxTree::BoxTree()
+{
+   mSignature = 0;
+   mDepth = 0;
+   VECTOR_SET_ASSOCIATION(mNodes);
+}
+
+U32 BoxTree::getSignature(const Vector<Box3F>& boxes)
+{
+   U32 count = boxes.size();
+   U32 crc = calculateCRC(&count, sizeof(count));
+   if (count)
+      crc = calculateCRC((void*)boxes.address(), count * sizeof(Box3F), crc);
+   return crc;
+}
+
+void BoxTree::build(const Vector<Box3F>& boxes)
+{
+   AssertFatal(boxes.size() <= 65536, "BoxTree::build: too many boxIndices");
+   mNodes.clear();
+   mDepth = 0;
+   mSignature = getSignature(boxes);
+   if (boxes.size() == 0)
+      return;
+
+   Vector<U16> boxIndices;
+   boxIndices.setSize(boxes.size());
+   for (U32 i = 0; i < boxIndices.size(); i++)
+      boxIndices[i] = i;
+
+   mNodes.reserve(boxes.size() / 2 + 1);
+   buildNode(boxes, boxIndices.address(), boxIndices.size(), 0);
+   mNodes.compact();
+
+   // Every level leaves at most three siblings on the stack
+   AssertFatal(mDepth * (Width - 1) + 1 <= StackSize, "BoxTree::build: tree too deep");
+}
+
+U32 BoxTree::buildNode(const Vector<Box3F>& boxes, U16* boxIndices, U32 count, U32 depth)
+{
+   mDepth = getMax(mDepth, depth + 1);
+   U32 index = mNodes.size();
+   mNodes.increment();
+   dMemset(&mNodes.last(), 0, sizeof(Node));
+
+   U16* groupStart[Width];
+   U32  groupSize[Width];
+   U32  numGroups;
+   if (count <= Width) {
+      for (numGroups = 0; numGroups < count; numGroups++) {
+         groupStart[numGroups] = boxIndices + numGroups;
+         groupSize[numGroups] = 1;
+      }
+   } else {
+      // More than four, so both halves have at least two
+      U32 half = splitBoxes(boxes, boxIndices, count);
+      U32 quarter = splitBoxes(boxes, boxIndices, half);
+      groupStart[0] = boxIndices;
+      groupSize[0]  = quarter;
+      groupStart[1] = boxIndices + quarter;
+      groupSize[1]  = half - quarter;
+
+      U16* upper = boxIndices + half;
+      quarter = splitBoxes(boxes, upper, count - half);
+      groupStart[2] = upper;
+      groupSize[2]  = quarter;
+      groupStart[3] = upper + quarter;
+      groupSize[3]  = count - half - quarter;
+      numGroups = 4;
+   }
+
+   for (U32 i = 0; i < numGroups; i++) {
+      Box3F bounds = boxes[groupStart[i][0]];
+      for (U32 j = 1; j < groupSize[i]; j++)
+         growBox(bounds, boxes[groupStart[i][j]].min, boxes[groupStart[i][j]].max);
+
+      // The recursion grows mNodes, don't hold on to the node
+      U32 child;
+      if (groupSize[i] == 1)
+         child = groupStart[i][0] | LeafFlag;
+      else
+         child = buildNode(boxes, groupStart[i], groupSize[i], depth + 1);
+
+      Node& node = mNodes[index];
+      node.minX[i] = bounds.min.x;
+      node.minY[i] = bounds.min.y;
+      node.minZ[i] = bounds.min.z;
+      node.maxX[i] = bounds.max.x;
+      node.maxY[i] = bounds.max.y;
+      node.maxZ[i] = bounds.max.z;
+      node.child[i] = child;
+      node.mask |= 1 << i;
+   }
+   return index;
+}
+
+
+//--------------------------------------------------------------------------
+// Persistence
+
+bool BoxTree::write(Stream& stream) const
+{
+   stream.write(U32(FileVersion));
+   stream.write(mSignature);
+   stream.write(mDepth);
+   stream.write(U32(mNodes.size()));
+
+   for (U32 i = 0; i < mNodes.size(); i++) {
+      const Node& node = mNodes[i];
+      for (U32 j = 0; j < Width; j++) {
+         stream.write(node.minX[j]);
+         stream.write(node.minY[j]);
+         stream.write(node.minZ[j]);
+         stream.write(node.maxX[j]);
+         stream.write(node.maxY[j]);
+         stream.write(node.maxZ[j]);
+         stream.write(node.child[j]);
+      }
+      stream.write(node.mask);
+   }
+   return stream.getStatus() == Stream::Ok;
+}
+
+bool BoxTree::read(Stream& stream, U32 signature)
+{
+   U32 version, fileSignature, depth, numNodes;
+   stream.read(&version);
+   stream.read(&fileSignature);
+   stream.read(&depth);
+   stream.read(&numNodes);
+   if (stream.getStatus() != Stream::Ok || version != FileVersion ||
+       fileSignature != signature || depth * (Width - 1) + 1 > StackSize)
+      return false;
+
+   mNodes.setSize(numNodes);
+   for (U32 i = 0; i < mNodes.size(); i++) {
+      Node& node = mNodes[i];
+      dMemset(&node, 0, sizeof(Node));
+      for (U32 j = 0; j < Width; j++) {
+         stream.read(&node.minX[j]);
+         stream.read(&node.minY[j]);
+         stream.read(&node.minZ[j]);
+         stream.read(&node.maxX[j]);
+         stream.read(&node.maxY[j]);
+         stream.read(&node.maxZ[j]);
+         stream.read(&node.child[j]);
+      }
+      stream.read(&node.mask);
+
+      // Inner children only ever point further down the array
+      for (U32 k = 0; k < Width; k++)
+         if ((node.mask & (1 << k)) && !(node.child[k] & LeafFlag) &&
+             (node.child[k] <= i || node.child[k] >= numNodes)) {
+            mNodes.clear();
+            return false;
+         }
+   }
+   if (stream.getStatus() != Stream::Ok) {
+      mNodes.clear();
+      return false;
+   }
+
+   mSignature = signature;
+   mDepth = depth;
+   return true;
+}
+
+
+//--------------------------------------------------------------------------
+// Queries
+
+U32 BoxTree::findBoxes(const Box3F& query, U16* boxIndices) const
+{
+   if (mNodes.size() == 0)
+      return 0;
+   return sBoxTreeFind(mNodes.address(), query, boxIndices);
+}
+
+bool BoxTree::touchesSegment(const Point3F& start, const Point3F& end, F32 padding) const
+{
+   if (mNodes.size() == 0)
+      return false;
+
+   BoxTreeRay ray;
+   for (U32 i = 0; i < 3; i++) {
+      F32 d = (&end.x)[i] - (&start.x)[i];
+      ray.lo[i]  = (&start.x)[i] + padding;
+      ray.hi[i]  = (&start.x)[i] - padding;
+      ray.inv[i] = (mFabs(d) > 1e-20f)? 1.0f / d: 1e30f;
+   }
+   return sBoxTreeTouchesSegment(mNodes.address(), ray);
+}
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _BOXTREE_H_
+#define _BOXTREE_H_
+
+#ifndef _PLATFORM_H_
+#include "Platform/platform.h"
+#endif
+#ifndef _MMATH_H_
+#include "Math/mMath.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+
+class Stream;
+
+//--------------------------------------------------------------------------
+// Bounding volume hierarchy over a fixed set of boxes (interior hulls,
+// shape collision triangles).
+//
+// Nodes are four wide and keep their child boxes as structure of arrays,
+// so a box or ray query does one round of SIMD tests per node.  A child is
+// either an inner node or a single box, so a passed test on a box is exact
+// and every box is found at most once.  Queries don't touch the tree and
+// can run on any thread.
+//
+// The tree only depends on the boxes, it is saved with a signature of
+// them and thrown away on load if they changed.
+
+class BoxTree
+{
+  public:
+   enum Constants {
+      Width       = 4,
+      StackSize   = 64,
+      FileVersion = 1,
+
+      LeafFlag    = 0x80000000
+   };
+
+   struct Node {
+      F32 minX[Width];
+      F32 minY[Width];
+      F32 minZ[Width];
+      F32 maxX[Width];
+      F32 maxY[Width];
+      F32 maxZ[Width];
+      U32 child[Width];    // node index, or box index | LeafFlag
+      U32 mask;            // children in use
+      U32 pad[3];
+   };
+
+  private:
+   Vector<Node> mNodes;
+   U32          mSignature;
+   U32          mDepth;
+
+   U32  buildNode(const Vector<Box3F>& boxes, U16* boxIndices, U32 count, U32 depth);
+
+  public:
+   BoxTree();
+
+   // At most 65536 boxes, found by their index in the vector
+   void build(const Vector<Box3F>& boxes);
+   static U32 getSignature(const Vector<Box3F>& boxes);
+
+   // read fails if the file doesn't match the signature
+   bool read(Stream& stream, U32 signature);
+   bool write(Stream& stream) const;
+
+   // Boxes that overlap the query, returns how many
+   U32  findBoxes(const Box3F& query, U16* boxIndices) const;
+   // Whether the segment touches any box grown by padding.  Only a reject
+   //  test, the caller still has to find the hit on what's in the boxes.
+   bool touchesSegment(const Point3F& start, const Point3F& end, F32 padding) const;
+
+   U32  getNodeCount() const { return mNodes.size(); }
+   U32  getDepth() const     { return mDepth; }
+   bool isEmpty() const      { return mNodes.size() == 0; }
+
+   static void installKernels(U32 properties = 0);
+   static const char* getKernelName();
+};
+
+#endif
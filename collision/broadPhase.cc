@@ -0,0 +1,278 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "Collision/broadPhase.h"
+#include "Collision/convex.h"
+#include "Sim/sceneObject.h"
+#include "console/console.h"
+#include "console/simParallel.h"
+#include "platform/profiler.h"
+
+//----------------------------------------------------------------------------
+
+BroadPhaseProxy::BroadPhaseProxy()
+{
+   mBroadPhase = NULL;
+   mObject = NULL;
+   mConvex = NULL;
+   mMask = 0;
+   mIndex = 0;
+   mValid = false;
+   VECTOR_SET_ASSOCIATION(mPairs);
+}
+
+
+//----------------------------------------------------------------------------
+
+CollisionBroadPhase::CollisionBroadPhase()
+{
+   mMaxWidth = 0;
+   mStats.clear();
+   VECTOR_SET_ASSOCIATION(mProxies);
+}
+
+CollisionBroadPhase::~CollisionBroadPhase()
+{
+   for (U32 i = 0; i < mProxies.size(); i++)
+      delete mProxies[i];
+}
+
+BroadPhaseProxy* CollisionBroadPhase::addProxy(SceneObject* object, Convex* convex, U32 mask)
+{
+   AssertFatal(object && convex, "CollisionBroadPhase::addProxy: no object or convex");
+
+   // It isn't sorted in until the first update gives it a box.
+   BroadPhaseProxy* proxy = new BroadPhaseProxy;
+   proxy->mBroadPhase = this;
+   proxy->mObject = object;
+   proxy->mConvex = convex;
+   proxy->mMask = mask;
+   return proxy;
+}
+
+void CollisionBroadPhase::removeProxy(BroadPhaseProxy* proxy)
+{
+   AssertFatal(proxy->mBroadPhase == this, "CollisionBroadPhase::removeProxy: wrong broad phase");
+   SimSharedLock lock;
+
+   // The object is on its way out, its convexes go with it.
+   while (proxy->mPairs.size())
+      removePair(proxy, proxy->mPairs.last(), false);
+
+   if (proxy->mValid) {
+      mProxies.erase(proxy->mIndex);
+      for (U32 i = proxy->mIndex; i < mProxies.size(); i++)
+         mProxies[i]->mIndex = i;
+   }
+   delete proxy;
+}
+
+
+//----------------------------------------------------------------------------
+
+void CollisionBroadPhase::sortProxy(BroadPhaseProxy* proxy)
+{
+   // Boxes only move a little between updates, so insertion sort it is.
+   U32 i = proxy->mIndex;
+   F32 x = proxy->mBox.min.x;
+   while (i > 0 && mProxies[i - 1]->mBox.min.x > x) {
+      mProxies[i] = mProxies[i - 1];
+      mProxies[i]->mIndex = i;
+      i--;
+   }
+   while (i + 1 < mProxies.size() && mProxies[i + 1]->mBox.min.x < x) {
+      mProxies[i] = mProxies[i + 1];
+      mProxies[i]->mIndex = i;
+      i++;
+   }
+   mProxies[i] = proxy;
+   proxy->mIndex = i;
+}
+
+U32 CollisionBroadPhase::findFirst(F32 x)
+{
+   // First proxy that can reach x
+   x -= mMaxWidth;
+   U32 lo = 0, hi = mProxies.size();
+   while (lo < hi) {
+      U32 mid = (lo + hi) >> 1;
+      if (mProxies[mid]->mBox.min.x < x)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+bool CollisionBroadPhase::pushConvex(SceneObject* object, BroadPhaseProxy* to)
+{
+   if (!(object->getType() & to->mMask))
+      return true;
+
+   // Objects mounted to the receiver are left out, the same way they are
+   // when it queries the container (see Vehicle::disableCollision).
+   to->mObject->disableCollision();
+   bool enabled = object->isCollisionEnabled() && object->getContainer() != NULL;
+   to->mObject->enableCollision();
+   if (!enabled)
+      return false;
+
+   object->buildConvex(to->mBox, to->mConvex);
+   mStats.pushed++;
+   return true;
+}
+
+void CollisionBroadPhase::addPair(BroadPhaseProxy* a, BroadPhaseProxy* b)
+{
+   a->mPairs.push_back(b);
+   b->mPairs.push_back(a);
+   mStats.pairsAdded++;
+}
+
+void CollisionBroadPhase::removePair(BroadPhaseProxy* a, BroadPhaseProxy* b, bool pull)
+{
+   U32 i;
+   for (i = 0; i < a->mPairs.size(); i++)
+      if (a->mPairs[i] == b) {
+         a->mPairs.erase_fast(i);
+         break;
+      }
+   for (i = 0; i < b->mPairs.size(); i++)
+      if (b->mPairs[i] == a) {
+         b->mPairs.erase_fast(i);
+         break;
+      }
+   mStats.pairsRemoved++;
+
+   if (pull) {
+      a->mConvex->removeFromWorkingList(b->mObject);
+      b->mConvex->removeFromWorkingList(a->mObject);
+      mStats.pulled++;
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+bool CollisionBroadPhase::updateProxy(BroadPhaseProxy* proxy, const Box3F& needed, F32 margin, U32 mask)
+{
+   mStats.updates++;
+   if (proxy->mValid && proxy->mMask == mask && proxy->mBox.isContained(needed))
+      return false;
+
+   PROFILE_START(BroadPhaseUpdate);
+   SimSharedLock lock;
+   mStats.queries++;
+
+   proxy->mMask = mask;
+   proxy->mBox.min = needed.min - Point3F(margin, margin, margin);
+   proxy->mBox.max = needed.max + Point3F(margin, margin, margin);
+   mMaxWidth = getMax(mMaxWidth, proxy->mBox.len_x());
+   if (!proxy->mValid) {
+      proxy->mIndex = mProxies.size();
+      proxy->mValid = true;
+      mProxies.push_back(proxy);
+   }
+   sortProxy(proxy);
+
+   // Everything in the container that's in range, the static geometry
+   // is only ever picked up here.
+   SceneObject* object = proxy->mObject;
+   object->disableCollision();
+   proxy->mConvex->updateWorkingList(proxy->mBox, mask);
+   object->enableCollision();
+
+   // Pairs that ended...
+   for (S32 i = proxy->mPairs.size() - 1; i >= 0; i--)
+      if (!proxy->mBox.isOverlapped(proxy->mPairs[i]->mBox))
+         removePair(proxy, proxy->mPairs[i], true);
+
+   // ...and the ones that started.  A pair that couldn't be pushed both
+   // ways isn't kept, so it's tried again on the next update of either.
+   for (U32 j = findFirst(proxy->mBox.min.x); j < mProxies.size(); j++) {
+      BroadPhaseProxy* other = mProxies[j];
+      if (other->mBox.min.x > proxy->mBox.max.x)
+         break;
+      if (other == proxy || !proxy->mBox.isOverlapped(other->mBox))
+         continue;
+
+      U32 k;
+      for (k = 0; k < proxy->mPairs.size(); k++)
+         if (proxy->mPairs[k] == other)
+            break;
+      if (k != proxy->mPairs.size())
+         continue;
+
+      bool in  = pushConvex(other->mObject, proxy);
+      bool out = pushConvex(proxy->mObject, other);
+      if (in && out)
+         addPair(proxy, other);
+   }
+   PROFILE_END();
+   return true;
+}
+
+void CollisionBroadPhase::pushObject(SceneObject* object, bool moved)
+{
+   if (!mProxies.size() || !object->isCollisionEnabled())
+      return;
+
+   SimSharedLock lock;
+   const Box3F& box = object->getWorldBox();
+   for (U32 i = findFirst(box.min.x); i < mProxies.size(); i++) {
+      BroadPhaseProxy* proxy = mProxies[i];
+      if (proxy->mBox.min.x > box.max.x)
+         break;
+      if (proxy->mObject == object || !proxy->mBox.isOverlapped(box))
+         continue;
+
+      if (moved) {
+         // Proxies that are paired push themselves, and the convex builders
+         // skip objects already on the list, but that still walks it.
+         U32 k;
+         for (k = 0; k < proxy->mPairs.size(); k++)
+            if (proxy->mPairs[k]->mObject == object)
+               break;
+         if (k != proxy->mPairs.size())
+            continue;
+
+         // leaves out objects mounted to the proxy, they move with it
+         pushConvex(object, proxy);
+      }
+      else if (object->getType() & proxy->mMask) {
+         object->buildConvex(proxy->mBox, proxy->mConvex);
+         mStats.pushed++;
+      }
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+void CollisionBroadPhase::dumpStats(const char* name, bool reset)
+{
+   U32 pairs = 0;
+   for (U32 i = 0; i < mProxies.size(); i++)
+      pairs += mProxies[i]->mPairs.size();
+
+   Con::printf("%s broad phase: %d proxies, %d pairs, max width %g",
+               name, mProxies.size(), pairs / 2, mMaxWidth);
+   Con::printf("   updates: %d, queries: %d (%.1f%%)", mStats.updates, mStats.queries,
+               mStats.updates? 100.0f * mStats.queries / mStats.updates: 0.0f);
+   Con::printf("   pairs added: %d, removed: %d, convexes pushed: %d, pulled: %d",
+               mStats.pairsAdded, mStats.pairsRemoved, mStats.pushed, mStats.pulled);
+
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(broadPhaseStats, void, 1, 2, "broadPhaseStats(<reset>);")
+{
+   bool reset = argc > 1 && dAtob(argv[1]);
+   gServerContainer.getBroadPhase()->dumpStats("Server", reset);
+   gClientContainer.getBroadPhase()->dumpStats("Client", reset);
+}
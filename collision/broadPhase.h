@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _BROADPHASE_H_
+#define _BROADPHASE_H_
+
+#ifndef _MMATH_H_
+#include "Math/mMath.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+
+class SceneObject;
+class Convex;
+class CollisionBroadPhase;
+
+
+//----------------------------------------------------------------------------
+// Persistent collision working sets
+//
+// A moving object that keeps a convex working list registers a proxy with
+// the broad phase of its container.  The proxy holds a fattened box around
+// what the object needs to collide with:
+//
+// - While the needed box stays inside the fattened box nothing is queried.
+// - When it leaves, the box is fattened again around the new needed box,
+//   the container is queried for the static geometry and the proxy is
+//   sorted back into place (sweep and prune on x).
+// - Proxies whose fattened boxes start or stop overlapping push their
+//   convexes into, or pull them out of, each other's working lists, so a
+//   proxy that doesn't move still sees the ones that come close.  Objects
+//   added to the container, or moved by it (checkBins), are pushed into
+//   the proxies they overlap the same way.
+//
+// A pushed convex follows its object, it stays on the list until the proxy
+// queries again even if the object leaves the fattened box.
+
+class BroadPhaseProxy
+{
+   friend class CollisionBroadPhase;
+
+   CollisionBroadPhase*    mBroadPhase;
+   SceneObject*            mObject;
+   Convex*                 mConvex;
+   U32                     mMask;
+   Box3F                   mBox;          // fattened
+   U32                     mIndex;        // in the sorted proxy list
+   Vector<BroadPhaseProxy*> mPairs;        // overlapping and pushed both ways
+   bool                    mValid;        // box has been set
+
+   BroadPhaseProxy();
+
+  public:
+   SceneObject*         getObject() const     { return mObject;     }
+   CollisionBroadPhase* getBroadPhase() const { return mBroadPhase; }
+   const Box3F&         getBox() const        { return mBox;        }
+   bool                 isValid() const       { return mValid;      }
+};
+
+
+//----------------------------------------------------------------------------
+
+class CollisionBroadPhase
+{
+   Vector<BroadPhaseProxy*> mProxies;      // sorted on mBox.min.x
+   F32                      mMaxWidth;     // widest proxy box along x, ever
+
+   struct Stats {
+      U32 updates;
+      U32 queries;
+      U32 pairsAdded;
+      U32 pairsRemoved;
+      U32 pushed;
+      U32 pulled;
+      void clear() { dMemset(this, 0, sizeof(*this)); }
+   } mStats;
+
+   void sortProxy(BroadPhaseProxy* proxy);
+   U32  findFirst(F32 x);
+   bool pushConvex(SceneObject* object, BroadPhaseProxy* to);
+   void pushObject(SceneObject* object, bool moved);
+   void addPair(BroadPhaseProxy* a, BroadPhaseProxy* b);
+   void removePair(BroadPhaseProxy* a, BroadPhaseProxy* b, bool pull);
+
+  public:
+   CollisionBroadPhase();
+   ~CollisionBroadPhase();
+
+   // The convex gets the working list deltas, the mask picks the object
+   // types that go on it.
+   BroadPhaseProxy* addProxy(SceneObject* object, Convex* convex, U32 mask);
+   void removeProxy(BroadPhaseProxy* proxy);
+
+   // Makes sure the working list covers the needed box.  Returns true if
+   // the proxy had to move, in which case the new box is the needed box
+   // grown by the margin.  The object's own collision must be enabled.
+   bool updateProxy(BroadPhaseProxy* proxy, const Box3F& needed, F32 margin, U32 mask);
+
+   // Called by the container.
+   void objectAdded(SceneObject* object)  { pushObject(object, false); }
+   void objectMoved(SceneObject* object)  { pushObject(object, true);  }
+
+   U32  getProxyCount() const { return mProxies.size(); }
+   void dumpStats(const char* name, bool reset);
+};
+
+#endif
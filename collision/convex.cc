@@ -12,6 +12,8 @@
 #include "Sim/sceneObject.h"
 #include "terrain/terrData.h"
 #include "Collision/convex.h"
+#include "platform/profiler.h"
+#include "console/simParallel.h"
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -299,6 +301,7 @@ Convex::~Convex()
 
 void Convex::collectGarbage()
 {
+   SimSharedLock lock;
    // Delete unreferenced Convex Objects
    for (Convex* itr = mNext; itr != this; itr = itr->mNext) {
       if (itr->mReference.rLink.mNext == &itr->mReference) {
@@ -311,6 +314,7 @@ void Convex::collectGarbage()
 
 void Convex::nukeList()
 {
+   SimSharedLock lock;
    // Delete all Convex Objects
    for (Convex* itr = mNext; itr != this; itr = itr->mNext) {
       Convex* ptr = itr;
@@ -387,17 +391,32 @@ Box3F Convex::getBoundingBox(const MatrixF& mat, const Point3F& scale) const
 
 void Convex::addToWorkingList(Convex* ptr)
 {
+   SimSharedLock lock;
    CollisionWorkingList* cl = CollisionWorkingList::alloc();
    cl->wLinkAfter(&mWorking);
    cl->rLinkAfter(&ptr->mReference);
    cl->mConvex = ptr;
 };
 
+void Convex::removeFromWorkingList(SceneObject* obj)
+{
+   SimSharedLock lock;
+   for (CollisionWorkingList* itr = mWorking.wLink.mNext; itr != &mWorking; itr = itr->wLink.mNext) {
+      if (itr->mConvex->getObject() == obj) {
+         CollisionWorkingList* cl = itr;
+         itr = itr->wLink.mPrev;
+         cl->free();
+      }
+   }
+}
+
 
 //----------------------------------------------------------------------------
 
 void Convex::updateWorkingList(const Box3F& box, const U32 colMask)
 {
+   PROFILE_START(ConvexUpdateWorkingList);
+   SimSharedLock lock;
    sTag++;
 
    // Clear objects off the working list that are no longer intersecting
@@ -418,6 +437,7 @@ void Convex::updateWorkingList(const Box3F& box, const U32 colMask)
                                         SimpleQueryList::insertionCallback, U32(&sql));
    for (U32 i = 0; i < sql.mList.size(); i++)
       sql.mList[i]->buildConvex(box, this);
+   PROFILE_END();
 }
 
 // ---------------------------------------------------------------------------
@@ -436,6 +456,7 @@ void Convex::updateStateList(const MatrixF& mat, const Point3F& scale, const Poi
       box1.max.setMax(oldMin + *displacement);
       box1.max.setMax(oldMax + *displacement);
    }
+   SimSharedLock lock;
    sTag++;
 
    // Destroy states which are no longer intersecting
@@ -472,6 +493,8 @@ CollisionState* Convex::findClosestState(const MatrixF& mat, const Point3F& scal
 
    MatrixF axform = mat;
    axform.scale(scale);
+   MatrixF axforminv = axform;
+   axforminv.inverse();
    
    for (CollisionStateList* itr = mList.mNext; itr != &mList; itr = itr->mNext) {
       CollisionState* state = itr->mState;
@@ -480,7 +503,11 @@ CollisionState* Convex::findClosestState(const MatrixF& mat, const Point3F& scal
 
       MatrixF bxform = state->b->getTransform();
       bxform.scale(state->b->getScale());
-      F32 dd = state->distance(axform, bxform);
+      MatrixF bxforminv = bxform;
+      bxforminv.inverse();
+      if (gGJKRecordPairs)
+         gjkRecordPair(state, axform, bxform);
+      F32 dd = state->distance(axform, bxform, &axforminv, &bxforminv);
       if (dd < dist) {
          dist = dd;
          st = state;
@@ -523,6 +550,8 @@ CollisionState* Convex::findClosestStateBounded(const MatrixF& mat, const Point3
                               1.0f/bscale.z));
       temp.affineInverse();
       bxforminv.mul(temp);
+      if (gGJKRecordPairs)
+         gjkRecordPair(state, axform, bxform);
       F32 dd = state->distanceBounded(axform, bxform, dontCareDist, &axforminv, &bxforminv);
       if (dd < dist) {
          dist = dd;
@@ -540,6 +569,7 @@ CollisionState* Convex::findClosestStateBounded(const MatrixF& mat, const Point3
 
 bool Convex::getCollisionInfo(const MatrixF& mat, const Point3F& scale, CollisionList* cList,F32 tol)
 {
+   PROFILE_START(ConvexGetCollisionInfo);
    for (CollisionStateList* itr = mList.mNext; itr != &mList; itr = itr->mNext) {
       CollisionState* state = itr->mState;
       if (state->mLista != itr)
@@ -564,6 +594,7 @@ bool Convex::getCollisionInfo(const MatrixF& mat, const Point3F& scale, Collisio
          fa.collide(fb,cList,tol);
       }
    }
+   PROFILE_END();
    return (cList->count != 0);
 }
 
@@ -121,6 +121,8 @@ class Convex {
    void linkAfter(Convex* next);
    void unlink();
 
+   // The working and state lists (and the free lists behind them) are
+   // shared between objects, they're only changed under the shared lock.
    U32 mTag;
    static U32 sTag;
 
@@ -148,6 +150,7 @@ public:
    void render();
 
    void                  addToWorkingList(Convex* ptr);
+   void                  removeFromWorkingList(SceneObject* obj);
    CollisionWorkingList& getWorkingList() { return mWorking; }
 
    CollisionState* findClosestState(const MatrixF& mat, const Point3F& scale);
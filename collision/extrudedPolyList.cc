@@ -13,6 +13,10 @@
 #include "collision/polyhedron.h"
 #include "collision/collision.h"
 
+#if defined(__SSE__) || (defined(_MSC_VER) && (_MSC_VER >= 1300))
+#define EXTRUDED_POLY_LIST_SSE
+#include <xmmintrin.h>
+#endif
 
 const F32 sgFrontEpsilon = 0.01;
 
@@ -60,6 +64,90 @@ U32 U32leftShift[33] =
    U32(0) // one more for good measure
 };
 
+
+//----------------------------------------------------------------------------
+// Vertex plane masks
+//
+// The front planes (the even ones, planes come in pairs) are kept four at a
+// time as x, y, z and d.  A vertex gets bit i for front plane i if it's at
+// least sgFrontEpsilon in front of it, and bit i + 1 for its back plane
+// otherwise.  The distances are summed in the same order as distToPlane.
+
+// Front bits of four planes to plane mask bits
+static const U32 sFrontMaskBits[16] =
+{
+   0xAA, 0xA9, 0xA6, 0xA5, 0x9A, 0x99, 0x96, 0x95,
+   0x6A, 0x69, 0x66, 0x65, 0x5A, 0x59, 0x56, 0x55,
+};
+
+static U32 extrudedPlaneMask_C(const F32* planes, U32 numGroups, const Point3F& p)
+{
+   U32 mask = 0;
+   for (U32 g = 0; g < numGroups; g++, planes += 16) {
+      U32 front = 0;
+      for (U32 k = 0; k < 4; k++) {
+         F32 dist = (planes[k] * p.x + planes[4 + k] * p.y + planes[8 + k] * p.z) + planes[12 + k];
+         if (dist >= sgFrontEpsilon)
+            front |= 1 << k;
+      }
+      mask |= sFrontMaskBits[front] << (g * 8);
+   }
+   return mask;
+}
+
+#ifdef EXTRUDED_POLY_LIST_SSE
+static U32 extrudedPlaneMask_SSE(const F32* planes, U32 numGroups, const Point3F& p)
+{
+   __m128 x   = _mm_set1_ps(p.x);
+   __m128 y   = _mm_set1_ps(p.y);
+   __m128 z   = _mm_set1_ps(p.z);
+   __m128 eps = _mm_set1_ps(sgFrontEpsilon);
+
+   U32 mask = 0;
+   for (U32 g = 0; g < numGroups; g++, planes += 16) {
+      __m128 dist = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes),     x),
+                               _mm_mul_ps(_mm_loadu_ps(planes + 4), y));
+      dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(planes + 8), z));
+      dist = _mm_add_ps(dist, _mm_loadu_ps(planes + 12));
+      mask |= sFrontMaskBits[_mm_movemask_ps(_mm_cmpge_ps(dist, eps))] << (g * 8);
+   }
+   return mask;
+}
+#endif
+
+static U32 (*sExtrudedPlaneMask)(const F32* planes, U32 numGroups, const Point3F& p) = extrudedPlaneMask_C;
+static const char* sExtrudedKernelName = "C";
+
+void ExtrudedPolyList::installKernels(U32 properties)
+{
+   if (!properties)
+      properties = Platform::SystemInfo.processor.properties;
+   else
+      properties &= Platform::SystemInfo.processor.properties;
+
+   sExtrudedPlaneMask = extrudedPlaneMask_C;
+   sExtrudedKernelName = "C";
+
+#ifdef EXTRUDED_POLY_LIST_SSE
+   if (properties & CPU_PROP_SSE) {
+      sExtrudedPlaneMask = extrudedPlaneMask_SSE;
+      sExtrudedKernelName = "SSE";
+   }
+#endif
+}
+
+const char* ExtrudedPolyList::getKernelName()
+{
+   return sExtrudedKernelName;
+}
+
+
+//----------------------------------------------------------------------------
+
+// Distance the early out in end() gives away, for the clipped points that
+// land a little off the poly
+static const F32 sgEarlyOutSlack = 0.001;
+
 // Minimum distance from a face
 F32 ExtrudedPolyList::FaceEpsilon = 0.01;
 
@@ -73,12 +161,16 @@ ExtrudedPolyList::ExtrudedPolyList()
    VECTOR_SET_ASSOCIATION(mExtrudedList);
    VECTOR_SET_ASSOCIATION(mPlaneList);
    VECTOR_SET_ASSOCIATION(mPolyPlaneList);
+   VECTOR_SET_ASSOCIATION(mFrontPlanes);
 
    mVelocity.set(0,0,0);
    mIndexList.reserve(128);
    mVertexList.reserve(64);
    mPolyPlaneList.reserve(64);
    mPlaneList.reserve(64);
+   mFrontPlanes.reserve(64);
+   mFrontGroups = 0;
+   mPlaneMask = 0;
    mCollisionList = 0;
 }
 
@@ -151,6 +243,27 @@ void ExtrudedPolyList::extrude(const Polyhedron& pt, const VectorF& vector)
          ef2.planeMask |= pmask << 1;
       }
    }
+
+   // Front planes for the mask kernels.  The padding is never in front.
+   AssertFatal(mPlaneList.size() <= 32, "ExtrudedPolyList::extrude: too many planes");
+   U32 numFront = mPlaneList.size() / 2;
+   mFrontGroups = (numFront + 3) / 4;
+   mFrontPlanes.setSize(mFrontGroups * 16);
+   for (U32 i = 0; i < mFrontGroups * 4; i++) {
+      F32* group = &mFrontPlanes[(i / 4) * 16 + (i % 4)];
+      if (i < numFront) {
+         const PlaneF& plane = mPlaneList[i * 2];
+         group[0]  = plane.x;
+         group[4]  = plane.y;
+         group[8]  = plane.z;
+         group[12] = plane.d;
+      }
+      else {
+         group[0] = group[4] = group[8] = 0;
+         group[12] = -1;
+      }
+   }
+   mPlaneMask = (mPlaneList.size() < 32)? U32leftShift[mPlaneList.size()] - 1: 0xFFFFFFFF;
 }
 
 
@@ -185,7 +298,7 @@ void ExtrudedPolyList::adjustCollisionTime()
 
 //----------------------------------------------------------------------------
 
-U32 ExtrudedPolyList::addPoint(const Point3F& p)
+inline U32 ExtrudedPolyList::transformPoint(const Point3F& p)
 {
    mVertexList.increment();
    Vertex& v = mVertexList.last();
@@ -195,19 +308,26 @@ U32 ExtrudedPolyList::addPoint(const Point3F& p)
    v.point.z = p.z * mScale.z;
    mMatrix.mulP(v.point);
 
-   // Build the plane mask, planes come in pairs
-   v.mask = 0;
-   for (U32 i = 0; i < mPlaneList.size(); i += 2)
-   {
-      F32 dist = mPlaneList[i].distToPlane(v.point);
-      if (dist >= sgFrontEpsilon)
-         v.mask |= U32leftShift[i];   // U64(1) << i;
-      else
-         v.mask |= U32leftShift[i+1]; // U64(2) << i;
-   }
+   // Build the plane mask
+   v.mask = sExtrudedPlaneMask(mFrontPlanes.address(), mFrontGroups, v.point) & mPlaneMask;
    return mVertexList.size() - 1;
 }
 
+U32 ExtrudedPolyList::addPoint(const Point3F& p)
+{
+   return transformPoint(p);
+}
+
+U32 ExtrudedPolyList::addPoints(const Point3F* points, U32 count)
+{
+   AssertFatal(count != 0, "ExtrudedPolyList::addPoints: no points");
+   mVertexList.reserve(mVertexList.size() + count);
+   U32 base = transformPoint(points[0]);
+   for (U32 i = 1; i < count; i++)
+      transformPoint(points[i]);
+   return base;
+}
+
 
 U32 ExtrudedPolyList::addPlane(const PlaneF& plane)
 {
@@ -257,12 +377,44 @@ void ExtrudedPolyList::vertex(U32 vi)
    mIndexList.push_back(vi);
 }
 
+void ExtrudedPolyList::addPolys(U32 material, U32 count, const U32* numVerts, const U32* vertices,
+                                const U32* planes, const U32* /*surfaceKeys*/)
+{
+   mPoly.object = mCurrObject;
+   mPoly.material = material;
+   for (U32 i = 0; i < count; i++) {
+      const U32* poly = vertices;
+      vertices += numVerts[i];
+
+      if (planes[i] == PlaneFromVerts)
+         mPoly.plane.set(mVertexList[poly[0]].point,
+                         mVertexList[poly[1]].point,
+                         mVertexList[poly[2]].point);
+      else {
+         AssertFatal(planes[i] < mPolyPlaneList.size(), "Out of bounds index!");
+         mPoly.plane = mPolyPlaneList[planes[i]];
+      }
+
+      // Same test end() starts with, before the indices are copied
+      if (mCollisionList->count >= CollisionList::MaxCollisions)
+         return;
+      if (mDot(mPoly.plane, mNormalVelocity) > 0)
+         continue;
+
+      mIndexList.setSize(numVerts[i]);
+      dMemcpy(mIndexList.address(), poly, numVerts[i] * sizeof(U32));
+      ExtrudedPolyList::end();
+   }
+}
+
 void ExtrudedPolyList::end()
 {
    // Anything facing away from the mVelocity is rejected
    if (mCollisionList->count >= CollisionList::MaxCollisions ||
        mDot(mPoly.plane, mNormalVelocity) > 0)
       return;
+   if (mCollisionList->count && !canImprove())
+      return;
 
    // Test the mPoly against the planes each extruded face.
    U32 cFaceCount = 0;
@@ -338,6 +490,35 @@ void ExtrudedPolyList::end()
 }
 
 
+//----------------------------------------------------------------------------
+// Clipping only cuts the poly down, so nothing testPoly() finds on it is
+// closer to a face than the poly's own closest vertex.  If that's too far
+// along for every face, whichever face end() picks can't beat the time
+// already found.
+
+bool ExtrudedPolyList::canImprove()
+{
+   F32 maxTime = mCollisionList->t + EqualEpsilon;
+   ExtrudedFace* face = mExtrudedList.begin();
+   ExtrudedFace* end = mExtrudedList.end();
+   for (; face != end; face++) {
+      if (!face->active)
+         continue;
+
+      F32 bd = 1E30;
+      for (U32 i = 0; i < mIndexList.size(); i++) {
+         F32 dist = face->plane.distToPlane(mVertexList[mIndexList[i]].point);
+         if (dist < bd)
+            bd = dist;
+      }
+      bd -= sgEarlyOutSlack;
+      if (bd < face->maxDistance + FaceEpsilon && bd / face->maxDistance <= maxTime)
+         return true;
+   }
+   return false;
+}
+
+
 //----------------------------------------------------------------------------
 
 bool ExtrudedPolyList::testPoly(ExtrudedFace& face)
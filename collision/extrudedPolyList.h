@@ -62,6 +62,9 @@ public:
    IndexList    mIndexList;
    ExtrudedList mExtrudedList;
    PlaneList    mPlaneList;
+   Vector<F32>  mFrontPlanes;    // even planes of mPlaneList, x, y, z and d four at a time
+   U32          mFrontGroups;
+   U32          mPlaneMask;      // a bit for each plane in mPlaneList
    VectorF      mVelocity;
    VectorF      mNormalVelocity;
    F32          mFaceShift;
@@ -75,6 +78,8 @@ public:
    //
 private:
    bool testPoly(ExtrudedFace&);
+   bool canImprove();
+   U32  transformPoint(const Point3F& p);
 
 public:
    ExtrudedPolyList();
@@ -85,10 +90,16 @@ public:
    void adjustCollisionTime();
    void render();
 
+   static void installKernels(U32 properties = 0);
+   static const char* getKernelName();
+
    // Virtual methods
    bool isEmpty() const;
    U32  addPoint(const Point3F& p);
    U32  addPlane(const PlaneF& plane);
+   U32  addPoints(const Point3F* points, U32 count);
+   void addPolys(U32 material, U32 count, const U32* numVerts, const U32* vertices,
+                 const U32* planes, const U32* /*surfaceKeys*/);
    void begin(U32 material, U32 /*surfaceKey*/);
    void plane(U32 v1,U32 v2,U32 v3);
    void plane(const PlaneF& p);
@@ -13,6 +13,15 @@
 #include "terrain/terrData.h"
 #include "Collision/convex.h"
 #include "Collision/gjk.h"
+#include "Collision/boxConvex.h"
+#include "console/console.h"
+#include "console/simParallel.h"
+#include "math/mRandom.h"
+
+#if defined(__SSE__) || (defined(_MSC_VER) && (_MSC_VER >= 1300))
+#define GJK_SUPPORT_SSE
+#include <xmmintrin.h>
+#endif
 
 
 //----------------------------------------------------------------------------
@@ -315,61 +324,137 @@ bool CollisionState::intersect(const MatrixF& a2w,
 
 //----------------------------------------------------------------------------
 
-F32 CollisionState::distance(const MatrixF& a2w,
-                             const MatrixF& b2w)
+//----------------------------------------------------------------------------
+// The distance loop, specialized on the support functions at compile time.
+// Box and terrain convexes get theirs inlined, everything else goes through
+// the virtual Convex::support.
+
+struct GJKVirtualSupport
 {
-   num_iterations = 0;
-   MatrixF w2a,w2b;
-   w2a = a2w;
-   w2b = b2w;
-   w2a.inverse();
-   w2b.inverse();
-   reset(a2w,b2w);
-   bits = 0;
-   all_bits = 0;
+   const Convex* convex;
+   GJKVirtualSupport(const Convex* c): convex(c) {}
+   Point3F operator()(const VectorF& v) const { return convex->support(v); }
+};
+
+struct GJKBoxSupport
+{
+   const BoxConvex* convex;
+   GJKBoxSupport(const Convex* c): convex(static_cast<const BoxConvex*>(c)) {}
+   Point3F operator()(const VectorF& v) const { return convex->supportInline(v); }
+};
+
+struct GJKTerrainSupport
+{
+   const TerrainConvex* convex;
+   GJKTerrainSupport(const Convex* c): convex(static_cast<const TerrainConvex*>(c)) {}
+   Point3F operator()(const VectorF& v) const { return convex->supportInline(v); }
+};
+
+template <class SupportA, class SupportB>
+static F32 gjkDistance(CollisionState* s, const SupportA& supportA, const SupportB& supportB,
+                       const MatrixF& a2w, const MatrixF& b2w,
+                       const MatrixF& w2a, const MatrixF& w2b,
+                       const F32 dontCareDist)
+{
+   // The loop limit is kept locally, this can run on several threads
+   // (see ProcessList::advanceIslands).
+   S32 iterations = 0;
+
+   VectorF zero(0,0,0),sa,sb;
+   a2w.mulP(supportA(zero),&sa);
+   b2w.mulP(supportB(zero),&sb);
+   s->v = sa - sb;
+   s->dist = s->v.len();
+   s->bits = 0;
+   s->all_bits = 0;
    F32 mu = 0;
 
    do {
-      nextBit();
+      s->nextBit();
 
-      VectorF va,sa;
-      w2a.mulV(-v,&va);
-      p[last] = a->support(va);
-      a2w.mulP(p[last],&sa);
+      VectorF va;
+      w2a.mulV(-s->v,&va);
+      s->p[s->last] = supportA(va);
+      a2w.mulP(s->p[s->last],&sa);
 
-      VectorF vb,sb;
-      w2b.mulV(v,&vb);
-      q[last] = b->support(vb);
-      b2w.mulP(q[last],&sb);
+      VectorF vb;
+      w2b.mulV(s->v,&vb);
+      s->q[s->last] = supportB(vb);
+      b2w.mulP(s->q[s->last],&sb);
 
       VectorF w = sa - sb;
-      F32 nm = mDot(v, w) / dist;
+      F32 nm = mDot(s->v, w) / s->dist;
       if (nm > mu)
          mu = nm;
-      if (mFabs(dist - mu) <= dist * rel_error)
-         return dist;
+      if (mu > dontCareDist)
+         return mu;
+      if (mFabs(s->dist - mu) <= s->dist * rel_error)
+         return s->dist;
 
-      ++num_iterations;
-      if (degenerate(w) || num_iterations > 100) {
+      ++iterations;
+      if (s->degenerate(w) || iterations > 100) {
          ++num_irregularities;
-         return dist;
+         return s->dist;
       }
 
-      y[last] = w;
-      all_bits = bits | last_bit;
+      s->y[s->last] = w;
+      s->all_bits = s->bits | s->last_bit;
 
-      if (!closest(v)) {
+      if (!s->closest(s->v)) {
          ++num_irregularities;
-         return dist;
+         return s->dist;
       }
 
-      dist = v.len();
+      s->dist = s->v.len();
+   }
+   while (s->bits < 15 && s->dist > sTolerance) ;
+
+   num_iterations = iterations;
+   if (s->bits == 15 && mu <= 0)
+      s->dist = 0;
+   return s->dist;
+}
+
+template <class SupportA>
+static F32 gjkDistanceB(CollisionState* s, const SupportA& supportA,
+                        const MatrixF& a2w, const MatrixF& b2w,
+                        const MatrixF& w2a, const MatrixF& w2b,
+                        const F32 dontCareDist)
+{
+   switch (s->b->getType()) {
+      case BoxConvexType:
+         return gjkDistance(s, supportA, GJKBoxSupport(s->b), a2w, b2w, w2a, w2b, dontCareDist);
+      case TerrainConvexType:
+         return gjkDistance(s, supportA, GJKTerrainSupport(s->b), a2w, b2w, w2a, w2b, dontCareDist);
+      default:
+         return gjkDistance(s, supportA, GJKVirtualSupport(s->b), a2w, b2w, w2a, w2b, dontCareDist);
+   }
+}
+
+static F32 gjkDistanceAB(CollisionState* s,
+                         const MatrixF& a2w, const MatrixF& b2w,
+                         const MatrixF& w2a, const MatrixF& w2b,
+                         const F32 dontCareDist)
+{
+   switch (s->a->getType()) {
+      case BoxConvexType:
+         return gjkDistanceB(s, GJKBoxSupport(s->a), a2w, b2w, w2a, w2b, dontCareDist);
+      case TerrainConvexType:
+         return gjkDistanceB(s, GJKTerrainSupport(s->a), a2w, b2w, w2a, w2b, dontCareDist);
+      default:
+         return gjkDistanceB(s, GJKVirtualSupport(s->a), a2w, b2w, w2a, w2b, dontCareDist);
    }
-   while (bits < 15 && dist > sTolerance) ;
+}
+
 
-   if (bits == 15 && mu <= 0)
-      dist = 0;
-   return dist;
+//----------------------------------------------------------------------------
+
+F32 CollisionState::distance(const MatrixF& a2w,
+                             const MatrixF& b2w,
+                             const MatrixF* _w2a,
+                             const MatrixF* _w2b)
+{
+   return distanceBounded(a2w, b2w, 1E30, _w2a, _w2b);
 }
 
 
@@ -379,68 +464,16 @@ F32 CollisionState::distanceBounded(const MatrixF& a2w,
                                     const MatrixF* _w2a,
                                     const MatrixF* _w2b)
 {
-   num_iterations = 0;
-   MatrixF w2a,w2b;
    if (_w2a == NULL || _w2b == NULL)
    {
+      MatrixF w2a,w2b;
       w2a = a2w;
       w2b = b2w;
       w2a.inverse();
       w2b.inverse();
+      return gjkDistanceAB(this, a2w, b2w, w2a, w2b, dontCareDist);
    }
-   else
-   {
-      w2a = *_w2a;
-      w2b = *_w2b;
-   }
-   reset(a2w,b2w);
-   bits = 0;
-   all_bits = 0;
-   F32 mu = 0;
-
-   do {
-      nextBit();
-
-      VectorF va,sa;
-      w2a.mulV(-v,&va);
-      p[last] = a->support(va);
-      a2w.mulP(p[last],&sa);
-
-      VectorF vb,sb;
-      w2b.mulV(v,&vb);
-      q[last] = b->support(vb);
-      b2w.mulP(q[last],&sb);
-
-      VectorF w = sa - sb;
-      F32 nm = mDot(v, w) / dist;
-      if (nm > mu)
-         mu = nm;
-      if (mu > dontCareDist)
-         return mu;
-      if (mFabs(dist - mu) <= dist * rel_error)
-         return dist;
-
-      ++num_iterations;
-      if (degenerate(w) || num_iterations > 100) {
-         ++num_irregularities;
-         return dist;
-      }
-
-      y[last] = w;
-      all_bits = bits | last_bit;
-
-      if (!closest(v)) {
-         ++num_irregularities;
-         return dist;
-      }
-
-      dist = v.len();
-   }
-   while (bits < 15 && dist > sTolerance) ;
-
-   if (bits == 15 && mu <= 0)
-      dist = 0;
-   return dist;
+   return gjkDistanceAB(this, a2w, b2w, *_w2a, *_w2b, dontCareDist);
 }
 
 
@@ -498,3 +531,341 @@ void CollisionState::render()
 
    glEnd();
 }   
+
+
+//----------------------------------------------------------------------------
+// Support kernels
+//----------------------------------------------------------------------------
+
+static U32 gjkSupportIndex_C(const F32* soa, U32 count, const VectorF& v)
+{
+   AssertFatal(count, "gjkSupportIndex: empty vertex cloud");
+   const F32* xs = soa;
+   const F32* ys = soa + count;
+   const F32* zs = soa + count * 2;
+
+   F32 best = xs[0] * v.x + ys[0] * v.y + zs[0] * v.z;
+   U32 index = 0;
+   for (U32 i = 1; i < count; i++) {
+      F32 dp = xs[i] * v.x + ys[i] * v.y + zs[i] * v.z;
+      if (dp > best) {
+         best = dp;
+         index = i;
+      }
+   }
+   return index;
+}
+
+#ifdef GJK_SUPPORT_SSE
+static U32 gjkSupportIndex_SSE(const F32* soa, U32 count, const VectorF& v)
+{
+   AssertFatal(count && !(count & 3), "gjkSupportIndex: bad vertex count");
+   const F32* xs = soa;
+   const F32* ys = soa + count;
+   const F32* zs = soa + count * 2;
+
+   __m128 vx = _mm_set1_ps(v.x);
+   __m128 vy = _mm_set1_ps(v.y);
+   __m128 vz = _mm_set1_ps(v.z);
+
+   // Each lane keeps its first maximum, indices are kept as floats so
+   // plain SSE can select them.
+   __m128 index = _mm_set_ps(3, 2, 1, 0);
+   __m128 step = _mm_set1_ps(4);
+   __m128 best = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs), vx),
+                                       _mm_mul_ps(_mm_loadu_ps(ys), vy)),
+                            _mm_mul_ps(_mm_loadu_ps(zs), vz));
+   __m128 bestIndex = index;
+   for (U32 i = 4; i < count; i += 4) {
+      index = _mm_add_ps(index, step);
+      __m128 dp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs + i), vx),
+                                        _mm_mul_ps(_mm_loadu_ps(ys + i), vy)),
+                             _mm_mul_ps(_mm_loadu_ps(zs + i), vz));
+      __m128 gt = _mm_cmpgt_ps(dp, best);
+      best = _mm_or_ps(_mm_and_ps(gt, dp), _mm_andnot_ps(gt, best));
+      bestIndex = _mm_or_ps(_mm_and_ps(gt, index), _mm_andnot_ps(gt, bestIndex));
+   }
+
+   // Across the lanes ties go to the lowest index, like the linear scan
+   F32 dots[4], indices[4];
+   _mm_storeu_ps(dots, best);
+   _mm_storeu_ps(indices, bestIndex);
+   U32 lane = 0;
+   for (U32 j = 1; j < 4; j++)
+      if (dots[j] > dots[lane] || (dots[j] == dots[lane] && indices[j] < indices[lane]))
+         lane = j;
+   return U32(indices[lane]);
+}
+#endif
+
+U32 (*gjkSupportIndex)(const F32* soa, U32 count, const VectorF& v) = gjkSupportIndex_C;
+static const char* sGJKKernelName = "C";
+
+void gjkInstallKernels(U32 properties)
+{
+   if (!properties)
+      properties = Platform::SystemInfo.processor.properties;
+   else
+      properties &= Platform::SystemInfo.processor.properties;
+
+   gjkSupportIndex = gjkSupportIndex_C;
+   sGJKKernelName = "C";
+
+#ifdef GJK_SUPPORT_SSE
+   if (properties & CPU_PROP_SSE) {
+      gjkSupportIndex = gjkSupportIndex_SSE;
+      sGJKKernelName = "SSE";
+   }
+#endif
+}
+
+const char* gjkGetKernelName()
+{
+   return sGJKKernelName;
+}
+
+
+//----------------------------------------------------------------------------
+// Pair recording and benchmark
+//
+// gjkRecordPairs(n) captures the next n pairs Convex::findClosestState
+// looks at, each convex as the cloud of points its support function
+// returns over a fixed set of directions (all of them for boxes and
+// terrain, the outline for shape hulls).  gjkBenchmark runs the distance
+// loop over the recorded pairs the old way, a linear support scan behind a
+// virtual call, and through the SoA kernel.  Without a recording it makes
+// up random pairs.
+//----------------------------------------------------------------------------
+
+struct GJKRecordedPair
+{
+   U32 start[2];
+   U32 count[2];
+   MatrixF xform[2];
+};
+
+static Vector<GJKRecordedPair> sRecordedPairs;
+static Vector<Point3F> sRecordedVerts;
+static Vector<VectorF> sRecordDirections;
+U32 gGJKRecordPairs = 0;
+
+static void buildRecordDirections()
+{
+   S32 x, y, z;
+   for (x = -1; x <= 1; x++)
+      for (y = -1; y <= 1; y++)
+         for (z = -1; z <= 1; z++)
+            if (x || y || z)
+               sRecordDirections.push_back(VectorF(F32(x), F32(y), F32(z)));
+
+   // and a spiral over the sphere
+   const U32 spiral = 100;
+   for (U32 i = 0; i < spiral; i++) {
+      F32 dz = 1 - (2 * i + 1) / F32(spiral);
+      F32 r = mSqrt(1 - dz * dz);
+      F32 angle = i * 2.39996323f;
+      sRecordDirections.push_back(VectorF(r * mCos(angle), r * mSin(angle), dz));
+   }
+}
+
+static void recordCloud(Convex* convex, U32* start, U32* count)
+{
+   *start = sRecordedVerts.size();
+   for (U32 i = 0; i < sRecordDirections.size(); i++) {
+      Point3F p = convex->support(sRecordDirections[i]);
+      U32 j;
+      for (j = *start; j < sRecordedVerts.size(); j++)
+         if (sRecordedVerts[j] == p)
+            break;
+      if (j == sRecordedVerts.size())
+         sRecordedVerts.push_back(p);
+   }
+   *count = sRecordedVerts.size() - *start;
+}
+
+void gjkRecordPair(CollisionState* state, const MatrixF& a2w, const MatrixF& b2w)
+{
+   // only lock when recording, this is on every GJK call
+   if (!gGJKRecordPairs)
+      return;
+   SimSharedLock lock;
+   if (!gGJKRecordPairs)
+      return;
+   gGJKRecordPairs--;
+
+   if (!sRecordDirections.size())
+      buildRecordDirections();
+
+   sRecordedPairs.increment();
+   GJKRecordedPair& pair = sRecordedPairs.last();
+   recordCloud(state->a, &pair.start[0], &pair.count[0]);
+   recordCloud(state->b, &pair.start[1], &pair.count[1]);
+   pair.xform[0] = a2w;
+   pair.xform[1] = b2w;
+
+   if (!gGJKRecordPairs)
+      Con::printf("gjkRecordPairs: recorded %d pairs", sRecordedPairs.size());
+}
+
+ConsoleFunction(gjkRecordPairs, void, 2, 2, "gjkRecordPairs(count);")
+{
+   SimSharedLock lock;
+   sRecordedPairs.clear();
+   sRecordedVerts.clear();
+   gGJKRecordPairs = getMax(dAtoi(argv[1]), 0);
+}
+
+
+//----------------------------------------------------------------------------
+
+class GJKCloudConvex: public Convex
+{
+  public:
+   const Point3F* mVerts;
+   U32 mCount;
+
+   // The same scan ShapeBaseConvex::support used to do
+   Point3F support(const VectorF& v) const {
+      F32 currMaxDP = mDot(mVerts[0], v);
+      U32 index = 0;
+      for (U32 i = 1; i < mCount; i++) {
+         F32 dp = mDot(mVerts[i], v);
+         if (dp > currMaxDP) {
+            currMaxDP = dp;
+            index = i;
+         }
+      }
+      return mVerts[index];
+   }
+};
+
+struct GJKCloudSupport
+{
+   const Point3F* verts;
+   const F32* soa;
+   U32 count;
+   GJKCloudSupport(const Point3F* v, const F32* s, U32 c): verts(v), soa(s), count(c) {}
+   Point3F operator()(const VectorF& v) const { return verts[gjkSupportIndex(soa, count, v)]; }
+};
+
+static void makeBenchmarkPairs()
+{
+   MRandomLCG random(0x61f3c9);
+   for (U32 i = 0; i < 512; i++) {
+      sRecordedPairs.increment();
+      GJKRecordedPair& pair = sRecordedPairs.last();
+      for (U32 k = 0; k < 2; k++) {
+         // hull sized clouds, a vehicle against the ground or another hull
+         pair.start[k] = sRecordedVerts.size();
+         pair.count[k] = random.randI(8, 48);
+         Point3F size(random.randF(0.5f, 4), random.randF(0.5f, 4), random.randF(0.5f, 2));
+         for (U32 j = 0; j < pair.count[k]; j++) {
+            VectorF d(random.randF(-1, 1), random.randF(-1, 1), random.randF(-1, 1));
+            d.normalizeSafe();
+            d.convolve(size);
+            sRecordedVerts.push_back(d);
+         }
+
+         EulerF rot(random.randF(0, M_2PI), random.randF(0, M_2PI), random.randF(0, M_2PI));
+         pair.xform[k].set(rot);
+         pair.xform[k].setColumn(3, k ? Point3F(random.randF(-6, 6), random.randF(-6, 6), random.randF(-3, 3))
+                                      : Point3F(0, 0, 0));
+      }
+   }
+}
+
+ConsoleFunction(gjkBenchmark, void, 1, 2, "gjkBenchmark(<iterations>);")
+{
+   U32 iterations = argc > 1 ? getMax(dAtoi(argv[1]), 1) : 100;
+
+   bool recorded = sRecordedPairs.size() != 0 && !gGJKRecordPairs;
+   if (!recorded) {
+      if (gGJKRecordPairs)
+         Con::printf("gjkBenchmark: recording still in progress, using random pairs");
+      gGJKRecordPairs = 0;
+      sRecordedPairs.clear();
+      sRecordedVerts.clear();
+      makeBenchmarkPairs();
+   }
+
+   // SoA copies of the clouds
+   U32 numPairs = sRecordedPairs.size();
+   Vector<U32> soaStart, soaCount;
+   Vector<F32> soa;
+   soaStart.setSize(numPairs * 2);
+   soaCount.setSize(numPairs * 2);
+   U32 i, k;
+   for (i = 0; i < numPairs; i++) {
+      for (k = 0; k < 2; k++) {
+         const GJKRecordedPair& pair = sRecordedPairs[i];
+         U32 count = pair.count[k];
+         U32 padded = (count + 3) & ~3;
+         soaStart[i * 2 + k] = soa.size();
+         soaCount[i * 2 + k] = padded;
+         soa.setSize(soa.size() + padded * 3);
+         F32* dst = soa.address() + soaStart[i * 2 + k];
+         for (U32 j = 0; j < padded; j++) {
+            const Point3F& p = sRecordedVerts[pair.start[k] + getMin(j, count - 1)];
+            dst[j] = p.x;
+            dst[j + padded] = p.y;
+            dst[j + padded * 2] = p.z;
+         }
+      }
+   }
+
+   Vector<MatrixF> inverses;
+   inverses.setSize(numPairs * 2);
+   for (i = 0; i < numPairs * 2; i++) {
+      inverses[i] = sRecordedPairs[i >> 1].xform[i & 1];
+      inverses[i].inverse();
+   }
+
+   Vector<F32> oldDist, newDist;
+   oldDist.setSize(numPairs);
+   newDist.setSize(numPairs);
+   CollisionState state;
+   GJKCloudConvex ca, cb;
+
+   U32 startTime = Platform::getRealMilliseconds();
+   for (U32 n = 0; n < iterations; n++) {
+      for (i = 0; i < numPairs; i++) {
+         const GJKRecordedPair& pair = sRecordedPairs[i];
+         ca.mVerts = &sRecordedVerts[pair.start[0]];
+         ca.mCount = pair.count[0];
+         cb.mVerts = &sRecordedVerts[pair.start[1]];
+         cb.mCount = pair.count[1];
+         const Convex* a = &ca;
+         const Convex* b = &cb;
+         oldDist[i] = gjkDistance(&state, GJKVirtualSupport(a), GJKVirtualSupport(b),
+                                  pair.xform[0], pair.xform[1],
+                                  inverses[i * 2], inverses[i * 2 + 1], 1E30);
+      }
+   }
+   U32 oldTime = Platform::getRealMilliseconds() - startTime;
+
+   startTime = Platform::getRealMilliseconds();
+   for (U32 m = 0; m < iterations; m++) {
+      for (i = 0; i < numPairs; i++) {
+         const GJKRecordedPair& pair = sRecordedPairs[i];
+         GJKCloudSupport sa(&sRecordedVerts[pair.start[0]], &soa[soaStart[i * 2]], soaCount[i * 2]);
+         GJKCloudSupport sb(&sRecordedVerts[pair.start[1]], &soa[soaStart[i * 2 + 1]], soaCount[i * 2 + 1]);
+         newDist[i] = gjkDistance(&state, sa, sb, pair.xform[0], pair.xform[1],
+                                  inverses[i * 2], inverses[i * 2 + 1], 1E30);
+      }
+   }
+   U32 newTime = Platform::getRealMilliseconds() - startTime;
+
+   U32 mismatches = 0;
+   F32 maxDelta = 0;
+   for (i = 0; i < numPairs; i++) {
+      F32 delta = mFabs(oldDist[i] - newDist[i]);
+      maxDelta = getMax(maxDelta, delta);
+      if (delta > 1E-4)
+         mismatches++;
+   }
+
+   Con::printf("gjkBenchmark: %d %s pairs x %d, %d mismatches, max distance delta %g",
+               numPairs, recorded ? "recorded" : "random", iterations, mismatches, maxDelta);
+   Con::printf("   virtual support: %d ms, SoA support (%s): %d ms",
+               oldTime, gjkGetKernelName(), newTime);
+}
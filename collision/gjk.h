@@ -62,11 +62,27 @@ struct CollisionState
    void getCollisionInfo(const MatrixF& mat, Collision* info);
    void getClosestPoints(Point3F& p1, Point3F& p2);
    bool intersect(const MatrixF& a2w, const MatrixF& b2w);
-   F32 distance(const MatrixF& a2w, const MatrixF& b2w);
+   F32 distance(const MatrixF& a2w, const MatrixF& b2w,
+                const MatrixF* w2a = NULL, const MatrixF* _w2b = NULL);
    F32 distanceBounded(const MatrixF& a2w, const MatrixF& b2w, const F32 dontCareDist,
                        const MatrixF* w2a = NULL, const MatrixF* _w2b = NULL);
    void render();
 };
 
 
+//----------------------------------------------------------------------------
+// Support search over a vertex cloud stored as structure of arrays: count
+// x's, then count y's, then count z's, with count padded to a multiple of
+// four using copies of the last vertex.  Returns the first vertex with the
+// largest dot product, the one a linear scan finds.
+
+extern U32 (*gjkSupportIndex)(const F32* soa, U32 count, const VectorF& v);
+void gjkInstallKernels(U32 properties = 0);
+const char* gjkGetKernelName();
+
+// Pair recording for gjkBenchmark (see gjkRecordPairs)
+extern U32 gGJKRecordPairs;
+void gjkRecordPair(CollisionState* state, const MatrixF& a2w, const MatrixF& b2w);
+
+
 #endif
@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "Collision/sweepBatch.h"
+#include "Sim/sceneObject.h"
+#include "console/console.h"
+#include "console/simParallel.h"
+#include "platform/profiler.h"
+
+//----------------------------------------------------------------------------
+
+SweepBatch::SweepBatch()
+{
+   mContainer = NULL;
+   mRegisterMask = 0;
+   mMask = 0;
+   mOpen = false;
+   mInvalid = false;
+   mStats.clear();
+   VECTOR_SET_ASSOCIATION(mRegistered);
+   VECTOR_SET_ASSOCIATION(mSweeps);
+   VECTOR_SET_ASSOCIATION(mSweepBoxes);
+   VECTOR_SET_ASSOCIATION(mObjects);
+   VECTOR_SET_ASSOCIATION(mCandidates);
+   VECTOR_SET_ASSOCIATION(mMoved);
+}
+
+S32 SweepBatch::addSweep(const Point3F& start, const Point3F& end, U32 mask)
+{
+   AssertFatal(!mOpen, "SweepBatch::addSweep: batch is open");
+
+   // The tree finds boxes by U16
+   if (mSweeps.size() >= 65536)
+      return -1;
+
+   mSweeps.increment();
+   Sweep& sweep = mSweeps.last();
+   sweep.start = start;
+   sweep.end   = end;
+   sweep.mask  = mask;
+   sweep.first = 0;
+   sweep.count = 0;
+
+   mSweepBoxes.increment();
+   Box3F& box = mSweepBoxes.last();
+   box.min.set(getMin(start.x, end.x), getMin(start.y, end.y), getMin(start.z, end.z));
+   box.max.set(getMax(start.x, end.x), getMax(start.y, end.y), getMax(start.z, end.z));
+
+   mMask |= mask;
+   return mSweeps.size() - 1;
+}
+
+
+//----------------------------------------------------------------------------
+
+void SweepBatch::setRegisterMask(U32 mask)
+{
+   // Only place the container is walked, sweeps of a new type don't come
+   // along often.
+   mRegisterMask = mask;
+   mRegistered.clear();
+   for (Container::Link* itr = mContainer->mStart.next; itr != &mContainer->mEnd; itr = itr->next) {
+      SceneObject* object = static_cast<SceneObject*>(itr);
+      if (object->getType() & mRegisterMask)
+         mRegistered.push_back(object);
+   }
+}
+
+void SweepBatch::begin()
+{
+   AssertFatal(mContainer != NULL, "SweepBatch::begin: no container");
+   AssertFatal(!mOpen, "SweepBatch::begin: already open");
+
+   mObjects.clear();
+   mCandidates.clear();
+   mMoved.clear();
+   mInvalid = false;
+   if (!mSweeps.size())
+      return;
+
+   PROFILE_START(SweepBatchBegin);
+   SimSharedLock lock;
+   mStats.ticks++;
+   mStats.sweeps += mSweeps.size();
+   mTree.build(mSweepBoxes);
+
+   Box3F bounds = mSweepBoxes[0];
+   U32 i;
+   for (i = 1; i < mSweepBoxes.size(); i++) {
+      bounds.min.setMin(mSweepBoxes[i].min);
+      bounds.max.setMax(mSweepBoxes[i].max);
+   }
+
+   if (mMask & ~mRegisterMask)
+      setRegisterMask(mRegisterMask | mMask);
+
+   // One pass over the registered objects.  Objects that can't collide
+   // right now are taken as well, they may be enabled by the time a cast
+   // is made.
+   U16* hits = (U16*) ContainerQueryContext::getCurrent()->getScratch(mSweeps.size() * sizeof(U16));
+   Vector<U32> pairSweeps, pairObjects;
+   for (i = 0; i < mRegistered.size(); i++) {
+      SceneObject* object = mRegistered[i];
+      U32 type = object->getType();
+      const Box3F& box = object->getWorldBox();
+      if (!(type & mMask) || !box.isOverlapped(bounds))
+         continue;
+
+      U32 numHits = mTree.findBoxes(box, hits);
+      if (!numHits)
+         continue;
+
+      for (U32 j = 0; j < numHits; j++) {
+         Sweep& sweep = mSweeps[hits[j]];
+         if (type & sweep.mask) {
+            sweep.count++;
+            pairSweeps.push_back(hits[j]);
+            pairObjects.push_back(mObjects.size());
+         }
+      }
+      mObjects.push_back(object);
+   }
+
+   // Candidates by sweep, in registration order
+   U32 first = 0;
+   for (i = 0; i < mSweeps.size(); i++) {
+      mSweeps[i].first = first;
+      first += mSweeps[i].count;
+      mSweeps[i].count = 0;
+   }
+   mCandidates.setSize(first);
+   for (i = 0; i < pairSweeps.size(); i++) {
+      Sweep& sweep = mSweeps[pairSweeps[i]];
+      mCandidates[sweep.first + sweep.count++] = pairObjects[i];
+   }
+   mStats.candidates += mCandidates.size();
+
+   mOpen = true;
+   PROFILE_END();
+}
+
+void SweepBatch::end()
+{
+   mOpen = false;
+   mSweeps.clear();
+   mSweepBoxes.clear();
+   mObjects.clear();
+   mCandidates.clear();
+   mMoved.clear();
+   mMask = 0;
+}
+
+
+//----------------------------------------------------------------------------
+
+bool SweepBatch::castObject(SceneObject* object, const Point3F& start, const Point3F& end,
+                            U32 mask, U32 slot, U32 seqKey, F32* currentT, RayInfo* info)
+{
+   // Same tests as Container::castRay, on the object as it is now
+   if (object->getContainerSeqKey(slot) == seqKey)
+      return false;
+   object->setContainerSeqKey(seqKey, slot);
+
+   if ((object->getType() & mask) == 0         ||
+       object->isCollisionEnabled() == false   ||
+       object->getContainer() != mContainer    ||
+       !object->getWorldBox().collideLine(start, end))
+      return false;
+
+   Point3F xformedStart, xformedEnd;
+   object->getWorldTransform().mulP(start, &xformedStart);
+   object->getWorldTransform().mulP(end,   &xformedEnd);
+   xformedStart.convolveInverse(object->getScale());
+   xformedEnd.convolveInverse(object->getScale());
+   mStats.objectCasts++;
+
+   RayInfo ri;
+   if (object->castRay(xformedStart, xformedEnd, &ri) && ri.t < *currentT) {
+      *info = ri;
+      info->point.interpolate(start, end, info->t);
+      *currentT = ri.t;
+      return true;
+   }
+   return false;
+}
+
+bool SweepBatch::castRay(S32 index, const Point3F& start, const Point3F& end, U32 mask, RayInfo* info)
+{
+   ContainerQueryContext* context = ContainerQueryContext::getCurrent();
+   if (!mOpen || mInvalid || index < 0 || index >= mSweeps.size() ||
+       !context->isMainContext() ||
+       mSweeps[index].start != start || mSweeps[index].end != end ||
+       (mask & ~mSweeps[index].mask) != 0) {
+      mStats.fallbacks++;
+      return mContainer->castRay(start, end, mask, info);
+   }
+
+   PROFILE_START(SweepBatchCastRay);
+   SimSharedLock lock;
+   mStats.casts++;
+   const U32 slot   = context->getSlot();
+   const U32 seqKey = context->nextSeqKey();
+   F32 currentT = 2.0;
+
+   const Sweep& sweep = mSweeps[index];
+   U32 i;
+   for (i = 0; i < sweep.count; i++) {
+      SceneObject* object = mObjects[mCandidates[sweep.first + i]];
+      if (object != NULL)
+         castObject(object, start, end, mask, slot, seqKey, &currentT, info);
+   }
+   for (i = 0; i < mMoved.size(); i++)
+      castObject(mMoved[i], start, end, mask, slot, seqKey, &currentT, info);
+
+   PROFILE_END();
+   return currentT != 2;
+}
+
+
+//----------------------------------------------------------------------------
+
+void SweepBatch::objectAdded(SceneObject* object)
+{
+   if (object->getType() & mRegisterMask)
+      mRegistered.push_back(object);
+   objectMoved(object);
+}
+
+void SweepBatch::objectMoved(SceneObject* object)
+{
+   if (!mOpen || !(object->getType() & mMask))
+      return;
+
+   // Island ticks move objects on the process threads, the casts can't
+   // keep up with that.
+   if (!ContainerQueryContext::getCurrent()->isMainContext()) {
+      mInvalid = true;
+      return;
+   }
+
+   for (U32 i = 0; i < mMoved.size(); i++)
+      if (mMoved[i] == object)
+         return;
+   mMoved.push_back(object);
+   mStats.moved++;
+}
+
+void SweepBatch::objectRemoved(SceneObject* object)
+{
+   U32 i;
+   if (object->getType() & mRegisterMask)
+      for (i = 0; i < mRegistered.size(); i++)
+         if (mRegistered[i] == object) {
+            mRegistered.erase_fast(i);
+            break;
+         }
+
+   if (!mOpen || !(object->getType() & mMask))
+      return;
+   if (!ContainerQueryContext::getCurrent()->isMainContext()) {
+      mInvalid = true;
+      return;
+   }
+
+   for (i = 0; i < mObjects.size(); i++)
+      if (mObjects[i] == object) {
+         mObjects[i] = NULL;
+         break;
+      }
+   for (i = 0; i < mMoved.size(); i++)
+      if (mMoved[i] == object) {
+         mMoved.erase_fast(i);
+         break;
+      }
+}
+
+
+void SweepBatch::objectTypeChanged(SceneObject* object)
+{
+   // damage changes player types on the process threads
+   SimSharedLock lock;
+   U32 i;
+   for (i = 0; i < mRegistered.size(); i++)
+      if (mRegistered[i] == object)
+         break;
+   bool registered = i != mRegistered.size();
+   if (registered && !(object->getType() & mRegisterMask))
+      mRegistered.erase_fast(i);
+   else if (!registered && (object->getType() & mRegisterMask))
+      mRegistered.push_back(object);
+}
+
+
+//----------------------------------------------------------------------------
+
+void SweepBatch::dumpStats(const char* name, bool reset)
+{
+   U32 ticks = getMax(mStats.ticks, U32(1));
+   U32 casts = getMax(mStats.casts, U32(1));
+   Con::printf("%s sweep batch: %d ticks, %.1f sweeps per tick, %d objects registered", name,
+               mStats.ticks, F32(mStats.sweeps) / ticks, mRegistered.size());
+   Con::printf("   casts: %d, fallbacks: %d, candidates per sweep: %.2f, moved per tick: %.1f",
+               mStats.casts, mStats.fallbacks,
+               mStats.sweeps? F32(mStats.candidates) / mStats.sweeps: 0.0f,
+               F32(mStats.moved) / ticks);
+   Con::printf("   object casts per cast: %.2f", F32(mStats.objectCasts) / casts);
+
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(sweepBatchStats, void, 1, 2, "sweepBatchStats(<reset>);")
+{
+   bool reset = argc > 1 && dAtob(argv[1]);
+   gServerContainer.getSweepBatch()->dumpStats("Server", reset);
+}
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SWEEPBATCH_H_
+#define _SWEEPBATCH_H_
+
+#ifndef _MMATH_H_
+#include "Math/mMath.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+#ifndef _BOXTREE_H_
+#include "Collision/boxTree.h"
+#endif
+
+class SceneObject;
+class Container;
+struct RayInfo;
+
+
+//----------------------------------------------------------------------------
+// Batched segment casts
+//
+// Segments that are known before a tick starts (projectiles moving along
+// their paths) are added up front.  begin() sorts the objects that overlap
+// a segment onto it, through a box tree over the segment boxes.  It only
+// looks at the objects registered with the batch: the container registers
+// every object whose type is in the registered mask as it's added, and the
+// mask grows to take in the sweep masks the first time they're seen.
+// Objects whose type changes while they're in the container have to say so
+// (objectTypeChanged).
+// During the tick castRay answers for a segment the same way
+// Container::castRay would:
+//
+// - The candidates are tested with their current world box, collision
+//   state and transform, so objects that ticked since begin() are seen
+//   where they are now.
+// - Objects that are added or move during the tick are kept on a list
+//   that every cast looks at as well.
+//
+// Only casts from the main thread use the batch.  If objects move on
+// other threads while it's open, it's dropped and casts go straight to
+// the container.
+
+class SweepBatch
+{
+   struct Sweep {
+      Point3F start;
+      Point3F end;
+      U32     mask;
+      U32     first;         // in mCandidates
+      U32     count;
+   };
+
+   Container*           mContainer;
+   Vector<SceneObject*> mRegistered;   // container objects of mRegisterMask types
+   U32                  mRegisterMask;
+   Vector<Sweep>        mSweeps;
+   Vector<Box3F>        mSweepBoxes;
+   Vector<SceneObject*> mObjects;      // overlapping a sweep at begin(), NULL once removed
+   Vector<U32>          mCandidates;   // into mObjects, by sweep
+   Vector<SceneObject*> mMoved;        // added or moved since begin()
+   BoxTree              mTree;
+   U32                  mMask;         // all the sweep masks
+   bool                 mOpen;
+   bool                 mInvalid;      // something moved off the main thread
+
+   struct Stats {
+      U32 ticks;
+      U32 sweeps;
+      U32 candidates;
+      U32 moved;
+      U32 casts;
+      U32 fallbacks;
+      U32 objectCasts;
+      void clear() { dMemset(this, 0, sizeof(*this)); }
+   } mStats;
+
+   void setRegisterMask(U32 mask);
+   bool castObject(SceneObject* object, const Point3F& start, const Point3F& end,
+                   U32 mask, U32 slot, U32 seqKey, F32* currentT, RayInfo* info);
+
+  public:
+   SweepBatch();
+
+   void setContainer(Container* container) { mContainer = container; }
+
+   // Returns the sweep index, or -1 if the batch is full.  Only between
+   // ticks.
+   S32  addSweep(const Point3F& start, const Point3F& end, U32 mask);
+   void begin();
+   void end();
+   bool isOpen() const { return mOpen; }
+
+   // Falls back to Container::castRay if the batch is closed, or the
+   // segment or mask isn't the one that was added.
+   bool castRay(S32 sweep, const Point3F& start, const Point3F& end, U32 mask, RayInfo* info);
+
+   // Called by the container.
+   void objectAdded(SceneObject* object);
+   void objectMoved(SceneObject* object);
+   void objectRemoved(SceneObject* object);
+   void objectTypeChanged(SceneObject* object);
+
+   void dumpStats(const char* name, bool reset);
+};
+
+#endif
@@ -19,8 +19,10 @@
 #include "console/gram.h"
 
 #include "console/simBase.h"
+#include "console/simParallel.h"
 #include "console/telnetDebugger.h"
 #include "sim/netStringTable.h"
+#include "platform/profiler.h"
 
 enum {
    MaxStackSize = 1024
@@ -272,29 +274,52 @@ void StringStack::getArgcArgv(StringTableEntry name, U32 *argc, const char ***in
 
 //------------------------------------------------------------
 
+// The string stack belongs to the main thread.  Inside a parallel section
+// (see console/simParallel.h) arguments only have to last until a deferred
+// call copies them, so each thread hands them out of a small ring instead.
+enum {
+   ParallelArgBufferSize = 2048
+};
+static THREAD_LOCAL char sParallelArgBuffer[ParallelArgBufferSize];
+static THREAD_LOCAL U32 sParallelArgOffset = 0;
+
+static char *getParallelArgBuffer(U32 size)
+{
+   AssertFatal(size <= ParallelArgBufferSize / 4, "Con::getArgBuffer: argument too big for a parallel section");
+   if(sParallelArgOffset + size > ParallelArgBufferSize)
+      sParallelArgOffset = 0;
+   char *ret = sParallelArgBuffer + sParallelArgOffset;
+   sParallelArgOffset += size;
+   return ret;
+}
+
 namespace Con
 {
 
 char *getReturnBuffer(U32 bufferSize)
 {
+   if(Sim::isParallel())
+      return getParallelArgBuffer(bufferSize);
    return STR.getReturnBuffer(bufferSize);
 }
 
 char *getArgBuffer(U32 bufferSize)
 {
+   if(Sim::isParallel())
+      return getParallelArgBuffer(bufferSize);
    return STR.getArgBuffer(bufferSize);
 }
 
 char *getFloatArg(F64 arg)
 {
-   char *ret = STR.getArgBuffer(32);
+   char *ret = getArgBuffer(32);
    dSprintf(ret, 32, "%g", arg);
    return ret;
 }
 
 char *getIntArg(S32 arg)
 {
-   char *ret = STR.getArgBuffer(32);
+   char *ret = getArgBuffer(32);
    dSprintf(ret, 32, "%d", arg);
    return ret;
 }
@@ -369,6 +394,7 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    static char traceBuffer[1024];
    U32 i;
    
+   PROFILE_START(CodeBlockExec);
    incRefCount();
    F64 *curFloatTable;
    char *curStringTable;
@@ -1216,6 +1242,7 @@ execFinished:
       globalFloats = NULL;
    }
    decRefCount();
+   PROFILE_END();
    return STR.getStringValue();
 }
 
@@ -16,6 +16,7 @@
 #include "console/consoleTypes.h"
 #include "console/telnetDebugger.h"
 #include "console/simBase.h"
+#include "console/simParallel.h"
 #include "console/compiler.h"
 #include <stdarg.h>
 
@@ -244,6 +245,7 @@ static void log(const char *string)
 
 static void _printf(ConsoleLogEntry::Level level, ConsoleLogEntry::Type type, const char* fmt, va_list argptr)
 {
+   SimSharedLock lock;
    char buffer[1024];
    U32 offset = 0;
    if(gEvalState.traceOn && gEvalState.stack.size())
@@ -536,6 +538,13 @@ const char *evaluatef(const char* string, ...)
 
 const char *execute(S32 argc, const char *argv[])
 {
+   // no scripts off the main thread, they run once the tick is done
+   if(SimCommandBuffer *buffer = SimCommandBuffer::getCurrent())
+   {
+      buffer->addScript(argc, argv);
+      return "";
+   }
+
    Namespace::Entry *ent;
    StringTableEntry funcName = StringTable->insert(argv[0]);
    ent = Namespace::global()->lookup(funcName);
@@ -554,6 +563,11 @@ const char *execute(SimObject *object, S32 argc, const char *argv[])
    static char idBuf[12];
    if(argc < 2)
       return "";
+   if(SimCommandBuffer *buffer = SimCommandBuffer::getCurrent())
+   {
+      buffer->addScript(object, argc, argv);
+      return "";
+   }
    if(object->getNamespace())
    {
       dSprintf(idBuf, sizeof(idBuf), "%d", object->getId());
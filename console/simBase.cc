@@ -7,6 +7,7 @@
 
 #include "platform/platform.h"
 #include "console/simBase.h"
+#include "console/simParallel.h"
 #include "core/stringTable.h"
 #include "console/console.h"
 #include "core/fileStream.h"
@@ -856,6 +857,7 @@ void SimObject::deleteNotify(SimObject* obj)
 {
    AssertFatal(!obj->isDeleted(),
                "SimManager::deleteNotify: Object is being deleted");
+   SimSharedLock lock;
    Notify *note = allocNotify();
    note->ptr = (void *) this;
    note->next = obj->mNotifyList;
@@ -874,6 +876,7 @@ void SimObject::deleteNotify(SimObject* obj)
 
 void SimObject::registerReference(SimObject **ptr)
 {
+   SimSharedLock lock;
    Notify *note = allocNotify();
    note->ptr = (void *) ptr;
    note->next = mNotifyList;
@@ -883,12 +886,14 @@ void SimObject::registerReference(SimObject **ptr)
 
 void SimObject::unregisterReference(SimObject **ptr)
 {
+   SimSharedLock lock;
    Notify *note = removeNotify((void *) ptr, Notify::ObjectRef);
    freeNotify(note);
 }
 
 void SimObject::clearNotify(SimObject* obj)
 {
+   SimSharedLock lock;
    Notify *note = obj->removeNotify((void *) this, Notify::DeleteNotify);
    if(note)
       freeNotify(note);
@@ -7,6 +7,7 @@
 
 #include "Platform/platform.h"
 #include "console/simBase.h"
+#include "console/simParallel.h"
 #include "Core/stringTable.h"
 #include "console/console.h"
 #include "Core/fileStream.h"
@@ -73,6 +74,7 @@ U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
       delete event;
       return InvalidEventId;
    }
+   SimSharedLock lock;
    event->sequenceCount = gEventSequence++;
    SimEvent **walk = &gEventQueue;
    SimEvent *current;
@@ -89,6 +91,7 @@ U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
 
 void cancelEvent(U32 eventSequence)
 {
+   SimSharedLock lock;
    SimEvent **walk = &gEventQueue;
    SimEvent *current;
    
@@ -127,6 +130,7 @@ static void cancelPendingEvents(SimObject *obj)
 
 bool isEventPending(U32 eventSequence)
 {
+   SimSharedLock lock;
    for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
       if(walk->sequenceCount == eventSequence)
          return true;
@@ -269,6 +273,7 @@ SimDataBlockGroup *getDataBlockGroup()
 void init()
 {
    initEventQueue();
+   initParallel();
    initRoot();
 
    InstantiateNamedSet(ActiveActionMapSet);
@@ -296,6 +301,7 @@ void shutdown()
 {
    shutdownRoot();
    shutdownEventQueue();
+   shutdownParallel();
 }
 
 }
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "console/simParallel.h"
+#include "console/console.h"
+#include "platform/platformMutex.h"
+
+//---------------------------------------------------------------------------
+
+namespace Sim
+{
+   static void *sSharedMutex = NULL;
+   static volatile bool sParallel = false;
+   static THREAD_LOCAL U32 sSharedDepth = 0;
+
+   void initParallel()
+   {
+      if(!sSharedMutex)
+         sSharedMutex = Mutex::createMutex();
+   }
+
+   void shutdownParallel()
+   {
+      AssertFatal(!sParallel, "Sim::shutdownParallel: still in a parallel section");
+      if(sSharedMutex)
+      {
+         Mutex::destroyMutex(sSharedMutex);
+         sSharedMutex = NULL;
+      }
+   }
+
+   void beginParallel()
+   {
+      AssertFatal(!sParallel, "Sim::beginParallel: parallel sections don't nest");
+      AssertFatal(sSharedMutex, "Sim::beginParallel: not initialized");
+      sParallel = true;
+   }
+
+   void endParallel()
+   {
+      AssertFatal(sParallel, "Sim::endParallel: not in a parallel section");
+      AssertFatal(sSharedDepth == 0, "Sim::endParallel: shared lock still held");
+      sParallel = false;
+   }
+
+   bool isParallel()
+   {
+      return sParallel;
+   }
+
+   // The flag only changes on the main thread while no other thread is
+   // running, so a lock taken inside a section is always released inside it.
+   void lockShared()
+   {
+      if(!sParallel)
+         return;
+      if(sSharedDepth++ == 0)
+         Mutex::lockMutex(sSharedMutex);
+   }
+
+   void unlockShared()
+   {
+      if(!sParallel)
+         return;
+      AssertFatal(sSharedDepth, "Sim::unlockShared: lock not held");
+      if(--sSharedDepth == 0)
+         Mutex::unlockMutex(sSharedMutex);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+
+THREAD_LOCAL SimCommandBuffer *SimCommandBuffer::smCurrent = NULL;
+
+SimCommandBuffer::SimCommandBuffer()
+{
+   VECTOR_SET_ASSOCIATION(mCommands);
+   VECTOR_SET_ASSOCIATION(mArgs);
+   VECTOR_SET_ASSOCIATION(mStrings);
+}
+
+void SimCommandBuffer::addCall(SimObject *object, CallFunction function, U32 data)
+{
+   mCommands.increment();
+   Command &cmd = mCommands.last();
+   cmd.type = Call;
+   cmd.objectId = object->getId();
+   cmd.function = function;
+   cmd.data = data;
+   cmd.argc = 0;
+}
+
+void SimCommandBuffer::addScript(S32 argc, const char *argv[])
+{
+   mCommands.increment();
+   Command &cmd = mCommands.last();
+   cmd.type = Script;
+   cmd.objectId = 0;
+   cmd.function = NULL;
+   cmd.data = mArgs.size();
+   cmd.argc = argc;
+
+   for(S32 i = 0; i < argc; i++)
+   {
+      // argv[1] of an object call is filled in by Con::execute
+      const char *arg = argv[i] ? argv[i] : "";
+      U32 len = dStrlen(arg) + 1;
+      U32 offset = mStrings.size();
+      mStrings.setSize(offset + len);
+      dMemcpy(mStrings.address() + offset, arg, len);
+      mArgs.push_back(offset);
+   }
+}
+
+void SimCommandBuffer::addScript(SimObject *object, S32 argc, const char *argv[])
+{
+   addScript(argc, argv);
+   mCommands.last().type = ObjectScript;
+   mCommands.last().objectId = object->getId();
+}
+
+void SimCommandBuffer::apply()
+{
+   AssertFatal(!Sim::isParallel(), "SimCommandBuffer::apply: still in a parallel section");
+   AssertFatal(smCurrent != this, "SimCommandBuffer::apply: buffer is current");
+
+   const char *argv[128];
+   for(U32 i = 0; i < mCommands.size(); i++)
+   {
+      // the vectors can't grow while this runs, nothing is current
+      const Command &cmd = mCommands[i];
+      SimObject *object = NULL;
+      if(cmd.type != Script && (object = Sim::findObject(cmd.objectId)) == NULL)
+         continue;
+
+      if(cmd.type == Call)
+      {
+         cmd.function(object, cmd.data);
+         continue;
+      }
+
+      U32 argc = getMin(cmd.argc, U32(128));
+      for(U32 j = 0; j < argc; j++)
+         argv[j] = mStrings.address() + mArgs[cmd.data + j];
+      if(cmd.type == Script)
+         Con::execute(argc, argv);
+      else
+         Con::execute(object, argc, argv);
+   }
+   clear();
+}
+
+void SimCommandBuffer::clear()
+{
+   mCommands.clear();
+   mArgs.clear();
+   mStrings.clear();
+}
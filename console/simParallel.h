@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMPARALLEL_H_
+#define _SIMPARALLEL_H_
+
+#ifndef _PLATFORM_H_
+#include "Platform/platform.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+#ifndef _SIMBASE_H_
+#include "console/simBase.h"
+#endif
+
+//---------------------------------------------------------------------------
+// Parallel sections
+//
+// The sim is single threaded.  The one exception is the server process list,
+// which can tick independent groups of objects on several threads at once
+// (see ProcessList::advanceObjects).  While that is going on the sim is in a
+// parallel section:
+//
+// - Shared state that the ticking objects can't avoid touching (the
+//   container bins, the event queue, the notify lists, ...) is guarded by
+//   the shared lock.  Outside of a parallel section locking it costs nothing.
+// - Side effects that have to happen in a well defined order (script
+//   callbacks, net dirty masks) are recorded in the SimCommandBuffer current
+//   on the thread and applied on the main thread once the section is over.
+
+namespace Sim
+{
+   void initParallel();
+   void shutdownParallel();
+
+   // Main thread only.
+   void beginParallel();
+   void endParallel();
+   bool isParallel();
+
+   // Recursive.  A no-op outside of a parallel section.
+   void lockShared();
+   void unlockShared();
+}
+
+class SimSharedLock
+{
+  public:
+   SimSharedLock()  { Sim::lockShared();   }
+   ~SimSharedLock() { Sim::unlockShared(); }
+};
+
+
+//---------------------------------------------------------------------------
+
+class SimCommandBuffer
+{
+  public:
+   typedef void (*CallFunction)(SimObject *object, U32 data);
+
+  private:
+   enum CommandType {
+      Call,
+      Script,
+      ObjectScript,
+   };
+   struct Command
+   {
+      U32 type;
+      SimObjectId objectId;
+      CallFunction function;
+      U32 data;          // call data, or the first argument offset for scripts
+      U32 argc;
+   };
+   Vector<Command> mCommands;
+   Vector<U32>     mArgs;     // offsets into mStrings
+   Vector<char>    mStrings;
+
+   static THREAD_LOCAL SimCommandBuffer *smCurrent;
+
+  public:
+   SimCommandBuffer();
+
+   // Runs function(object, data) when the buffer is applied, if the object
+   // still exists by then.
+   void addCall(SimObject *object, CallFunction function, U32 data);
+
+   // Con::execute, deferred.  The arguments are copied.
+   void addScript(S32 argc, const char *argv[]);
+   void addScript(SimObject *object, S32 argc, const char *argv[]);
+
+   // Runs the commands in the order they were added and empties the buffer.
+   // Main thread only.
+   void apply();
+   void clear();
+   U32  size() const { return mCommands.size(); }
+
+   // The buffer side effects on this thread go to, if any.
+   static SimCommandBuffer *getCurrent() { return smCurrent; }
+
+   class Scope
+   {
+      SimCommandBuffer *mPrev;
+     public:
+      Scope(SimCommandBuffer *buffer) { mPrev = smCurrent; smCurrent = buffer; }
+      ~Scope()                        { smCurrent = mPrev; }
+   };
+};
+
+#endif
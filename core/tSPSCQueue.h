@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSPSCQUEUE_H_
+#define _TSPSCQUEUE_H_
+
+//Includes
+#ifndef _PLATFORM_H_
+#include "Platform/platform.h"
+#endif
+#ifndef _PLATFORMASSERT_H_
+#include "Platform/platformAssert.h"
+#endif
+
+// Keeps the compiler (and on weakly ordered cpus, the processor) from moving
+// the item copy across the index update.
+#if defined(_MSC_VER)
+extern "C" void _ReadWriteBarrier();
+#pragma intrinsic(_ReadWriteBarrier)
+#define SPSC_FENCE() _ReadWriteBarrier()
+#elif defined(__GNUC__)
+#define SPSC_FENCE() __sync_synchronize()
+#else
+#define SPSC_FENCE()
+#endif
+
+//----------------------------------------------------------------------------
+// Fixed size, lock free queue with exactly one producer thread and exactly
+// one consumer thread.  Each index is only ever written by one side, so the
+// only synchronization needed is ordering the item copy against the index
+// store.  Size must be a power of 2.
+
+template <class T, U32 Size>
+class SPSCQueue
+{
+   T mItems[Size];
+   volatile U32 mHead;  // next item to pop, written by the consumer
+   volatile U32 mTail;  // next free slot, written by the producer
+
+  public:
+   SPSCQueue();
+
+   // producer side
+   bool push(const T &item);
+   bool isFull() const  { return mTail - mHead == Size; }
+
+   // consumer side
+   bool pop(T &item);
+   bool isEmpty() const { return mHead == mTail; }
+
+   // either side, may be stale by the time it returns
+   U32 size() const     { return mTail - mHead; }
+   U32 capacity() const { return Size; }
+};
+
+template <class T, U32 Size>
+inline SPSCQueue<T, Size>::SPSCQueue()
+{
+   AssertFatal((Size & (Size - 1)) == 0, "SPSCQueue: size must be a power of 2");
+   mHead = mTail = 0;
+}
+
+template <class T, U32 Size>
+inline bool SPSCQueue<T, Size>::push(const T &item)
+{
+   U32 tail = mTail;
+   if(tail - mHead == Size)
+      return false;
+   mItems[tail & (Size - 1)] = item;
+   SPSC_FENCE();
+   mTail = tail + 1;
+   return true;
+}
+
+template <class T, U32 Size>
+inline bool SPSCQueue<T, Size>::pop(T &item)
+{
+   U32 head = mHead;
+   if(head == mTail)
+      return false;
+   SPSC_FENCE();
+   item = mItems[head & (Size - 1)];
+   SPSC_FENCE();
+   mHead = head + 1;
+   return true;
+}
+
+#endif //_TSPSCQUEUE_H_
@@ -0,0 +1,150 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/benchmark.h"
+#include "platform/event.h"
+#include "platform/gameInterface.h"
+#include "platform/platformAudio.h"
+#include "platform/profiler.h"
+#include "console/console.h"
+#include "core/fileStream.h"
+#include "sim/netConnection.h"
+
+namespace Benchmark
+{
+   enum {
+      FileNameLength = 256,
+   };
+
+   static Mode sMode = None;
+   static char sFileName[FileNameLength];
+   static char sReportName[FileNameLength] = "benchmark.csv";
+   static U32 sPassCount = 0;
+   static U32 sStartRealTime = 0;
+   static U32 sStartVirtualTime = 0;
+
+   static void writeLine(FileStream &stream, const char *line)
+   {
+      stream.write(dStrlen(line), line);
+   }
+
+   static void finish()
+   {
+      U32 realTime = Platform::getRealMilliseconds() - sStartRealTime;
+      U32 simTime = Platform::getVirtualMilliseconds() - sStartVirtualTime;
+
+      Con::printf("Benchmark: %s done, %d passes, %d ms sim time in %d ms.",
+                  sFileName, sPassCount, simTime, realTime);
+
+      FileStream stream;
+      if(!stream.open(sReportName, FileStream::Write))
+         Con::errorf(ConsoleLogEntry::General, "Benchmark: unable to open report file %s.", sReportName);
+      else
+      {
+         char buffer[1024];
+         dSprintf(buffer, sizeof(buffer), "file,%s\n", sFileName);
+         writeLine(stream, buffer);
+         dSprintf(buffer, sizeof(buffer), "mode,%s\n", sMode == Journal ? "journal" : "demo");
+         writeLine(stream, buffer);
+         dSprintf(buffer, sizeof(buffer), "passes,%d\n", sPassCount);
+         writeLine(stream, buffer);
+         dSprintf(buffer, sizeof(buffer), "simMs,%d\n", simTime);
+         writeLine(stream, buffer);
+         dSprintf(buffer, sizeof(buffer), "realMs,%d\n", realTime);
+         writeLine(stream, buffer);
+
+         // profiler times are in processor ticks
+         F64 ticksPerMs = Platform::SystemInfo.processor.mhz * 1000.0;
+         if(ticksPerMs <= 0)
+            ticksPerMs = 1;
+
+         if(gProfiler)
+            gProfiler->updateRootTotals();
+         writeLine(stream, "marker,invokes,totalMs,selfMs\n");
+         for(ProfilerRootData *walk = ProfilerRootData::sRootList; walk; walk = walk->mNextRoot)
+         {
+            if(!walk->mTotalInvokeCount)
+               continue;
+            dSprintf(buffer, sizeof(buffer), "%s,%d,%.3f,%.3f\n",
+                     walk->mName, walk->mTotalInvokeCount,
+                     walk->mTotalTime / ticksPerMs,
+                     (walk->mTotalTime - walk->mSubTime) / ticksPerMs);
+            writeLine(stream, buffer);
+         }
+         stream.close();
+      }
+      sMode = None;
+      Game->setRunning(false);
+   }
+
+   Mode getMode()
+   {
+      return sMode;
+   }
+
+   void start(S32 argc, const char **argv)
+   {
+      const char *fileName = NULL;
+      for(S32 i = 1; i < argc - 1; i++)
+      {
+         if(!dStricmp(argv[i], "-benchmark"))
+            fileName = argv[++i];
+         else if(!dStricmp(argv[i], "-benchmarkReport"))
+         {
+            dStrncpy(sReportName, argv[++i], FileNameLength - 1);
+            sReportName[FileNameLength - 1] = 0;
+         }
+      }
+      if(!fileName)
+         return;
+
+      dStrncpy(sFileName, fileName, FileNameLength - 1);
+      sFileName[FileNameLength - 1] = 0;
+
+      // nobody is listening...
+      Audio::setDriver("none");
+
+      if(gProfiler)
+      {
+         gProfiler->reset();
+         gProfiler->enable(true);
+      }
+      sPassCount = 0;
+      sStartRealTime = Platform::getRealMilliseconds();
+      sStartVirtualTime = Platform::getVirtualMilliseconds();
+
+      const char *ext = dStrrchr(sFileName, '.');
+      if(ext && !dStricmp(ext, ".jrn"))
+      {
+         sMode = Journal;
+         Game->playJournal(sFileName);
+         Con::printf("Benchmark: replaying journal %s.", sFileName);
+      }
+      else
+      {
+         sMode = Demo;
+         Con::executef(3, "playDemo", sFileName, "1");
+         Con::printf("Benchmark: replaying demo %s.", sFileName);
+      }
+   }
+
+   void process()
+   {
+      if(sMode == None)
+         return;
+
+      sPassCount++;
+      if(sMode == Journal)
+      {
+         // the journal drops back to JournalOff when it runs dry
+         if(Game->getJournalMode() != GameInterface::JournalPlay)
+            finish();
+      }
+      else if(!NetConnection::getServerConnection())
+         finish();
+   }
+}
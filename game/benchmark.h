@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+//----------------------------------------------------------------------------
+// Headless replay benchmark.
+//
+//    -benchmark <file.jrn | file.rec> [-benchmarkReport <file>]
+//
+// Replays a journal or a demo recording with rendering and audio off and
+// the main loop stepping the sim as fast as it can, then writes the
+// profiler totals for the run to a comma separated report and quits.
+// Demos are stepped a fixed demo tick at a time; journals replay their
+// recorded time events, since those are part of the deterministic input.
+
+namespace Benchmark
+{
+   enum Mode {
+      None,
+      Journal,
+      Demo,
+   };
+
+   void start(S32 argc, const char **argv);
+   void process();
+   Mode getMode();
+
+   inline bool isActive() { return getMode() != None; }
+}
+
+#endif
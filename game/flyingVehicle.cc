@@ -520,6 +520,16 @@ void FlyingVehicle::updateForces(F32 /*dt*/)
 
 //----------------------------------------------------------------------------
 
+// The height ray goes straight down from wherever the tick moves us to.
+bool FlyingVehicle::getIslandBox(Box3F* box)
+{
+   if (!Parent::getIslandBox(box))
+      return false;
+   F32 r = 10 + getMax(mDataBlock->createHoverHeight, mDataBlock->hoverHeight);
+   box->min.z = getMin(box->min.z, getPosition().z - r - getIslandReach());
+   return true;
+}
+
 F32 FlyingVehicle::getHeight()
 {
    Point3F sp,ep;
@@ -169,6 +169,7 @@ class FlyingVehicle: public Vehicle
 
    bool onAdd();
    void onRemove();
+   bool getIslandBox(Box3F* box);
    void advanceTime(F32 dt);
 
    bool writePacketData(GameConnection *, BitStream *stream);
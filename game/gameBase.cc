@@ -117,6 +117,8 @@ GameBase::GameBase()
    mProcessLink.next = mProcessLink.prev = this;
    mAfterObject = 0;
    mProcessTag = 0;
+   mIslandTag = 0;
+   mIslandIndex = 0;
    mLastDelta = 0;
    mDataBlock = 0;
    mProcessTick = true;
@@ -493,6 +495,11 @@ void GameBase::clearProcessAfter()
    mAfterObject = 0;
 }
 
+bool GameBase::getIslandBox(Box3F*)
+{
+   return false;
+}
+
 
 //----------------------------------------------------------------------------
 
@@ -20,6 +20,8 @@
 
 class NetConnection;
 class ProcessList;
+class ProcessThread;
+class SimCommandBuffer;
 struct Move;
 struct SensorData;
 struct TargetInfo;
@@ -79,6 +81,8 @@ class GameBase : public SceneObject
    U32  mProcessTag;                      // Tag used during sort
    Link mProcessLink;                     // Ordered process queue
    SimObjectPtr<GameBase> mAfterObject;
+   U32  mIslandTag;                       // Island building, the index is
+   U32  mIslandIndex;                     // valid while the tag is current
 
    // Collision Notification
   public:
@@ -157,6 +161,11 @@ class GameBase : public SceneObject
    virtual void interpolateTick(F32 backDelta);
    virtual void advanceTime(F32 dt);
 
+   // Objects that can tick off the main thread return the box their next
+   // processTick can reach into, see ProcessList::advanceObjects.  The
+   // default keeps the object on the main thread.
+   virtual bool getIslandBox(Box3F* box);
+
    virtual Point3F getVelocity() const;
 
    virtual void setHeat(const F32);
@@ -238,6 +247,15 @@ inline void GameBase::decLockCount()
 
 class ProcessList
 {
+public:
+   enum {
+      // each thread needs a query context of its own
+      MaxThreads = ContainerQueryContext::MaxContexts - 1,
+   };
+
+private:
+   friend class ProcessThread;
+
    GameBase head;
    U32 mCurrentTag;
    SimTime mLastTick;
@@ -245,12 +263,57 @@ class ProcessList
    SimTime mLastDelta;
    bool mDirty;
 
+   // Island ticking (server list with process threads only)
+   struct Island {
+      U32  start;                   // first member in mIslandMembers
+      U32  count;
+      SimCommandBuffer* commands;
+   };
+   struct IslandStats {
+      U32 ticks;
+      U32 parallelTicks;
+      U32 mainObjects;
+      U32 islandObjects;
+      U32 islands;
+      U32 largestIsland;
+      U32 commands;
+      F64 parallelTime;             // processor ticks
+      void clear() { dMemset(this, 0, sizeof(*this)); }
+   };
+   U32                       mIslandTag;
+   Vector<GameBase*>         mIslandObjects;
+   Vector<Box3F>             mIslandBoxes;
+   Vector<U32>               mIslandSets;      // union-find over mIslandObjects
+   Vector<U8>                mIslandFlags;
+   Vector<Island>            mIslands;
+   Vector<GameBase*>         mIslandMembers;
+   Vector<U32>               mIslandOrder;     // dispatch order, biggest first
+   Vector<SimCommandBuffer*> mCommandBuffers;
+   ProcessThread*            mThreads[MaxThreads];
+   U32                       mNumThreads;
+   void*                     mIslandMutex;
+   void*                     mIslandsDone;
+   U32                       mNextIsland;
+   IslandStats               mStats;
+
    void orderList();
    void advanceObjects();
+   void tickObject(GameBase* obj);
+
+   void advanceIslands();
+   void collectIslandObjects(bool afterMainThread);
+   S32  getIslandIndex(GameBase* obj);
+   U32  findIslandSet(U32 index);
+   void joinIslandSets(U32 index, GameBase* obj);
+   void joinIslandLinks(U32 index, GameBase* obj);
+   void joinIslandBoxes();
+   void buildIslands();
+   void tickIslands();
 
 public:
    SimTime getLastTime() { return mLastTime; }
    ProcessList();
+   ~ProcessList();
    void markDirty()  { mDirty = true; }
    bool isDirty()  { return mDirty; }
    void addObject(GameBase* obj) {
@@ -258,6 +321,13 @@ public:
    }
    void advanceServerTime(SimTime timeDelta);
    void advanceClientTime(SimTime timeDelta);
+
+   // Threads that tick islands along with the main thread, 0 ticks
+   // everything on the main thread.
+   void startThreads(U32 count);
+   void stopThreads();
+   U32  getNumThreads() { return mNumThreads; }
+   void dumpIslandStats(bool reset);
 };
 
 extern ProcessList gClientProcessList;
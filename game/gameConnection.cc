@@ -454,16 +454,20 @@ void GameConnection::handleRecordedBlock(U32 type, U32 size, void *data)
 void GameConnection::writeDemoStartBlock(ResizeBitStream *stream)
 {
    // write all the data blocks to the stream:
+   // (keyframes skip them, they don't change once the mission is up)
 
-   for(SimObjectId i = DataBlockObjectIdFirst; i <= DataBlockObjectIdLast; i++)
+   if(!isWritingDemoKeyframe())
    {
-      SimDataBlock *data;
-      if(Sim::findObject(i, data))
+      for(SimObjectId i = DataBlockObjectIdFirst; i <= DataBlockObjectIdLast; i++)
       {
-         stream->writeFlag(true);
-         SimDataBlockEvent evt(data);
-         evt.pack(this, stream);
-         stream->validate();
+         SimDataBlock *data;
+         if(Sim::findObject(i, data))
+         {
+            stream->writeFlag(true);
+            SimDataBlockEvent evt(data);
+            evt.pack(this, stream);
+            stream->validate();
+         }
       }
    }
    stream->writeFlag(false);
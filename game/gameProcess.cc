@@ -10,7 +10,12 @@
 #include "game/gameBase.h"
 #include "game/shapeBase.h"
 #include "game/targetManager.h"
+#include "game/projectileManager.h"
+#include "game/proximityIndex.h"
 #include "platform/profiler.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "console/simParallel.h"
 
 //----------------------------------------------------------------------------
 
@@ -24,6 +29,20 @@ ProcessList::ProcessList()
    mLastTick = 0;
    mLastTime = 0;
    mLastDelta = 0;
+
+   mIslandTag = 0;
+   mNumThreads = 0;
+   mIslandMutex = NULL;
+   mIslandsDone = NULL;
+   mNextIsland = 0;
+   mStats.clear();
+}
+
+ProcessList::~ProcessList()
+{
+   stopThreads();
+   for (U32 i = 0; i < mCommandBuffers.size(); i++)
+      delete mCommandBuffers[i];
 }
 
 
@@ -104,8 +123,22 @@ void ProcessList::advanceServerTime(SimTime timeDelta)
    // Advance all the objects
    for (; mLastTick != targetTick; mLastTick += TickMs)
    {
+      U32 tickStart[2];
+      startHighResolutionTimer(tickStart);
+      PROFILE_START(TickSensorState);
       gTargetManager->tickSensorState();
-      advanceObjects();
+      PROFILE_END();
+      PROFILE_START(ProximityIndex);
+      gServerProximity.update();
+      PROFILE_END();
+      gServerProjectileManager.beginTick();
+      if (mNumThreads)
+         advanceIslands();
+      else
+         advanceObjects();
+      gServerProjectileManager.endTick();
+      if(gProfiler)
+         gProfiler->serverTickComplete(endHighResolutionTimer(tickStart));
    }
 
    // Credit all the connections with the elapsed ticks.
@@ -225,24 +258,461 @@ void ProcessList::advanceObjects()
    {
       obj->plUnlink();
       obj->plLinkBefore(&head);
+      tickObject(obj);
+   }
+   PROFILE_END();
+}
 
-      // Each object is either advanced a single tick, or if it's
-      // being controlled by a client, ticked once for each pending move.
-      if (obj->mTypeMask & ShapeBaseObjectType) {
-         ShapeBase* pSB = static_cast<ShapeBase*>(obj);
-         GameConnection* con = pSB->getControllingClient();
-         if (con && con->getControlObject() == pSB) {
-            Move* movePtr;
-            U32 m,numMoves;
-            con->getMoveList(&movePtr, &numMoves);
-            for (m = 0; m < numMoves && pSB->getControllingClient() == con; )
-               obj->processTick(&movePtr[m++]);
-            con->clearMoves(m);
-            continue;
-         }
+void ProcessList::tickObject(GameBase* obj)
+{
+   // Each object is either advanced a single tick, or if it's
+   // being controlled by a client, ticked once for each pending move.
+   if (obj->mTypeMask & ShapeBaseObjectType) {
+      ShapeBase* pSB = static_cast<ShapeBase*>(obj);
+      GameConnection* con = pSB->getControllingClient();
+      if (con && con->getControlObject() == pSB) {
+         Move* movePtr;
+         U32 m,numMoves;
+         con->getMoveList(&movePtr, &numMoves);
+         for (m = 0; m < numMoves && pSB->getControllingClient() == con; )
+            obj->processTick(&movePtr[m++]);
+         con->clearMoves(m);
+         return;
+      }
+   }
+   if (obj->mProcessTick)
+      obj->processTick(0);
+}
+
+
+//----------------------------------------------------------------------------
+// Island ticking
+//
+// With process threads running the server list is ticked in two passes:
+//
+// - Objects that can't say how far their tick reaches (see
+//   GameBase::getIslandBox, AI controlled and seeker shapes can't, see
+//   ShapeBase::ticksWithinIslandBox), and everything mounted to, controlling or
+//   processing after one of them, tick on the main thread first, in list
+//   order, exactly like advanceObjects does.
+// - The rest are split into islands: sets of objects that are linked, or
+//   whose reach boxes overlap each other's (or those of the objects that
+//   already ticked).  Islands can't touch each other during the tick, so
+//   they tick at the same time, each on one thread in list order.  Their
+//   script callbacks and net masks go to a command buffer per island which
+//   is applied on the main thread afterwards, in list order of the islands,
+//   so the outcome doesn't depend on the thread timing.
+//
+// Objects ticking in an island must not delete objects directly.
+
+class ProcessThread : public Thread
+{
+   ProcessList*           mList;
+   ContainerQueryContext* mContext;
+   void*                  mWakeSemaphore;
+   volatile bool          mStopping;
+   S32                    mIndex;
+
+public:
+   ProcessThread(ProcessList* list, ContainerQueryContext* context, S32 index);
+   ~ProcessThread();
+
+   void wake() { Semaphore::releaseSemaphore(mWakeSemaphore); }
+   void stop();
+   void run(S32);
+};
+
+ProcessThread::ProcessThread(ProcessList* list, ContainerQueryContext* context, S32 index)
+   : Thread(0, index, false)
+{
+   mList = list;
+   mContext = context;
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mStopping = false;
+   mIndex = index;
+
+   // Now that the semaphore is created, start up the thread
+   start();
+}
+
+ProcessThread::~ProcessThread()
+{
+   Semaphore::destroySemaphore(mWakeSemaphore);
+   delete mContext;
+}
+
+void ProcessThread::stop()
+{
+   if (!isAlive())
+      return;
+
+   mStopping = true;
+   wake();
+   join();
+}
+
+void ProcessThread::run(S32)
+{
+   if (gProfiler) {
+      char name[32];
+      dSprintf(name, sizeof(name), "Process %d", mIndex);
+      gProfiler->setThreadName(name);
+   }
+
+   ContainerQueryContext::Scope scope(mContext);
+   while (1) {
+      Semaphore::acquireSemaphore(mWakeSemaphore);
+      if (mStopping)
+         return;
+
+      mList->tickIslands();
+      Semaphore::releaseSemaphore(mList->mIslandsDone);
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+enum IslandFlags {
+   IslandCanTick    = BIT(0),      // returned an island box
+   IslandMainGroup  = BIT(1),      // set on the root, has to tick on the main thread
+   IslandWorker     = BIT(2),      // ticks in an island this pass
+};
+
+static const U32 TickedIndex = 0xFFFFFFFF;
+
+void ProcessList::startThreads(U32 count)
+{
+   stopThreads();
+   count = getMin(count, U32(MaxThreads));
+   if (!count)
+      return;
+
+   mIslandMutex = Mutex::createMutex();
+   mIslandsDone = Semaphore::createSemaphore(0);
+   for (U32 i = 0; i < count; i++) {
+      // the container queries of other systems may hold some of the contexts
+      ContainerQueryContext* context = ContainerQueryContext::create();
+      if (!context)
+         break;
+      mThreads[mNumThreads] = new ProcessThread(this, context, mNumThreads);
+      mNumThreads++;
+   }
+   if (mNumThreads < count)
+      Con::warnf("ProcessList::startThreads: only %d of %d threads started", mNumThreads, count);
+}
+
+void ProcessList::stopThreads()
+{
+   for (U32 i = 0; i < mNumThreads; i++) {
+      mThreads[i]->stop();
+      delete mThreads[i];
+   }
+   mNumThreads = 0;
+
+   if (mIslandMutex) {
+      Mutex::destroyMutex(mIslandMutex);
+      mIslandMutex = NULL;
+   }
+   if (mIslandsDone) {
+      Semaphore::destroySemaphore(mIslandsDone);
+      mIslandsDone = NULL;
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+void ProcessList::collectIslandObjects(bool afterMainThread)
+{
+   U32 prevTag = mIslandTag;
+   if (!++mIslandTag)
+      mIslandTag++;
+
+   mIslandObjects.clear();
+   mIslandBoxes.clear();
+   mIslandSets.clear();
+   mIslandFlags.clear();
+   for (GameBase* obj = head.mProcessLink.next; obj != &head;
+         obj = obj->mProcessLink.next)
+   {
+      // Objects that ticked on the main thread, or were added while it
+      // did, only connect islands on the second pass.
+      bool pending = !afterMainThread ||
+         (obj->mIslandTag == prevTag && obj->mIslandIndex != TickedIndex);
+
+      U32 index = mIslandObjects.size();
+      obj->mIslandTag = mIslandTag;
+      obj->mIslandIndex = index;
+      mIslandObjects.push_back(obj);
+      mIslandSets.push_back(index);
+      mIslandBoxes.increment();
+      mIslandFlags.push_back(0);
+
+      if (obj->getIslandBox(&mIslandBoxes.last()))
+         mIslandFlags.last() = pending ? (IslandCanTick | IslandWorker) : IslandCanTick;
+      else
+         mIslandBoxes.last() = obj->getWorldBox();
+   }
+}
+
+S32 ProcessList::getIslandIndex(GameBase* obj)
+{
+   return (obj && obj->mIslandTag == mIslandTag)? S32(obj->mIslandIndex): -1;
+}
+
+U32 ProcessList::findIslandSet(U32 index)
+{
+   while (mIslandSets[index] != index) {
+      mIslandSets[index] = mIslandSets[mIslandSets[index]];
+      index = mIslandSets[index];
+   }
+   return index;
+}
+
+void ProcessList::joinIslandSets(U32 index, GameBase* obj)
+{
+   S32 other = getIslandIndex(obj);
+   if (other < 0)
+      return;
+
+   // Keep the lowest index as the root, the islands are built in list order
+   U32 a = findIslandSet(index);
+   U32 b = findIslandSet(other);
+   if (a < b)
+      mIslandSets[b] = a;
+   else if (b < a)
+      mIslandSets[a] = b;
+}
+
+void ProcessList::joinIslandLinks(U32 index, GameBase* obj)
+{
+   joinIslandSets(index, obj->mAfterObject);
+   if (obj->mTypeMask & ShapeBaseObjectType) {
+      ShapeBase* pSB = static_cast<ShapeBase*>(obj);
+      joinIslandSets(index, pSB->getObjectMount());
+      joinIslandSets(index, pSB->getControlObject());
+      joinIslandSets(index, pSB->getControllingObject());
+   }
+}
+
+static const Box3F* sSortBoxes;
+
+static S32 QSORT_CALLBACK cmpIslandBox(const void* a, const void* b)
+{
+   F32 ax = sSortBoxes[*(const U32*)a].min.x;
+   F32 bx = sSortBoxes[*(const U32*)b].min.x;
+   return (ax < bx)? -1: ((ax > bx)? 1: 0);
+}
+
+void ProcessList::joinIslandBoxes()
+{
+   // Sort and sweep along x
+   mIslandOrder.setSize(mIslandObjects.size());
+   for (U32 i = 0; i < mIslandOrder.size(); i++)
+      mIslandOrder[i] = i;
+   sSortBoxes = mIslandBoxes.address();
+   dQsort(mIslandOrder.address(), mIslandOrder.size(), sizeof(U32), cmpIslandBox);
+
+   for (U32 i = 0; i < mIslandOrder.size(); i++) {
+      const Box3F& box = mIslandBoxes[mIslandOrder[i]];
+      for (U32 j = i + 1; j < mIslandOrder.size(); j++) {
+         const Box3F& other = mIslandBoxes[mIslandOrder[j]];
+         if (other.min.x > box.max.x)
+            break;
+         if (box.isOverlapped(other))
+            joinIslandSets(mIslandOrder[i], mIslandObjects[mIslandOrder[j]]);
+      }
+   }
+}
+
+void ProcessList::buildIslands()
+{
+   // Roots are the lowest index of their set, so walking in list order
+   // creates the islands in list order too.  mIslandOrder maps roots to
+   // islands here.
+   U32 count = mIslandObjects.size();
+   mIslandOrder.setSize(count);
+   mIslands.clear();
+   U32 i;
+   for (i = 0; i < count; i++) {
+      U32 root = findIslandSet(i);
+      if (root == i)
+         mIslandOrder[i] = TickedIndex;
+      if (!(mIslandFlags[i] & IslandWorker))
+         continue;
+      if (mIslandOrder[root] == TickedIndex) {
+         mIslandOrder[root] = mIslands.size();
+         mIslands.increment();
+         mIslands.last().start = 0;
+         mIslands.last().count = 0;
+      }
+      mIslands[mIslandOrder[root]].count++;
+   }
+
+   U32 start = 0;
+   for (i = 0; i < mIslands.size(); i++) {
+      mIslands[i].start = start;
+      start += mIslands[i].count;
+      mIslands[i].count = 0;
+   }
+   mIslandMembers.setSize(start);
+   for (i = 0; i < count; i++) {
+      if (mIslandFlags[i] & IslandWorker) {
+         Island& island = mIslands[mIslandOrder[findIslandSet(i)]];
+         mIslandMembers[island.start + island.count++] = mIslandObjects[i];
+      }
+   }
+
+   while (mCommandBuffers.size() < mIslands.size())
+      mCommandBuffers.push_back(new SimCommandBuffer);
+   for (i = 0; i < mIslands.size(); i++)
+      mIslands[i].commands = mCommandBuffers[i];
+
+   // Hand out the biggest islands first
+   mIslandOrder.setSize(mIslands.size());
+   for (i = 0; i < mIslands.size(); i++) {
+      U32 j = i;
+      for (; j > 0 && mIslands[mIslandOrder[j - 1]].count < mIslands[i].count; j--)
+         mIslandOrder[j] = mIslandOrder[j - 1];
+      mIslandOrder[j] = i;
+   }
+}
+
+void ProcessList::tickIslands()
+{
+   while (1) {
+      Mutex::lockMutex(mIslandMutex);
+      U32 next = mNextIsland++;
+      Mutex::unlockMutex(mIslandMutex);
+      if (next >= mIslandOrder.size())
+         return;
+
+      PROFILE_START(TickIsland);
+      Island& island = mIslands[mIslandOrder[next]];
+      SimCommandBuffer::Scope scope(island.commands);
+      for (U32 i = 0; i < island.count; i++)
+         tickObject(mIslandMembers[island.start + i]);
+      PROFILE_END();
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+void ProcessList::advanceIslands()
+{
+   PROFILE_START(AdvanceIslands);
+   mStats.ticks++;
+
+   // Find what has to tick on the main thread.
+   PROFILE_START(FindMainThreadObjects);
+   collectIslandObjects(false);
+   U32 i;
+   for (i = 0; i < mIslandObjects.size(); i++)
+      joinIslandLinks(i, mIslandObjects[i]);
+   for (i = 0; i < mIslandObjects.size(); i++)
+      if (!(mIslandFlags[i] & IslandCanTick))
+         mIslandFlags[findIslandSet(i)] |= IslandMainGroup;
+   PROFILE_END();
+
+   // Tick it, same as advanceObjects.
+   GameBase list;
+   GameBase* obj;
+   list.plLinkBefore(head.mProcessLink.next);
+   head.plUnlink();
+   while ((obj = list.mProcessLink.next) != &list)
+   {
+      obj->plUnlink();
+      obj->plLinkBefore(&head);
+      S32 index = getIslandIndex(obj);
+      if (index < 0 || (mIslandFlags[findIslandSet(index)] & IslandMainGroup)) {
+         obj->mIslandIndex = TickedIndex;
+         mStats.mainObjects++;
+         tickObject(obj);
       }
-      if (obj->mProcessTick)
-         obj->processTick(0);
    }
+
+   // Now the islands, out of whatever is left.
+   PROFILE_START(BuildIslands);
+   collectIslandObjects(true);
+   for (i = 0; i < mIslandObjects.size(); i++)
+      joinIslandLinks(i, mIslandObjects[i]);
+   joinIslandBoxes();
+   buildIslands();
    PROFILE_END();
+
+   mStats.islands += mIslands.size();
+   mStats.islandObjects += mIslandMembers.size();
+   for (i = 0; i < mIslands.size(); i++)
+      mStats.largestIsland = getMax(mStats.largestIsland, mIslands[i].count);
+
+   if (mIslands.size() < 2) {
+      // Nothing to run side by side, tick in list order.
+      list.plLinkBefore(head.mProcessLink.next);
+      head.plUnlink();
+      while ((obj = list.mProcessLink.next) != &list)
+      {
+         obj->plUnlink();
+         obj->plLinkBefore(&head);
+         S32 index = getIslandIndex(obj);
+         if (index >= 0 && (mIslandFlags[index] & IslandWorker))
+            tickObject(obj);
+      }
+      PROFILE_END();
+      return;
+   }
+
+   U32 start[2];
+   startHighResolutionTimer(start);
+   mNextIsland = 0;
+   Sim::beginParallel();
+   for (i = 0; i < mNumThreads; i++)
+      mThreads[i]->wake();
+   tickIslands();
+   for (i = 0; i < mNumThreads; i++)
+      Semaphore::acquireSemaphore(mIslandsDone);
+   Sim::endParallel();
+   gServerContainer.releaseDeferredRefs();
+   mStats.parallelTime += endHighResolutionTimer(start);
+   mStats.parallelTicks++;
+
+   PROFILE_START(ApplyIslandCommands);
+   for (i = 0; i < mIslands.size(); i++) {
+      mStats.commands += mIslands[i].commands->size();
+      mIslands[i].commands->apply();
+   }
+   PROFILE_END();
+
+   PROFILE_END();
+}
+
+void ProcessList::dumpIslandStats(bool reset)
+{
+   Con::printf("Process threads: %d", mNumThreads);
+   U32 ticks = getMax(mStats.ticks, U32(1));
+   U32 parallelTicks = getMax(mStats.parallelTicks, U32(1));
+   F64 ticksPerMs = Platform::SystemInfo.processor.mhz * 1000.0;
+   Con::printf("   ticks: %d, in parallel: %d", mStats.ticks, mStats.parallelTicks);
+   Con::printf("   per tick: %.1f main thread objects, %.1f island objects, %.1f islands",
+               F32(mStats.mainObjects) / ticks, F32(mStats.islandObjects) / ticks,
+               F32(mStats.islands) / ticks);
+   Con::printf("   largest island: %d, commands per tick: %.1f",
+               mStats.largestIsland, F32(mStats.commands) / parallelTicks);
+   if (ticksPerMs > 0)
+      Con::printf("   parallel section avg: %.3f ms",
+                  F32(mStats.parallelTime / ticksPerMs / parallelTicks));
+
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(setProcessThreads, void, 2, 2, "setProcessThreads(count);")
+{
+   gServerProcessList.startThreads(U32(getMax(dAtoi(argv[1]), 0)));
+}
+
+ConsoleFunction(processIslandStats, void, 1, 2, "processIslandStats(<reset>);")
+{
+   gServerProcessList.dumpIslandStats(argc > 1 && dAtob(argv[1]));
 }
@@ -547,6 +547,18 @@ struct StabPoint
 };
 
 
+// The stabilizer rays start inside the object box and reach twice the
+// longest stabilizer out of it.
+bool HoverVehicle::getIslandBox(Box3F* box)
+{
+   if (!Parent::getIslandBox(box))
+      return false;
+   F32 stab = 2 * getMax(mDataBlock->stabLenMin, mDataBlock->stabLenMax);
+   box->min -= Point3F(stab, stab, stab);
+   box->max += Point3F(stab, stab, stab);
+   return true;
+}
+
 void HoverVehicle::updateForces(F32 /*dt*/)
 {
    Point3F gravForce(0, 0, sHoverVehicleGravity * mGravityMod);
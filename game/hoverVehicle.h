@@ -186,6 +186,7 @@ class HoverVehicle : public Vehicle
 
    // Time/Move Management
   public:
+   bool getIslandBox(Box3F* box);
    void advanceTime(F32);
 
    DECLARE_CONOBJECT(HoverVehicle);
@@ -781,14 +781,13 @@ void Item::updatePos(const U32 /*mask*/, const F32 dt)
 
 //----------------------------------------------------------------------------
 
-static MatrixF IMat(1);
-
 bool Item::buildPolyList(AbstractPolyList* polyList, const Box3F&, const SphereF&)
 {
    // Collision with the item is always against the item's object
    // space bounding box axis aligned in world space.
    Point3F pos;
    mObjToWorld.getColumn(3,&pos);
+   MatrixF IMat(1);
    IMat.setColumn(3,pos);
    polyList->setTransform(&IMat, mObjScale);
    polyList->setObject(this);
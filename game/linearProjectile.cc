@@ -697,8 +697,14 @@ bool LinearProjectile::updatePos(const Point3F& oldPos,
    if(mSourceIdTimeoutTicks && bool(mVehicleObject))
       mVehicleObject->disableCollision();
    
+   // Server casts were gathered before the tick (see ProjectileManager)
    RayInfo rInfo;
-   if (mContainer->castRay(oldPos, newPos, csmDynamicCollisionMask, &rInfo) == true) {
+   bool hit;
+   if (mSweepIndex != -1)
+      hit = mContainer->getSweepBatch()->castRay(mSweepIndex, oldPos, newPos, csmDynamicCollisionMask, &rInfo);
+   else
+      hit = mContainer->castRay(oldPos, newPos, csmDynamicCollisionMask, &rInfo);
+   if (hit == true) {
       *hitPos    = rInfo.point;
       *hitNormal = rInfo.normal;
       *hitDelta  = rInfo.t;
@@ -813,6 +819,22 @@ Point3F LinearProjectile::getVelocity() const
 }
 
 
+//--------------------------------------------------------------------------
+bool LinearProjectile::getTickSweep(Point3F* start, Point3F* end, U32* mask)
+{
+   // The dynamic cast the server side of processTick will make, if it
+   // gets that far
+   U32 tick = mCurrTick + 1;
+   if (!isServerObject() || mHidden == true || tick >= mDeleteTick ||
+       ((tick - 1) * TickMs) >= mSegments[mNumSegments - 1].msEnd)
+      return false;
+
+   getTransform().getColumn(3, start);
+   *end  = deriveExactPosition(tick);
+   *mask = csmDynamicCollisionMask;
+   return true;
+}
+
 //--------------------------------------------------------------------------
 void LinearProjectile::processTick(const Move* move)
 {
@@ -123,6 +123,7 @@ class LinearProjectile : public Projectile
    virtual void renderObject(SceneState*, SceneRenderImage*);
 
    bool updatePos(const Point3F&, const Point3F&, F32*, Point3F*, Point3F*, SceneObject*&);
+   bool getTickSweep(Point3F*, Point3F*, U32*);
    void processTick(const Move*);
    void interpolateTick(F32);
    void advanceTime(F32);
@@ -169,6 +169,9 @@ static void sendRemoteCommand(NetConnection *conn, S32 argc, const char **argv)
       Con::errorf(ConsoleLogEntry::Script, "Remote Command Error - command must be a tag.");
       return;
    }
+   // the event would just be thrown away-
+   if(conn->isLean())
+      return;
    S32 i;
    for(i = argc - 1; i >= 0; i--)
    {
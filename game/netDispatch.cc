@@ -963,18 +963,27 @@ ConsoleFunction(stopRecord, void, 1, 1, "stopRecord();")
    conn->stopRecording();
 }
 
-ConsoleFunction(playDemo, void, 2, 2, "playDemo(recFileName)")
+ConsoleFunction(playDemo, void, 2, 3, "playDemo(recFileName, <fast>)")
 {
-   argc;
    GameConnection *conn = new GameConnection(false, true, false);
    conn->registerObject();
    NetConnection::setServerConnection(conn);
 
    Sim::getRootGroup()->addObject(conn, gServerConnectionName);
-   if(!conn->replayDemoRecord(argv[1]))
+   bool fast = argc > 2 && dAtob(argv[2]);
+   if(!conn->replayDemoRecord(argv[1], fast))
    {
       Con::printf("Unable to open demo file %s.", argv[1]);
       conn->deleteObject();
    }
 }
 
+ConsoleFunction(seekDemo, bool, 2, 2, "seekDemo(timeMS);")
+{
+   argc;
+   NetConnection *conn = NetConnection::getServerConnection();
+   if(!conn || !conn->isPlayingBack())
+      return false;
+   return conn->seekDemo(dAtoi(argv[1]));
+}
+
@@ -34,6 +34,8 @@
 #include "core/resManager.h"
 #include "interior/interiorRes.h"
 #include "interior/interiorInstance.h"
+#include "collision/boxTree.h"
+#include "collision/extrudedPolyList.h"
 #include "ts/tsShapeInstance.h"
 #include "terrain/terrData.h"
 #include "terrain/terrRender.h"
@@ -49,9 +51,12 @@
 #include "game/GameFunctions.h"
 #include "game/particleEngine.h"
 #include "game/targetManager.h"
+#include "game/gameBase.h"
 #include "platform/platformRedBook.h"
 #include "game/tribesGame.h"
 #include "game/netDispatch.h"
+#include "sim/netConnection.h"
+#include "game/benchmark.h"
 #include "sim/decalManager.h"
 #include "sim/frameAllocator.h"
 #include "scenegraph/detailManager.h"
@@ -179,6 +184,10 @@ static bool initLibraries()
    InteriorLMManager::init();
    InteriorInstance::init();
    TSShapeInstance::init();
+   TerrainBlock::installRayKernels();
+   gjkInstallKernels();
+   BoxTree::installKernels();
+   ExtrudedPolyList::installKernels();
    RedBook::init();
    
    return true;
@@ -369,6 +378,7 @@ void shutdownGame()
    ParticleEngine::destroy();
    PathManager::destroy();
    DetailManager::shutdown();
+   gServerProcessList.stopThreads();
 
    // Note: tho the SceneGraphs are created after the Manager, delete them after, rather
    //  than before to make sure that all the objects are removed from the graph.
@@ -437,6 +447,7 @@ S32 TribesGame::main(S32 argc, const char **argv)
       Con::setVariable(avar("Game::argv%d", i), argv[i]);
    if (initGame() == false)
       return 0;
+   Benchmark::start(argc, argv);
 
 #ifdef IHVBUILD
    char* pPrint = new char[dStrlen(sgVerPrintString) + 1];
@@ -457,13 +468,23 @@ S32 TribesGame::main(S32 argc, const char **argv)
    {
       PROFILE_START(MainLoop);
       Game->journalProcess();
+      Benchmark::process();
       //if(Game->getJournalMode() != GameInterface::JournalLoad)
       //{
          Net::process();      // read in all events
          Platform::process(); // keys, etc.
          TelConsole->process();
          TelDebugger->process();
-         TimeManager::process(); // guaranteed to produce an event
+         NetConnection *demo = NetConnection::getServerConnection();
+         if(demo && demo->isFastDemoPlayback())
+         {
+            // don't wait on the clock, step a demo tick every pass
+            TimeEvent event;
+            event.elapsedTime = demo->getDemoTickSize();
+            Game->postEvent(event);
+         }
+         else
+            TimeManager::process(); // guaranteed to produce an event
       //}
       PROFILE_END();
    }
@@ -656,7 +677,8 @@ void TribesGame::processTimeEvent(TimeEvent *event)
    clientNetProcess();
    PROFILE_END();
 
-   if(Canvas && gDGLRender)
+   NetConnection *demo = NetConnection::getServerConnection();
+   if(Canvas && gDGLRender && !Benchmark::isActive() && !(demo && demo->isFastDemoPlayback()))
    {
       bool preRenderOnly = false;
       if(gFrameSkip && gFrameCount % gFrameSkip)
@@ -1117,6 +1117,27 @@ void Player::updateWorkingCollisionSet()
    }
 }
 
+bool Player::getIslandBox(Box3F* box)
+{
+   if (!ticksWithinIslandBox())
+      return false;
+
+   // Whatever a rebuilt working set can reach, plus the cached one
+   // still in use (see updateWorkingCollisionSet), and the world box
+   // updateContainer queries with after the move
+   F32 l = ((mVelocity.len() + 10) * TickSec * 1.1) + 0.1;
+   *box = mConvex.getBoundingBox(getTransform(), getScale());
+   box->min.setMin(getWorldBox().min);
+   box->max.setMax(getWorldBox().max);
+   box->min -= Point3F(3 * l, 3 * l, 3 * l);
+   box->max += Point3F(3 * l, 3 * l, 3 * l);
+   if (mWorkingQueryBox.min.x != -1e9) {
+      box->min.setMin(mWorkingQueryBox.min);
+      box->max.setMax(mWorkingQueryBox.max);
+   }
+   return true;
+}
+
 
 bool Player::checkDismountPosition(const MatrixF& oldMat, const MatrixF& mat)
 {
@@ -1871,6 +1892,8 @@ void Player::updateDamageState()
       mTypeMask &= ~PlayerObjectType;
       mTypeMask |= CorpseObjectType;
    }
+   if (getContainer())
+      getContainer()->getSweepBatch()->objectTypeChanged(this);
 
    Parent::updateDamageState();
 }
@@ -2505,9 +2528,16 @@ bool Player::updatePos(const F32 travelTime)
    F32 time = travelTime;
    U32 count = 0;
 
-   static Polyhedron sBoxPolyhedron;
-   static ExtrudedPolyList sExtrudedPolyList;
-   static ExtrudedPolyList sPhysZonePolyList;
+   // One set per query context, the server can move players on more than
+   // one thread (see ProcessList::advanceObjects).
+   static Polyhedron sBoxPolyhedron[ContainerQueryContext::MaxContexts];
+   static ExtrudedPolyList sExtrudedPolyList[ContainerQueryContext::MaxContexts];
+   static ExtrudedPolyList sPhysZonePolyList[ContainerQueryContext::MaxContexts];
+   static EarlyOutPolyList sEarlyOutPolyList[ContainerQueryContext::MaxContexts];
+   const U32 slot = ContainerQueryContext::getCurrent()->getSlot();
+   Polyhedron& boxPolyhedron = sBoxPolyhedron[slot];
+   ExtrudedPolyList& extrudedPolyList = sExtrudedPolyList[slot];
+   ExtrudedPolyList& physZonePolyList = sPhysZonePolyList[slot];
 
    for (; count < sMoveRetryCount; count++) {
       F32 speed = mVelocity.len();
@@ -2535,7 +2565,7 @@ bool Player::updatePos(const F32 travelTime)
          wBox.min += end;
          wBox.max += end;
 
-         static EarlyOutPolyList eaPolyList;
+         EarlyOutPolyList& eaPolyList = sEarlyOutPolyList[slot];
          eaPolyList.clear();
          eaPolyList.mNormal.set(0,0,0);
          eaPolyList.mPlaneList.clear();
@@ -2583,7 +2613,7 @@ bool Player::updatePos(const F32 travelTime)
       }
 
       collisionMatrix.setColumn(3, start);
-      sBoxPolyhedron.buildBox(collisionMatrix, mObjBox);
+      boxPolyhedron.buildBox(collisionMatrix, mObjBox);
 
       // Setup the bounding box for the extrudedPolyList
       Box3F plistBox = mObjBox;
@@ -2595,13 +2625,13 @@ bool Player::updatePos(const F32 travelTime)
       
       // Build extruded polyList...
       VectorF vector = end - start;
-      sExtrudedPolyList.extrude(sBoxPolyhedron,vector);
-      sExtrudedPolyList.setVelocity(mVelocity);
-      sExtrudedPolyList.setCollisionList(&collisionList);
+      extrudedPolyList.extrude(boxPolyhedron,vector);
+      extrudedPolyList.setVelocity(mVelocity);
+      extrudedPolyList.setCollisionList(&collisionList);
 
-      sPhysZonePolyList.extrude(sBoxPolyhedron,vector);
-      sPhysZonePolyList.setVelocity(mVelocity);
-      sPhysZonePolyList.setCollisionList(&physZoneCollisionList);
+      physZonePolyList.extrude(boxPolyhedron,vector);
+      physZonePolyList.setVelocity(mVelocity);
+      physZonePolyList.setCollisionList(&physZoneCollisionList);
       
       // Build list from convex states here...
       CollisionWorkingList& rList = mConvex.getWorkingList();
@@ -2616,13 +2646,13 @@ bool Player::updatePos(const F32 travelTime)
                {
                   ForceFieldBare* pField = dynamic_cast<ForceFieldBare*>(pConvex->getObject());
                   if (pField == NULL || pField->isPermiableTo(this) == false)
-                     pConvex->getPolyList(&sExtrudedPolyList);
+                     pConvex->getPolyList(&extrudedPolyList);
                } else
                {
                   if (pConvex->getObject()->getTypeMask() & PhysicalZoneObjectType)
-                     pConvex->getPolyList(&sPhysZonePolyList);
+                     pConvex->getPolyList(&physZonePolyList);
                   else
-                     pConvex->getPolyList(&sExtrudedPolyList);
+                     pConvex->getPolyList(&extrudedPolyList);
                }
             }
          }
@@ -2815,7 +2845,8 @@ void Player::findContact(bool* run,bool* jump,VectorF* contactNormal)
    wBox.max.y = pos.y + mObjBox.max.y;
    wBox.max.z = pos.z + mObjBox.min.z + sTractionDistance;
 
-   static ClippedPolyList polyList;
+   static ClippedPolyList sPolyList[ContainerQueryContext::MaxContexts];
+   ClippedPolyList& polyList = sPolyList[ContainerQueryContext::getCurrent()->getSlot()];
    polyList.clear();
    polyList.doConstruct();
    polyList.mNormal.set(0,0,0);
@@ -2962,7 +2993,7 @@ F32 Player::getMass() const
 #define  LH_HACK   1
 // Hack for short-term soln to Training crash - 
 #if   LH_HACK
-static U32  sBalance;
+static THREAD_LOCAL U32  sBalance;
 
 bool Player::displaceObject(const Point3F& displacement)
 {
@@ -3313,14 +3344,13 @@ bool Player::castRay(const Point3F &start, const Point3F &end, RayInfo* info)
 
 //----------------------------------------------------------------------------
 
-static MatrixF IMat(1);
-
 bool Player::buildPolyList(AbstractPolyList* polyList, const Box3F&, const SphereF&)
 {
    // Collision with the player is always against the player's object
    // space bounding box axis aligned in world space.
    Point3F pos;
    getTransform().getColumn(3,&pos);
+   MatrixF IMat(1);
    IMat.setColumn(3,pos);
    polyList->setTransform(&IMat, Point3F(1,1,1));
    polyList->setObject(this);
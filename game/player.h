@@ -471,6 +471,7 @@ public:
    void setPilot(bool);
    bool isPilot() const;
    void processTick(const Move*);
+   bool getIslandBox(Box3F* box);
    void interpolateTick(F32 dt);
    void advanceTime(F32 dt);
    bool castRay(const Point3F &start, const Point3F &end, RayInfo* info);
@@ -15,6 +15,7 @@
 #include "game/shapeBase.h"
 #include "ts/tsShapeInstance.h"
 #include "game/projectile.h"
+#include "game/projectileManager.h"
 #include "audio/audio.h"
 #include "sim/decalManager.h"
 #include "game/splash.h"
@@ -459,6 +460,8 @@ Projectile::Projectile()
    mSourceObjectSlot = -1;
 
    mCurrTick         = 0;
+   mSweepIndex       = -1;
+   mManaged          = false;
 
    mProjectileShape  = NULL;
    mAmbientThread    = NULL;
@@ -498,7 +501,7 @@ void Projectile::initPersistFields()
 
 void Projectile::consoleInit()
 {
-   //
+   Con::addVariable("Projectile::batchSweeps", TypeBool, &ProjectileManager::smBatchSweeps);
 }
 
 
@@ -629,6 +632,9 @@ bool Projectile::onAdd()
 
 void Projectile::onRemove()
 {
+   if (mManaged)
+      gServerProjectileManager.removeProjectile(this);
+
    if (bool(mBaseEmitter)) {
       mBaseEmitter->deleteWhenEmpty();
       mBaseEmitter = NULL;
@@ -684,12 +690,22 @@ void Projectile::processTick(const Move* move)
 {
    Parent::processTick(move);
 
+   // Not before the first tick, onAdd can still fail further down
+   if (isServerObject() && !mManaged)
+      gServerProjectileManager.addProjectile(this);
+
    mCurrTick++;
    if (mSourceIdTimeoutTicks)
       mSourceIdTimeoutTicks--;
 }
 
 
+bool Projectile::getTickSweep(Point3F*, Point3F*, U32*)
+{
+   return false;
+}
+
+
 void Projectile::advanceTime(F32 dt)
 {
    Parent::advanceTime(dt);
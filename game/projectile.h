@@ -128,6 +128,7 @@ class ProjectileData : public GameBaseData
 class Projectile : public GameBase
 {
    typedef GameBase Parent;
+   friend class ProjectileManager;
 
   protected:
    enum ProjectileConstants {
@@ -190,6 +191,14 @@ class Projectile : public GameBase
    U32     mExcessVel;     // Excess velocity inherited from firing object, ranges
                            //  from 0 to 255, in 1 m/s increments
 
+   // Server only, the segment this tick's cast was batched under, or -1
+   S32     mSweepIndex;
+   bool    mManaged;       // in gServerProjectileManager
+
+   // The segment the next processTick will cast along, if it's known
+   // before the tick starts (see ProjectileManager).
+   virtual bool getTickSweep(Point3F* start, Point3F* end, U32* mask);
+
   protected:
    bool onAdd();
    void onRemove();
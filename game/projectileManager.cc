@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/projectileManager.h"
+#include "game/projectile.h"
+#include "Sim/sceneObject.h"
+#include "platform/profiler.h"
+
+//--------------------------------------------------------------------------
+
+ProjectileManager gServerProjectileManager;
+bool ProjectileManager::smBatchSweeps = true;
+
+ProjectileManager::ProjectileManager()
+{
+   VECTOR_SET_ASSOCIATION(mProjectiles);
+}
+
+void ProjectileManager::addProjectile(Projectile* projectile)
+{
+   projectile->mSweepIndex = -1;
+   projectile->mManaged = true;
+   mProjectiles.push_back(projectile);
+}
+
+void ProjectileManager::removeProjectile(Projectile* projectile)
+{
+   for (U32 i = 0; i < mProjectiles.size(); i++)
+      if (mProjectiles[i] == projectile) {
+         mProjectiles.erase_fast(i);
+         break;
+      }
+   projectile->mManaged = false;
+}
+
+void ProjectileManager::beginTick()
+{
+   if (!smBatchSweeps || !mProjectiles.size())
+      return;
+
+   PROFILE_START(ProjectileSweeps);
+   SweepBatch* batch = gServerContainer.getSweepBatch();
+   for (U32 i = 0; i < mProjectiles.size(); i++) {
+      Projectile* projectile = mProjectiles[i];
+      Point3F start, end;
+      U32 mask;
+      if (projectile->getTickSweep(&start, &end, &mask))
+         projectile->mSweepIndex = batch->addSweep(start, end, mask);
+   }
+   batch->begin();
+   PROFILE_END();
+}
+
+void ProjectileManager::endTick()
+{
+   // Projectiles added during the tick never had a sweep
+   for (U32 i = 0; i < mProjectiles.size(); i++)
+      mProjectiles[i]->mSweepIndex = -1;
+   gServerContainer.getSweepBatch()->end();
+}
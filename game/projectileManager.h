@@ -0,0 +1,46 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _PROJECTILEMANAGER_H_
+#define _PROJECTILEMANAGER_H_
+
+#ifndef _PLATFORM_H_
+#include "Platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "Core/tVector.h"
+#endif
+
+class Projectile;
+
+//--------------------------------------------------------------------------
+// The server projectiles.  Before each tick the segments they are going
+// to cast along (see Projectile::getTickSweep) go into the sweep batch of
+// the server container, so it is walked once for all of them instead of
+// once per cast.  The projectiles still tick, cast and collide in process
+// list order, only the casts are answered from the batch.
+
+class ProjectileManager
+{
+   Vector<Projectile*> mProjectiles;
+
+  public:
+   static bool smBatchSweeps;
+
+   ProjectileManager();
+
+   void addProjectile(Projectile*);
+   void removeProjectile(Projectile*);
+
+   // Around each server tick, see ProcessList::advanceServerTime
+   void beginTick();
+   void endTick();
+};
+
+extern ProjectileManager gServerProjectileManager;
+
+#endif
@@ -0,0 +1,422 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/proximityIndex.h"
+#include "game/gameConnection.h"
+#include "game/shapeBase.h"
+#include "game/gameBase.h"
+#include "console/console.h"
+#include "console/simBase.h"
+#include "math/mMath.h"
+
+ProximityIndex gServerProximity;
+
+// Players cover this in a couple of seconds, most AI queries are a cell or
+// a few across.
+F32 ProximityIndex::smCellSize = 64.0f;
+
+//--------------------------------------------------------------------------
+
+ProximityIndex::ProximityIndex()
+{
+   mBucketMask = 0;
+   mMaxExtent = 0;
+   mStats.clear();
+}
+
+void ProximityIndex::clear()
+{
+   mEntries.clear();
+   mBuckets.clear();
+   mBucketMask = 0;
+   mOversize.clear();
+   mMaxExtent = 0;
+}
+
+S32 ProximityIndex::cellCoord(F32 v) const
+{
+   return S32(mFloor(v / smCellSize));
+}
+
+U32 ProximityIndex::bucketOf(S32 x, S32 y) const
+{
+   return ((U32(x) * 73856093) ^ (U32(y) * 19349663)) & mBucketMask;
+}
+
+void ProximityIndex::addObject(SceneObject *object)
+{
+   mObjects.push_back(object);
+}
+
+// Shapes come and go at the end more than anywhere else-
+void ProximityIndex::removeObject(SceneObject *object)
+{
+   for (S32 i = mObjects.size() - 1; i >= 0; i--)
+      if (mObjects[i] == object) {
+         mObjects.erase_fast(i);
+         return;
+      }
+}
+
+void ProximityIndex::begin()
+{
+   mEntries.clear();
+   mOversize.clear();
+}
+
+ProximityIndex::Entry &ProximityIndex::add()
+{
+   mEntries.increment();
+   Entry &entry = mEntries.last();
+   entry.clientId = 0;
+   entry.objectId = 0;
+   entry.typeMask = 0;
+   entry.team = 0;
+   entry.isAI = false;
+   entry.position.set(0, 0, 0);
+   entry.extent.set(0, 0, 0);
+   entry.tag = -1;
+   return entry;
+}
+
+// The box of an object, and how far it can get from it before the next update.
+static void setObjectBox(ProximityIndex::Entry &entry, SceneObject *object)
+{
+   const Box3F &box = object->getWorldBox();
+   box.getCenter(&entry.position);
+   entry.extent = box.max - entry.position;
+
+   F32 slack = 0.25f;
+   if (object->getType() & ShapeBaseObjectType)
+      slack += static_cast<ShapeBase *>(object)->getVelocity().len() * TickSec * 2;
+   entry.extent += Point3F(slack, slack, slack);
+}
+
+void ProximityIndex::update()
+{
+   begin();
+
+   SimGroup *g = Sim::getClientGroup();
+   for (SimGroup::iterator i = g->begin(); i != g->end(); i++)
+   {
+      GameConnection *client = dynamic_cast<GameConnection *>(*i);
+      if (!client)
+         continue;
+      ShapeBase *control = client->getControlObject();
+      if (!control)
+         continue;
+
+      Entry &entry = add();
+      entry.clientId = client->getId();
+      entry.objectId = control->getId();
+      entry.typeMask = control->getType();
+      entry.team = client->getSensorGroup();
+      entry.isAI = client->isAIControlled();
+      setObjectBox(entry, control);
+   }
+
+   // Control objects are in already-
+   for (S32 o = 0; o < mObjects.size(); o++)
+   {
+      SceneObject *object = mObjects[o];
+      if (object->getType() & ShapeBaseObjectType) {
+         GameConnection *client = static_cast<ShapeBase *>(object)->getControllingClient();
+         if (client && client->getControlObject() == object)
+            continue;
+      }
+
+      Entry &entry = add();
+      entry.objectId = object->getId();
+      entry.typeMask = object->getType();
+      setObjectBox(entry, object);
+   }
+
+   finish();
+}
+
+void ProximityIndex::finish()
+{
+   mStats.updates++;
+
+   // Twice as many buckets as entries keeps the chains short-
+   U32 numBuckets = 64;
+   while (numBuckets < U32(mEntries.size()) * 2)
+      numBuckets <<= 1;
+   mBucketMask = numBuckets - 1;
+   mBuckets.setSize(numBuckets);
+   for (U32 b = 0; b < numBuckets; b++)
+      mBuckets[b] = -1;
+
+   mMaxExtent = 0;
+   for (S32 e = 0; e < mEntries.size(); e++)
+   {
+      Entry &entry = mEntries[e];
+      entry.cellX = cellCoord(entry.position.x);
+      entry.cellY = cellCoord(entry.position.y);
+      U32 b = bucketOf(entry.cellX, entry.cellY);
+      entry.next = mBuckets[b];
+      mBuckets[b] = e;
+
+      F32 extent = getMax(entry.extent.x, entry.extent.y);
+      if (extent > smCellSize)
+         mOversize.push_back(e);
+      else
+         mMaxExtent = getMax(mMaxExtent, extent);
+   }
+}
+
+//--------------------------------------------------------------------------
+
+bool ProximityIndex::passes(const Entry &entry, const Filter &filter) const
+{
+   if (!(entry.typeMask & filter.typeMask))
+      return false;
+   if (filter.excludeClient && entry.clientId == filter.excludeClient)
+      return false;
+   if (!entry.clientId && filter.clients != AllObjects)
+      return false;
+   if (filter.excludeTeam >= 0 && entry.team == U32(filter.excludeTeam))
+      return false;
+   if (filter.clients == HumanClients && entry.isAI)
+      return false;
+   if (filter.clients == AIClients && !entry.isAI)
+      return false;
+   return true;
+}
+
+F32 ProximityIndex::distSquared(const Entry &entry, const Point3F &center, const Filter &filter) const
+{
+   Point3F d = entry.position - center;
+   if (filter.planar)
+      d.z = 0;
+   return d.lenSquared();
+}
+
+bool ProximityIndex::touches(const Entry &entry, const Point3F &center, const Point3F &half) const
+{
+   return mFabs(entry.position.x - center.x) <= half.x + entry.extent.x &&
+          mFabs(entry.position.y - center.y) <= half.y + entry.extent.y &&
+          mFabs(entry.position.z - center.z) <= half.z + entry.extent.z;
+}
+
+// Other cells hash into the same bucket, so the cell has to be checked too.
+void ProximityIndex::gatherCell(S32 x, S32 y, const Point3F &center, F32 radiusSq,
+                                    const Filter &filter, EntryList &list)
+{
+   mStats.cellsVisited++;
+   for (S32 e = mBuckets[bucketOf(x, y)]; e >= 0; e = mEntries[e].next)
+   {
+      const Entry &entry = mEntries[e];
+      if (entry.cellX != x || entry.cellY != y)
+         continue;
+      mStats.entriesTested++;
+      if (distSquared(entry, center, filter) <= radiusSq && passes(entry, filter))
+         list.push_back(&entry);
+   }
+}
+
+void ProximityIndex::gatherAll(const Point3F &center, F32 radiusSq, const Filter &filter,
+                                    EntryList &list)
+{
+   mStats.linearScans++;
+   mStats.entriesTested += mEntries.size();
+   for (S32 e = 0; e < mEntries.size(); e++)
+   {
+      const Entry &entry = mEntries[e];
+      if (distSquared(entry, center, filter) <= radiusSq && passes(entry, filter))
+         list.push_back(&entry);
+   }
+}
+
+// When the query covers more cells than there are entries, just look at them all.
+void ProximityIndex::findRadius(const Point3F &center, F32 radius, const Filter &filter,
+                                    EntryList &list)
+{
+   list.clear();
+   mStats.queries++;
+   if (mEntries.empty() || radius < 0)
+      return;
+
+   F32 radiusSq = radius * radius;
+   S32 x0 = cellCoord(center.x - radius), x1 = cellCoord(center.x + radius);
+   S32 y0 = cellCoord(center.y - radius), y1 = cellCoord(center.y + radius);
+   F64 numCells = F64(x1 - x0 + 1) * F64(y1 - y0 + 1);
+
+   if (numCells > mEntries.size() * 2 + 8)
+      gatherAll(center, radiusSq, filter, list);
+   else
+      for (S32 y = y0; y <= y1; y++)
+         for (S32 x = x0; x <= x1; x++)
+            gatherCell(x, y, center, radiusSq, filter, list);
+}
+
+// Cells out as far as the widest entry that isn't oversize could reach in.
+void ProximityIndex::findBox(const Box3F &box, const Filter &filter, EntryList &list)
+{
+   list.clear();
+   mStats.queries++;
+   if (mEntries.empty())
+      return;
+
+   Point3F center, half;
+   box.getCenter(&center);
+   half = box.max - center;
+
+   S32 x0 = cellCoord(box.min.x - mMaxExtent), x1 = cellCoord(box.max.x + mMaxExtent);
+   S32 y0 = cellCoord(box.min.y - mMaxExtent), y1 = cellCoord(box.max.y + mMaxExtent);
+   F64 numCells = F64(x1 - x0 + 1) * F64(y1 - y0 + 1);
+
+   if (numCells > mEntries.size() * 2 + 8) {
+      mStats.linearScans++;
+      mStats.entriesTested += mEntries.size();
+      for (S32 e = 0; e < mEntries.size(); e++)
+         if (touches(mEntries[e], center, half) && passes(mEntries[e], filter))
+            list.push_back(&mEntries[e]);
+      return;
+   }
+
+   for (S32 y = y0; y <= y1; y++)
+      for (S32 x = x0; x <= x1; x++) {
+         mStats.cellsVisited++;
+         for (S32 e = mBuckets[bucketOf(x, y)]; e >= 0; e = mEntries[e].next)
+         {
+            const Entry &entry = mEntries[e];
+            if (entry.cellX != x || entry.cellY != y)
+               continue;
+            if (getMax(entry.extent.x, entry.extent.y) > smCellSize)
+               continue;
+            mStats.entriesTested++;
+            if (touches(entry, center, half) && passes(entry, filter))
+               list.push_back(&entry);
+         }
+      }
+
+   mStats.entriesTested += mOversize.size();
+   for (S32 i = 0; i < mOversize.size(); i++)
+      if (touches(mEntries[mOversize[i]], center, half) && passes(mEntries[mOversize[i]], filter))
+         list.push_back(&mEntries[mOversize[i]]);
+}
+
+//--------------------------------------------------------------------------
+
+struct ProximityNear
+{
+   F32                           distSq;
+   const ProximityIndex::Entry * entry;
+};
+
+static S32 QSORT_CALLBACK compareNear(const void *a, const void *b)
+{
+   F32 da = ((const ProximityNear *)a)->distSq;
+   F32 db = ((const ProximityNear *)b)->distSq;
+   if (da != db)
+      return (da < db ? -1 : 1);
+   // ties go by id so the order doesn't depend on the hash-
+   const ProximityIndex::Entry *ea = ((const ProximityNear *)a)->entry;
+   const ProximityIndex::Entry *eb = ((const ProximityNear *)b)->entry;
+   if (ea->clientId != eb->clientId)
+      return ea->clientId - eb->clientId;
+   return ea->objectId - eb->objectId;
+}
+
+static void sortNear(const Point3F &center, bool planar, ProximityIndex::EntryList &list,
+                     Vector<ProximityNear> &sorted)
+{
+   sorted.setSize(list.size());
+   for (S32 i = 0; i < list.size(); i++) {
+      Point3F d = list[i]->position - center;
+      if (planar)
+         d.z = 0;
+      sorted[i].distSq = d.lenSquared();
+      sorted[i].entry = list[i];
+   }
+   if (sorted.size() > 1)
+      dQsort(sorted.address(), sorted.size(), sizeof(ProximityNear), compareNear);
+}
+
+// Rings of cells out from the center's cell, until the count nearest so far are all
+// closer than anything outside the rings can be.
+void ProximityIndex::findNearest(const Point3F &center, S32 count, F32 maxDist,
+                                    const Filter &filter, EntryList &list)
+{
+   list.clear();
+   mStats.queries++;
+   if (mEntries.empty() || count <= 0 || maxDist < 0)
+      return;
+
+   F32 maxDistSq = maxDist * maxDist;
+   S32 cx = cellCoord(center.x), cy = cellCoord(center.y);
+   S32 cellsLeft = mEntries.size() * 2 + 8;
+   Vector<ProximityNear> sorted;
+
+   for (S32 r = 0; ; r++)
+   {
+      if (r == 0)
+         gatherCell(cx, cy, center, maxDistSq, filter, list);
+      else {
+         for (S32 x = cx - r; x <= cx + r; x++) {
+            gatherCell(x, cy - r, center, maxDistSq, filter, list);
+            gatherCell(x, cy + r, center, maxDistSq, filter, list);
+         }
+         for (S32 y = cy - r + 1; y <= cy + r - 1; y++) {
+            gatherCell(cx - r, y, center, maxDistSq, filter, list);
+            gatherCell(cx + r, y, center, maxDistSq, filter, list);
+         }
+      }
+
+      // Nothing outside the rings is nearer than their edge-
+      F32 edge = getMin(getMin(center.x - (cx - r) * smCellSize, (cx + r + 1) * smCellSize - center.x),
+                        getMin(center.y - (cy - r) * smCellSize, (cy + r + 1) * smCellSize - center.y));
+      if (edge >= maxDist)
+         break;
+      if (list.size() >= count) {
+         sortNear(center, filter.planar, list, sorted);
+         if (sorted[count - 1].distSq <= edge * edge)
+            break;
+      }
+
+      // Far enough out that walking the entries is cheaper-
+      if ((cellsLeft -= (r ? 8 * r : 1)) < 8 * (r + 1)) {
+         list.clear();
+         gatherAll(center, maxDistSq, filter, list);
+         break;
+      }
+   }
+
+   sortNear(center, filter.planar, list, sorted);
+   list.setSize(getMin(count, sorted.size()));
+   for (S32 i = 0; i < list.size(); i++)
+      list[i] = sorted[i].entry;
+}
+
+const ProximityIndex::Entry *ProximityIndex::findNearest(const Point3F &center, F32 maxDist,
+                                                            const Filter &filter)
+{
+   EntryList list;
+   findNearest(center, 1, maxDist, filter, list);
+   return list.empty() ? NULL : list[0];
+}
+
+//--------------------------------------------------------------------------
+
+void ProximityIndex::dumpStats(bool reset)
+{
+   U32 queries = getMax(mStats.queries, U32(1));
+   Con::printf("Proximity index: %d entries (%d oversize), %d registered objects, %d buckets, cell size %g",
+                  mEntries.size(), mOversize.size(), mObjects.size(), mBuckets.size(), smCellSize);
+   Con::printf("   updates: %d, queries: %d, linear scans: %d", mStats.updates,
+                  mStats.queries, mStats.linearScans);
+   Con::printf("   per query: %.1f cells, %.1f entries tested",
+                  F32(mStats.cellsVisited) / queries, F32(mStats.entriesTested) / queries);
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(proximityStats, void, 1, 2, "proximityStats(<reset>);")
+{
+   gServerProximity.dumpStats(argc > 1 && dAtob(argv[1]));
+}
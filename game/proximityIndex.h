@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _PROXIMITYINDEX_H_
+#define _PROXIMITYINDEX_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _MBOX_H_
+#include "math/mBox.h"
+#endif
+
+class SceneObject;
+
+//--------------------------------------------------------------------------
+// Where the clients are.  Once at the start of each server tick the control
+// object of every connection in the client group goes into a hash of 2D
+// cells, so the AI (and anything else that wants the players or vehicles
+// near a point) doesn't have to walk the client group and measure to all of
+// them.  Entries hold ids and the position as of the start of the tick, the
+// objects themselves can go away during the tick.
+//
+// Objects that register themselves (server shapes and static shapes, see
+// ShapeBase::onAdd) go in too, with no client, so box queries like the AI's
+// avoidance can find what they might bump into.  Other users fill an index of
+// their own with begin()/add()/finish(), e.g. the sensor tick's index of the
+// sensors (TargetManager::tickSensorState).
+
+class ProximityIndex
+{
+  public:
+   struct Entry
+   {
+      S32      clientId;      // 0 if no client controls it
+      S32      objectId;
+      U32      typeMask;      // of the (control) object
+      U32      team;          // client sensor group
+      bool     isAI;
+      Point3F  position;      // (control) object box center
+      Point3F  extent;        // half the box, plus what it may move in a tick
+      S32      tag;           // the filler's own, -1 in the server index
+      S32      cellX, cellY;
+      S32      next;          // in the bucket
+   };
+
+   enum ClientFilter {
+      AllClients,
+      HumanClients,
+      AIClients,
+      AllObjects        // the entries with no client too
+   };
+
+   struct Filter
+   {
+      U32            typeMask;         // control object must have one of these
+      ClientFilter   clients;
+      S32            excludeClient;
+      S32            excludeTeam;      // -1 for none
+      bool           planar;           // measure in the XY plane only
+
+      Filter() : typeMask(0xFFFFFFFF), clients(AllClients), excludeClient(0), excludeTeam(-1),
+                  planar(false) {}
+   };
+
+   typedef Vector<const Entry*> EntryList;
+
+   static F32 smCellSize;
+
+  protected:
+   Vector<Entry>  mEntries;
+   Vector<S32>    mBuckets;
+   U32            mBucketMask;
+   Vector<S32>    mOversize;     // entries wider than a cell, box queries check them all
+   F32            mMaxExtent;    // of the rest
+   Vector<SceneObject*> mObjects;
+
+   struct Stats {
+      U32   updates;
+      U32   queries;
+      U32   cellsVisited;
+      U32   entriesTested;
+      U32   linearScans;
+      void  clear() { dMemset(this, 0, sizeof(*this)); }
+   } mStats;
+
+   S32   cellCoord(F32 v) const;
+   U32   bucketOf(S32 x, S32 y) const;
+   bool  passes(const Entry& entry, const Filter& filter) const;
+   F32   distSquared(const Entry& entry, const Point3F& center, const Filter& filter) const;
+   bool  touches(const Entry& entry, const Point3F& center, const Point3F& half) const;
+   void  gatherCell(S32 x, S32 y, const Point3F& center, F32 radiusSq,
+                        const Filter& filter, EntryList& list);
+   void  gatherAll(const Point3F& center, F32 radiusSq, const Filter& filter, EntryList& list);
+
+  public:
+   ProximityIndex();
+
+   // Rebuilt from the client group, see ProcessList::advanceServerTime
+   void update();
+   void clear();
+
+   // Server objects stay in the index until they are removed.
+   void addObject(SceneObject* object);
+   void removeObject(SceneObject* object);
+
+   // Fill by hand: add() entries, set their fields except the cell, then finish().
+   void  begin();
+   Entry& add();
+   void  finish();
+
+   // Entries whose box (with the move slack) overlaps box, in no order.
+   void findBox(const Box3F& box, const Filter& filter, EntryList& list);
+
+   // Entries within radius of center, in no order.
+   void findRadius(const Point3F& center, F32 radius, const Filter& filter, EntryList& list);
+
+   // Up to count entries closest to center (and within maxDist), nearest first.
+   void findNearest(const Point3F& center, S32 count, F32 maxDist, const Filter& filter,
+                        EntryList& list);
+
+   // Nearest entry, NULL if none are within maxDist.
+   const Entry* findNearest(const Point3F& center, F32 maxDist, const Filter& filter);
+
+   S32   size() const  { return mEntries.size(); }
+   void  dumpStats(bool reset);
+};
+
+extern ProximityIndex gServerProximity;
+
+#endif
@@ -35,6 +35,8 @@
 #include "platform/profiler.h"
 #include "game/targetManager.h"
 #include "game/projSeeker.h"
+#include "console/simParallel.h"
+#include "game/proximityIndex.h"
 
 IMPLEMENT_CO_DATABLOCK_V1(ShapeBaseData);
 
@@ -239,6 +241,8 @@ bool ShapeBaseData::preload(bool server, char errorBuffer[256])
          dSprintf(buff, sizeof(buff), "LOS-%d", i + 1 + MaxCollisionShapes);
          if ((LOSDetails[i] = shape->findDetail(buff)) == -1)
             LOSDetails[i] = collisionDetails[i];
+         else
+            shape->buildCollisionTrees(LOSDetails[i]);
       }
 
       debrisDetail = shape->findDetail("Debris-17");
@@ -756,6 +760,10 @@ ShapeBase::ShapeBase()
 
 ShapeBase::~ShapeBase()
 {
+   // not in onRemove, a subclass's onAdd can still fail after ours added it
+   if (isServerObject())
+      gServerProximity.removeObject(this);
+
    delete mConvexList;
    mConvexList = NULL;
 
@@ -814,6 +822,9 @@ bool ShapeBase::onAdd()
 
    setHeat(mDataBlock->heat);
 
+   if (isServerObject())
+      gServerProximity.addObject(this);
+
    return true;
 }
 
@@ -1189,11 +1200,29 @@ void ShapeBase::advanceTime(F32 dt)
 }
 
 
+// Some ticks query far beyond anything an island box could cover: an AI
+// connection thinks (paths, detection, avoidance) in its move list, and seeker
+// images search their whole cone (thinkAboutLocking).  Those tick on the main
+// thread.
+bool ShapeBase::ticksWithinIslandBox()
+{
+   GameConnection* con = getControllingClient();
+   if (con && con->getControlObject() == this && con->isAIControlled())
+      return false;
+   ShapeBaseImageData* image = getMountedImage(0);
+   if (image && image->isSeeker)
+      return false;
+   return true;
+}
+
 void ShapeBase::thinkAboutLocking()
 {
    AssertFatal(isServerObject(), "Error, must not call this on the client!");
    AssertFatal(getMountedImage(0) && getMountedImage(0)->isSeeker, "Error, no image, or a non-seeker image!");
 
+   // Turns collision off on objects that may be ticking on other threads
+   SimSharedLock lock;
+
    // For right now, we're just going to check every tick.  This should
    //  be slowed down to every third or fourth tick.
 
@@ -1660,11 +1689,11 @@ void ShapeBase::setDamageLevel(F32 damage)
 
 //----------------------------------------------------------------------------
 
-static F32 sWaterDensity   = 1;
-static F32 sWaterViscosity = 15;
-static F32 sWaterCoverage  = 0;
-static U32 sWaterType      = 0;
-static F32 sWaterHeight    = 0.0f;
+static THREAD_LOCAL F32 sWaterDensity   = 1;
+static THREAD_LOCAL F32 sWaterViscosity = 15;
+static THREAD_LOCAL F32 sWaterCoverage  = 0;
+static THREAD_LOCAL U32 sWaterType      = 0;
+static THREAD_LOCAL F32 sWaterHeight    = 0.0f;
 
 static void waterFind(SceneObject* obj,S32 key)
 {
@@ -3129,7 +3158,10 @@ bool ShapeBase::castRay(const Point3F &start, const Point3F &end, RayInfo* info)
       info->object = NULL;
       for (U32 i = 0; i < ShapeBaseData::MaxCollisionShapes; i++) {
          if (mDataBlock->LOSDetails[i] != -1) {
-            mShapeInstance->animate(mDataBlock->LOSDetails[i]);
+            // Animating writes the shared node transforms, queries from
+            //  other threads collide with the last animated pose.
+            if (ContainerQueryContext::getCurrent()->isMainContext())
+               mShapeInstance->animate(mDataBlock->LOSDetails[i]);
             if (mShapeInstance->castRay(start, end, info, mDataBlock->LOSDetails[i])) {
                info->object = this;
                if (info->t < shortest.t) {
@@ -3152,16 +3184,27 @@ bool ShapeBase::castRay(const Point3F &start, const Point3F &end, RayInfo* info)
 
 //----------------------------------------------------------------------------
 
-bool ShapeBase::buildPolyList(AbstractPolyList* polyList, const Box3F &, const SphereF &)
+bool ShapeBase::buildPolyList(AbstractPolyList* polyList, const Box3F &box, const SphereF &)
 {
    if (mShapeInstance) {
       bool ret = false;
 
+      // Static shapes only emit the triangles in the box.  The others get
+      // asked with made up boxes (see Vehicle::renderObject).
+      Box3F objBox = box;
+      const Box3F* pBox = NULL;
+      if (getType() & StaticObjectType) {
+         mWorldToObj.mul(objBox);
+         objBox.min.convolveInverse(mObjScale);
+         objBox.max.convolveInverse(mObjScale);
+         pBox = &objBox;
+      }
+
       polyList->setTransform(&mObjToWorld, mObjScale);
       polyList->setObject(this);
       for (U32 i = 0; i < ShapeBaseData::MaxCollisionShapes; i++) {
          if (mDataBlock->collisionDetails[i] != -1) {
-            mShapeInstance->buildPolyList(polyList,mDataBlock->collisionDetails[i]);
+            mShapeInstance->buildPolyList(polyList,mDataBlock->collisionDetails[i],pBox);
             ret = true;
          }
       }
@@ -3880,17 +3923,7 @@ Point3F ShapeBaseConvex::support(const VectorF& v) const
       pShapeBase->mShapeInstance->getShape()->getAccelerator(pShapeBase->mDataBlock->collisionDetails[hullId]);
    AssertFatal(pAccel != NULL, "Error, no accel!");
 
-   F32 currMaxDP = mDot(pAccel->vertexList[0], v);
-   U32 index = 0;
-   for (U32 i = 1; i < pAccel->numVerts; i++) {
-      F32 dp = mDot(pAccel->vertexList[i], v);
-      if (dp > currMaxDP) {
-         currMaxDP = dp;
-         index = i;
-      }
-   }
-
-   return pAccel->vertexList[index];
+   return pAccel->vertexList[gjkSupportIndex(pAccel->soaVerts, pAccel->numPaddedVerts, v)];
 }
 
 
@@ -3945,6 +3978,8 @@ void ShapeBaseConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFe
 
 void ShapeBaseConvex::getPolyList(AbstractPolyList* list)
 {
+   // Animating the collision detail doesn't need the shared lock: a shape
+   // close enough to be on a working list is in the same island.
    list->setTransform(&pShapeBase->getTransform(), pShapeBase->getScale());
    list->setObject(pShapeBase);
 
@@ -883,6 +883,7 @@ protected:
    virtual void setControllingObject(ShapeBase* obj);
    virtual ShapeBase* getControlObject();
    virtual void setControlObject(ShapeBase*);
+   bool ticksWithinIslandBox();
    bool isFirstPerson();
    bool useObjsEyePoint() const;
    bool onlyFirstPerson() const;
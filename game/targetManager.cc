@@ -16,6 +16,9 @@
 
 //------------------------------------------------------------------------------
 TargetManager *   gTargetManager = NULL;
+
+bool TargetManager::smUseSensorIndex = true;
+bool TargetManager::smCompareSensorIndex = false;
 HUDTargetList *   gTargetList = NULL;
 
 //------------------------------------------------------------------------------
@@ -479,7 +482,7 @@ bool TargetManager::playTargetAudio(S32 targetId, S32 fileTag, AudioDescription
       if(con->isServerConnection())
          continue;
 
-      if (dynamic_cast<GameConnection*>(con) && static_cast<GameConnection*>(con)->isAIControlled())
+      if (con->isLean())
          continue;
       
       ShapeBase * controlObj = static_cast<GameConnection*>(con)->getControlObject();
@@ -506,6 +509,8 @@ bool TargetManager::playTargetAudio(S32 targetId, S32 fileTag, AudioDescription
 TargetManager::TargetManager()
 {
    VECTOR_SET_ASSOCIATION(notifyList);
+   mSensorReach = 0;
+   mSensorStats.clear();
    clear();
 }
 
@@ -616,7 +621,7 @@ IMPLEMENT_CO_CLIENTEVENT_V1(SensorGroupColorEvent);
 
 void TargetManager::clientSensorGroupChanged(NetConnection * client, U32 newGroup)
 {
-   if(dynamic_cast<GameConnection*>(client) && static_cast<GameConnection*>(client)->isAIControlled())
+   if(client->isLean())
       return;
    client->postNetEvent(new SensorGroupColorEvent(newGroup, 0xffffffff));
 }
@@ -685,7 +690,7 @@ bool TargetManager::getGameName(S32 target, char * buf, S32 bufSize, bool server
 //-----------------------------------------------------------------------------
 void TargetManager::newClient(NetConnection *client)
 {
-   if(dynamic_cast<GameConnection*>(client) && static_cast<GameConnection*>(client)->isAIControlled())
+   if(client->isLean())
       return;
 
    for(U32 i = 0; i < TargetFreeMaskSize; i++)
@@ -768,7 +773,7 @@ void TargetManager::updateTarget(S32 targ, S32 nameTag, S32 skinTag, S32 voiceTa
       if(conn->isServerConnection())
          continue;
 
-      if (dynamic_cast<GameConnection*>(conn) && static_cast<GameConnection*>(conn)->isAIControlled())
+      if (conn->isLean())
          continue;
 
       if(nameTag != -1)
@@ -793,7 +798,7 @@ void TargetManager::freeTarget(S32 target)
    {
       if(conn->isServerConnection())
          continue;
-      if (dynamic_cast<GameConnection*>(conn) && static_cast<GameConnection*>(conn)->isAIControlled())
+      if (conn->isLean())
          continue;
       conn->postNetEvent(new TargetFreeEvent(target));
    }
@@ -879,7 +884,7 @@ void TargetManager::reset()
       if(con->isServerConnection())
          continue;
 
-      if (dynamic_cast<GameConnection*>(con) && static_cast<GameConnection*>(con)->isAIControlled())
+      if (con->isLean())
          continue;
 
       resetClient(con);
@@ -1243,7 +1248,7 @@ static void cResetClientTargets(SimObject *, S32, const char ** argv)
    NetConnection * client = dynamic_cast<NetConnection*>(Sim::findObject(dAtoi(argv[1])));
    if(client)
    {
-      if(dynamic_cast<GameConnection*>(client) && static_cast<GameConnection*>(client)->isAIControlled())
+      if(client->isLean())
          return;
 
       client->postNetEvent( new ResetClientTargetsEvent(dAtob(argv[2])) );
@@ -1729,6 +1734,11 @@ static void cPlayTargetAudio(SimObject *, S32 argc, const char ** argv)
       Con::warnf("Failed to send target audio event to clients");
 }
 
+static void cSensorIndexStats(SimObject *, S32 argc, const char ** argv)
+{
+   gTargetManager->dumpSensorStats(argc > 1 && dAtob(argv[1]));
+}
+
 void TargetManager::create()
 {
    gTargetManager = new TargetManager;
@@ -1796,6 +1806,10 @@ void TargetManager::create()
    Con::setIntVariable("$TargetInfo::CommanderListRender",  TargetInfo::CommanderListRender);
 
    Con::addCommand("playTargetAudio",        cPlayTargetAudio,       "playTargetAudio(target, fileTag, desc, update)",        5, 5);
+
+   Con::addCommand("sensorIndexStats",       cSensorIndexStats,      "sensorIndexStats(<reset>)",                             1, 2);
+   Con::addVariable("Sensor::useIndex",      TypeBool,               &TargetManager::smUseSensorIndex);
+   Con::addVariable("Sensor::compareIndex",  TypeBool,               &TargetManager::smCompareSensorIndex);
 }
 
 void TargetManager::destroy()
@@ -2387,7 +2401,7 @@ static void cRemoveClientTargetType(SimObject *, S32, const char ** argv)
    NetConnection * client = dynamic_cast<NetConnection*>(Sim::findObject(dAtoi(argv[1])));
    if(client && !client->isServerConnection())
    {
-      if(dynamic_cast<GameConnection*>(client) && static_cast<GameConnection*>(client)->isAIControlled())
+      if(client->isLean())
          return;
       client->postNetEvent( new RemoveClientTargetTypeEvent(type) );
    }
@@ -2473,256 +2487,381 @@ static inline bool testLOS(GameBase * sensor, const Point3F & sensorPos,
    return(hasLOS);
 }
 
-void TargetManager::tickSensorState()
+// Players sense and are sensed from their eye, everything else from its box center.
+static void getSensePoint(GameBase * object, Point3F * pos)
 {
-   U32 objectCount = 0;
-   U32 totalCount = MaxTargets - mFreeCount;
-   U32 pingCount = (totalCount >> 5) + 1;  // ping everything once a second
-   U32 lastSensed = mLastSensedObject;
+   if(object->getType() & PlayerObjectType)
+   {
+      AssertFatal(dynamic_cast<Player*>(object), "Invalid player object.");
 
-   for(U32 i = mLastSensedObject + 1; i - mLastSensedObject < MaxTargets; i++)
+      MatrixF eye;
+      static_cast<Player*>(object)->getEyeTransform(&eye);
+      eye.getColumn(3, pos);
+   }
+   else
+      *pos = object->getBoxCenter();
+}
+
+// The sensors reaching no further than a few cells go in the index, the rest
+// every target has to look at anyway.  Nothing moves during the sensor tick, so
+// the positions are exact.
+void TargetManager::buildSensorIndex()
+{
+   F32 wideReach = ProximityIndex::smCellSize * 4;
+
+   mSensorIndex.begin();
+   mWideSensors.clear();
+   mSensorReach = 0;
+   for(U32 sens = 0; sens < MaxTargets; sens++)
    {
-      U32 index = i & (MaxTargets - 1);
-      U32 maskPos = index >> 5;
-      U32 maskShift = index & 0x1F;
-      if((maskShift == 0) && mFreeMask[maskPos] == 0)
+      U32 smaskPos = sens >> 5;
+      U32 smaskShift = sens & 0x1F;
+      if((smaskShift == 0) && mFreeMask[smaskPos] == 0)
       {
-         i += 31;
+         sens += 31;
          continue;
       }
-      if(!(mFreeMask[maskPos] & (1 << maskShift)))
+      if(!(mFreeMask[smaskPos] & (1 << smaskShift)))
          continue;
-      TargetInfo *targetInfo = mTargets + index;
-      
-      if(!bool(targetInfo->targetObject))
+      TargetInfo *sensorInfo = mTargets + sens;
+      if(!bool(sensorInfo->targetObject) || !sensorInfo->sensorData)
          continue;
-         
-      GameBase * target = targetInfo->targetObject;
-      
-      // ok, we have an object
-      // now loop through all the sensable objects
-      U32 baseVisMask = 0;
-      U32 activeJamVisMask = 0;
-      U32 passiveJamVisMask = 0;
-      U32 cloakVisMask = 0;
-      bool pinged = false;
-      bool jammed = false;
-      bool enemyJammed = false;
-      
-      Point3F targetPos;
-      
-      // grab eye point if player...
-      if(target->getType() & PlayerObjectType)
+      GameBase *sensor = sensorInfo->targetObject;
+      SensorData *sensorData = sensorInfo->sensorData;
+
+      // the detection cylinder or the jamming sphere, whichever is wider
+      F32 reachSq = 0;
+      if(sensorData->detects)
+         reachSq = sensorData->detectRSquared;
+      if(sensorData->jams)
+         reachSq = getMax(reachSq, sensorData->jamRSquared);
+      F32 reach = mSqrt(reachSq);
+      if(reach > wideReach)
       {
-         AssertFatal(dynamic_cast<Player*>(target), "Invalid player object.");
-         Player * player = static_cast<Player*>(target);
-
-         MatrixF eye;
-         player->getEyeTransform(&eye);
-         eye.getColumn(3, &targetPos);
+         mWideSensors.push_back(sens);
+         continue;
       }
-      else
-         targetPos = target->getBoxCenter();
-         
-      Point3F targetVec;
 
-      for(U32 sens = 0; sens < MaxTargets; sens++)
-      {
-         bool testedLOS = false;
-         bool hasLOS = false;
-         U32 smaskPos = sens >> 5;
-         U32 smaskShift = sens & 0x1F;
-         if((smaskShift == 0) && mFreeMask[smaskPos] == 0)
-         {
-            sens += 31;
-            continue;
-         }
-         if(!(mFreeMask[smaskPos] & (1 << smaskShift)))
-            continue;
-         TargetInfo *sensorInfo = mTargets + sens;
-         if(!bool(sensorInfo->targetObject))
-            continue;
-         GameBase *sensor = sensorInfo->targetObject;
-         SensorData *sensorData = sensorInfo->sensorData;
-         
-         if(!sensor || !sensorData)
-            continue;
+      ProximityIndex::Entry &entry = mSensorIndex.add();
+      entry.objectId = sensor->getId();
+      entry.typeMask = sensor->getType();
+      entry.team = sensorInfo->sensorGroup;
+      entry.tag = sens;
+      getSensePoint(sensor, &entry.position);
+      mSensorReach = getMax(mSensorReach, reach);
+   }
+   mSensorIndex.finish();
+}
 
-         // can't detect its own bad self, but can jam...
-         if(sens == index)
-         {
-            if(sensorData->jams)
-               jammed = true;
-            continue;
-         }
-         // sensors must be shapebase items (need damage state)
-         if(!dynamic_cast<ShapeBase*>(sensor))
-            continue;
+static S32 QSORT_CALLBACK compareSensors(const void *a, const void *b)
+{
+   return *((const S32 *)a) - *((const S32 *)b);
+}
 
-         ShapeBase * sensorShape = static_cast<ShapeBase*>(sensor);
-         if(sensorShape->getDamageState() != ShapeBase::Enabled)
-            continue;
+// The sensors that might reach targetPos, in target order: the jamming depends on
+// the order they are scanned in.  A target that is a sensor itself is always in,
+// it can jam itself at any range.
+void TargetManager::findSensors(U32 index, const Point3F & targetPos)
+{
+   ProximityIndex::Filter filter;
+   filter.clients = ProximityIndex::AllObjects;
+   filter.planar = true;
+   mSensorIndex.findRadius(targetPos, mSensorReach + 1.f, filter, mSensorHits);
 
-         Point3F sensorPos;
+   mSensorList = mWideSensors;
+   for(S32 i = 0; i < mSensorHits.size(); i++)
+      mSensorList.push_back(mSensorHits[i]->tag);
+   if(mTargets[index].sensorData)
+      mSensorList.push_back(index);
+   if(mSensorList.size() > 1)
+      dQsort(mSensorList.address(), mSensorList.size(), sizeof(S32), compareSensors);
 
-         bool jumpNoDetect = false;
+   S32 count = 0;
+   for(S32 i = 0; i < mSensorList.size(); i++)
+      if(!count || mSensorList[i] != mSensorList[count - 1])
+         mSensorList[count++] = mSensorList[i];
+   mSensorList.setSize(count);
+}
 
-         // jams? and is/not always visible?
-         U32 sensorMask = 1 << sensorInfo->sensorGroup;
-         if((targetInfo->sensorAlwaysVisMask | targetInfo->sensorNeverVisMask) & sensorMask)
-         {
-            if(sensorData->jams)
-               jumpNoDetect = true;
-            else
-               continue;
-         }
+// Everything the sensors (all of them, or just the listed ones in order) make
+// of one target.
+void TargetManager::scanSensors(U32 index, const Point3F & targetPos, const Vector<S32> * sensors,
+                                SensorScan & scan)
+{
+   TargetInfo *targetInfo = mTargets + index;
+   GameBase * target = targetInfo->targetObject;
 
-         // grab the sensor position (grab eye of players)
-         // if this is a player then grab its eye...
-         if(sensor->getType() & PlayerObjectType)
-         {
-            AssertFatal(dynamic_cast<Player*>(sensor), "Invalid player object.");
+   scan.baseVisMask = 0;
+   scan.activeJamVisMask = 0;
+   scan.passiveJamVisMask = 0;
+   scan.cloakVisMask = 0;
+   scan.pinged = false;
+   scan.jammed = false;
+   scan.enemyJammed = false;
 
-            MatrixF eye;
-            sensorShape->getEyeTransform(&eye);
-            eye.getColumn(3, &sensorPos);
-         }
-         else
-            sensorPos = sensor->getBoxCenter();
+   Point3F targetVec;
 
-         // jams but is visible?
-         if(jumpNoDetect)
-            goto nodetect;
+   U32 count = sensors ? sensors->size() : MaxTargets;
+   for(U32 s = 0; s < count; s++)
+   {
+      bool testedLOS = false;
+      bool hasLOS = false;
+      U32 sens = sensors ? (*sensors)[s] : s;
+      U32 smaskPos = sens >> 5;
+      U32 smaskShift = sens & 0x1F;
+      if(!sensors && (smaskShift == 0) && mFreeMask[smaskPos] == 0)
+      {
+         s += 31;
+         continue;
+      }
+      if(!(mFreeMask[smaskPos] & (1 << smaskShift)))
+         continue;
+      TargetInfo *sensorInfo = mTargets + sens;
+      if(!bool(sensorInfo->targetObject))
+         continue;
+      GameBase *sensor = sensorInfo->targetObject;
+      SensorData *sensorData = sensorInfo->sensorData;
+      
+      if(!sensor || !sensorData)
+         continue;
+      mSensorStats.sensorsTested++;
 
-         // see if the sensor detects stuff:
-         if(!sensorData->detects)
-            goto nodetect;
+      // can't detect its own bad self, but can jam...
+      if(sens == index)
+      {
+         if(sensorData->jams)
+            scan.jammed = true;
+         continue;
+      }
+      // sensors must be shapebase items (need damage state)
+      if(!dynamic_cast<ShapeBase*>(sensor))
+         continue;
 
-         U32 *mask;
-         if(sensorData->detectsActiveJammed)       // everything
-            mask = &activeJamVisMask;
-         else if(sensorData->detectsCloaked)       // all but motion
-            mask = &cloakVisMask;
-         else if(sensorData->detectsPassiveJammed) // all but motion and los
-            mask = &passiveJamVisMask;
-         else
-            mask = &baseVisMask;
+      ShapeBase * sensorShape = static_cast<ShapeBase*>(sensor);
+      if(sensorShape->getDamageState() != ShapeBase::Enabled)
+         continue;
 
-         // see if we can skip this one:
-         if((*mask & sensorMask) && (pinged == sensorData->detectionPings))
-            goto nodetect;
+      Point3F sensorPos;
 
-         targetVec = targetPos - sensorPos;
+      bool jumpNoDetect = false;
 
-         // check distance:
-         if(targetVec.isZero())
+      // jams? and is/not always visible?
+      U32 sensorMask = 1 << sensorInfo->sensorGroup;
+      if((targetInfo->sensorAlwaysVisMask | targetInfo->sensorNeverVisMask) & sensorMask)
+      {
+         if(sensorData->jams)
+            jumpNoDetect = true;
+         else
             continue;
-         
-         // uncapped cylinder
-         if(Point2F(targetVec.x, targetVec.y).lenSquared() > sensorData->detectRSquared)
-            goto nodetect;
+      }
+
+      // grab the sensor position (grab eye of players)
+      // if this is a player then grab its eye...
+      if(sensor->getType() & PlayerObjectType)
+      {
+         AssertFatal(dynamic_cast<Player*>(sensor), "Invalid player object.");
+
+         MatrixF eye;
+         sensorShape->getEyeTransform(&eye);
+         eye.getColumn(3, &sensorPos);
+      }
+      else
+         sensorPos = sensor->getBoxCenter();
+
+      // jams but is visible?
+      if(jumpNoDetect)
+         goto nodetect;
+
+      // see if the sensor detects stuff:
+      if(!sensorData->detects)
+         goto nodetect;
+
+      U32 *mask;
+      if(sensorData->detectsActiveJammed)       // everything
+         mask = &scan.activeJamVisMask;
+      else if(sensorData->detectsCloaked)       // all but motion
+         mask = &scan.cloakVisMask;
+      else if(sensorData->detectsPassiveJammed) // all but motion and los
+         mask = &scan.passiveJamVisMask;
+      else
+         mask = &scan.baseVisMask;
+
+      // see if we can skip this one:
+      if((*mask & sensorMask) && (scan.pinged == sensorData->detectionPings))
+         goto nodetect;
+
+      targetVec = targetPos - sensorPos;
+
+      // check distance:
+      if(targetVec.isZero())
+         continue;
+      
+      // uncapped cylinder
+      if(Point2F(targetVec.x, targetVec.y).lenSquared() > sensorData->detectRSquared)
+         goto nodetect;
 
 // normal sphere
 //         if(targetVec.lenSquared() > sensorData->detectRSquared)
 //            goto nodetect;
 
-         // minvel:
-         if(sensorData->detectMinVelocity != 0.f)
-            if(target->getVelocity().lenSquared() < sensorData->detectMinVSquared)
-               goto nodetect;
+      // minvel:
+      if(sensorData->detectMinVelocity != 0.f)
+         if(target->getVelocity().lenSquared() < sensorData->detectMinVSquared)
+            goto nodetect;
 
-         // fov:
-         if(sensorData->detectsFOVOnly)
-         {
-            MatrixF camMat;
-            sensorShape->getEyeTransform(&camMat);
+      // fov:
+      if(sensorData->detectsFOVOnly)
+      {
+         MatrixF camMat;
+         sensorShape->getEyeTransform(&camMat);
 
-            VectorF camDir;
-            camMat.mulV(VectorF(0,1,0), &camDir);
-            targetVec.normalize();
+         VectorF camDir;
+         camMat.mulV(VectorF(0,1,0), &camDir);
+         targetVec.normalize();
 
-            F32 dot = mClampF(mDot(targetVec, camDir), -1.f, 1.f);
+         F32 dot = mClampF(mDot(targetVec, camDir), -1.f, 1.f);
 
-            // check if interested in projected fov through this object
-            if(sensorData->useObjectFOV)
-            {
-               F32 objectFov = mDegToRad(sensorShape->getCameraFov());
-               F32 halfFovCos = mCos(objectFov / 2.f);
-               if(dot < halfFovCos)
-                  goto nodetect;
+         // check if interested in projected fov through this object
+         if(sensorData->useObjectFOV)
+         {
+            F32 objectFov = mDegToRad(sensorShape->getCameraFov());
+            F32 halfFovCos = mCos(objectFov / 2.f);
+            if(dot < halfFovCos)
+               goto nodetect;
 
-               if(sensorData->detectFOVPercent != 0.f)
-               {
-                  F32 objRadius = target->getWorldSphere().radius;
-                  F32 distance = Point3F(targetPos - sensorPos).len();
-               
-                  F32 projRadius = distance * mTan(objectFov / 2.f);
+            if(sensorData->detectFOVPercent != 0.f)
+            {
+               F32 objRadius = target->getWorldSphere().radius;
+               F32 distance = Point3F(targetPos - sensorPos).len();
+            
+               F32 projRadius = distance * mTan(objectFov / 2.f);
 
-                  if(((objRadius / projRadius) * 100.f) < sensorData->detectFOVPercent)
-                     goto nodetect;
-               }
-            }
-            else
-               if(dot < sensorData->halfFovCos)
+               if(((objRadius / projRadius) * 100.f) < sensorData->detectFOVPercent)
                   goto nodetect;
+            }
          }
-
-         // los:
-         if(sensorData->detectsUsingLOS)
-         {
-            testedLOS = true;
-            hasLOS = testLOS(sensor, sensorPos, target, targetPos);
-            if(!hasLOS)
+         else
+            if(dot < sensorData->halfFovCos)
                goto nodetect;
-         }
+      }
+
+      // los:
+      if(sensorData->detectsUsingLOS)
+      {
+         testedLOS = true;
+         hasLOS = testLOS(sensor, sensorPos, target, targetPos);
+         if(!hasLOS)
+            goto nodetect;
+      }
 
-         // it's detected
-         *mask |= sensorMask;
+      // it's detected
+      *mask |= sensorMask;
 
-         // friendly do not ping
-         if(sensorData->detectionPings && !(sensorInfo->sensorFriendlyMask & (1 << targetInfo->sensorGroup)))
-            pinged = true;
+      // friendly do not ping
+      if(sensorData->detectionPings && !(sensorInfo->sensorFriendlyMask & (1 << targetInfo->sensorGroup)))
+         scan.pinged = true;
 
 nodetect:
-         
-         // early out?
-         if(!sensorData->jams || (jammed && enemyJammed))
+      
+      // early out?
+      if(!sensorData->jams || (scan.jammed && scan.enemyJammed))
+         continue;
+
+      if(sensorInfo->sensorGroup == targetInfo->sensorGroup)
+      {
+         if(scan.jammed)
             continue;
+      }
+      else
+      {
+         if(scan.enemyJammed && sensorData->jamsOnlyGroup)
+            continue;
+      }
 
-         if(sensorInfo->sensorGroup == targetInfo->sensorGroup)
-         {
-            if(jammed)
-               continue;
-         }
-         else
-         {
-            if(enemyJammed && sensorData->jamsOnlyGroup)
-               continue;
-         }
+      // normal sphere
+      if((targetPos - sensorPos).lenSquared() > sensorData->jamRSquared)
+         continue;
 
-         // normal sphere
-         if((targetPos - sensorPos).lenSquared() > sensorData->jamRSquared)
+      // check los
+      if(sensorData->jamsUsingLOS)
+      {
+         if(!testedLOS)
+            hasLOS = testLOS(sensor, sensorPos, target, targetPos);
+
+         if(!hasLOS)
             continue;
+      }
 
-         // check los
-         if(sensorData->jamsUsingLOS)
-         {
-            if(!testedLOS)
-               hasLOS = testLOS(sensor, sensorPos, target, targetPos);
+      // set the jammed state
+      if(sensorInfo->sensorGroup == targetInfo->sensorGroup)
+         scan.jammed = true;
+      else
+      {
+         scan.jammed = !sensorData->jamsOnlyGroup;
+         scan.enemyJammed = true;
+      }
+   }
+}
 
-            if(!hasLOS)
-               continue;
-         }
+void TargetManager::tickSensorState()
+{
+   U32 objectCount = 0;
+   U32 totalCount = MaxTargets - mFreeCount;
+   U32 pingCount = (totalCount >> 5) + 1;  // ping everything once a second
+   U32 lastSensed = mLastSensedObject;
 
-         // set the jammed state
-         if(sensorInfo->sensorGroup == targetInfo->sensorGroup)
-            jammed = true;
-         else
+   mSensorStats.ticks++;
+   if(smUseSensorIndex)
+      buildSensorIndex();
+
+   for(U32 i = mLastSensedObject + 1; i - mLastSensedObject < MaxTargets; i++)
+   {
+      U32 index = i & (MaxTargets - 1);
+      U32 maskPos = index >> 5;
+      U32 maskShift = index & 0x1F;
+      if((maskShift == 0) && mFreeMask[maskPos] == 0)
+      {
+         i += 31;
+         continue;
+      }
+      if(!(mFreeMask[maskPos] & (1 << maskShift)))
+         continue;
+      TargetInfo *targetInfo = mTargets + index;
+      
+      if(!bool(targetInfo->targetObject))
+         continue;
+         
+      GameBase * target = targetInfo->targetObject;
+      
+      Point3F targetPos;
+      getSensePoint(target, &targetPos);
+
+      // ok, we have an object
+      // now loop through the sensable objects
+      SensorScan scan;
+      mSensorStats.targets++;
+      if(smUseSensorIndex)
+      {
+         findSensors(index, targetPos);
+         scanSensors(index, targetPos, &mSensorList, scan);
+
+         // the full scan is the reference
+         if(smCompareSensorIndex)
          {
-            jammed = !sensorData->jamsOnlyGroup;
-            enemyJammed = true;
+            SensorScan full;
+            U32 tested = mSensorStats.sensorsTested;
+            scanSensors(index, targetPos, NULL, full);
+            mSensorStats.sensorsTested = tested;
+            mSensorStats.compared++;
+            if(scan.baseVisMask != full.baseVisMask || scan.activeJamVisMask != full.activeJamVisMask ||
+               scan.passiveJamVisMask != full.passiveJamVisMask || scan.cloakVisMask != full.cloakVisMask ||
+               scan.pinged != full.pinged || scan.jammed != full.jammed || scan.enemyJammed != full.enemyJammed)
+               mSensorStats.mismatches++;
+            scan = full;
          }
       }
+      else
+         scanSensors(index, targetPos, NULL, scan);
 
       // check cloaked/passiveJammed: only ShapeBase objects
       bool cloaked = false;
@@ -2735,30 +2874,30 @@ nodetect:
 
       // check what could detect it: active->cloaked->passive->base
       U32 visMask;
-      if(jammed)
-         visMask = activeJamVisMask;
+      if(scan.jammed)
+         visMask = scan.activeJamVisMask;
       else if(cloaked)
-         visMask = activeJamVisMask | cloakVisMask;
+         visMask = scan.activeJamVisMask | scan.cloakVisMask;
       else if(passiveJammed)
-         visMask = activeJamVisMask | cloakVisMask | passiveJamVisMask;
+         visMask = scan.activeJamVisMask | scan.cloakVisMask | scan.passiveJamVisMask;
       else
-         visMask = activeJamVisMask | cloakVisMask | passiveJamVisMask | baseVisMask;
+         visMask = scan.activeJamVisMask | scan.cloakVisMask | scan.passiveJamVisMask | scan.baseVisMask;
 
       visMask |= targetInfo->sensorAlwaysVisMask;
       visMask &= ~targetInfo->sensorNeverVisMask;
                
       targetInfo->sensorVisMask = visMask;
       targetInfo->sensorFlags = 0;
-      if(pinged)
+      if(scan.pinged)
          targetInfo->sensorFlags |= TargetInfo::SensorPinged;
 
       // if jammed, then notify the shapebase object
-      if(jammed || enemyJammed)
+      if(scan.jammed || scan.enemyJammed)
       {
-         if(jammed)
+         if(scan.jammed)
             targetInfo->sensorFlags |= TargetInfo::SensorJammed;
          
-         if(enemyJammed)
+         if(scan.enemyJammed)
          {
             targetInfo->sensorFlags |= TargetInfo::EnemySensorJammed;
 
@@ -2783,6 +2922,22 @@ nodetect:
    mLastSensedObject = lastSensed;
 }
 
+void TargetManager::dumpSensorStats(bool reset)
+{
+   U32 targets = getMax(mSensorStats.targets, U32(1));
+   Con::printf("Sensor tick: %s, %d sensors in the index, %d wide (reach %g)",
+                  smUseSensorIndex ? "indexed" : "full scans", mSensorIndex.size(),
+                  mWideSensors.size(), mSensorReach);
+   Con::printf("   ticks: %d, targets: %d, sensors tested per target: %.1f", mSensorStats.ticks,
+                  mSensorStats.targets, F32(mSensorStats.sensorsTested) / targets);
+   if(mSensorStats.compared)
+      Con::printf("   compared with full scans: %d, mismatches: %d", mSensorStats.compared,
+                     mSensorStats.mismatches);
+   mSensorIndex.dumpStats(reset);
+   if(reset)
+      mSensorStats.clear();
+}
+
 //------------------------------------------------------------------------------
 // debug list control: fills with target info
 //------------------------------------------------------------------------------
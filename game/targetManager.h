@@ -29,6 +29,9 @@
 #ifndef _AUDIO_H_
 #include "audio/audio.h"
 #endif
+#ifndef _PROXIMITYINDEX_H_
+#include "game/proximityIndex.h"
+#endif
 
 struct SensorData;
 class ResizeBitStream;
@@ -162,6 +165,37 @@ struct TargetManager
    U32 mFreeCount;
    U32 mLastSensedObject;
    U32 mSensorGroupCount;
+
+   // What the sensors make of one target, see tickSensorState
+   struct SensorScan
+   {
+      U32   baseVisMask;
+      U32   activeJamVisMask;
+      U32   passiveJamVisMask;
+      U32   cloakVisMask;
+      bool  pinged;
+      bool  jammed;
+      bool  enemyJammed;
+   };
+   struct SensorStats
+   {
+      U32   ticks;
+      U32   targets;
+      U32   sensorsTested;
+      U32   compared;
+      U32   mismatches;
+      void  clear() { dMemset(this, 0, sizeof(*this)); }
+   };
+   ProximityIndex             mSensorIndex;     // the sensors with a short reach
+   Vector<S32>                mWideSensors;     // and the rest
+   F32                        mSensorReach;     // furthest any in the index reach
+   ProximityIndex::EntryList  mSensorHits;
+   Vector<S32>                mSensorList;
+   SensorStats                mSensorStats;
+
+   void buildSensorIndex();
+   void findSensors(U32 index, const Point3F & targetPos);
+   void scanSensors(U32 index, const Point3F & targetPos, const Vector<S32> * sensors, SensorScan & scan);
    
    U32 mSensorGroupAlwaysVisMask[32];
    U32 mSensorGroupNeverVisMask[32];
@@ -243,6 +277,10 @@ struct TargetManager
    TargetInfo *getServerTarget(S32 target);
    void updateTarget(S32 targ, S32 nameTag, S32 skinTag, S32 voiceTag, S32 typeTag, S32 sensorGroup, S32 dataBlockId, S32 render, F32 voicePitch, U32 prefSkin);
    void tickSensorState();
+   void dumpSensorStats(bool reset);
+
+   static bool smUseSensorIndex;
+   static bool smCompareSensorIndex;
    
    void clientSensorGroupChanged(NetConnection * con, U32 newGroup);
    void setSensorGroupColor(U32 sensorGroup, U32 updateMask, ColorI & color);
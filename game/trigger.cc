@@ -16,6 +16,7 @@
 #include "Math/mathIO.h"
 
 #include "game/trigger.h"
+#include "console/simParallel.h"
 
 namespace {
 
@@ -440,6 +441,8 @@ void Trigger::potentialEnterObject(GameBase* enter)
 {
    AssertFatal(isServerObject(), "Error, should never be called on the client!");
 
+   // objects in any island can walk in
+   SimSharedLock lock;
    for (U32 i = 0; i < mObjects.size(); i++) {
       if (mObjects[i] == enter)
          return;
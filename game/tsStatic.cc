@@ -15,6 +15,7 @@
 #include "console/consoleTypes.h"
 #include "game/shapeBase.h"
 #include "game/shadow.h"
+#include "game/proximityIndex.h"
 #include "scenegraph/detailManager.h"
 
 IMPLEMENT_CO_NETOBJECT_V1(TSStatic);
@@ -106,6 +107,8 @@ bool TSStatic::onAdd()
    }
    
    addToScene();
+   if (isServerObject())
+      gServerProximity.addObject(this);
 
    return true;
 }
@@ -115,6 +118,9 @@ void TSStatic::onRemove()
 {
    mConvexList->nukeList();
 
+   if (isServerObject())
+      gServerProximity.removeObject(this);
+
    removeFromScene();
 
    delete mShapeInstance;
@@ -372,7 +378,9 @@ bool TSStatic::castRay(const Point3F &start, const Point3F &end, RayInfo* info)
       info->object = NULL;
       for (U32 i = 0; i < MaxCollisionShapes; i++) {
          if (mLOSDetails[i] != -1) {
-            mShapeInstance->animate(mLOSDetails[i]);
+            // see ShapeBase::castRay
+            if (ContainerQueryContext::getCurrent()->isMainContext())
+               mShapeInstance->animate(mLOSDetails[i]);
             if (mShapeInstance->castRay(start, end, info, mLOSDetails[i])) {
                info->object = this;
                if (info->t < shortest.t)
@@ -393,16 +401,22 @@ bool TSStatic::castRay(const Point3F &start, const Point3F &end, RayInfo* info)
 
 
 //----------------------------------------------------------------------------
-bool TSStatic::buildPolyList(AbstractPolyList* polyList, const Box3F &, const SphereF &)
+bool TSStatic::buildPolyList(AbstractPolyList* polyList, const Box3F &box, const SphereF &)
 {
    if (mShapeInstance) {
       bool ret = false;
 
+      // Only the triangles in the box (see TSMesh::buildBoxPolyList)
+      Box3F objBox = box;
+      mWorldToObj.mul(objBox);
+      objBox.min.convolveInverse(mObjScale);
+      objBox.max.convolveInverse(mObjScale);
+
       polyList->setTransform(&mObjToWorld, mObjScale);
       polyList->setObject(this);
       for (U32 i = 0; i < MaxCollisionShapes; i++) {
          if (mCollisionDetails[i] != -1) {
-            mShapeInstance->buildPolyList(polyList, mCollisionDetails[i]);
+            mShapeInstance->buildPolyList(polyList, mCollisionDetails[i], &objBox);
             ret = true;
          }
       }
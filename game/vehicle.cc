@@ -450,6 +450,7 @@ Vehicle::Vehicle()
    mDelta.dt = 1;
    mDelta.move = NullMove;
    mPredictionCount = 0;
+   mBroadPhaseProxy = NULL;
    mDelta.cameraOffset.set(0,0,0);
    mDelta.cameraVec.set(0,0,0);
    mDelta.cameraRot.set(0,0,0);
@@ -620,6 +621,11 @@ void Vehicle::onRemove()
       }
    }
 
+   if (mBroadPhaseProxy) {
+      mBroadPhaseProxy->getBroadPhase()->removeProxy(mBroadPhaseProxy);
+      mBroadPhaseProxy = NULL;
+   }
+
    Parent::onRemove();
 }
 
@@ -801,20 +807,42 @@ void Vehicle::updateWorkingCollisionSet(const U32 mask)
    F32 len    = scaledVelocity.len();
    F32 newLen = len + (50 * TickSec);
 
-   // Check to see if it is actually necessary to construct the new working list,
-   //  or if we can use the cached version from the last query.  We use the x
-   //  component of the min member of the mWorkingQueryBox, which is lame, but
-   //  it works ok.
-   bool updateSet = false;
-
    Box3F convexBox = mConvex.getBoundingBox(getTransform(), getScale());
    F32 l = (newLen * 1.1) + 0.1;  // fudge factor
    convexBox.min -= Point3F(l, l, l);
    convexBox.max += Point3F(l, l, l);
-   
-   disableCollision();
-   mConvex.updateWorkingList(convexBox, mask);
-   enableCollision();
+
+   // The broad phase only queries again once we've left the cached box,
+   //  anything else coming close is pushed onto the list as it moves.
+   if (!mBroadPhaseProxy)
+      mBroadPhaseProxy = getContainer()->getBroadPhase()->addProxy(this, &mConvex, mask);
+   mBroadPhaseProxy->getBroadPhase()->updateProxy(mBroadPhaseProxy, convexBox, 2 * l, mask);
+}
+
+F32 Vehicle::getIslandReach()
+{
+   return 3 * (((mRigid.state.linVelocity.len() + 50) * TickSec * 1.1) + 0.1);
+}
+
+bool Vehicle::getIslandBox(Box3F* box)
+{
+   if (!ticksWithinIslandBox())
+      return false;
+
+   // Whatever a new working set can reach, plus the cached one still in
+   // use (see updateWorkingCollisionSet), and the world box updateContainer
+   // queries with after the move.  The subclasses add their own rays.
+   F32 reach = getIslandReach();
+   *box = mConvex.getBoundingBox(getTransform(), getScale());
+   box->min.setMin(getWorldBox().min);
+   box->max.setMax(getWorldBox().max);
+   box->min -= Point3F(reach, reach, reach);
+   box->max += Point3F(reach, reach, reach);
+   if (mBroadPhaseProxy && mBroadPhaseProxy->isValid()) {
+      box->min.setMin(mBroadPhaseProxy->getBox().min);
+      box->max.setMax(mBroadPhaseProxy->getBox().max);
+   }
+   return true;
 }
 
 
@@ -21,6 +21,7 @@
 class ParticleEmitter;
 class ParticleEmitterData;
 class ClippedPolyList;
+class BroadPhaseProxy;
 
 
 //----------------------------------------------------------------------------
@@ -177,6 +178,7 @@ class Vehicle: public ShapeBase
    S32  mStuckTimer;
    
    ShapeBaseConvex mConvex;
+   BroadPhaseProxy* mBroadPhaseProxy;     // keeps mConvex's working list
 
    Rigid mRigid;
 
@@ -228,6 +230,8 @@ class Vehicle: public ShapeBase
    Vehicle();
    static void initPersistFields();
    void processTick(const Move*);
+   bool getIslandBox(Box3F* box);
+   F32  getIslandReach();
    bool onAdd();
    void onRemove();
    void interpolateTick(F32 dt);
@@ -1033,10 +1033,30 @@ U32 WheeledVehicle::getCollisionMask()
 
 //----------------------------------------------------------------------------
 
+// The wheel sweeps (the tire box over twice the spring either side of the
+// hub) and the safety rays, around wherever the tick moves us to.
+bool WheeledVehicle::getIslandBox(Box3F* box)
+{
+   if (!Parent::getIslandBox(box))
+      return false;
+   F32 r = 0;
+   for (S32 i = 0; i < mDataBlock->wheelCount; i++) {
+      const WheeledVehicleData::Wheel& wheel = mDataBlock->wheel[i];
+      r = getMax(r, wheel.pos.len() + 3 * wheel.spring.len() + 3 * mDataBlock->tire.radius);
+      r = getMax(r, wheel.safePos.len());
+   }
+   r += getIslandReach();
+   Point3F pos = getPosition();
+   box->min.setMin(pos - Point3F(r, r, r));
+   box->max.setMax(pos + Point3F(r, r, r));
+   return true;
+}
+
 void WheeledVehicle::updateWheels()
 {
    disableCollision();
-   static Polyhedron polyh;
+   static Polyhedron sPolyh[ContainerQueryContext::MaxContexts];
+   Polyhedron& polyh = sPolyh[ContainerQueryContext::getCurrent()->getSlot()];
 //   static ExtrudedPolyList sExtrudedList;
    mWheelContact = false;
 
@@ -172,6 +172,7 @@ class WheeledVehicle: public Vehicle
 
    bool onAdd();
    void onRemove();
+   bool getIslandBox(Box3F* box);
    void advanceTime(F32 dt);
    bool buildPolyList(AbstractPolyList* polyList, const Box3F&, const SphereF&);
 
@@ -1049,7 +1049,10 @@ void GuiCanvas::renderFrame(bool preRenderOnly)
    Point2I size = Platform::getWindowSize();
 
    if(size.x == 0 || size.y == 0)
+   {
+      PROFILE_END();
       return;
+   }
       
    RectI screenRect(0, 0, size.x, size.y);
    mBounds = screenRect;
@@ -18,6 +18,7 @@
 #include "dgl/materialList.h"
 #include "dgl/materialPropertyMap.h"
 #include "interior/interiorSubObject.h"
+#include "collision/boxTree.h"
 #include "core/bitVector.h"
 #include "sim/frameAllocator.h"
 #include "scenegraph/sgUtil.h"
@@ -29,6 +30,8 @@ bool Interior::smRenderEnvironmentMaps = true;
 bool Interior::smUseVertexLighting = false;
 bool Interior::smUseTexturedFog = false;
 bool Interior::smLockArrays = true;
+bool Interior::smUseBVH = true;
+F32  Interior::smBVHRayPadding = 0.05f;
 
 
 // These are setup by setupActivePolyList
@@ -281,6 +284,7 @@ Interior::Interior()
    mPreppedForRender = false;;
 
    mSearchTag = 0;
+   mBVH = NULL;
 
    // Bind our vectors
    VECTOR_SET_ASSOCIATION(mPlanes);
@@ -366,6 +370,9 @@ Interior::~Interior()
       delete mSubObjects[i];
       mSubObjects[i] = NULL;
    }
+
+   delete mBVH;
+   mBVH = NULL;
 }
 
 
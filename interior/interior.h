@@ -63,6 +63,7 @@ struct RayInfo;
 struct EdgeList;
 class SurfaceHash;
 class InteriorPolytope;
+class BoxTree;
 class FloorPlan;
 class LightInfo;
 class PlaneRange;
@@ -230,9 +231,23 @@ class Interior
    bool buildLightPolyList(U32* lightSurfaces, U32* numLightSurfaces,
                            const Box3F&, const MatrixF&, const Point3F&);
 
-   bool getIntersectingHulls(const Box3F&, U16* hulls, U32* numHulls);
+   // visited, if given, is a zeroed bit per hull that stands in for the
+   //  search tags, so the search can run off the main thread
+   bool getIntersectingHulls(const Box3F&, U16* hulls, U32* numHulls, U8* visited = NULL);
    bool getIntersectingVehicleHulls(const Box3F&, U16* hulls, U32* numHulls);
 
+   // Collision BVH over the convex hulls (see Collision/boxTree.h).  While there
+   //  is one and smUseBVH is set it answers getIntersectingHulls, and rays
+   //  that miss all of its boxes skip the BSP.
+   static bool smUseBVH;
+   static F32  smBVHRayPadding;
+
+   void buildBVH();
+   bool readBVH(Stream& stream);
+   bool writeBVH(Stream& stream) const;
+   const BoxTree* getBVH() const { return mBVH; }
+   void getHullBoxes(Vector<Box3F>& boxes) const;
+
   protected:
    bool castRay_r(const U16, const U16, const Point3F&, const Point3F&, RayInfo*);
    void buildPolyList_r(InteriorPolytope& polytope,
@@ -630,6 +645,7 @@ class Interior
    Vector<TriFan>          mVehicleWindingIndices;
    
    U16                     mSearchTag;
+   BoxTree*                mBVH;
 
    //-------------------------------------- Private interface
   private:
@@ -0,0 +1,263 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+//
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "interior/interior.h"
+#include "interior/interiorInstance.h"
+#include "interior/interiorRes.h"
+#include "Collision/boxTree.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "Sim/sceneObject.h"
+
+//--------------------------------------------------------------------------
+// Collision BVH (see Collision/boxTree.h)
+
+void Interior::getHullBoxes(Vector<Box3F>& boxes) const
+{
+   boxes.setSize(mConvexHulls.size());
+   for (U32 i = 0; i < mConvexHulls.size(); i++) {
+      const ConvexHull& rHull = mConvexHulls[i];
+      boxes[i].min.set(rHull.minX, rHull.minY, rHull.minZ);
+      boxes[i].max.set(rHull.maxX, rHull.maxY, rHull.maxZ);
+   }
+}
+
+void Interior::buildBVH()
+{
+   Vector<Box3F> boxes;
+   getHullBoxes(boxes);
+
+   if (mBVH == NULL)
+      mBVH = new BoxTree;
+   mBVH->build(boxes);
+}
+
+bool Interior::readBVH(Stream& stream)
+{
+   Vector<Box3F> boxes;
+   getHullBoxes(boxes);
+
+   if (mBVH == NULL)
+      mBVH = new BoxTree;
+   if (mBVH->read(stream, BoxTree::getSignature(boxes)) == false) {
+      delete mBVH;
+      mBVH = NULL;
+      return false;
+   }
+   return true;
+}
+
+bool Interior::writeBVH(Stream& stream) const
+{
+   AssertFatal(mBVH != NULL, "Interior::writeBVH: no BVH built");
+   return mBVH->write(stream);
+}
+
+
+//--------------------------------------------------------------------------
+// Comparison against the coord bins and the BSP
+//
+// For every interior in the mission: every hull is looked up by its own
+// box, then random boxes and random segments through the bounds are run
+// down both paths.  Hull sets have to match exactly.  A ray the BSP hits
+// but the BVH culls is a miss, the other way round is only the early out
+// not paying off.
+
+static Vector<InteriorInstance*> sCompareInstances;
+
+static void findCompareInstance(SceneObject* obj, S32)
+{
+   sCompareInstances.push_back(static_cast<InteriorInstance*>(obj));
+}
+
+static S32 QSORT_CALLBACK cmpHullIndex(const void* a, const void* b)
+{
+   return S32(*(const U16*)a) - S32(*(const U16*)b);
+}
+
+static bool sameHulls(U16* a, U32 numA, U16* b, U32 numB)
+{
+   if (numA != numB)
+      return false;
+   dQsort(a, numA, sizeof(U16), cmpHullIndex);
+   dQsort(b, numB, sizeof(U16), cmpHullIndex);
+   return dMemcmp(a, b, numA * sizeof(U16)) == 0;
+}
+
+ConsoleFunction(interiorBVHCompare, void, 1, 3, "interiorBVHCompare(<rays>, <boxes>);")
+{
+   U32 numRays  = (argc > 1)? dAtoi(argv[1]): 10000;
+   U32 numBoxes = (argc > 2)? dAtoi(argv[2]): 10000;
+
+   sCompareInstances.clear();
+   gServerContainer.findObjects(InteriorObjectType, findCompareInstance);
+   if (sCompareInstances.size() == 0)
+      gClientContainer.findObjects(InteriorObjectType, findCompareInstance);
+   if (sCompareInstances.size() == 0) {
+      Con::printf("interiorBVHCompare: no interiors");
+      return;
+   }
+
+   MRandomLCG random(0x1234);
+   bool useBVH = Interior::smUseBVH;
+   U32 numInteriors = 0, totalHulls = 0, totalNodes = 0, maxDepth = 0;
+   U32 hullMismatches = 0, boxMismatches = 0;
+   U32 rayMisses = 0, rayMismatches = 0, rayHits = 0, raysCulled = 0;
+   U32 binTime = 0, bvhBoxTime = 0, bspTime = 0, bvhRayTime = 0;
+
+   for (U32 n = 0; n < sCompareInstances.size(); n++) {
+      Resource<InteriorResource>& res = sCompareInstances[n]->getResource();
+      if (bool(res) == false || res->getNumDetailLevels() == 0)
+         continue;
+      Interior* pInterior = res->getDetailLevel(0);
+      if (pInterior->getBVH() == NULL)
+         pInterior->buildBVH();
+      const BoxTree* bvh = pInterior->getBVH();
+
+      // Interiors are shared between instances
+      U32 k;
+      for (k = 0; k < n; k++)
+         if (bool(sCompareInstances[k]->getResource()) &&
+             sCompareInstances[k]->getResource()->getDetailLevel(0) == pInterior)
+            break;
+      if (k != n)
+         continue;
+
+      Vector<Box3F> boxes;
+      pInterior->getHullBoxes(boxes);
+      numInteriors++;
+      totalHulls += boxes.size();
+      totalNodes += bvh->getNodeCount();
+      maxDepth = getMax(maxDepth, bvh->getDepth());
+      if (boxes.size() == 0)
+         continue;
+
+      Vector<U16> binHulls, bvhHulls;
+      binHulls.setSize(boxes.size());
+      bvhHulls.setSize(boxes.size());
+
+      // Every hull by its own box
+      U32 i;
+      for (i = 0; i < boxes.size(); i++) {
+         U32 numBin = 0, numBVH = 0;
+         Interior::smUseBVH = false;
+         pInterior->getIntersectingHulls(boxes[i], binHulls.address(), &numBin);
+         Interior::smUseBVH = true;
+         pInterior->getIntersectingHulls(boxes[i], bvhHulls.address(), &numBVH);
+         if (!sameHulls(binHulls.address(), numBin, bvhHulls.address(), numBVH))
+            hullMismatches++;
+      }
+
+      // Random boxes and segments through the bounds, grown a little so
+      // some of them miss
+      Box3F bounds = pInterior->getBoundingBox();
+      Point3F grow = (bounds.max - bounds.min) * 0.1f;
+      bounds.min -= grow;
+      bounds.max += grow;
+      Point3F extent = bounds.max - bounds.min;
+
+      Vector<Box3F> queries;
+      queries.setSize(numBoxes);
+      for (i = 0; i < numBoxes; i++) {
+         Point3F center(random.randF(bounds.min.x, bounds.max.x),
+                        random.randF(bounds.min.y, bounds.max.y),
+                        random.randF(bounds.min.z, bounds.max.z));
+         Point3F radius(random.randF() * extent.x * 0.05f,
+                        random.randF() * extent.y * 0.05f,
+                        random.randF() * extent.z * 0.05f);
+         queries[i].min = center - radius;
+         queries[i].max = center + radius;
+      }
+
+      Vector<U32> binCounts, bvhCounts;
+      binCounts.setSize(numBoxes);
+      bvhCounts.setSize(numBoxes);
+      Vector<U16> binAll, bvhAll;
+      binAll.reserve(numBoxes * 4);
+      bvhAll.reserve(numBoxes * 4);
+
+      Interior::smUseBVH = false;
+      U32 startTime = Platform::getRealMilliseconds();
+      for (i = 0; i < numBoxes; i++) {
+         binCounts[i] = 0;
+         pInterior->getIntersectingHulls(queries[i], binHulls.address(), &binCounts[i]);
+      }
+      binTime += Platform::getRealMilliseconds() - startTime;
+
+      Interior::smUseBVH = true;
+      startTime = Platform::getRealMilliseconds();
+      for (i = 0; i < numBoxes; i++) {
+         bvhCounts[i] = 0;
+         pInterior->getIntersectingHulls(queries[i], bvhHulls.address(), &bvhCounts[i]);
+      }
+      bvhBoxTime += Platform::getRealMilliseconds() - startTime;
+
+      // Timed without the bookkeeping, checked again with it
+      for (i = 0; i < numBoxes; i++) {
+         U32 numBin = 0, numBVH = 0;
+         Interior::smUseBVH = false;
+         pInterior->getIntersectingHulls(queries[i], binHulls.address(), &numBin);
+         Interior::smUseBVH = true;
+         pInterior->getIntersectingHulls(queries[i], bvhHulls.address(), &numBVH);
+         if (numBin != binCounts[i] || numBVH != bvhCounts[i] ||
+             !sameHulls(binHulls.address(), numBin, bvhHulls.address(), numBVH))
+            boxMismatches++;
+      }
+
+      Vector<Point3F> starts, ends;
+      starts.setSize(numRays);
+      ends.setSize(numRays);
+      for (i = 0; i < numRays; i++) {
+         starts[i].set(random.randF(bounds.min.x, bounds.max.x),
+                       random.randF(bounds.min.y, bounds.max.y),
+                       random.randF(bounds.min.z, bounds.max.z));
+         ends[i].set(random.randF(bounds.min.x, bounds.max.x),
+                     random.randF(bounds.min.y, bounds.max.y),
+                     random.randF(bounds.min.z, bounds.max.z));
+      }
+
+      Vector<RayInfo> bspInfo, bvhInfo;
+      Vector<U8> bspHit, bvhHit;
+      bspInfo.setSize(numRays);
+      bvhInfo.setSize(numRays);
+      bspHit.setSize(numRays);
+      bvhHit.setSize(numRays);
+
+      Interior::smUseBVH = false;
+      startTime = Platform::getRealMilliseconds();
+      for (i = 0; i < numRays; i++)
+         bspHit[i] = pInterior->castRay(starts[i], ends[i], &bspInfo[i]);
+      bspTime += Platform::getRealMilliseconds() - startTime;
+
+      Interior::smUseBVH = true;
+      startTime = Platform::getRealMilliseconds();
+      for (i = 0; i < numRays; i++)
+         bvhHit[i] = pInterior->castRay(starts[i], ends[i], &bvhInfo[i]);
+      bvhRayTime += Platform::getRealMilliseconds() - startTime;
+
+      for (i = 0; i < numRays; i++) {
+         if (bspHit[i])
+            rayHits++;
+         if (!bvh->touchesSegment(starts[i], ends[i], Interior::smBVHRayPadding))
+            raysCulled++;
+         if (bspHit[i] != bvhHit[i])
+            rayMisses++;
+         else if (bspHit[i] && (bspInfo[i].t != bvhInfo[i].t || bspInfo[i].face != bvhInfo[i].face))
+            rayMismatches++;
+      }
+   }
+   Interior::smUseBVH = useBVH;
+   sCompareInstances.clear();
+
+   Con::printf("interiorBVHCompare: %d interiors, %d hulls, %d nodes, depth %d, kernel %s",
+               numInteriors, totalHulls, totalNodes, maxDepth, BoxTree::getKernelName());
+   Con::printf("   hull boxes: %d mismatches", hullMismatches);
+   Con::printf("   %d boxes: %d mismatches, coord bins: %d ms, BVH: %d ms",
+               numBoxes * numInteriors, boxMismatches, binTime, bvhBoxTime);
+   Con::printf("   %d rays: %d hits, %d culled, %d missed, %d mismatched, BSP: %d ms, BVH + BSP: %d ms",
+               numRays * numInteriors, rayHits, raysCulled, rayMisses, rayMismatches, bspTime, bvhRayTime);
+}
@@ -14,6 +14,7 @@
 #include "PlatformWin32/platformGL.h"
 #include "Sim/frameAllocator.h"
 #include "Platform/profiler.h"
+#include "Collision/boxTree.h"
 
 namespace {
 
@@ -429,6 +430,12 @@ bool Interior::castRay_r(const U16      node,
 
 bool Interior::castRay(const Point3F& s, const Point3F& e, RayInfo* info)
 {
+   // Nothing solid lies outside the hulls, so a ray that misses all of
+   //  their boxes can't hit the BSP either.
+   if (smUseBVH && mBVH != NULL && !mBVH->isEmpty() &&
+       !mBVH->touchesSegment(s, e, smBVHRayPadding))
+      return false;
+
    // DMM: Going to need normal here eventually.
    bool hit = castRay_r(0, U16(-1), s, e, info);
    if (hit) {
@@ -670,15 +677,32 @@ bool Interior::buildPolyList(AbstractPolyList* list,
    interiorBox.max.y += yrad;
    interiorBox.max.z += zrad;
 
-   U32 waterMark = FrameAllocator::getWaterMark();
-
-   U16* hulls = (U16*)FrameAllocator::alloc(mConvexHulls.size() * sizeof(U16));
+   // The frame allocator and the hull search tags belong to the main
+   //  thread, other query contexts use their own scratch.
+   ContainerQueryContext* context = ContainerQueryContext::getCurrent();
+   bool mainThread = context->isMainContext();
+
+   U32 waterMark = 0;
+   U16* hulls;
+   U8* visited = NULL;
+   if (mainThread) {
+      waterMark = FrameAllocator::getWaterMark();
+      hulls = (U16*)FrameAllocator::alloc(mConvexHulls.size() * sizeof(U16));
+   } else {
+      U32 hullBytes    = mConvexHulls.size() * sizeof(U16);
+      U32 visitedBytes = (mConvexHulls.size() + 7) >> 3;
+      U8* scratch = context->getScratch(hullBytes + visitedBytes);
+      hulls   = (U16*)scratch;
+      visited = scratch + hullBytes;
+      dMemset(visited, 0, visitedBytes);
+   }
    U32 numHulls = 0;
 
-   getIntersectingHulls(interiorBox,hulls, &numHulls);
+   getIntersectingHulls(interiorBox,hulls, &numHulls, visited);
    
    if (numHulls == 0) {
-      FrameAllocator::setWaterMark(waterMark);
+      if (mainThread)
+         FrameAllocator::setWaterMark(waterMark);
       return false;
    }
 
@@ -744,7 +768,8 @@ bool Interior::buildPolyList(AbstractPolyList* list,
       }
    }
 
-   FrameAllocator::setWaterMark(waterMark);
+   if (mainThread)
+      FrameAllocator::setWaterMark(waterMark);
    return !list->isEmpty();
 }
 
@@ -1072,19 +1097,27 @@ bool Interior::scanZones(const Box3F&   box,
 }
 
 
-bool Interior::getIntersectingHulls(const Box3F& query, U16* hulls, U32* numHulls)
+bool Interior::getIntersectingHulls(const Box3F& query, U16* hulls, U32* numHulls, U8* visited)
 {
    AssertFatal(*numHulls == 0, "Error, some stuff in the hull vector already!");
 
+   // The BVH finds every hull once, no tags needed
+   if (smUseBVH && mBVH != NULL) {
+      *numHulls = mBVH->findBoxes(query, hulls);
+      return *numHulls != 0;
+   }
+
    // This is paranoia, and I probably wouldn't do it if the tag was 32 bits, but
    //  a possible collision every 65k searches is just a little too small for comfort
    // DMM
-   if (mSearchTag == 0) {
-      for (U32 i = 0; i < mConvexHulls.size(); i++)
-         mConvexHulls[i].searchTag = 0;
-      mSearchTag = 1;
-   } else {
-      mSearchTag++;
+   if (visited == NULL) {
+      if (mSearchTag == 0) {
+         for (U32 i = 0; i < mConvexHulls.size(); i++)
+            mConvexHulls[i].searchTag = 0;
+         mSearchTag = 1;
+      } else {
+         mSearchTag++;
+      }
    }
 
    F32 xBinSize = mBoundingBox.len_x() / F32(NumCoordBins);
@@ -1116,9 +1149,16 @@ bool Interior::getIntersectingHulls(const Box3F& query, U16* hulls, U32* numHull
          for (U32 k = rBin.binStart; k < rBin.binStart + rBin.binCount; k++) {
             U16 hullIndex = mCoordBinIndices[k];
             ConvexHull& rHull = mConvexHulls[hullIndex];
-            if (rHull.searchTag == mSearchTag)
-               continue;
-            rHull.searchTag = mSearchTag;
+            if (visited) {
+               U8 bit = 1 << (hullIndex & 7);
+               if (visited[hullIndex >> 3] & bit)
+                  continue;
+               visited[hullIndex >> 3] |= bit;
+            } else {
+               if (rHull.searchTag == mSearchTag)
+                  continue;
+               rHull.searchTag = mSearchTag;
+            }
 
             Box3F qb(rHull.minX, rHull.minY, rHull.minZ, rHull.maxX, rHull.maxY, rHull.maxZ);
             if (query.isOverlapped(qb)) {
@@ -1393,6 +1433,81 @@ void InteriorConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFea
 }
 
 
+//--------------------------------------------------------------------------
+// Adds the points and surfaces of a hull that the list is interested in, in
+// one call each.  currPos points at the first surface, the format of the
+// surface string can be found in interior.cc, in processHullPolyLists.
+
+static void addHullPolys(AbstractPolyList* list, const U8* pString, U32 currPos,
+                         const ItrPaddedPoint* points, const U32* pointIndices,
+                         const U8* pointString, U32 numPoints, U32 numSurfaces,
+                         U8 interestMask, const U16* planeIndices, U32 remappedPlaneBase)
+{
+   // The frame allocator holds the variable sized arrays
+   U32 waterMark = FrameAllocator::getWaterMark();
+
+   // Gather the points, remapped to their place in the list
+   U32* pointRemapTable = reinterpret_cast<U32*>(FrameAllocator::alloc(numPoints * sizeof(U32)));
+   Point3F* listPoints  = reinterpret_cast<Point3F*>(FrameAllocator::alloc(numPoints * sizeof(Point3F)));
+   U32 numListPoints = 0;
+   U32 i;
+   for (i = 0; i < numPoints; i++) {
+      if ((interestMask & pointString[i]) != 0) {
+         pointRemapTable[i] = numListPoints;
+         listPoints[numListPoints++] = points[pointIndices[i]].point;
+      }
+   }
+   if (numListPoints == 0) {
+      FrameAllocator::setWaterMark(waterMark);
+      return;
+   }
+   U32 pointBase = list->addPoints(listPoints, numListPoints);
+
+   // Size up the surfaces we're interested in
+   U32 numPolys = 0, numIndices = 0;
+   U32 pos = currPos;
+   for (i = 0; i < numSurfaces; i++) {
+      U32 snPoints = pString[pos];
+      if ((interestMask & pString[pos + 1]) != 0) {
+         numPolys++;
+         numIndices += snPoints;
+      }
+      pos += 3 + snPoints * 2;
+   }
+
+   U32* numVerts    = reinterpret_cast<U32*>(FrameAllocator::alloc(numPolys * sizeof(U32)));
+   U32* planes      = reinterpret_cast<U32*>(FrameAllocator::alloc(numPolys * sizeof(U32)));
+   U32* surfaceKeys = reinterpret_cast<U32*>(FrameAllocator::alloc(numPolys * sizeof(U32)));
+   U32* vertices    = reinterpret_cast<U32*>(FrameAllocator::alloc(numIndices * sizeof(U32)));
+
+   U32 poly = 0, index = 0;
+   for (i = 0; i < numSurfaces; i++) {
+      U32 snPoints = pString[currPos++];
+      U32 sMask    = pString[currPos++];
+      U32 sPlane   = pString[currPos++];
+
+      if ((interestMask & sMask) != 0) {
+         numVerts[poly]    = snPoints;
+         planes[poly]      = remappedPlaneBase + sPlane;
+         surfaceKeys[poly] = planeIndices[sPlane];
+         poly++;
+         for (U32 j = 0; j < snPoints; j++) {
+            U16 remappedIndex  = pString[currPos++] << 8;
+            remappedIndex     |= pString[currPos++];
+            vertices[index++]  = pointBase + pointRemapTable[remappedIndex];
+         }
+      }
+      else {
+         // Superflous poly, just skip past the points
+         currPos += snPoints * 2;
+      }
+   }
+   if (numPolys)
+      list->addPolys(0, numPolys, numVerts, vertices, planes, surfaceKeys);
+
+   FrameAllocator::setWaterMark(waterMark);
+}
+
 void InteriorConvex::getPolyList(AbstractPolyList* list)
 {
    // Setup collision state data
@@ -1458,56 +1573,10 @@ void InteriorConvex::getPolyList(AbstractPolyList* list)
          }
       }
 
-      // Now, whip through the points, and build up the remap table, adding only
-      //  those points that the list is interested in.  Note that we use the frameAllocator
-      //  to get enoughMemory to deal with the variable sized remap array
-      U32 waterMark        = FrameAllocator::getWaterMark();
-      U32* pointRemapTable = reinterpret_cast<U32*>(FrameAllocator::alloc(numPoints * sizeof(U32)));
-      {
-         for (U32 i = 0; i < numPoints; i++) {
-            if ((interestMask & pointString[i]) != 0) {
-               const Point3F& rPoint = pInterior->mPoints[pointIndices[i]].point;
-
-               pointRemapTable[i] = list->addPoint(rPoint);
-            }
-         }
-      }
-
-      // Now, whip through the surfaces, checking to make sure that we're interested in
-      //  that poly as we go.  At this point, currPos should point to the first surface.
-      //  The format of the surface string can be found in interior.cc, in the
-      //  processHullPolyLists function
-      {
-         for (U32 i = 0; i < numSurfaces; i++) {
-            U32 snPoints = pString[currPos++];
-            U32 sMask    = pString[currPos++];
-            U32 sPlane   = pString[currPos++];
-
-            if ((interestMask & sMask) != 0) {
-               // Add the poly
-               //
-               list->begin(0, planeIndices[sPlane]);
-               for (U32 j = 0; j < snPoints; j++) {
-                  U16 remappedIndex  = pString[currPos++] << 8;
-                  remappedIndex     |= pString[currPos++];
-                  remappedIndex      = pointRemapTable[remappedIndex];
-                  list->vertex(remappedIndex);
-               }
-               list->plane(remappedPlaneBase + sPlane);
-            
-               list->end();
-            }
-            else {
-               // Superflous poly, just skip past the points
-               currPos += snPoints * 2;
-            }
-         }
-      }
-
-      // Reset the watermark on the allocator
-      {
-         FrameAllocator::setWaterMark(waterMark);
-      }
+      // Hand the interesting points and surfaces over in bulk
+      addHullPolys(list, pString, currPos, pInterior->mPoints.address(), pointIndices,
+                   pointString, numPoints, numSurfaces, interestMask,
+                   planeIndices, remappedPlaneBase);
    }
    else
    {
@@ -1567,56 +1636,10 @@ void InteriorConvex::getPolyList(AbstractPolyList* list)
          }
       }
 
-      // Now, whip through the points, and build up the remap table, adding only
-      //  those points that the list is interested in.  Note that we use the frameAllocator
-      //  to get enoughMemory to deal with the variable sized remap array
-      U32 waterMark        = FrameAllocator::getWaterMark();
-      U32* pointRemapTable = reinterpret_cast<U32*>(FrameAllocator::alloc(numPoints * sizeof(U32)));
-      {
-         for (U32 i = 0; i < numPoints; i++) {
-            if ((interestMask & pointString[i]) != 0) {
-               const Point3F& rPoint = pInterior->mVehiclePoints[pointIndices[i]].point;
-
-               pointRemapTable[i] = list->addPoint(rPoint);
-            }
-         }
-      }
-
-      // Now, whip through the surfaces, checking to make sure that we're interested in
-      //  that poly as we go.  At this point, currPos should point to the first surface.
-      //  The format of the surface string can be found in interior.cc, in the
-      //  processHullPolyLists function
-      {
-         for (U32 i = 0; i < numSurfaces; i++) {
-            U32 snPoints = pString[currPos++];
-            U32 sMask    = pString[currPos++];
-            U32 sPlane   = pString[currPos++];
-
-            if ((interestMask & sMask) != 0) {
-               // Add the poly
-               //
-               list->begin(0, planeIndices[sPlane]);
-               for (U32 j = 0; j < snPoints; j++) {
-                  U16 remappedIndex  = pString[currPos++] << 8;
-                  remappedIndex     |= pString[currPos++];
-                  remappedIndex      = pointRemapTable[remappedIndex];
-                  list->vertex(remappedIndex);
-               }
-               list->plane(remappedPlaneBase + sPlane);
-            
-               list->end();
-            }
-            else {
-               // Superflous poly, just skip past the points
-               currPos += snPoints * 2;
-            }
-         }
-      }
-
-      // Reset the watermark on the allocator
-      {
-         FrameAllocator::setWaterMark(waterMark);
-      }
+      // Hand the interesting points and surfaces over in bulk
+      addHullPolys(list, pString, currPos, pInterior->mVehiclePoints.address(), pointIndices,
+                   pointString, numPoints, numSurfaces, interestMask,
+                   planeIndices, remappedPlaneBase);
    }
 }
 
@@ -351,6 +351,7 @@ void InteriorInstance::consoleInit()
    Con::addVariable("pref::Interior::lockArrays", TypeBool, &Interior::smLockArrays);
 
    Con::addVariable("pref::Interior::detailAdjust", TypeF32, &InteriorInstance::smDetailModification);
+   Con::addVariable("Interior::useBVH", TypeBool, &Interior::smUseBVH);
    
    // DEBUG ONLY!!!
 #ifdef DEBUG
@@ -457,6 +458,7 @@ bool InteriorInstance::onAdd()
    }
    else
       mCRC = mInteriorRes.getCRC();
+   mInteriorRes->prepCollisionBVH(buffer);
 
    if(!Parent::onAdd())
       return false;
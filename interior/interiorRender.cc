@@ -427,7 +427,7 @@ void Interior::render(const bool useAlarmLighting, MaterialList* pMaterials, con
    {
       if (useFogCoord())
       {
-         PROFILE_START(IRO_Render_VC_FC);
+         PROFILE_START(Render_VC_FC);
          render_vc_fc(useAlarmLighting, pMaterials, instanceHandle, normalVLights, alarmVLights);
          PROFILE_END();
       }
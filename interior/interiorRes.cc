@@ -7,6 +7,7 @@
 
 #include "console/console.h"
 #include "Core/stream.h"
+#include "Core/fileStream.h"
 #include "interior/interior.h"
 #include "interior/interiorResObjects.h"
 #include "dgl/gBitmap.h"
@@ -318,3 +319,43 @@ ResourceInstance* constructInteriorDIF(Stream& stream)
    }
 }
 
+
+//--------------------------------------------------------------------------
+void InteriorResource::prepCollisionBVH(const char* fileName)
+{
+   if (mDetailLevels.size() == 0 || mDetailLevels[0]->getBVH() != NULL)
+      return;
+
+   // interiors/foo.dif -> interiors/foo.bvh
+   char cacheName[256];
+   dStrncpy(cacheName, fileName, sizeof(cacheName) - 5);
+   cacheName[sizeof(cacheName) - 5] = '\0';
+   char* ext = dStrrchr(cacheName, '.');
+   if (ext != NULL && dStrchr(ext, '/') == NULL)
+      *ext = '\0';
+   dStrcat(cacheName, ".bvh");
+
+   U32 i;
+   Stream* stream = ResourceManager->openStream(cacheName);
+   if (stream != NULL) {
+      U32 numDetailLevels = 0;
+      stream->read(&numDetailLevels);
+      bool loaded = numDetailLevels == mDetailLevels.size();
+      for (i = 0; loaded && i < mDetailLevels.size(); i++)
+         loaded = mDetailLevels[i]->readBVH(*stream);
+      ResourceManager->closeStream(stream);
+      if (loaded)
+         return;
+   }
+
+   for (i = 0; i < mDetailLevels.size(); i++)
+      mDetailLevels[i]->buildBVH();
+
+   // Read only installs just don't get a cache
+   FileStream file;
+   if (ResourceManager->openFileForWrite(file, ResourceManager->getModPathOf(fileName), cacheName)) {
+      file.write(U32(mDetailLevels.size()));
+      for (i = 0; i < mDetailLevels.size(); i++)
+         mDetailLevels[i]->writeBVH(file);
+   }
+}
@@ -45,6 +45,10 @@ class InteriorResource : public ResourceInstance
    bool            write(Stream& stream) const;
    static GBitmap* extractPreview(Stream&);
 
+   // Loads the collision BVHs of the detail levels from the cache next to
+   //  the .dif, or builds them and tries to write the cache.
+   void            prepCollisionBVH(const char* fileName);
+
    S32       getNumDetailLevels() const;
    S32       getNumSubObjects() const;
    S32       getNumTriggers() const;
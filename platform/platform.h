@@ -174,7 +174,8 @@ enum x86Properties
    CPU_PROP_MMX       = (1<<2),     // Integer-SIMD
    CPU_PROP_3DNOW     = (1<<3),     // AMD Float-SIMD
    CPU_PROP_SSE       = (1<<4),     // PentiumIII SIMD
-   CPU_PROP_RDTSC     = (1<<5)      // Read Time Stamp Counter
+   CPU_PROP_RDTSC     = (1<<5),     // Read Time Stamp Counter
+   CPU_PROP_SSE2      = (1<<6)      // Pentium4 integer/double SIMD
 };
 
 enum PPCProperties
@@ -353,6 +354,9 @@ const char* __dyncreate_getNameFromType(ConsoleObject *);
 namespace Memory {
    U32 getMemoryUsed();
    U32 getMemoryAllocated();
+
+   // the heap locks itself from here on, Thread::start calls it
+   void enableThreadSafety();
 } // namespace Memory
 
 extern void* FN_CDECL operator new(dsize_t size, void* ptr);
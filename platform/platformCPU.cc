@@ -16,6 +16,7 @@ enum
    BIT_RDTSC   = (1<<4),  
    BIT_MMX     = (1<<23),  
    BIT_SSE     = (1<<25),  
+   BIT_SSE2    = (1<<26),  
    BIT_3DNOW   = (1<<31),  
 };
 
@@ -26,6 +27,7 @@ void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
    Platform::SystemInfo.processor.properties |= (properties & BIT_FPU)   ? CPU_PROP_FPU : 0;
    Platform::SystemInfo.processor.properties |= (properties & BIT_RDTSC) ? CPU_PROP_RDTSC : 0;
    Platform::SystemInfo.processor.properties |= (properties & BIT_MMX)   ? CPU_PROP_MMX : 0;
+   Platform::SystemInfo.processor.properties |= (properties & BIT_SSE2)  ? CPU_PROP_SSE2 : 0;
 
    if (dStricmp(vendor, "GenuineIntel") == 0)
    {
@@ -9,6 +9,7 @@
 #include "core/fileStream.h"
 #include "console/console.h"
 #include "platform/profiler.h"
+#include "platform/platformThread.h"
 
 //-------------------------------------- Make sure we don't have the define set
 #ifdef new
@@ -849,6 +850,84 @@ static void checkUnusedAlloc(FreeHeader *header, U32 size)
    }
 }
 
+//---------------------------------------------------------------------------
+// The heap is shared by every thread once there is more than one, so the
+// lock is only taken after the first Thread::start.  It is a spin lock
+// rather than a Mutex because creating a Mutex allocates.  It is recursive,
+// so an assert (or anything else) that allocates while the lock is held
+// doesn't deadlock.  A waiter spins on reads with a pause, backing off, and
+// gives up its timeslice when the holder is slow to let go.
+#if defined(_MSC_VER)
+extern "C" long __cdecl _InterlockedExchange(long volatile *, long);
+#pragma intrinsic(_InterlockedExchange)
+extern "C" void _mm_pause(void);
+#pragma intrinsic(_mm_pause)
+extern "C" __declspec(dllimport) int __stdcall SwitchToThread(void);
+#define HEAP_LOCK_ACQUIRE(lock) _InterlockedExchange(lock, 1)
+#define HEAP_LOCK_RELEASE(lock) _InterlockedExchange(lock, 0)
+#define HEAP_LOCK_PAUSE()       _mm_pause()
+#define HEAP_LOCK_YIELD()       SwitchToThread()
+#elif defined(__GNUC__)
+#include <sched.h>
+#define HEAP_LOCK_ACQUIRE(lock) __sync_lock_test_and_set(lock, 1)
+#define HEAP_LOCK_RELEASE(lock) __sync_lock_release(lock)
+#if defined(__i386__) || defined(__x86_64__)
+#define HEAP_LOCK_PAUSE()       __asm__ __volatile__("pause")
+#else
+#define HEAP_LOCK_PAUSE()
+#endif
+#define HEAP_LOCK_YIELD()       sched_yield()
+#else
+#define HEAP_LOCK_ACQUIRE(lock) 0
+#define HEAP_LOCK_RELEASE(lock)
+#define HEAP_LOCK_PAUSE()
+#define HEAP_LOCK_YIELD()
+#endif
+
+enum {
+   HeapLockMaxSpin = 64,      // pauses between tries before yielding
+};
+
+static volatile bool sHeapThreaded = false;
+static volatile long sHeapLock = 0;
+static THREAD_LOCAL U32 sHeapLockDepth = 0;
+
+static void heapLockAcquire()
+{
+   U32 spin = 1;
+   while(HEAP_LOCK_ACQUIRE(&sHeapLock))
+   {
+      do
+      {
+         if(spin > HeapLockMaxSpin)
+            HEAP_LOCK_YIELD();
+         else
+         {
+            for(U32 i = 0; i < spin; i++)
+               HEAP_LOCK_PAUSE();
+            spin <<= 1;
+         }
+      } while(sHeapLock);
+   }
+}
+
+struct HeapLock
+{
+   bool mLocked;
+
+   HeapLock()
+   {
+      mLocked = sHeapThreaded;
+      if(mLocked && sHeapLockDepth++ == 0)
+         heapLockAcquire();
+   }
+   ~HeapLock()
+   {
+      if(mLocked && --sHeapLockDepth == 0)
+         HEAP_LOCK_RELEASE(&sHeapLock);
+   }
+};
+
 static void* alloc(U32 size, bool array, const char* fileName, const U32 line)
 {
    fileName, line;
@@ -1059,6 +1138,11 @@ void setBreakAlloc(U32 breakAlloc)
 {
    gBreakAlloc = breakAlloc;
 }
+
+void enableThreadSafety()
+{
+   sHeapThreaded = true;
+}
      
 } // namespace Memory
 
@@ -1081,46 +1165,55 @@ void setMinimumAllocUnit(U32 allocUnit)
 
 void* FN_CDECL operator new(dsize_t size, const char* fileName, const U32 line)
 {
+   Memory::HeapLock lock;
    return Memory::alloc(size, false, fileName, line);
 }
 
 void* FN_CDECL operator new[](dsize_t size, const char* fileName, const U32 line)
 {
+   Memory::HeapLock lock;
    return Memory::alloc(size, true, fileName, line);
 }
 
 void* FN_CDECL operator new(dsize_t size)
 {
+   Memory::HeapLock lock;
    return Memory::alloc(size, false, NULL, 0);
 }
 
 void* FN_CDECL operator new[](dsize_t size)
 {
+   Memory::HeapLock lock;
    return Memory::alloc(size, true, NULL, 0);
 }
 
 void FN_CDECL operator delete(void* mem)
 {
+   Memory::HeapLock lock;
    Memory::free(mem, false);
 }
 
 void FN_CDECL operator delete[](void* mem)
 {
+   Memory::HeapLock lock;
    Memory::free(mem, true);
 }
 
 void* dMalloc_r(U32 in_size, const char* fileName, const U32 line)
 {
+   Memory::HeapLock lock;
    return Memory::alloc(in_size, false, fileName, line);
 }
 
 void dFree(void* in_pFree)
 {
+   Memory::HeapLock lock;
    Memory::free(in_pFree, false);
 }
 
 void* dRealloc(void* in_pResize, U32 in_size)
 {
+   Memory::HeapLock lock;
    return Memory::realloc(in_pResize, in_size);
 }
 
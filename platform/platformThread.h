@@ -12,6 +12,17 @@
 #include "Platform/types.h"
 #endif
 
+// Storage class for per thread variables.  Plain data only, at file or
+// class static scope.
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+// no thread locals: every thread shares the variable
+#define THREAD_LOCAL
+#endif
+
 typedef void (*ThreadRunFunction)(S32);
 
 class Thread
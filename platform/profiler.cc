@@ -12,8 +12,9 @@
 #include "console/console.h"
 #include "core/tVector.h"
 #include "core/fileStream.h"
+#include "platform/platformMutex.h"
+#include "platform/platformThread.h"
 
-#ifdef ENABLE_PROFILER
 ProfilerRootData *ProfilerRootData::sRootList = NULL;
 Profiler *gProfiler = NULL;
 
@@ -62,6 +63,21 @@ U32 endHighResolutionTimer(U32 time[2])
    return ticks;
 }
 
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+
+void startHighResolutionTimer(U32 time[2])
+{
+   __asm__ __volatile__ ("rdtsc" : "=a" (time[0]), "=d" (time[1]));
+}
+
+U32 endHighResolutionTimer(U32 time[2])
+{
+   U32 lo, hi;
+   __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+   U64 ticks = ((U64(hi) << 32) | lo) - ((U64(time[1]) << 32) | time[0]);
+   return U32(ticks);
+}
+
 #else
 
 void startHighResolutionTimer(U32 time[2])
@@ -75,92 +91,193 @@ U32 endHighResolutionTimer(U32 time[2])
 
 #endif
 
+//----------------------------------------------------------------------------
+// per thread profiler state
+
+// without thread locals every thread shares the main thread's stack
+static THREAD_LOCAL ProfilerThreadState *sThreadState = NULL;
+
+struct ProfilerTraceEvent
+{
+   ProfilerRootData *mRoot;
+   U32 mStartTime[2];
+   U32 mDuration;
+};
+
+struct ProfilerThreadState
+{
+   enum {
+      NameLength = 32,
+   };
+   ProfilerThreadState *mNext;
+   U32 mIndex;
+   char mName[NameLength];
+
+   ProfilerData *mRootProfilerData;
+   ProfilerData *mCurrentProfilerData;
+   S32 mStackDepth;
+   bool mEnabled;
+
+   ProfilerTraceEvent *mTraceEvents;
+   U32 mTraceEventCount;
+};
+
+static inline U64 timerValue(const U32 time[2])
+{
+   return (U64(time[1]) << 32) | time[0];
+}
+
+static F64 getTicksPerMs()
+{
+   F64 ticksPerMs = Platform::SystemInfo.processor.mhz * 1000.0;
+   return ticksPerMs > 0 ? ticksPerMs : 1;
+}
+
+ProfilerData *Profiler::allocProfilerData(ProfilerData *parent, ProfilerRootData *root)
+{
+   ProfilerData *data = (ProfilerData *) malloc(sizeof(ProfilerData));
+   dMemset(data, 0, sizeof(ProfilerData));
+   data->mRoot = root;
+   data->mParent = parent;
+   if(root)
+      data->mHash = root->mNameHash;
+
+   // the node lists are shared by all threads
+   Mutex::lockMutex(mMutex);
+   data->mNextProfilerData = mProfileList;
+   mProfileList = data;
+   if(root)
+   {
+      data->mNextForRoot = root->mFirstProfilerData;
+      root->mFirstProfilerData = data;
+   }
+   if(parent)
+   {
+      U32 index = data->mHash & (ProfilerData::HashTableSize - 1);
+      data->mNextHash = parent->mChildHash[index];
+      parent->mChildHash[index] = data;
+      data->mNextSibling = parent->mFirstChild;
+      parent->mFirstChild = data;
+   }
+   Mutex::unlockMutex(mMutex);
+   return data;
+}
+
+ProfilerThreadState *Profiler::createThreadState()
+{
+   ProfilerThreadState *ts = (ProfilerThreadState *) malloc(sizeof(ProfilerThreadState));
+   ts->mRootProfilerData = allocProfilerData(NULL, NULL);
+   ts->mCurrentProfilerData = ts->mRootProfilerData;
+   ts->mStackDepth = 0;
+   ts->mEnabled = false;
+   ts->mTraceEvents = NULL;
+   ts->mTraceEventCount = 0;
+
+   Mutex::lockMutex(mMutex);
+   ts->mIndex = mThreadCount++;
+   dSprintf(ts->mName, sizeof(ts->mName), "Thread %d", ts->mIndex);
+   ts->mNext = mThreadList;
+   mThreadList = ts;
+   Mutex::unlockMutex(mMutex);
+
+   sThreadState = ts;
+   return ts;
+}
+
+inline ProfilerThreadState *Profiler::getThreadState()
+{
+   ProfilerThreadState *ts = sThreadState;
+   return ts ? ts : createThreadState();
+}
+
+//----------------------------------------------------------------------------
+
 Profiler::Profiler()
 {
    mMaxStackDepth = MaxStackDepth;
-   mCurrentHash = 0;
-
-   mCurrentProfilerData = (ProfilerData *) malloc(sizeof(ProfilerData));
-   mCurrentProfilerData->mRoot = NULL;
-   mCurrentProfilerData->mNextForRoot = NULL;
-   mCurrentProfilerData->mNextProfilerData = NULL;
-   mCurrentProfilerData->mNextHash = NULL;
-   mCurrentProfilerData->mParent = NULL;
-   mCurrentProfilerData->mNextSibling = NULL;
-   mCurrentProfilerData->mFirstChild = NULL;
-   mCurrentProfilerData->mLastSeenProfiler = NULL;
-   mCurrentProfilerData->mHash = 0;
-   mCurrentProfilerData->mSubDepth = 0;
-   mCurrentProfilerData->mInvokeCount = 0;
-   mCurrentProfilerData->mTotalTime = 0;
-   mCurrentProfilerData->mSubTime = 0;
-   mRootProfilerData = mCurrentProfilerData;
-
-   for(U32 i = 0; i < ProfilerData::HashTableSize; i++)
-      mCurrentProfilerData->mChildHash[i] = 0;
-   
+   mMutex = Mutex::createMutex();
+   mThreadList = NULL;
+   mThreadCount = 0;
    mProfileList = NULL;
 
-   mEnabled = false;
-   mStackDepth = 0;
    mNextEnable = false;
    gProfiler = this;
    mDumpToConsole   = false;
    mDumpToFile      = false;
    mDumpFileName[0] = '\0';
+
+   mCapturing = false;
+   mCaptureFrames = 0;
+   mFrameCount = 0;
+   mWriteCapture = false;
+   mCaptureFileName[0] = '\0';
+   mSpikeArmed = false;
+   mSpikeTriggered = false;
+   mSpikeThreshold = 0;
+
+   // the profiler is a static, so this is the main thread
+   mMainThread = createThreadState();
+   dStrcpy(mMainThread->mName, "Main");
 }
 
 Profiler::~Profiler()
 {
-   reset();
-   free(mRootProfilerData);
    gProfiler = NULL;
+   while(mThreadList)
+   {
+      ProfilerThreadState *next = mThreadList->mNext;
+      free(mThreadList->mTraceEvents);
+      free(mThreadList);
+      mThreadList = next;
+   }
+   while(mProfileList)
+   {
+      ProfilerData *next = mProfileList->mNextProfilerData;
+      free(mProfileList);
+      mProfileList = next;
+   }
+   Mutex::destroyMutex(mMutex);
 }
 
 void Profiler::reset()
 {
-   mEnabled = false; // in case we're in a profiler call.
-   while(mProfileList)
+   // Other threads may be inside their trees, so the nodes are kept around
+   // and just cleared.
+   Mutex::lockMutex(mMutex);
+   for(ProfilerData *walk = mProfileList; walk; walk = walk->mNextProfilerData)
    {
-      ProfilerData *next = mProfileList->mNextProfilerData;
-      free(mProfileList);
-      mProfileList = NULL;
+      walk->mInvokeCount = 0;
+      walk->mTotalTime = 0;
+      walk->mSubTime = 0;
    }
    for(ProfilerRootData *walk = ProfilerRootData::sRootList; walk; walk = walk->mNextRoot)
    {
-      walk->mFirstProfilerData = 0;
       walk->mTotalTime = 0;
       walk->mSubTime = 0;
       walk->mTotalInvokeCount = 0;
    }
-   mCurrentProfilerData = mRootProfilerData;
-   mCurrentProfilerData->mNextForRoot = 0;
-   mCurrentProfilerData->mFirstChild = 0;
-   for(U32 i = 0; i < ProfilerData::HashTableSize; i++)
-      mCurrentProfilerData->mChildHash[i] = 0;
-   mCurrentProfilerData->mInvokeCount = 0;
-   mCurrentProfilerData->mTotalTime = 0;
-   mCurrentProfilerData->mSubTime = 0;
-   mCurrentProfilerData->mSubDepth = 0;
-   mCurrentProfilerData->mLastSeenProfiler = 0;
+   Mutex::unlockMutex(mMutex);
 }
 
 static Profiler aProfiler; // allocate the global profiler
 
-ProfilerRootData::ProfilerRootData(const char *name)
+// Markers first reached on several threads at once can both get here, the
+// second one finds it done.
+void Profiler::registerRoot(ProfilerRootData *root)
 {
-   for(ProfilerRootData *walk = sRootList; walk; walk = walk->mNextRoot)
-      if(!dStrcmp(walk->mName, name))
-         Platform::debugBreak();
+   Mutex::lockMutex(mMutex);
+   if(!root->mRegistered)
+   {
+      for(ProfilerRootData *walk = ProfilerRootData::sRootList; walk; walk = walk->mNextRoot)
+         if(!dStrcmp(walk->mName, root->mName))
+            Platform::debugBreak();
 
-   mName = name;
-   mNameHash = _StringTable::hashString(name);
-   mNextRoot = sRootList;
-   sRootList = this;
-   mTotalTime = 0;
-   mTotalInvokeCount = 0;
-   mFirstProfilerData = NULL;
-   mEnabled = true;
+      root->mNameHash = _StringTable::hashString(root->mName);
+      root->mNextRoot = ProfilerRootData::sRootList;
+      ProfilerRootData::sRootList = root;
+      root->mRegistered = true;
+   }
+   Mutex::unlockMutex(mMutex);
 }
 
 void Profiler::validate()
@@ -188,30 +305,57 @@ void Profiler::validate()
    }
 }
 
+void Profiler::setThreadName(const char *name)
+{
+   ProfilerThreadState *ts = getThreadState();
+   dStrncpy(ts->mName, name, ProfilerThreadState::NameLength - 1);
+   ts->mName[ProfilerThreadState::NameLength - 1] = 0;
+}
+
 void Profiler::hashPush(ProfilerRootData *root)
 {
-   mStackDepth++;
-   AssertFatal(mStackDepth <= mMaxStackDepth,
+   if(!root->mRegistered)
+      registerRoot(root);
+
+   ProfilerThreadState *ts = getThreadState();
+   if(ts->mStackDepth == 0)
+   {
+      // apply the next enable...
+      bool enable = mNextEnable || mCapturing;
+      if(!ts->mEnabled && enable)
+         startHighResolutionTimer(ts->mRootProfilerData->mStartTime);
+      ts->mEnabled = enable;
+      if(ts == mMainThread)
+         beginFrame();
+      if(mCapturing && !ts->mTraceEvents)
+      {
+         ts->mTraceEvents = (ProfilerTraceEvent *) malloc(sizeof(ProfilerTraceEvent) * TraceEventsPerThread);
+         ts->mTraceEventCount = 0;
+      }
+   }
+   ts->mStackDepth++;
+   AssertFatal(ts->mStackDepth <= mMaxStackDepth,
                   "Stack overflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
-   if(!mEnabled)
+   if(!ts->mEnabled)
       return;
 
+   ProfilerData *current = ts->mCurrentProfilerData;
    ProfilerData *nextProfiler = NULL;
-   if(!root->mEnabled || mCurrentProfilerData->mRoot == root)
+   if(!root->mEnabled || current->mRoot == root)
    {
-      mCurrentProfilerData->mSubDepth++;
+      current->mSubDepth++;
       return;
    }
 
-   if(mCurrentProfilerData->mLastSeenProfiler &&
-            mCurrentProfilerData->mLastSeenProfiler->mRoot == root)
-      nextProfiler = mCurrentProfilerData->mLastSeenProfiler;
+   if(current->mLastSeenProfiler &&
+            current->mLastSeenProfiler->mRoot == root)
+      nextProfiler = current->mLastSeenProfiler;
 
    if(!nextProfiler)
    {
       // first see if it's in the hash table...
       U32 index = root->mNameHash & (ProfilerData::HashTableSize - 1);
-      nextProfiler = mCurrentProfilerData->mChildHash[index];
+      nextProfiler = current->mChildHash[index];
       while(nextProfiler)
       {
          if(nextProfiler->mRoot == root)
@@ -219,38 +363,12 @@ void Profiler::hashPush(ProfilerRootData *root)
          nextProfiler = nextProfiler->mNextHash;
       }
       if(!nextProfiler)
-      {
-         nextProfiler = (ProfilerData *) malloc(sizeof(ProfilerData));
-         for(U32 i = 0; i < ProfilerData::HashTableSize; i++)
-            nextProfiler->mChildHash[i] = 0;
-
-         nextProfiler->mRoot = root;
-         nextProfiler->mNextForRoot = root->mFirstProfilerData;
-         root->mFirstProfilerData = nextProfiler;
-         
-         nextProfiler->mNextProfilerData = mProfileList;
-         mProfileList = nextProfiler;
-
-         nextProfiler->mNextHash = mCurrentProfilerData->mChildHash[index];
-         mCurrentProfilerData->mChildHash[index] = nextProfiler;
-
-         nextProfiler->mParent = mCurrentProfilerData;
-         nextProfiler->mNextSibling = mCurrentProfilerData->mFirstChild;
-         mCurrentProfilerData->mFirstChild = nextProfiler;
-         nextProfiler->mFirstChild = NULL;
-         nextProfiler->mLastSeenProfiler = NULL;
-         nextProfiler->mHash = root->mNameHash;
-         nextProfiler->mInvokeCount = 0;
-         nextProfiler->mTotalTime = 0;
-         nextProfiler->mSubTime = 0;
-         nextProfiler->mSubDepth = 0;
-      }
+         nextProfiler = allocProfilerData(current, root);
    }
-   root->mTotalInvokeCount++;
    nextProfiler->mInvokeCount++;
    startHighResolutionTimer(nextProfiler->mStartTime);
-   mCurrentProfilerData->mLastSeenProfiler = nextProfiler;
-   mCurrentProfilerData = nextProfiler;
+   current->mLastSeenProfiler = nextProfiler;
+   ts->mCurrentProfilerData = nextProfiler;
 }
 
 void Profiler::enable(bool enabled)
@@ -275,37 +393,165 @@ void Profiler::dumpToFile(const char* fileName)
 
 void Profiler::hashPop()
 {
-   mStackDepth--;
-   AssertFatal(mStackDepth >= 0, "Stack underflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
-   if(mEnabled)
+   ProfilerThreadState *ts = getThreadState();
+   ts->mStackDepth--;
+   AssertFatal(ts->mStackDepth >= 0, "Stack underflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
+   if(ts->mEnabled)
    {
-      if(mCurrentProfilerData->mSubDepth)
+      ProfilerData *current = ts->mCurrentProfilerData;
+      if(current->mSubDepth)
       {
-         mCurrentProfilerData->mSubDepth--;
+         current->mSubDepth--;
          return;
       }
-      F64 fElapsed = endHighResolutionTimer(mCurrentProfilerData->mStartTime);
-      mCurrentProfilerData->mTotalTime += fElapsed;
-      mCurrentProfilerData->mParent->mSubTime += fElapsed; // mark it in the parent as well...
-      mCurrentProfilerData->mRoot->mTotalTime += fElapsed;
-      if(mCurrentProfilerData->mParent->mRoot)
-         mCurrentProfilerData->mParent->mRoot->mSubTime += fElapsed; // mark it in the parent as well...
-      mCurrentProfilerData = mCurrentProfilerData->mParent;
+      U32 elapsed = endHighResolutionTimer(current->mStartTime);
+      F64 fElapsed = elapsed;
+      current->mTotalTime += fElapsed;
+      current->mParent->mSubTime += fElapsed; // mark it in the parent as well...
+      ts->mCurrentProfilerData = current->mParent;
+
+      if(ts->mTraceEvents)
+      {
+         ProfilerTraceEvent &event = ts->mTraceEvents[ts->mTraceEventCount++ & (TraceEventsPerThread - 1)];
+         event.mRoot = current->mRoot;
+         event.mStartTime[0] = current->mStartTime[0];
+         event.mStartTime[1] = current->mStartTime[1];
+         event.mDuration = elapsed;
+      }
    }
-   if(mStackDepth == 0)
+   if(ts->mStackDepth == 0 && ts == mMainThread)
+      endFrame();
+}
+
+//----------------------------------------------------------------------------
+// frames and trace capture
+
+void Profiler::beginFrame()
+{
+   U32 *frameStart = mFrameStart[mFrameCount++ % MaxCaptureFrames];
+   startHighResolutionTimer(frameStart);
+}
+
+void Profiler::endFrame()
+{
+   if(mDumpToConsole || mDumpToFile)
+      dump();
+   if(mSpikeTriggered)
    {
-      // apply the next enable...
-      if(mDumpToConsole || mDumpToFile)
+      writeCapture();
+      mSpikeTriggered = false;
+      mSpikeArmed = false;
+      stopCapture();
+   }
+   else if(mWriteCapture)
+   {
+      writeCapture();
+      mWriteCapture = false;
+   }
+}
+
+void Profiler::startCapture(U32 numFrames)
+{
+   if(!numFrames)
+   {
+      stopCapture();
+      return;
+   }
+   mCaptureFrames = getMin(numFrames, U32(MaxCaptureFrames));
+   mCapturing = true;
+}
+
+void Profiler::stopCapture()
+{
+   mCapturing = false;
+   mSpikeArmed = false;
+   mSpikeTriggered = false;
+}
+
+void Profiler::captureToFile(const char *fileName)
+{
+   AssertFatal(dStrlen(fileName) < DumpFileNameLength, "Error, capture filename too long");
+   dStrcpy(mCaptureFileName, fileName);
+   mWriteCapture = true;
+}
+
+void Profiler::armSpikeCapture(F32 thresholdMs, const char *fileName, U32 numFrames)
+{
+   startCapture(numFrames);
+   captureToFile(fileName);
+   mWriteCapture = false;
+   mSpikeThreshold = thresholdMs * getTicksPerMs();
+   mSpikeArmed = true;
+}
+
+void Profiler::serverTickComplete(U32 ticks)
+{
+   if(!mSpikeArmed || mSpikeTriggered || ticks <= mSpikeThreshold)
+      return;
+   mSpikeTriggered = true;
+   Con::printf("Profiler: server tick took %.2f ms, capturing to %s.",
+               ticks / getTicksPerMs(), mCaptureFileName);
+}
+
+void Profiler::writeCapture()
+{
+   if(!mFrameCount || !mCaptureFrames)
+      return;
+
+   FileStream fws;
+   if(!fws.open(mCaptureFileName, FileStream::Write))
+   {
+      Con::errorf(ConsoleLogEntry::General, "Profiler: unable to open %s.", mCaptureFileName);
+      return;
+   }
+
+   // only events from the kept frames go out, the current one included
+   U32 frames = getMin(mFrameCount, mCaptureFrames);
+   U64 captureStart = timerValue(mFrameStart[(mFrameCount - frames) % MaxCaptureFrames]);
+   F64 ticksPerUs = getTicksPerMs() / 1000.0;
+
+   char buffer[256];
+   const char *separator = "";
+   U32 eventCount = 0;
+   dStrcpy(buffer, "{\"traceEvents\":[\n");
+   fws.write(dStrlen(buffer), buffer);
+
+   Mutex::lockMutex(mMutex);
+   for(ProfilerThreadState *ts = mThreadList; ts; ts = ts->mNext)
+   {
+      dSprintf(buffer, sizeof(buffer), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+               separator, ts->mIndex, ts->mName);
+      fws.write(dStrlen(buffer), buffer);
+      separator = ",\n";
+
+      if(!ts->mTraceEvents)
+         continue;
+      U32 count = ts->mTraceEventCount;
+      U32 first = count > TraceEventsPerThread ? count - TraceEventsPerThread : 0;
+      for(U32 i = first; i != count; i++)
       {
-         dump();
-         startHighResolutionTimer(mCurrentProfilerData->mStartTime);
+         ProfilerTraceEvent &event = ts->mTraceEvents[i & (TraceEventsPerThread - 1)];
+         U64 start = timerValue(event.mStartTime);
+         if(!event.mRoot || start < captureStart)
+            continue;
+         dSprintf(buffer, sizeof(buffer), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                  separator, event.mRoot->mName, ts->mIndex,
+                  F64(start - captureStart) / ticksPerUs, event.mDuration / ticksPerUs);
+         fws.write(dStrlen(buffer), buffer);
+         eventCount++;
       }
-      if(!mEnabled && mNextEnable)
-         startHighResolutionTimer(mCurrentProfilerData->mStartTime);
-      mEnabled = mNextEnable;
    }
+   Mutex::unlockMutex(mMutex);
+
+   dStrcpy(buffer, "\n]}\n");
+   fws.write(dStrlen(buffer), buffer);
+   fws.close();
+   Con::printf("Profiler: wrote %d events from %d frames to %s.", eventCount, frames, mCaptureFileName);
 }
 
+//----------------------------------------------------------------------------
+// dumps
+
 static S32 QSORT_CALLBACK rootDataCompare(const void *s1, const void *s2)
 {
    const ProfilerRootData *r1 = *((ProfilerRootData **) s1);
@@ -390,13 +636,41 @@ static void profilerDataDumpRecurseFile(ProfilerData *data, char *buffer, U32 bu
    buffer[bufferLen] = 0;
 }
 
+void Profiler::updateRootTotals()
+{
+   Mutex::lockMutex(mMutex);
+   ProfilerRootData *root;
+   for(root = ProfilerRootData::sRootList; root; root = root->mNextRoot)
+   {
+      root->mTotalTime = 0;
+      root->mSubTime = 0;
+      root->mTotalInvokeCount = 0;
+   }
+   for(ProfilerData *walk = mProfileList; walk; walk = walk->mNextProfilerData)
+   {
+      if(!walk->mRoot)
+         continue;
+      walk->mRoot->mTotalTime += walk->mTotalTime;
+      walk->mRoot->mTotalInvokeCount += walk->mInvokeCount;
+      if(walk->mParent->mRoot)
+         walk->mParent->mRoot->mSubTime += walk->mTotalTime; // mark it in the parent as well...
+   }
+   Mutex::unlockMutex(mMutex);
+}
+
 void Profiler::dump()
 {
-   bool enableSave = mEnabled;
-   mEnabled = false;
-   mStackDepth++;
    // may have some profiled calls... gotta turn em off.
-   
+   ProfilerThreadState *ts = getThreadState();
+   bool enableSave = ts->mEnabled;
+   ts->mEnabled = false;
+   ts->mStackDepth++;
+
+   updateRootTotals();
+
+   // no new nodes while the trees are sorted
+   Mutex::lockMutex(mMutex);
+
    Vector<ProfilerRootData *> rootVector;
    F64 totalTime = 0;
    for(ProfilerRootData *walk = ProfilerRootData::sRootList; walk; walk = walk->mNextRoot)
@@ -406,6 +680,8 @@ void Profiler::dump()
    }
    dQsort((void *) &rootVector[0], rootVector.size(), sizeof(ProfilerRootData *), rootDataCompare);
 
+   char depthBuffer[MaxStackDepth * 2 + 1];
+   ProfilerThreadState *walk;
 
    if (mDumpToConsole == true)
    {
@@ -423,18 +699,19 @@ void Profiler::dump()
          rootVector[i]->mTotalTime = 0;
          rootVector[i]->mSubTime = 0;
       }
-      Con::printf("");
-      Con::printf("Ordered by stack trace total time -");
-      Con::printf("%% Time  %% NSTime  Invoke #  Name");
-
-      U32 depth = 0;
-      mCurrentProfilerData->mTotalTime = endHighResolutionTimer(mCurrentProfilerData->mStartTime);
-
-      char depthBuffer[MaxStackDepth * 2 + 1];
-      depthBuffer[0] = 0;
-      profilerDataDumpRecurse(mCurrentProfilerData, depthBuffer, 0, totalTime);
-      mEnabled = enableSave;
-      mStackDepth--;
+      for(walk = mThreadList; walk; walk = walk->mNext)
+      {
+         if(!walk->mRootProfilerData->mFirstChild)
+            continue;
+         Con::printf("");
+         Con::printf("%s - ordered by stack trace total time -", walk->mName);
+         Con::printf("%% Time  %% NSTime  Invoke #  Name");
+
+         walk->mRootProfilerData->mTotalTime = endHighResolutionTimer(walk->mRootProfilerData->mStartTime);
+         depthBuffer[0] = 0;
+         profilerDataDumpRecurse(walk->mRootProfilerData, depthBuffer, 0, totalTime);
+         startHighResolutionTimer(walk->mRootProfilerData->mStartTime);
+      }
    }
    else if (mDumpToFile == true && mDumpFileName[0] != '\0')
    {
@@ -463,23 +740,27 @@ void Profiler::dump()
             rootVector[i]->mTotalTime = 0;
             rootVector[i]->mSubTime = 0;
          }
-         dStrcpy(buffer, "\nOrdered by non-sub total time -\n");
+      for(walk = mThreadList; walk; walk = walk->mNext)
+      {
+         if(!walk->mRootProfilerData->mFirstChild)
+            continue;
+         dSprintf(buffer, 1023, "\n%s - ordered by stack trace total time -\n", walk->mName);
          fws.write(dStrlen(buffer), buffer);
          dStrcpy(buffer, "%%NSTime  %% Time  Invoke #  Name\n");
          fws.write(dStrlen(buffer), buffer);
 
-      U32 depth = 0;
-      mCurrentProfilerData->mTotalTime = endHighResolutionTimer(mCurrentProfilerData->mStartTime);
-
-      char depthBuffer[MaxStackDepth * 2 + 1];
-      depthBuffer[0] = 0;
-      profilerDataDumpRecurseFile(mCurrentProfilerData, depthBuffer, 0, totalTime, fws);
-      mEnabled = enableSave;
-      mStackDepth--;
-
+         walk->mRootProfilerData->mTotalTime = endHighResolutionTimer(walk->mRootProfilerData->mStartTime);
+         depthBuffer[0] = 0;
+         profilerDataDumpRecurseFile(walk->mRootProfilerData, depthBuffer, 0, totalTime, fws);
+         startHighResolutionTimer(walk->mRootProfilerData->mStartTime);
+      }
       fws.close();
    }
-   
+   Mutex::unlockMutex(mMutex);
+
+   ts->mEnabled = enableSave;
+   ts->mStackDepth--;
+
    mDumpToConsole = false;
    mDumpToFile    = false;
    mDumpFileName[0] = '\0';
@@ -535,4 +816,22 @@ ConsoleFunction(profilerDumpToFile, void, 2, 2, "profilerDumpToFile(filename);")
       gProfiler->dumpToFile(argv[1]);
 }
 
-#endif
+ConsoleFunction(profilerCapture, void, 2, 2, "profilerCapture(numFrames); 0 stops capturing.")
+{
+   argc;
+   if(gProfiler)
+      gProfiler->startCapture(dAtoi(argv[1]));
+}
+
+ConsoleFunction(profilerCaptureToFile, void, 2, 2, "profilerCaptureToFile(filename);")
+{
+   argc;
+   if(gProfiler)
+      gProfiler->captureToFile(argv[1]);
+}
+
+ConsoleFunction(profilerCaptureOnSpike, void, 3, 4, "profilerCaptureOnSpike(tickThresholdMS, filename, <numFrames>);")
+{
+   if(gProfiler)
+      gProfiler->armSpikeCapture(dAtof(argv[1]), argv[2], argc > 3 ? dAtoi(argv[3]) : 8);
+}
@@ -8,31 +8,64 @@
 #ifndef _PROFILER_H_
 #define _PROFILER_H_
 
-#ifdef ENABLE_PROFILER
-
 struct ProfilerData;
 struct ProfilerRootData;
-
+struct ProfilerThreadState;
+
+// processor tick timer used by the profiler
+void startHighResolutionTimer(U32 time[2]);
+U32 endHighResolutionTimer(U32 time[2]);
+
+//----------------------------------------------------------------------------
+// The profiler is always compiled in.  While it is disabled a marker costs
+// a thread local lookup and a depth count.  Every thread that hits a marker
+// gets its own stack and call tree; the thread that constructed the profiler
+// (the main thread) also drives the frame boundaries, which are the points
+// where it returns to stack depth zero.
+//
+// While capturing, every completed marker is also recorded into a per thread
+// ring buffer so the last few frames can be written out as a Chrome
+// trace-event file (chrome://tracing).
+//
 class Profiler
 {
    enum {
       MaxStackDepth = 256,
-      DumpFileNameLength = 256
+      DumpFileNameLength = 256,
+      MaxCaptureFrames = 256,
+      TraceEventsPerThread = 65536, // must be a power of 2
    };
-   U32 mCurrentHash;
 
-   ProfilerData *mCurrentProfilerData;
+   void *mMutex;
+   ProfilerThreadState *mThreadList;
+   ProfilerThreadState *mMainThread;
+   U32 mThreadCount;
    ProfilerData *mProfileList;
-   ProfilerData *mRootProfilerData;
 
-   bool mEnabled;
-   S32 mStackDepth;
    bool mNextEnable;
    U32 mMaxStackDepth;
    bool mDumpToConsole;
    bool mDumpToFile;
    char mDumpFileName[DumpFileNameLength];
+
+   bool mCapturing;
+   U32 mCaptureFrames;
+   U32 mFrameCount;
+   U32 mFrameStart[MaxCaptureFrames][2];
+   bool mWriteCapture;
+   char mCaptureFileName[DumpFileNameLength];
+   bool mSpikeArmed;
+   bool mSpikeTriggered;
+   F64 mSpikeThreshold;
+
+   ProfilerThreadState *getThreadState();
+   ProfilerThreadState *createThreadState();
+   ProfilerData *allocProfilerData(ProfilerData *parent, ProfilerRootData *root);
+   void registerRoot(ProfilerRootData *root);
+   void beginFrame();
+   void endFrame();
    void dump();
+   void writeCapture();
    void validate();
 public:
    Profiler();
@@ -45,24 +78,42 @@ public:
    void hashPush(ProfilerRootData *data);
    void hashPop();
    void enableMarker(const char *marker, bool enabled);
+
+   // Name the calling thread in dumps and trace captures.
+   void setThreadName(const char *name);
+   // Sum the per thread call trees into the ProfilerRootData totals.
+   void updateRootTotals();
+
+   // Keep the last numFrames frames of marker events (0 stops).
+   void startCapture(U32 numFrames);
+   void stopCapture();
+   // Write the captured frames at the end of the current frame.
+   void captureToFile(const char *fileName);
+   // Capture continuously and write the frames out (once) as soon as a
+   // server tick takes longer than thresholdMs.
+   void armSpikeCapture(F32 thresholdMs, const char *fileName, U32 numFrames);
+   // Called by the server process list with the duration of each tick.
+   void serverTickComplete(U32 ticks);
 };
 
 extern Profiler *gProfiler;
 
+// Plain data so the marker statics are set up at load time, with no
+// constructor for two threads to race through.  A root goes on the root
+// list the first time it's pushed (see Profiler::registerRoot).
 struct ProfilerRootData
 {
    const char *mName;
+   bool mEnabled;
+   volatile bool mRegistered;
    U32 mNameHash;
    ProfilerData *mFirstProfilerData;
    ProfilerRootData *mNextRoot;
    F64 mTotalTime;
    F64 mSubTime;
    U32 mTotalInvokeCount;
-   bool mEnabled;
 
    static ProfilerRootData *sRootList;
-
-   ProfilerRootData(const char *name);
 };
 
 struct ProfilerData
@@ -90,14 +141,9 @@ struct ProfilerData
 
 
 #define PROFILE_START(name) \
-static ProfilerRootData pdata##name##obj (#name); \
+static ProfilerRootData pdata##name##obj = { #name, true }; \
 if(gProfiler) gProfiler->hashPush(& pdata##name##obj )
 
 #define PROFILE_END() if(gProfiler) gProfiler->hashPop()
 
-#else
-#define PROFILE_START(x) 
-#define PROFILE_END()
-#endif
-
 #endif
@@ -5,6 +5,7 @@
 // Portions Copyright (c) 2001 by Sierra Online, Inc.
 //-----------------------------------------------------------------------------
 
+#include "Platform/platform.h"
 #include "Platform/platformThread.h"
 #include "Platform/platformSemaphore.h"
 
@@ -72,6 +73,7 @@ void Thread::start( void )
 
 	LinuxThreadData* threadData = reinterpret_cast<LinuxThreadData*>( mData );
 	Semaphore::acquireSemaphore( threadData->mSemaphore );
+	Memory::enableThreadSafety( );
 
 	pthread_attr_t attr;
 	pthread_t thread;
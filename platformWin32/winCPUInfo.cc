@@ -38,6 +38,7 @@ void Processor::init()
       BIT_RDTSC   = (1<<4),  
       BIT_MMX     = (1<<23),  
       BIT_SSE     = (1<<25),  
+      BIT_SSE2    = (1<<26),  
       BIT_3DNOW   = (1<<31),  
    };
 
@@ -99,6 +100,7 @@ void Processor::init()
    Platform::SystemInfo.processor.properties |= (properties & BIT_FPU)   ? CPU_PROP_FPU : 0;
    Platform::SystemInfo.processor.properties |= (properties & BIT_RDTSC) ? CPU_PROP_RDTSC : 0;
    Platform::SystemInfo.processor.properties |= (properties & BIT_MMX)   ? CPU_PROP_MMX : 0;
+   Platform::SystemInfo.processor.properties |= (properties & BIT_SSE2)  ? CPU_PROP_SSE2 : 0;
 
    //--------------------------------------
    if (dStricmp(vendor, "GenuineIntel") == 0)
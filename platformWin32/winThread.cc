@@ -66,6 +66,7 @@ void Thread::start()
 
    WinThreadData * threadData = reinterpret_cast<WinThreadData*>(mData);
    Semaphore::acquireSemaphore(threadData->mSemaphore);
+   Memory::enableThreadSafety();
 
    DWORD threadID;
    CreateThread(0, 0, ThreadRunHandler, mData, 0, &threadID);
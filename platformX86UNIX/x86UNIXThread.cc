@@ -65,6 +65,7 @@ void Thread::start()
 
    x86UNIXThreadData * threadData = reinterpret_cast<x86UNIXThreadData*>(mData);
    Semaphore::acquireSemaphore(threadData->mSemaphore);
+   Memory::enableThreadSafety();
 
    pthread_t threadID;
    pthread_create(&threadID, NULL, ThreadRunHandler, mData);
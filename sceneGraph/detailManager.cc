@@ -8,6 +8,7 @@
 #include "sceneGraph/detailManager.h"
 #include "ts/tsShapeInstance.h"
 #include "ts/tsPartInstance.h"
+#include "ts/tsAnimateBatch.h"
 #include "dgl/dgl.h"
 
 // bias towards using same detail level as previous frame
@@ -378,6 +379,24 @@ bool DetailManager::selectCurrent(TSPartInstance * pi)
    return true;
 }
 
+//---------------------------------------------------------
+// Rendering selects the same detail again and animate() then has nothing to do.
+void DetailManager::animateCurrent()
+{
+   AssertFatal(!mInPrepRender,"DetailManager::animateCurrent");
+
+   if (!gTSAnimateBatch.getNumThreads())
+      return;
+
+   for (S32 i=0; i<mDetailData.size(); i++)
+   {
+      TSShapeInstance * si = mDetailData[i]->shapeInstance;
+      if (si && selectCurrent(si))
+         gTSAnimateBatch.add(si);
+   }
+   gTSAnimateBatch.run();
+}
+
 //---------------------------------------------------------
 void DetailManager::computePriority(DetailData * detailData, S32 bump)
 {
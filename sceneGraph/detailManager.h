@@ -73,6 +73,7 @@ private:
 
    void selectPotential(TSPartInstance * pi, F32 dist, F32 invScale, const DetailProfile * dp = &smDefaultProfile);
    bool selectCurrent(TSPartInstance * pi);
+   void animateCurrent();
 
    void bumpOne(DetailData*, S32 bump);
    void bumpAll(S32 bump);
@@ -99,6 +100,9 @@ public:
 
    static void beginPrepRender() { get()->begin(); }
    static void endPrepRender() { get()->end(); }
+   // selects the current detail of each shape instance that's rendering and
+   // animates them all at once on the animation threads (if any are running)
+   static void animateCurrentDetails() { get()->animateCurrent(); }
 
    static void selectPotentialDetails(TSShapeInstance * si, F32 dist, F32 invScale) { get()->selectPotential(si,dist,invScale); }
    static bool selectCurrentDetail(TSShapeInstance * si) { return get()->selectCurrent(si); }
@@ -182,6 +182,8 @@ void SceneGraph::renderScene(const U32 objectMask)
    DetailManager::endPrepRender();
    PROFILE_END();
 
+   DetailManager::animateCurrentDetails();
+
    // grab the lights...
    PROFILE_START(RegisterLights);
    mLightManager.registerLights(false);
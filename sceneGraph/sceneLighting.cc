@@ -17,6 +17,9 @@
 #include "gui/guiCanvas.h"
 #include "core/zipSubStream.h"
 #include "game/gameConnection.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/profiler.h"
 
 namespace {
 
@@ -119,6 +122,34 @@ class SceneLightingProcessEvent : public SimEvent
       };
 };
 
+//------------------------------------------------------------------------------
+// Takes lit objects off the job list until it's empty
+class SceneLightingThread : public Thread
+{
+   private:
+      SceneLighting *   mLighting;
+      S32               mIndex;
+
+   public:
+      SceneLightingThread(SceneLighting * lighting, S32 index) : Thread(0, index, false)
+      {
+         mLighting = lighting;
+         mIndex = index;
+         start();
+      }
+
+      void run(S32)
+      {
+         if(gProfiler)
+         {
+            char name[32];
+            dSprintf(name, sizeof(name), "Lighting %d", mIndex);
+            gProfiler->setThreadName(name);
+         }
+         mLighting->runLightJobs();
+      }
+};
+
 //------------------------------------------------------------------------------
 bool SceneLighting::smUseVertexLighting   = false;
 
@@ -128,6 +159,18 @@ SceneLighting::SceneLighting()
    mFileName[0] = 0;
    smUseVertexLighting = Interior::smUseVertexLighting;
 
+   mNumThreads = 0;
+   mThreadCount = 0;
+   mJobMutex = Mutex::createMutex();
+   mNextJob = 0;
+   mNumFinished = 0;
+   mJobLight = 0;
+   mAbortJobs = false;
+
+   mLastVectorLight = -1;
+   mJournalName[0] = 0;
+   mJournal = 0;
+
    static bool initialized = false;
    if(!initialized)
    {
@@ -142,6 +185,11 @@ SceneLighting::~SceneLighting()
    gLighting = 0;
    gLightingProgress = 0.f;
 
+   // the threads are working on the proxies
+   stopLightJobs();
+   Mutex::destroyMutex(mJobMutex);
+   closeJournal(false);
+
    ObjectProxy ** proxyItr;
    for(proxyItr = mSceneObjects.begin(); proxyItr != mSceneObjects.end(); proxyItr++)
       delete *proxyItr;
@@ -874,6 +922,30 @@ void SceneLighting::addInterior(ShadowVolumeBSP * shadowVolume, InteriorProxy &
    }
 }
 
+//------------------------------------------------------------------------------
+// Copies the base lightmaps of every surface addInterior and light fill for
+// the detail, so the lighting threads find them in place
+void SceneLighting::duplicateLightmaps(InteriorProxy & interior, S32 level)
+{
+   Interior * detail = interior->mInteriorRes->getDetailLevel(level);
+   bool hasAlarm = detail->hasAlarmState();
+
+   for(U32 i = 0; i < detail->getNumZones(); i++)
+   {
+      Interior::Zone & zone = detail->mZones[i];
+      for(U32 j = 0; j < zone.surfaceCount; j++)
+      {
+         U32 surfaceIndex = detail->mZoneSurfaces[zone.surfaceStart + j];
+         if(!(detail->mSurfaces[surfaceIndex].surfaceFlags & Interior::SurfaceOutsideVisible))
+            continue;
+
+         gInteriorLMManager.duplicateBaseLightmap(detail->getLMHandle(), interior->getLMHandle(), detail->getNormalLMapIndex(surfaceIndex));
+         if(hasAlarm && detail->getNormalLMapIndex(surfaceIndex) != detail->getAlarmLMapIndex(surfaceIndex))
+            gInteriorLMManager.duplicateBaseLightmap(detail->getLMHandle(), interior->getLMHandle(), detail->getAlarmLMapIndex(surfaceIndex));
+      }
+   }
+}
+
 //------------------------------------------------------------------------------
 ShadowVolumeBSP::SVPoly * SceneLighting::buildInteriorPoly(ShadowVolumeBSP * shadowVolumeBSP,
    InteriorProxy & interior, Interior * detail, U32 surfaceIndex, LightInfo * light,
@@ -1088,6 +1160,27 @@ bool SceneLighting::light(BitSet32 flags)
    for(ObjectProxy ** proxyItr = mSceneObjects.begin(); proxyItr != mSceneObjects.end(); proxyItr++)
       (*proxyItr)->init();
 
+   mThreadCount = mClamp(Con::getIntVariable("$pref::sceneLighting::threads", 4), 0, MaxThreads);
+
+   // only the vector lights do any lighting
+   mLastVectorLight = -1;
+   for(U32 i = 0; i < mLights.size(); i++)
+      if(mLights[i]->mType == LightInfo::Vector)
+         mLastVectorLight = i;
+
+   // pick up where an interrupted light of this mission left off
+   if(Con::getBoolVariable("$pref::sceneLighting::cacheLighting", true))
+   {
+      dSprintf(mJournalName, sizeof(mJournalName), "%sj", mFileName);
+      if(!flags.test(ForceAlways|ForceWritable))
+      {
+         U32 resumed = loadJournal();
+         if(resumed)
+            Con::printf(" Resuming mission lighting: %d of %d objects lit", resumed, mSceneObjects.size());
+      }
+      openJournal();
+   }
+
    // get things started
    Sim::postEvent(this, new SceneLightingProcessEvent(0, -1), Sim::getTargetTime() + 1);
    return(true);
@@ -1099,6 +1192,7 @@ void SceneLighting::processEvent(U32 light, S32 object)
    // cancel lighting?
    if(gTerminateLighting)
    {
+      stopLightJobs();
       completed(false);
       deleteObject();
       return;
@@ -1138,6 +1232,7 @@ void SceneLighting::processEvent(U32 light, S32 object)
             else
             {
                Con::printf(" Successfully saved mission lighting file: '%s'", mFileName);
+               closeJournal(true);
                
                // update the resource manager (need size of this file now)
                U32 size = dStrlen(ResourceManager->getModPaths());
@@ -1169,6 +1264,8 @@ void SceneLighting::processEvent(U32 light, S32 object)
       }
       else
       {
+         S32 next = object + 1;
+
          // start of this light?
          if(object == -1)
          {
@@ -1183,13 +1280,30 @@ void SceneLighting::processEvent(U32 light, S32 object)
                if((*proxyItr)->preLight(mLights[light]))
                   mLitObjects.push_back(*proxyItr);
             }
+
+            if(mThreadCount)
+               startLightJobs(light);
+         }
+         else if(mThreadCount)
+         {
+            // wait on the lighting threads
+            if(finishLightJobs(light))
+               next = mLitObjects.size();
+            else
+               next = object;
          }
          else
          {
-            if(mLitObjects[object]->getObject())
+            ObjectProxy * proxy = mLitObjects[object];
+            if(proxy->getObject())
             {
                gLightingProgress = (F32(light) / F32(mLights.size())) + ((F32(object + 1) / F32(mLitObjects.size())) / F32(mLights.size()));
-               mLitObjects[object]->light(mLights[light]);
+               if(!proxy->mResumed)
+               {
+                  proxy->prepareLight(mLights[light]);
+                  proxy->light(mLights[light]);
+                  finishObject(light, proxy);
+               }
             }
             else
             {
@@ -1199,11 +1313,271 @@ void SceneLighting::processEvent(U32 light, S32 object)
          }
 
          Canvas->paint();
-         Sim::postEvent(this, new SceneLightingProcessEvent(light, object + 1), Sim::getTargetTime() + 1);
+         Sim::postEvent(this, new SceneLightingProcessEvent(light, next), Sim::getTargetTime() + ((next == object) ? 30 : 1));
       }
    }
 }   
 
+//------------------------------------------------------------------------------
+// Lighting threads
+//
+// Each lit object's lightmap only depends on its own light() call, which
+// reads the other objects (their geometry and box shadow volumes) but
+// doesn't change them.  Everything that isn't safe off the main thread
+// (the texture handles, the box shadow volume tests, the console) is done
+// in prepareLight before the threads start, or in finishLight as each
+// object comes back.
+
+struct LightJob
+{
+   U32   mCost;
+   U32   mObject;
+};
+
+static S32 QSORT_CALLBACK compareLightJobs(const void * a, const void * b)
+{
+   U32 costA = ((const LightJob *)a)->mCost;
+   U32 costB = ((const LightJob *)b)->mCost;
+   if(costA == costB)
+      return(S32(((const LightJob *)a)->mObject) - S32(((const LightJob *)b)->mObject));
+   return((costA < costB) ? 1 : -1);
+}
+
+void SceneLighting::startLightJobs(U32 light)
+{
+   AssertFatal(!mNumThreads, "SceneLighting::startLightJobs: threads still running");
+
+   mJobs.clear();
+   mFinishedJobs.clear();
+   mNextJob = 0;
+   mNumFinished = 0;
+   mJobLight = light;
+   mAbortJobs = false;
+
+   Vector<LightJob> jobs;
+   for(U32 i = 0; i < mLitObjects.size(); i++)
+   {
+      ObjectProxy * proxy = mLitObjects[i];
+      if(!proxy->getObject() || proxy->mResumed)
+         continue;
+
+      proxy->prepareLight(mLights[light]);
+
+      jobs.increment();
+      jobs.last().mCost = proxy->getLightCost();
+      jobs.last().mObject = i;
+   }
+
+   // most expensive first, so no thread is left with a big one at the end
+   dQsort(jobs.address(), jobs.size(), sizeof(LightJob), compareLightJobs);
+   for(U32 j = 0; j < jobs.size(); j++)
+      mJobs.push_back(jobs[j].mObject);
+
+   U32 count = getMin(mThreadCount, U32(mJobs.size()));
+   for(U32 t = 0; t < count; t++)
+      mThreads[mNumThreads++] = new SceneLightingThread(this, t);
+}
+
+bool SceneLighting::finishLightJobs(U32 light)
+{
+   Vector<U32> finished;
+   Mutex::lockMutex(mJobMutex);
+   finished = mFinishedJobs;
+   mFinishedJobs.clear();
+   Mutex::unlockMutex(mJobMutex);
+
+   for(U32 i = 0; i < finished.size(); i++)
+      finishObject(light, mLitObjects[finished[i]]);
+   mNumFinished += finished.size();
+
+   if(mJobs.size())
+      gLightingProgress = (F32(light) + (F32(mNumFinished) / F32(mJobs.size()))) / F32(mLights.size());
+
+   if(mNumFinished < mJobs.size())
+      return(false);
+
+   stopLightJobs();
+   return(true);
+}
+
+void SceneLighting::stopLightJobs()
+{
+   mAbortJobs = true;
+   for(U32 i = 0; i < mNumThreads; i++)
+   {
+      mThreads[i]->join();
+      delete mThreads[i];
+   }
+   mNumThreads = 0;
+}
+
+void SceneLighting::runLightJobs()
+{
+   LightInfo * light = mLights[mJobLight];
+   while(!mAbortJobs && !gTerminateLighting)
+   {
+      Mutex::lockMutex(mJobMutex);
+      S32 job = (mNextJob < mJobs.size()) ? S32(mJobs[mNextJob++]) : -1;
+      Mutex::unlockMutex(mJobMutex);
+
+      if(job == -1)
+         return;
+
+      mLitObjects[job]->light(light);
+
+      Mutex::lockMutex(mJobMutex);
+      mFinishedJobs.push_back(job);
+      Mutex::unlockMutex(mJobMutex);
+   }
+}
+
+void SceneLighting::finishObject(U32 light, ObjectProxy * proxy)
+{
+   proxy->finishLight();
+
+   // done for good?
+   if(S32(light) == mLastVectorLight)
+      writeJournal(proxy);
+}
+
+//------------------------------------------------------------------------------
+// Resume journal
+//
+// Version, mission chunk and light count, then one chunk per object that
+// has been through its last light.  A chunk cut short by the interruption
+// ends the journal.
+
+U32 SceneLighting::loadJournal()
+{
+   ResourceObject * match = ResourceManager->find(mJournalName);
+   if(!match || !(match->flags & ResourceObject::File))
+      return(0);
+
+   // get out of vfs...
+   char fileName[1024];
+   dSprintf(fileName, sizeof(fileName), "%s/%s", match->filePath, match->fileName);
+
+   FileStream stream;
+   if(!stream.open(fileName, FileStream::Read))
+      return(0);
+
+   U32 version;
+   U32 numLights;
+   SceneLighting::PersistInfo::MissionChunk missionChunk;
+   if(!stream.read(&version) || version != PersistInfo::smFileVersion ||
+      !missionChunk.read(stream) || !verifyMissionInfo(&missionChunk) ||
+      !stream.read(&numLights) || numLights != mLights.size())
+      return(0);
+
+   U32 resumed = 0;
+   U32 chunkType;
+   while(stream.read(&chunkType))
+   {
+      SceneLighting::PersistInfo::PersistChunk * chunk;
+      if(chunkType == PersistInfo::PersistChunk::InteriorChunkType)
+         chunk = new SceneLighting::PersistInfo::InteriorChunk;
+      else if(chunkType == PersistInfo::PersistChunk::TerrainChunkType)
+         chunk = new SceneLighting::PersistInfo::TerrainChunk;
+      else
+         break;
+
+      if(!chunk->read(stream))
+      {
+         delete chunk;
+         break;
+      }
+
+      for(U32 i = 0; i < mSceneObjects.size(); i++)
+      {
+         ObjectProxy * proxy = mSceneObjects[i];
+         if(proxy->mResumed || !proxy->isValidChunk(chunk))
+            continue;
+         if(isInterior(proxy->mObj) != (chunkType == PersistInfo::PersistChunk::InteriorChunkType))
+            continue;
+
+         if(proxy->setPersistInfo(chunk))
+         {
+            proxy->mResumed = true;
+            resumed++;
+         }
+         break;
+      }
+      delete chunk;
+   }
+
+   return(resumed);
+}
+
+void SceneLighting::openJournal()
+{
+   closeJournal(false);
+
+   // always written from scratch, an interrupted chunk can't be appended to
+   mJournal = new FileStream;
+   SceneLighting::PersistInfo::MissionChunk missionChunk;
+   if(!ResourceManager->openFileForWrite(*mJournal, ResourceManager->getModPathOf(mJournalName), mJournalName) ||
+      !getMissionInfo(&missionChunk) ||
+      !mJournal->write(PersistInfo::smFileVersion) ||
+      !missionChunk.write(*mJournal) ||
+      !mJournal->write(U32(mLights.size())))
+   {
+      Con::warnf("SceneLighting:: unable to write lighting journal '%s'", mJournalName);
+      delete mJournal;
+      mJournal = 0;
+      return;
+   }
+
+   // the objects picked up from the old one
+   for(U32 i = 0; i < mSceneObjects.size(); i++)
+      if(mSceneObjects[i]->mResumed)
+         writeJournal(mSceneObjects[i]);
+   mJournal->flush();
+}
+
+void SceneLighting::writeJournal(ObjectProxy * proxy)
+{
+   if(!mJournal || !proxy->getObject())
+      return;
+
+   SceneLighting::PersistInfo::PersistChunk * chunk;
+   if(isInterior(proxy->mObj))
+      chunk = new SceneLighting::PersistInfo::InteriorChunk;
+   else if(isTerrain(proxy->mObj))
+      chunk = new SceneLighting::PersistInfo::TerrainChunk;
+   else
+      return;
+
+   if(proxy->getPersistInfo(chunk))
+   {
+      mJournal->write(chunk->mChunkType);
+      chunk->write(*mJournal);
+      mJournal->flush();
+   }
+   delete chunk;
+}
+
+void SceneLighting::closeJournal(bool remove)
+{
+   if(!mJournal)
+      return;
+
+   mJournal->close();
+   delete mJournal;
+   mJournal = 0;
+
+   if(remove)
+   {
+      ResourceObject * match = ResourceManager->find(mJournalName);
+      if(match && (match->flags & ResourceObject::File))
+      {
+         char fileName[1024];
+         dSprintf(fileName, sizeof(fileName), "%s/%s", match->filePath, match->fileName);
+         ResourceManager->purge(match);
+         dFileDelete(fileName);
+      }
+   }
+}
+
 //------------------------------------------------------------------------------
 
 struct CacheEntry {
@@ -1564,6 +1938,30 @@ bool SceneLighting::InteriorProxy::isShadowedBy(InteriorProxy * test)
    return(false);
 }
 
+void SceneLighting::InteriorProxy::prepareLight(LightInfo *)
+{
+   InteriorInstance * interior = getObject();
+   if(!interior)
+      return;
+
+   // the box shadow volume tests recycle polys in both volumes
+   mShadowedBy.setSize(gLighting->mLitObjects.size());
+   for(U32 i = 0; i < gLighting->mLitObjects.size(); i++)
+   {
+      ObjectProxy * proxy = gLighting->mLitObjects[i];
+      mShadowedBy[i] = proxy != this && proxy->getObject() && gLighting->isInterior(proxy->mObj) &&
+                       isShadowedBy(static_cast<InteriorProxy*>(proxy));
+   }
+
+   // fresh copies of the lightmaps light() is going to fill
+   for(U32 j = 0; j < interior->getResource()->getNumDetailLevels(); j++)
+   {
+      Interior * detail = interior->getResource()->getDetailLevel(j);
+      gInteriorLMManager.clearLightmaps(detail->getLMHandle(), interior->getLMHandle());
+      gLighting->duplicateLightmaps(*this, j);
+   }
+}
+
 void SceneLighting::InteriorProxy::light(LightInfo * light)
 {
    InteriorInstance * interior = getObject();
@@ -1586,7 +1984,7 @@ void SceneLighting::InteriorProxy::light(LightInfo * light)
          if(*itr == this)
             continue;
 
-         if(isShadowedBy(static_cast<InteriorProxy*>(*itr)))
+         if(mShadowedBy[U32(itr - gLighting->mLitObjects.begin())])
             gLighting->addInterior(&shadowVolume, *static_cast<InteriorProxy*>(*itr), light, SceneLighting::SHADOW_DETAIL);
       }
 
@@ -1655,9 +2053,8 @@ void SceneLighting::InteriorProxy::light(LightInfo * light)
    // light all details
    for(U32 i = 0; i < interior->getResource()->getNumDetailLevels(); i++)
    {
-      // clear lightmaps
+      // lightmaps were cleared in prepareLight
       Interior * detail = interior->getResource()->getDetailLevel(i);
-      gInteriorLMManager.clearLightmaps(detail->getLMHandle(), interior->getLMHandle());
 
       // clear out the last inserted interior
       shadowVolume.removeLastInterior();
@@ -1944,19 +2341,35 @@ void SceneLighting::InteriorProxy::light(LightInfo * light)
       }
    }
 
-   Con::printf("    = interior lit in %3.3f seconds", (Platform::getRealMilliseconds()-time)/1000.f);
+   mLightTime = Platform::getRealMilliseconds() - time;
 }
 
-void SceneLighting::InteriorProxy::postLight()
+void SceneLighting::InteriorProxy::finishLight()
 {
-   delete mBoxShadowBSP;
-   mBoxShadowBSP = 0;
-
    InteriorInstance * interior = getObject();
    if(!interior)
       return;
 
    interior->rebuildVertexColors();
+   Con::printf("    = interior lit in %3.3f seconds", mLightTime/1000.f);
+}
+
+U32 SceneLighting::InteriorProxy::getLightCost()
+{
+   InteriorInstance * interior = getObject();
+   if(!interior)
+      return(0);
+
+   U32 cost = 0;
+   for(U32 i = 0; i < interior->getResource()->getNumDetailLevels(); i++)
+      cost += interior->getResource()->getDetailLevel(i)->getSurfaceCount();
+   return(cost);
+}
+
+void SceneLighting::InteriorProxy::postLight()
+{
+   delete mBoxShadowBSP;
+   mBoxShadowBSP = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -2183,6 +2596,8 @@ SceneLighting::TerrainProxy::TerrainProxy(SceneObject * obj) :
    Parent(obj)
 {
    mLightmap = 0;
+   mGenerateLevel = 0;
+   mAllowLexelSplits = false;
 }
 
 SceneLighting::TerrainProxy::~TerrainProxy()
@@ -2210,6 +2625,12 @@ bool SceneLighting::TerrainProxy::preLight(LightInfo * light)
    return(true);
 }
 
+void SceneLighting::TerrainProxy::prepareLight(LightInfo *)
+{
+   mGenerateLevel = Con::getIntVariable("$pref::sceneLighting::terrainGenerateLevel", 0);
+   mAllowLexelSplits = Con::getBoolVariable("$pref::sceneLighting::terrainAllowLexelSplits", false);
+}
+
 void SceneLighting::TerrainProxy::light(LightInfo * light)
 {
    TerrainBlock * terrain = getObject();
@@ -2235,6 +2656,17 @@ void SceneLighting::TerrainProxy::light(LightInfo * light)
 
    lightVector(light);
 
+   delete mShadowVolume;
+
+   mLightTime = Platform::getRealMilliseconds() - time;
+}
+
+void SceneLighting::TerrainProxy::finishLight()
+{
+   TerrainBlock * terrain = getObject();
+   if(!terrain)
+      return;
+
    // set the lightmap...
    U16 * lPtr = (U16*)terrain->lightMap->getAddress(0,0);
    for(U32 i = 0; i < (TerrainBlock::LightmapSize * TerrainBlock::LightmapSize); i++)
@@ -2242,9 +2674,12 @@ void SceneLighting::TerrainProxy::light(LightInfo * light)
  
    terrain->buildMaterialMap();
 
-   delete mShadowVolume;
+   Con::printf("    = terrain lit in %3.3f seconds", mLightTime/1000.f);
+}
 
-   Con::printf("    = terrain lit in %3.3f seconds", (Platform::getRealMilliseconds()-time)/1000.f);
+U32 SceneLighting::TerrainProxy::getLightCost()
+{
+   return(TerrainBlock::BlockSize * TerrainBlock::BlockSize);
 }
 
 //------------------------------------------------------------------------------
@@ -2415,10 +2850,9 @@ void SceneLighting::TerrainProxy::lightVector(LightInfo * light)
    if(lightDir.x == 0 && lightDir.y == 0)
       return;
    
-   S32 generateLevel = Con::getIntVariable("$pref::sceneLighting::terrainGenerateLevel", 0);
-   generateLevel = mClamp(generateLevel, 0, 4);
+   S32 generateLevel = mClamp(mGenerateLevel, 0, 4);
 
-   bool allowLexelSplits = Con::getBoolVariable("$pref::sceneLighting::terrainAllowLexelSplits", false);
+   bool allowLexelSplits = mAllowLexelSplits;
 
    U32 generateDim = TerrainBlock::LightmapSize << generateLevel;
    U32 generateShift = TerrainBlock::LightmapShift + generateLevel;
@@ -24,6 +24,9 @@
 #include "sceneGraph/shadowVolumeBSP.h"
 #endif
 
+class FileStream;
+class SceneLightingThread;
+
 //------------------------------------------------------------------------------
 class SceneLighting : public SimObject
 {
@@ -114,6 +117,7 @@ class SceneLighting : public SimObject
       };
 
       void addInterior(ShadowVolumeBSP *, InteriorProxy &, LightInfo *, S32);
+      void duplicateLightmaps(InteriorProxy &, S32);
       ShadowVolumeBSP::SVPoly * buildInteriorPoly(ShadowVolumeBSP *, InteriorProxy &, Interior *, U32, LightInfo *, bool);
 
       //------------------------------------------------------------------------------
@@ -123,8 +127,10 @@ class SceneLighting : public SimObject
          public:
          SimObjectPtr<SceneObject>     mObj;
          U32                           mChunkCRC;
+         bool                          mResumed;      // restored from the journal, not lit again
+         S32                           mLightTime;
 
-         ObjectProxy(SceneObject * obj) : mObj(obj){mChunkCRC = 0;}
+         ObjectProxy(SceneObject * obj) : mObj(obj){mChunkCRC = 0; mResumed = false; mLightTime = 0;}
          virtual ~ObjectProxy(){}
          SceneObject * operator->() {return(mObj);}
          SceneObject * getObject() {return(mObj);}
@@ -133,9 +139,16 @@ class SceneLighting : public SimObject
          virtual bool loadResources() {return(true);}
          virtual void init() {}
          virtual bool preLight(LightInfo *) {return(false);}
-         virtual void light(LightInfo *) {}
          virtual void postLight() {}
 
+         // once every object has had preLight: prepareLight and finishLight
+         // run on the main thread, light may run on a lighting thread and
+         // only reads the other objects
+         virtual void prepareLight(LightInfo *) {}
+         virtual void light(LightInfo *) {}
+         virtual void finishLight() {}
+         virtual U32 getLightCost() {return(0);}
+
          // persistance
          bool calcValidation();
          bool isValidChunk(PersistInfo::PersistChunk *);
@@ -163,12 +176,16 @@ class SceneLighting : public SimObject
             Vector<ShadowVolumeBSP::SVPoly*>    mLitBoxSurfaces;
             Vector<PlaneF>                      mOppositeBoxPlanes;
             Vector<PlaneF>                      mTerrainTestPlanes;
+            Vector<U8>                          mShadowedBy;      // by each of the lit objects
 
             // lighting interface
             bool loadResources();
             bool preLight(LightInfo *);
-            void light(LightInfo *);
             void postLight();
+            void prepareLight(LightInfo *);
+            void light(LightInfo *);
+            void finishLight();
+            U32 getLightCost();
 
             // persist
             U32 getResourceCRC();
@@ -184,6 +201,8 @@ class SceneLighting : public SimObject
             BitVector               mShadowMask;
             ShadowVolumeBSP *       mShadowVolume;
             ColorF *                mLightmap;
+            S32                     mGenerateLevel;
+            bool                    mAllowLexelSplits;
 
             void lightVector(LightInfo *);
 
@@ -209,7 +228,10 @@ class SceneLighting : public SimObject
             // lighting
             void init();
             bool preLight(LightInfo *);
+            void prepareLight(LightInfo *);
             void light(LightInfo *);
+            void finishLight();
+            U32 getLightCost();
 
             // persist
             U32 getResourceCRC();
@@ -244,6 +266,41 @@ class SceneLighting : public SimObject
       void processEvent(U32 light, S32 object);
       void processCache();
 
+      // lighting threads: the lit objects of a light are handed out as
+      // jobs, the events only wait for them and finish them off
+      enum {
+         MaxThreads = 16
+      };
+
+      SceneLightingThread *      mThreads[MaxThreads];
+      U32                        mNumThreads;
+      U32                        mThreadCount;        // $pref::sceneLighting::threads
+      void *                     mJobMutex;
+      Vector<U32>                mJobs;               // into mLitObjects, most expensive first
+      U32                        mNextJob;
+      Vector<U32>                mFinishedJobs;       // guarded by mJobMutex
+      U32                        mNumFinished;
+      U32                        mJobLight;
+      volatile bool              mAbortJobs;
+
+      void startLightJobs(U32 light);
+      bool finishLightJobs(U32 light);
+      void stopLightJobs();
+      void runLightJobs();
+      void finishObject(U32 light, ObjectProxy *);
+
+      // resume journal: the chunks of the objects done with their last
+      // light, appended as they finish, so an interrupted light can pick
+      // up where it left off
+      S32                        mLastVectorLight;
+      char                       mJournalName[1024];
+      FileStream *               mJournal;
+
+      U32 loadJournal();
+      void openJournal();
+      void writeJournal(ObjectProxy *);
+      void closeJournal(bool remove);
+
       // inlined
       bool isTerrain(SceneObject *);
       bool isInterior(SceneObject *);
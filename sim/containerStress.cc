@@ -0,0 +1,190 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "sim/sceneObject.h"
+#include "platform/platformThread.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "game/objectTypes.h"
+
+extern Container gServerContainer;
+
+//----------------------------------------------------------------------------
+// Concurrent container query stress test.  Casts the same set of rays once
+// on the main context and then split up over worker threads, each with its
+// own query context, and checks that every thread got the main thread's
+// answer.  The scene must not change while it runs, so this is only meant
+// to be run from the console.
+
+namespace {
+
+enum {
+   MaxStressThreads = ContainerQueryContext::MaxContexts - 1,
+};
+
+struct StressRay
+{
+   Point3F start;
+   Point3F end;
+   bool hit;
+   F32 t;
+   SceneObject *object;
+};
+
+Vector<Point3F> sStressPoints;
+
+void collectStressPoint(SceneObject *obj, S32)
+{
+   // skip the terrain and anything else that covers the whole mission
+   const Box3F &box = obj->getWorldBox();
+   if(box.len_x() < 10000 && box.len_y() < 10000)
+      sStressPoints.push_back((box.min + box.max) * 0.5);
+}
+
+void castStressRays(StressRay *rays, U32 count, U32 mask, ContainerQueryContext *context)
+{
+   for(U32 i = 0; i < count; i++)
+   {
+      RayInfo info;
+      rays[i].hit = gServerContainer.castRay(rays[i].start, rays[i].end, mask, &info, context);
+      rays[i].t = rays[i].hit ? info.t : 1;
+      rays[i].object = rays[i].hit ? info.object : NULL;
+   }
+}
+
+class ContainerStressThread : public Thread
+{
+   StressRay *mRays;
+   U32 mCount;
+   U32 mMask;
+   ContainerQueryContext *mContext;
+
+  public:
+   U32 mTime;
+
+   ContainerStressThread(StressRay *rays, U32 count, U32 mask, ContainerQueryContext *context)
+      : Thread(0, 0, false)
+   {
+      mRays = rays;
+      mCount = count;
+      mMask = mask;
+      mContext = context;
+      mTime = 0;
+      start();
+   }
+
+   void run(S32)
+   {
+      U32 startTime = Platform::getRealMilliseconds();
+      castStressRays(mRays, mCount, mMask, mContext);
+      mTime = Platform::getRealMilliseconds() - startTime;
+   }
+};
+
+} // namespace {}
+
+ConsoleFunction(containerRayStress, void, 1, 4, "containerRayStress(<numRays>, <numThreads>, <mask>);")
+{
+   U32 numRays = argc > 1 ? dAtoi(argv[1]) : 10000;
+   U32 numThreads = argc > 2 ? dAtoi(argv[2]) : 4;
+   U32 mask = argc > 3 ? dAtoi(argv[3]) : U32(TerrainObjectType | InteriorObjectType | StaticShapeObjectType |
+                                               PlayerObjectType | VehicleObjectType | ItemObjectType);
+   numThreads = mClamp(numThreads, 1, MaxStressThreads);
+   if(!numRays)
+      return;
+
+   // rays run between (and straight down onto) the objects in the mission
+   sStressPoints.clear();
+   Box3F everything(Point3F(-1e9, -1e9, -1e9), Point3F(1e9, 1e9, 1e9));
+   gServerContainer.findObjects(everything, 0xFFFFFFFF, collectStressPoint);
+   if(sStressPoints.size() < 2)
+   {
+      Con::errorf(ConsoleLogEntry::General, "containerRayStress: need a mission with some objects in it.");
+      return;
+   }
+
+   MRandomLCG random(1376312589);
+   Vector<StressRay> baseline;
+   baseline.setSize(numRays);
+   for(U32 i = 0; i < numRays; i++)
+   {
+      StressRay &ray = baseline[i];
+      const Point3F &a = sStressPoints[random.randI(0, sStressPoints.size() - 1)];
+      if(i & 1)
+      {
+         const Point3F &b = sStressPoints[random.randI(0, sStressPoints.size() - 1)];
+         ray.start = a + Point3F(random.randF(-10, 10), random.randF(-10, 10), random.randF(0, 20));
+         ray.end = b + Point3F(random.randF(-10, 10), random.randF(-10, 10), random.randF(0, 20));
+      }
+      else
+      {
+         ray.start = a + Point3F(random.randF(-100, 100), random.randF(-100, 100), 500);
+         ray.end = ray.start - Point3F(0, 0, 2000);
+      }
+   }
+   sStressPoints.clear();
+
+   // single threaded, on the main context...
+   U32 startTime = Platform::getRealMilliseconds();
+   castStressRays(baseline.address(), numRays, mask, NULL);
+   U32 baselineTime = Platform::getRealMilliseconds() - startTime;
+
+   // ...then the same rays split over the workers
+   Vector<StressRay> results = baseline;
+   ContainerQueryContext *contexts[MaxStressThreads];
+   ContainerStressThread *threads[MaxStressThreads];
+   U32 perThread = (numRays + numThreads - 1) / numThreads;
+   U32 i;
+   for(i = 0; i < numThreads; i++)
+      if((contexts[i] = ContainerQueryContext::create()) == NULL)
+         break;
+   if(i < numThreads)
+   {
+      Con::printf("containerRayStress: only %d query contexts free.", i);
+      numThreads = i;
+      if(!numThreads)
+         return;
+      perThread = (numRays + numThreads - 1) / numThreads;
+   }
+
+   startTime = Platform::getRealMilliseconds();
+   for(i = 0; i < numThreads; i++)
+   {
+      U32 first = getMin(i * perThread, numRays);
+      U32 count = getMin(perThread, numRays - first);
+      threads[i] = new ContainerStressThread(results.address() + first, count, mask, contexts[i]);
+   }
+   for(i = 0; i < numThreads; i++)
+      threads[i]->join();
+   U32 threadedTime = Platform::getRealMilliseconds() - startTime;
+
+   U32 hits = 0;
+   U32 mismatches = 0;
+   for(i = 0; i < numRays; i++)
+   {
+      const StressRay &a = baseline[i];
+      const StressRay &b = results[i];
+      hits += a.hit;
+      if(a.hit != b.hit || a.object != b.object || a.t != b.t)
+      {
+         if(mismatches < 8)
+            Con::errorf(ConsoleLogEntry::General, "containerRayStress: ray %d: %d/%d %s vs %d/%d %s", i,
+                        a.hit, a.object ? a.object->getId() : 0, a.object ? a.object->getClassName() : "",
+                        b.hit, b.object ? b.object->getId() : 0, b.object ? b.object->getClassName() : "");
+         mismatches++;
+      }
+   }
+
+   Con::printf("containerRayStress: %d rays, %d hits, %d mismatches", numRays, hits, mismatches);
+   Con::printf("   1 thread: %d ms, %d threads: %d ms", baselineTime, numThreads, threadedTime);
+   for(i = 0; i < numThreads; i++)
+   {
+      Con::printf("   thread %d: %d ms", i, threads[i]->mTime);
+      delete threads[i];
+      delete contexts[i];
+   }
+}
@@ -17,6 +17,7 @@
 #include "console/consoleTypes.h"
 #include <stdarg.h>
 #include "game/badWordFilter.h"
+#include "platform/profiler.h"
 
 enum {
    PingTimeout = 4500, // milliseconds
@@ -171,11 +172,14 @@ static U32 gPacketUpdateDelayToServer = 32;
 static U32 gPacketRateToClient = 10;
 static U32 gPacketSize = 200;
 
+U32 NetConnection::smDemoKeyframeInterval = 30000;
+
 void NetConnection::consoleInit()
 {
    Con::addVariable("pref::Net::PacketRateToServer",  TypeS32, &gPacketRateToServer);
    Con::addVariable("pref::Net::PacketRateToClient",  TypeS32, &gPacketRateToClient);
    Con::addVariable("pref::Net::PacketSize",          TypeS32, &gPacketSize);
+   Con::addVariable("Demo::keyframeInterval",         TypeS32, &smDemoKeyframeInterval);
 }
 
 void NetConnection::checkMaxRate()
@@ -217,6 +221,7 @@ NetConnection::NetConnection(bool ghostFrom, bool ghostTo, bool sendEvents)
    mLogging = false;
 #endif   
    mIsNetworkConnection = false;
+   mLean = false;
    mConnectionObjectId = 0;
    mLastUpdateTime = 0;
    mRoundTripTime = 0;
@@ -291,16 +296,17 @@ NetConnection::NetConnection(bool ghostFrom, bool ghostTo, bool sendEvents)
    }
    else
       mLocalGhosts = NULL;
-      
-   U32 i;
-   for(i = 0; i < NetStringTable::MaxStrings; i++)
-      mStringXLTable[i] = 0;
-   for(i = 0; i < NetStringTable::MaxStrings >> 3; i++)
-      mStringSentBitArray[i] = 0;
+
+   mStringXLTable = NULL;
+   mStringSentBitArray = NULL;
 
    mMissionPathsSent = false;
    mDemoWriteStream = NULL;
    mDemoReadStream = NULL;
+   mDemoLastKeyframeTime = 0;
+   mDemoProcessEventId = 0;
+   mDemoWritingKeyframe = false;
+   mDemoFastPlayback = false;
    
    mPingSendCount = 0;
    mPingRetryCount = DefaultPingRetryCount;
@@ -316,8 +322,9 @@ NetConnection::~NetConnection()
    delete[] mGhostLookupTable;
    delete[] mGhostRefs;
    delete[] mGhostArray;
-   if(mDemoWriteStream)
-      delete mDemoWriteStream;
+   delete[] mStringXLTable;
+   delete[] mStringSentBitArray;
+   stopRecording();
    if(mDemoReadStream)
       ResourceManager->closeStream(mDemoReadStream);
 }
@@ -424,8 +431,26 @@ ConsoleMethod( NetConnection, setLogging, void, 3, 3, "conn.setLogging(bool)")
 
 #endif 
 
+void NetConnection::setLean()
+{
+   AssertFatal(!mGhostFrom && !mGhostTo, "NetConnection::setLean: lean connections can't ghost.");
+   AssertFatal(!mStringXLTable, "NetConnection::setLean: strings already mapped.");
+   mLean = true;
+   mSendingEvents = false;
+}
+
+void NetConnection::allocStringTables()
+{
+   mStringXLTable = new U16[NetStringTable::MaxStrings];
+   mStringSentBitArray = new U8[NetStringTable::MaxStrings >> 3];
+   dMemset(mStringXLTable, 0, sizeof(U16) * NetStringTable::MaxStrings);
+   dMemset(mStringSentBitArray, 0, NetStringTable::MaxStrings >> 3);
+}
+
 void NetConnection::mapString(U32 remoteId, U32 localId)
 {
+   if(!mStringXLTable)
+      allocStringTables();
    if(mStringXLTable[remoteId])
       gNetStringTable->removeString(mStringXLTable[remoteId]);
    mStringXLTable[remoteId] = localId;
@@ -433,13 +458,18 @@ void NetConnection::mapString(U32 remoteId, U32 localId)
 
 void NetConnection::clearString(U32 id)
 {
+   if(!mStringSentBitArray)
+      return;
    mStringSentBitArray[id >> 3] &= ~(1 << (id & 0x7));
 }
 
 void NetConnection::checkString(U32 id)
 {
-   if(!id)  
+   // nothing is ever sent over a lean connection
+   if(!id || mLean)
       return;
+   if(!mStringSentBitArray)
+      allocStringTables();
    if(!(mStringSentBitArray[id >> 3] & (1 << (id & 0x7))))
    {
       mStringSentBitArray[id >> 3] |= (1 << (id & 0x7));
@@ -478,7 +508,7 @@ void NetConnection::onRemove()
    
    if(mGhostFrom)
       clearGhostInfo();   
-   for(U32 i = 0; i < NetStringTable::MaxStrings; i++)
+   for(U32 i = 0; mStringXLTable && i < NetStringTable::MaxStrings; i++)
       if(mStringXLTable[i])
          gNetStringTable->removeString(mStringXLTable[i]);
    
@@ -550,7 +580,14 @@ void NetConnection::handleNotify(bool recvd)
 void NetConnection::processRawPacket(BitStream *bstream)
 {
    if(mDemoWriteStream)
-      recordBlock(Sim::getCurrentTime(), BlockTypePacket, bstream->getReadByteSize(), bstream->getBuffer());
+   {
+      // snapshot before the packet is processed so playback can
+      // resume from the keyframe by handling this same packet
+      U32 time = Sim::getCurrentTime();
+      if(smDemoKeyframeInterval && time >= mDemoLastKeyframeTime + smDemoKeyframeInterval)
+         writeDemoKeyframe(time);
+      recordBlock(time, BlockTypePacket, bstream->getReadByteSize(), bstream->getBuffer());
+   }
    ConnectionProtocol::processRawPacket(bstream);
 }
 
@@ -714,7 +751,9 @@ void NetConnection::readPacket(BitStream *bstream)
 void NetConnection::writePacket(BitStream *bstream, PacketNotify *note)
 {
    eventWritePacket(bstream, note);
+   PROFILE_START(GhostWritePacket);
    ghostWritePacket(bstream, note);
+   PROFILE_END();
 }
 
 void NetConnection::packetReceived(PacketNotify *note)
@@ -742,6 +781,8 @@ void NetConnection::writeDemoStartBlock(ResizeBitStream* stream)
    // Write all the current paths to the stream...
    gClientPathManager->dumpState(stream);
    stream->validate();
+   if(!mStringXLTable)
+      allocStringTables();
    U32 start = 0;
    for(U32 i = 0; i < NetStringTable::MaxStrings;)
    {
@@ -809,6 +850,41 @@ void NetConnection::readDemoStartBlock(BitStream* stream)
    ghostReadStartBlock(stream);
 }
 
+void NetConnection::writeDemoSnapshot(ResizeBitStream *stream)
+{
+   // first write out all the strings we have from the server:
+   for(U32 i = 0; mStringXLTable && i < NetStringTable::MaxStrings; i++)
+   {
+      U32 strId = mStringXLTable[i];
+      if(strId)
+      {
+         stream->writeFlag(true);
+         stream->writeInt(i, NetStringTable::StringIdBitSize);
+         stream->writeString(gNetStringTable->lookupString(strId));
+         stream->validate();
+      }
+   }
+   stream->writeFlag(false);
+
+   // then write out the start block
+   writeDemoStartBlock(stream);
+}
+
+void NetConnection::readDemoSnapshot(BitStream *stream)
+{
+   while(stream->readFlag())
+   {
+      U32 id = stream->readInt(NetStringTable::StringIdBitSize);
+      char buf[256];
+      stream->readString(buf);
+      U32 localId;
+      localId = gNetStringTable->addString(buf);
+      mapString(id, localId);
+   }
+
+   readDemoStartBlock(stream);
+}
+
 bool NetConnection::startDemoRecord(const char *fileName)
 {
    FileStream *fs = new FileStream;
@@ -821,32 +897,105 @@ bool NetConnection::startDemoRecord(const char *fileName)
    
    mDemoWriteStream = fs;
    mDemoWriteStream->write(mProtocolVersion);
-   ResizeBitStream bs;
-   // first write out all the strings we have from the server:
-   for(U32 i = 0; i < NetStringTable::MaxStrings; i++)
-   {
-      U32 strId = mStringXLTable[i];
-      if(strId)
-      {
-         bs.writeFlag(true);
-         bs.writeInt(i, NetStringTable::StringIdBitSize);
-         bs.writeString(gNetStringTable->lookupString(strId));
-         bs.validate();
-      }
-   }
-   bs.writeFlag(false);
 
-   // then write out the start block
-   writeDemoStartBlock(&bs);
+   // the start block doubles as the keyframe for time zero
+   DemoKeyframe key;
+   key.time = 0;
+   key.position = mDemoWriteStream->getPosition();
+   mDemoKeyframes.clear();
+   mDemoKeyframes.push_back(key);
+
+   ResizeBitStream bs;
+   writeDemoSnapshot(&bs);
    U32 size = bs.getPosition() + 1;
    mDemoWriteStream->write(size);
    mDemoWriteStream->write(size, bs.getBuffer());
    mDemoWriteStartTime = Sim::getCurrentTime() + 
       getDemoTickSize() - (Sim::getCurrentTime() % getDemoTickSize());
    mDemoLastWriteTime = mDemoWriteStartTime;
+   mDemoLastKeyframeTime = mDemoWriteStartTime;
    return true;
 }
 
+void NetConnection::writeDemoKeyframe(U32 time)
+{
+   if(time < mDemoWriteStartTime)
+      time = mDemoWriteStartTime;
+
+   ResizeBitStream bs;
+   mDemoWritingKeyframe = true;
+   writeDemoSnapshot(&bs);
+   mDemoWritingKeyframe = false;
+
+   // the block header is time, type and size - the keyframe position
+   // points at the size so it reads back just like the start block.
+   DemoKeyframe key;
+   key.time = time - mDemoWriteStartTime;
+   key.position = mDemoWriteStream->getPosition() + 2 * sizeof(U32);
+   mDemoKeyframes.push_back(key);
+
+   recordBlock(time, BlockTypeKeyframe, bs.getPosition() + 1, bs.getBuffer());
+   mDemoLastKeyframeTime = time;
+}
+
+void NetConnection::writeDemoIndex()
+{
+   // The index is an ordinary block so a linear reader stops on it,
+   // followed by a fixed size footer giving its offset.
+   U32 indexPosition = mDemoWriteStream->getPosition();
+   mDemoWriteStream->write(mDemoLastWriteTime - mDemoWriteStartTime);
+   mDemoWriteStream->write(U32(BlockTypeIndex));
+   mDemoWriteStream->write(U32(sizeof(U32) + mDemoKeyframes.size() * 2 * sizeof(U32)));
+   mDemoWriteStream->write(U32(mDemoKeyframes.size()));
+   for(U32 i = 0; i < mDemoKeyframes.size(); i++)
+   {
+      mDemoWriteStream->write(mDemoKeyframes[i].time);
+      mDemoWriteStream->write(mDemoKeyframes[i].position);
+   }
+   mDemoWriteStream->write(indexPosition);
+   mDemoWriteStream->write(U32(DemoIndexMagic));
+   mDemoKeyframes.clear();
+}
+
+void NetConnection::readDemoIndex()
+{
+   mDemoKeyframes.clear();
+   if(!mDemoReadStream->hasCapability(Stream::StreamPosition))
+      return;
+
+   U32 start = mDemoReadStream->getPosition();
+   U32 streamSize = mDemoReadStream->getStreamSize();
+   if(streamSize < start + 2 * sizeof(U32))
+      return;
+
+   U32 indexPosition, magic;
+   mDemoReadStream->setPosition(streamSize - 2 * sizeof(U32));
+   mDemoReadStream->read(&indexPosition);
+   mDemoReadStream->read(&magic);
+   if(magic == DemoIndexMagic && indexPosition >= start && indexPosition < streamSize)
+   {
+      U32 time, type, size, count;
+      mDemoReadStream->setPosition(indexPosition);
+      mDemoReadStream->read(&time);
+      mDemoReadStream->read(&type);
+      mDemoReadStream->read(&size);
+      mDemoReadStream->read(&count);
+      if(type == BlockTypeIndex && size == sizeof(U32) + count * 2 * sizeof(U32))
+      {
+         mDemoKeyframes.setSize(count);
+         for(U32 i = 0; i < count; i++)
+         {
+            mDemoReadStream->read(&mDemoKeyframes[i].time);
+            mDemoReadStream->read(&mDemoKeyframes[i].position);
+         }
+      }
+      if(mDemoReadStream->getStatus() != Stream::Ok)
+         mDemoKeyframes.clear();
+   }
+   // an old recording with no index is still playable, just not seekable
+   mDemoReadStream->setPosition(start);
+}
+
 class DemoProcessEvent : public SimEvent
 {
 public:
@@ -865,31 +1014,22 @@ public:
       }
 };
 
-bool NetConnection::replayDemoRecord(const char *fileName)
+bool NetConnection::replayDemoRecord(const char *fileName, bool fast)
 {
    Stream *fs = ResourceManager->openStream(fileName);
    if(!fs)
       return false;
       
    mDemoReadStream = fs;
+   mDemoFastPlayback = fast;
    mDemoReadStream->read(&mProtocolVersion);
+   readDemoIndex();
    U32 size;
    mDemoReadStream->read(&size);
    U8 *block = new U8[size];
    mDemoReadStream->read(size, block);
    BitStream bs(block, size);
-
-   while(bs.readFlag())
-   {
-      U32 id = bs.readInt(NetStringTable::StringIdBitSize);
-      char buf[256];
-      bs.readString(buf);
-      U32 localId;
-      localId = gNetStringTable->addString(buf);
-      mapString(id, localId);
-   }
-
-   readDemoStartBlock(&bs);
+   readDemoSnapshot(&bs);
    delete[] block;
    if(mDemoReadStream->getStatus() != Stream::Ok)
       return false;
@@ -913,7 +1053,12 @@ void NetConnection::startDemoRead()
    mDemoReadStartTime = Sim::getTargetTime();
    mDemoReadStartTime += getDemoTickSize() - (mDemoReadStartTime % getDemoTickSize());
    
-   Sim::postEvent(this, new DemoProcessEvent, mDemoReadStartTime + time);
+   postNextDemoBlock(time);
+}
+
+void NetConnection::postNextDemoBlock(U32 time)
+{
+   mDemoProcessEventId = Sim::postEvent(this, new DemoProcessEvent, time + mDemoReadStartTime);
 }
 
 U32 NetConnection::getDemoTickSize()
@@ -925,6 +1070,7 @@ void NetConnection::stopRecording()
 {
    if(mDemoWriteStream)
    {
+      writeDemoIndex();
       delete mDemoWriteStream;
       mDemoWriteStream = NULL;
    }
@@ -972,8 +1118,37 @@ void NetConnection::readNextDemoBlock()
    U32 size;
    mDemoReadStream->read(&type);
    mDemoReadStream->read(&size);
-   mDemoReadStream->read(size, buffer);
-   handleRecordedBlock(type, size, buffer);
+   if(type == BlockTypeIndex)
+   {
+      // the index trailer marks the end of the recorded blocks
+      demoPlaybackComplete();
+      deleteObject();
+      return;
+   }
+   if(type != BlockTypeKeyframe && size > MaxPacketDataSize)
+   {
+      // a corrupt or foreign demo, nothing after this can be trusted
+      Con::warnf("NetConnection::readNextDemoBlock: block of type %d is %d bytes (max %d), stopping playback.",
+                 type, size, MaxPacketDataSize);
+      demoPlaybackComplete();
+      deleteObject();
+      return;
+   }
+   if(type == BlockTypeKeyframe)
+   {
+      // keyframes are only read when seeking
+      while(size)
+      {
+         U32 len = getMin(size, U32(MaxPacketDataSize));
+         mDemoReadStream->read(len, buffer);
+         size -= len;
+      }
+   }
+   else
+   {
+      mDemoReadStream->read(size, buffer);
+      handleRecordedBlock(type, size, buffer);
+   }
    U32 time;
    mDemoReadStream->read(&time);
    if(mDemoReadStream->getStatus() != Stream::Ok)
@@ -982,7 +1157,107 @@ void NetConnection::readNextDemoBlock()
       deleteObject();
    }
    else   
-      Sim::postEvent(this, new DemoProcessEvent, time + mDemoReadStartTime);
+      postNextDemoBlock(time);
+}
+
+void NetConnection::resetDemoPlaybackState()
+{
+   // nothing recorded on playback is ever sent, so just let go of
+   // whatever the client queued up
+   while(mNotifyQueueHead)
+   {
+      PacketNotify *note = mNotifyQueueHead;
+      mNotifyQueueHead = note->nextPacket;
+      packetReceived(note);
+      delete note;
+   }
+   mNotifyQueueTail = NULL;
+
+   while(mWaitSeqEvents)
+   {
+      NetEvent *next = mWaitSeqEvents->mNextEvent;
+      delete mWaitSeqEvents;
+      mWaitSeqEvents = next;
+   }
+
+   if(mLocalGhosts)
+   {
+      for(S32 i = 0; i < MaxGhostCount; i++)
+      {
+         if(mLocalGhosts[i])
+         {
+            mLocalGhosts[i]->deleteObject();
+            mLocalGhosts[i] = NULL;
+         }
+      }
+   }
+
+   for(U32 i = 0; mStringXLTable && i < NetStringTable::MaxStrings; i++)
+   {
+      if(mStringXLTable[i])
+      {
+         gNetStringTable->removeString(mStringXLTable[i]);
+         mStringXLTable[i] = 0;
+      }
+   }
+}
+
+bool NetConnection::seekDemo(U32 time)
+{
+   if(!mDemoReadStream || !mDemoKeyframes.size())
+      return false;
+
+   // find the last keyframe at or before the requested time
+   S32 i;
+   for(i = mDemoKeyframes.size() - 1; i > 0; i--)
+      if(mDemoKeyframes[i].time <= time)
+         break;
+   const DemoKeyframe &key = mDemoKeyframes[i];
+
+   Sim::cancelEvent(mDemoProcessEventId);
+   resetDemoPlaybackState();
+
+   // the index comes from the file, so a keyframe that doesn't fit in what's
+   // left of the recording is as broken as a failed read
+   U32 streamSize = mDemoReadStream->getStreamSize();
+   U32 size = 0;
+   bool ok = key.position < streamSize && mDemoReadStream->setPosition(key.position);
+   if(ok)
+   {
+      mDemoReadStream->read(&size);
+      ok = mDemoReadStream->getStatus() == Stream::Ok &&
+           size <= streamSize - mDemoReadStream->getPosition();
+   }
+   if(ok)
+   {
+      U8 *block = new U8[size];
+      mDemoReadStream->read(size, block);
+      if(mDemoReadStream->getStatus() == Stream::Ok)
+      {
+         BitStream bs(block, size);
+         readDemoSnapshot(&bs);
+      }
+      delete[] block;
+   }
+
+   U32 next;
+   if(ok)
+      mDemoReadStream->read(&next);
+   if(!ok || mDemoReadStream->getStatus() != Stream::Ok)
+   {
+      demoPlaybackComplete();
+      deleteObject();
+      return false;
+   }
+
+   // carry on from the keyframe as though it had just been reached,
+   // keeping the recording's alignment to the tick boundary
+   U32 tickSize = getDemoTickSize();
+   U32 now = Sim::getCurrentTime();
+   mDemoReadStartTime = now + tickSize - (now % tickSize);
+   mDemoReadStartTime -= key.time - (key.time % tickSize);
+   postNextDemoBlock(next);
+   return true;
 }
 
 //--------------------------------------------------------------------
@@ -155,6 +155,7 @@ private:
    NetConnection *mNextTableHash;
    static NetConnection *mHashTable[HashTableSize];
    bool mIsNetworkConnection;
+   bool mLean;
 protected:
    static NetConnection *mServerConnection;
    static NetConnection *mLocalClientConnection;
@@ -172,6 +173,10 @@ public:
    bool isLocalConnection() { return mConnectionObjectId != 0; }
    bool isNetworkConnection() { return mIsNetworkConnection; }
    void setNetworkConnection(bool net) { mIsNetworkConnection = net; }
+   // A lean connection lives only on the server and never sends a packet (the
+   // AI's): no ghosting, no events, and no string tables.
+   void setLean();
+   bool isLean() { return mLean; }
    // call this if the "connection" is local to this app
    // short-circuits protocol layer
    
@@ -276,8 +281,10 @@ public:
 
 private:
 
-   U16 mStringXLTable[NetStringTable::MaxStrings];
-   U8 mStringSentBitArray[NetStringTable::MaxStrings >> 3];
+   // Allocated on first use, lean connections never get them.
+   U16 *mStringXLTable;
+   U8 *mStringSentBitArray;
+   void allocStringTables();
    NetConnection *mNextConnection;
    NetConnection *mPrevConnection;
    static NetConnection *mConnectionList;
@@ -288,7 +295,7 @@ public:
    void mapString(U32 remoteId, U32 localId);
    void clearString(U32 id);
    void checkString(U32 id);
-   U32 translateRemoteStringId(U32 id) { return mStringXLTable[id]; }
+   U32 translateRemoteStringId(U32 id) { return mStringXLTable ? mStringXLTable[id] : 0; }
    void validateSendString(const char *str);
    void packString(BitStream *stream, const char *str);
    void unpackString(BitStream *stream, char readBuffer[1024]);
@@ -379,24 +386,63 @@ private:
 
    U32 mDemoRealStartTime;
 
+   // A keyframe is a full snapshot of the connection (the same data as
+   // the start block) written into the recording every so often.  The
+   // index trailer written by stopRecording() lists all of them, so
+   // playback can jump to the nearest one instead of replaying from
+   // the beginning.
+   struct DemoKeyframe
+   {
+      U32 time;         // ms relative to the start of the recording
+      U32 position;     // stream offset of the snapshot size field
+   };
+   Vector<DemoKeyframe> mDemoKeyframes;
+   U32 mDemoLastKeyframeTime;
+   U32 mDemoProcessEventId;
+   bool mDemoWritingKeyframe;
+   bool mDemoFastPlayback;
+
+   void writeDemoSnapshot(ResizeBitStream *stream);
+   void readDemoSnapshot(BitStream *stream);
+   void writeDemoKeyframe(U32 time);
+   void writeDemoIndex();
+   void readDemoIndex();
+   void resetDemoPlaybackState();
+   void postNextDemoBlock(U32 time);
+
 public:
    enum {
       BlockTypePacket,
-      NetConnectionBlockTypeCount
+      NetConnectionBlockTypeCount,
+
+      // kept clear of the subclass block types so recordings made
+      // before keyframes existed still replay
+      BlockTypeKeyframe = 0x7ffffffe,
+      BlockTypeIndex    = 0x7fffffff,
    };
+   enum {
+      DemoIndexMagic = 0x58444e49,   // 'INDX'
+   };
+   static U32 smDemoKeyframeInterval;
+
    bool isRecording()
       { return mDemoWriteStream != NULL; }
    bool isPlayingBack()
       { return mDemoReadStream != NULL; }
+   bool isWritingDemoKeyframe()
+      { return mDemoWritingKeyframe; }
+   bool isFastDemoPlayback()
+      { return mDemoFastPlayback; }
    
    void recordBlock(U32 time, U32 type, U32 size, void *data);
    virtual void handleRecordedBlock(U32 type, U32 size, void *data);
    void readNextDemoBlock();
    
    bool startDemoRecord(const char *fileName);
-   bool replayDemoRecord(const char *fileName);
+   bool replayDemoRecord(const char *fileName, bool fast = false);
    void startDemoRead();   
    void stopRecording();
+   bool seekDemo(U32 time);
    
    virtual void writeDemoStartBlock(ResizeBitStream *stream);
    virtual void readDemoStartBlock(BitStream *stream);
@@ -7,6 +7,7 @@
 
 #include "platform/platform.h"
 #include "console/simBase.h"
+#include "console/simParallel.h"
 #include "core/dnet.h"
 #include "sim/netConnection.h"
 #include "sim/netObject.h"
@@ -43,6 +44,11 @@ NetObject::~NetObject()
 void NetObject::setMaskBits(U32 orMask)
 {
    AssertFatal(orMask != 0, "Invalid net mask bits set.");
+   if(SimCommandBuffer *buffer = SimCommandBuffer::getCurrent())
+   {
+      buffer->addCall(this, deferredSetMaskBits, orMask);
+      return;
+   }
    AssertFatal(mDirtyMaskBits == 0 || (mPrevDirtyList != NULL || mNextDirtyList != NULL || mDirtyList == this), "Invalid dirty list state.");
    if(!mDirtyMaskBits)
    {
@@ -62,6 +68,11 @@ void NetObject::clearMaskBits(U32 orMask)
 {
    if(isDeleted())
       return;
+   if(SimCommandBuffer *buffer = SimCommandBuffer::getCurrent())
+   {
+      buffer->addCall(this, deferredClearMaskBits, orMask);
+      return;
+   }
    if(mDirtyMaskBits)
    {
       mDirtyMaskBits &= ~orMask;
@@ -89,6 +100,16 @@ void NetObject::clearMaskBits(U32 orMask)
    }
 }
 
+void NetObject::deferredSetMaskBits(SimObject *object, U32 orMask)
+{
+   static_cast<NetObject *>(object)->setMaskBits(orMask);
+}
+
+void NetObject::deferredClearMaskBits(SimObject *object, U32 orMask)
+{
+   static_cast<NetObject *>(object)->clearMaskBits(orMask);
+}
+
 void NetObject::collapseDirtyList()
 {
    Vector<NetObject *> tempV;
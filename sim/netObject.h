@@ -71,6 +71,10 @@ protected:
 	BitSet32 mNetFlags;
    U32 mNetIndex;                   // the index of this ghost in the GhostManager on the server
    GhostInfo *mFirstObjectRef;
+
+   // deferred mask changes from a parallel section
+   static void deferredSetMaskBits(SimObject *object, U32 orMask);
+   static void deferredClearMaskBits(SimObject *object, U32 orMask);
 public:
 	NetObject();
 	~NetObject();
@@ -6,6 +6,7 @@
 //-----------------------------------------------------------------------------
 
 #include "sim/sceneObject.h"
+#include "console/simParallel.h"
 #include "scenegraph/sceneGraph.h"
 #include "console/consoleTypes.h"
 #include "collision/extrudedPolyList.h"
@@ -24,16 +25,10 @@ IMPLEMENT_CONOBJECT(SceneObject);
 const U32 Container::csmNumBins = 16;
 const F32 Container::csmBinSize = 64;
 const F32 Container::csmTotalBinSize = Container::csmBinSize * Container::csmNumBins;
-U32       Container::smCurrSeqKey = 1;
 const U32 Container::csmRefPoolBlockSize = 4096;
 
 namespace {
 
-// Statics used by buildPolyList methods
-AbstractPolyList* sPolyList;
-SphereF sBoundingSphere;
-Box3F sBoundingBox;
-
 // Statics used by collide methods
 ExtrudedPolyList sExtrudedPolyList;
 Polyhedron sBoxPolyhedron;
@@ -324,7 +319,8 @@ SceneObject::SceneObject()
    mRenderWorldToObj.identity();
    mRenderWorldBox = Box3F(Point3F(0, 0, 0), Point3F(0, 0, 0));
    mRenderWorldSphere = SphereF(Point3F(0, 0, 0), 0);
-   mContainerSeqKey = 0;
+   for (U32 i = 0; i < ContainerQueryContext::MaxContexts; i++)
+      mContainerSeqKeys[i] = 0;
 
    mBinRefHead  = NULL;
 
@@ -459,6 +455,7 @@ bool SceneObject::collideBox(const Point3F &start, const Point3F &end, RayInfo *
 
 void SceneObject::disableCollision()
 {
+   SimSharedLock lock;
    mCollisionCount++;
    AssertFatal(mCollisionCount < 50, "Wow, that's too much");
 }
@@ -496,6 +493,7 @@ bool SceneObject::displaceObject(const Point3F&)
 
 void SceneObject::enableCollision()
 {
+   SimSharedLock lock;
    if (mCollisionCount)
       --mCollisionCount;
 }
@@ -554,6 +552,7 @@ void SceneObject::setTransform(const MatrixF& mat)
    resetWorldBox();
 
    if (mSceneManager != NULL && mNumCurrZones != 0) {
+      SimSharedLock lock;
       mSceneManager->zoneRemove(this);
       mSceneManager->zoneInsert(this);
       if (getContainer())
@@ -747,6 +746,50 @@ void SceneObject::getWSPortalPlane(const U32 /*portalIndex*/, PlaneF*)
 }
 
 
+//----------------------------------------------------------------------------
+//-------------------------------------- ContainerQueryContext
+//
+U32 ContainerQueryContext::smSlotsInUse = 1;
+U32 ContainerQueryContext::smSlotSeqKeys[ContainerQueryContext::MaxContexts];
+ContainerQueryContext ContainerQueryContext::smMainContext(0);
+THREAD_LOCAL ContainerQueryContext* ContainerQueryContext::smCurrent = NULL;
+
+ContainerQueryContext::ContainerQueryContext(U32 slot)
+{
+   mSlot   = slot;
+   mSeqKey = smSlotSeqKeys[slot];
+}
+
+ContainerQueryContext::~ContainerQueryContext()
+{
+   AssertFatal(smCurrent != this, "ContainerQueryContext: deleting a context that's still in use");
+
+   // The objects still hold keys from this context, the next one in the
+   //  slot has to start past them.
+   smSlotSeqKeys[mSlot] = mSeqKey;
+   if (mSlot != 0)
+      smSlotsInUse &= ~(1 << mSlot);
+}
+
+ContainerQueryContext* ContainerQueryContext::create()
+{
+   for (U32 i = 1; i < MaxContexts; i++) {
+      if ((smSlotsInUse & (1 << i)) == 0) {
+         smSlotsInUse |= 1 << i;
+         return new ContainerQueryContext(i);
+      }
+   }
+   return NULL;
+}
+
+U8* ContainerQueryContext::getScratch(U32 size)
+{
+   if (mScratch.size() < size)
+      mScratch.setSize(size);
+   return mScratch.address();
+}
+
+
 //----------------------------------------------------------------------------
 //-------------------------------------- Container implementation
 //
@@ -771,6 +814,27 @@ void Container::Link::linkAfter(Container::Link* ptr)
 }
 
 //----------------------------------------------------------------------------
+// The bins are changed under the shared lock, but queries walk them without
+//  it.  So a new ref is filled in before it's linked into its bin, and a ref
+//  taken out of a bin during a parallel section keeps its next link and isn't
+//  reused until the section is over (releaseDeferredRefs), in case a query is
+//  standing on it.  A query can then see an object in a bin it just left or
+//  miss one that just came in, but only objects of other islands move while
+//  it runs, and islands never reach each other's objects: every query an
+//  island object makes stays inside its island box (GameBase::getIslandBox),
+//  and the old and new boxes of a moving object stay inside its own.  Even a
+//  box read half way through a move is made of coordinates from those two,
+//  so it misses the query on the same axis the island boxes are apart on,
+//  and the answer doesn't depend on the thread timing.
+#if defined(_MSC_VER)
+extern "C" void _ReadWriteBarrier();
+#pragma intrinsic(_ReadWriteBarrier)
+#define BIN_FENCE() _ReadWriteBarrier()
+#elif defined(__GNUC__)
+#define BIN_FENCE() __sync_synchronize()
+#else
+#define BIN_FENCE()
+#endif
 
 Container gServerContainer;
 Container gClientContainer;
@@ -779,6 +843,7 @@ Container::Container()
 {
    mEnd.next = mEnd.prev = &mStart;
    mStart.next = mStart.prev = &mEnd;
+   mSweepBatch.setContainer(this);
 
    if (!sBoxPolyhedron.edgeList.size()) {
       Box3F box;
@@ -807,6 +872,7 @@ Container::Container()
    VECTOR_SET_ASSOCIATION(mSearchList);
    
    mFreeRefPool = NULL;
+   mDeferredRefs = NULL;
    addRefPoolBlock();
 
    cleanupSearchVectors();
@@ -814,6 +880,7 @@ Container::Container()
 
 Container::~Container()
 {
+   releaseDeferredRefs();
    for (U32 i = 0; i < mRefPoolBlocks.size(); i++) {
       SceneObjectRef* pool = mRefPoolBlocks[i];
       for (U32 j = 0; j < csmRefPoolBlockSize; j++)
@@ -829,17 +896,22 @@ Container::~Container()
 bool Container::addObject(SceneObject* obj)
 {
    AssertFatal(obj->mContainer == NULL, "Adding already added object.");
+   SimSharedLock lock;
    obj->mContainer = this;
    obj->linkAfter(&mStart);
 
    insertIntoBins(obj);
+   mBroadPhase.objectAdded(obj);
+   mSweepBatch.objectAdded(obj);
    return true;
 }
 
 bool Container::removeObject(SceneObject* obj)
 {
    AssertFatal(obj->mContainer == this, "Trying to remove from wrong container.");
+   SimSharedLock lock;
    removeFromBins(obj);
+   mSweepBatch.objectRemoved(obj);
 
    obj->mContainer = 0;
    obj->unlink();
@@ -903,6 +975,7 @@ void Container::insertIntoBins(SceneObject* obj)
 
             if (mBinArray[base + insertX].nextInBin)
                mBinArray[base + insertX].nextInBin->prevInBin = ref;
+            BIN_FENCE();
             mBinArray[base + insertX].nextInBin = ref;
 
             *pCurrInsert = ref;
@@ -919,6 +992,7 @@ void Container::insertIntoBins(SceneObject* obj)
 
       if (mOverflowBin.nextInBin)
          mOverflowBin.nextInBin->prevInBin = ref;
+      BIN_FENCE();
       mOverflowBin.nextInBin = ref;
 
       obj->mBinRefHead = ref;
@@ -959,6 +1033,7 @@ void Container::insertIntoBins(SceneObject* obj,
 
             if (mBinArray[base + insertX].nextInBin)
                mBinArray[base + insertX].nextInBin->prevInBin = ref;
+            BIN_FENCE();
             mBinArray[base + insertX].nextInBin = ref;
 
             *pCurrInsert = ref;
@@ -975,6 +1050,7 @@ void Container::insertIntoBins(SceneObject* obj,
 
       if (mOverflowBin.nextInBin)
          mOverflowBin.nextInBin->prevInBin = ref;
+      BIN_FENCE();
       mOverflowBin.nextInBin = ref;
       obj->mBinRefHead = ref;
    }
@@ -986,6 +1062,7 @@ void Container::removeFromBins(SceneObject* obj)
 
    SceneObjectRef* chain = obj->mBinRefHead;
    obj->mBinRefHead = NULL;
+   bool defer = Sim::isParallel();
    
    while (chain) {
       SceneObjectRef* trash = chain;
@@ -996,6 +1073,21 @@ void Container::removeFromBins(SceneObject* obj)
          trash->nextInBin->prevInBin = trash->prevInBin;
       trash->prevInBin->nextInBin = trash->nextInBin;
 
+      if (defer) {
+         trash->nextInObj = mDeferredRefs;
+         mDeferredRefs    = trash;
+      }
+      else
+         freeObjectRef(trash);
+   }
+}
+
+void Container::releaseDeferredRefs()
+{
+   AssertFatal(!Sim::isParallel(), "Container::releaseDeferredRefs: queries may still be running");
+   while (mDeferredRefs) {
+      SceneObjectRef* trash = mDeferredRefs;
+      mDeferredRefs = trash->nextInObj;
       freeObjectRef(trash);
    }
 }
@@ -1004,36 +1096,48 @@ void Container::removeFromBins(SceneObject* obj)
 void Container::checkBins(SceneObject* obj)
 {
    AssertFatal(obj != NULL, "No object?");
+   SimSharedLock lock;
+   mSweepBatch.objectMoved(obj);
 
    if (obj->mBinRefHead == NULL)
    {
       insertIntoBins(obj);
-      return;
    }
-   
-   // Otherwise, the object is already in the bins.  Let's see if it has strayed out of
-   //  the bins that it's currently in...
-   const Box3F* pWBox = &obj->getWorldBox();
-
-   U32 minX, maxX, minY, maxY;
-   getBinRange(pWBox->min.x, pWBox->max.x, minX, maxX);
-   getBinRange(pWBox->min.y, pWBox->max.y, minY, maxY);
-   if (obj->mBinMinX != minX || obj->mBinMaxX != maxX ||
-       obj->mBinMinY != minY || obj->mBinMaxY != maxY)
+   else
    {
-      // We have to rebin the object
-      removeFromBins(obj);
-      insertIntoBins(obj, minX, maxX, minY, maxY);
+      // Otherwise, the object is already in the bins.  Let's see if it has strayed out of
+      //  the bins that it's currently in...
+      const Box3F* pWBox = &obj->getWorldBox();
+
+      U32 minX, maxX, minY, maxY;
+      getBinRange(pWBox->min.x, pWBox->max.x, minX, maxX);
+      getBinRange(pWBox->min.y, pWBox->max.y, minY, maxY);
+      if (obj->mBinMinX != minX || obj->mBinMaxX != maxX ||
+          obj->mBinMinY != minY || obj->mBinMaxY != maxY)
+      {
+         // We have to rebin the object
+         removeFromBins(obj);
+         insertIntoBins(obj, minX, maxX, minY, maxY);
+      }
    }
+
+   // Proxies it moved into have to see it before they query again
+   mBroadPhase.objectMoved(obj);
 }
 
 
-void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, S32 key)
+void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, S32 key,
+                            ContainerQueryContext* context)
 {
+   if (!context)
+      context = ContainerQueryContext::getCurrent();
+   ContainerQueryContext::Scope scope(context);
+   const U32 slot   = context->getSlot();
+   const U32 seqKey = context->nextSeqKey();
+
    U32 minX, maxX, minY, maxY;
    getBinRange(box.min.x, box.max.x, minX, maxX);
    getBinRange(box.min.y, box.max.y, minY, maxY);
-   smCurrSeqKey++;
    for (U32 i = minY; i <= maxY; i++) {
       U32 insertY = i % csmNumBins;
       U32 base    = insertY * csmNumBins;
@@ -1042,8 +1146,8 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, S
 
          SceneObjectRef* chain = mBinArray[base + insertX].nextInBin;
          while (chain) {
-            if (chain->object->getContainerSeqKey() != smCurrSeqKey) {
-               chain->object->setContainerSeqKey(smCurrSeqKey);
+            if (chain->object->getContainerSeqKey(slot) != seqKey) {
+               chain->object->setContainerSeqKey(seqKey, slot);
 
                if ((chain->object->getType() & mask) != 0 &&
                    chain->object->isCollisionEnabled())
@@ -1059,8 +1163,8 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, S
    }
    SceneObjectRef* chain = mOverflowBin.nextInBin;
    while (chain) {
-      if (chain->object->getContainerSeqKey() != smCurrSeqKey) {
-         chain->object->setContainerSeqKey(smCurrSeqKey);
+      if (chain->object->getContainerSeqKey(slot) != seqKey) {
+         chain->object->setContainerSeqKey(seqKey, slot);
 
          if ((chain->object->getType() & mask) != 0 &&
              chain->object->isCollisionEnabled()) {
@@ -1074,8 +1178,15 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, S
 }
 
 
-void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, FindCallback callback, S32 key)
+void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, FindCallback callback, S32 key,
+                                      ContainerQueryContext* context)
 {
+   if (!context)
+      context = ContainerQueryContext::getCurrent();
+   ContainerQueryContext::Scope scope(context);
+   const U32 slot   = context->getSlot();
+   const U32 seqKey = context->nextSeqKey();
+
    U32 i;
    Box3F box;
    box.min.set(1e9, 1e9, 1e9);
@@ -1088,7 +1199,6 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
    U32 minX, maxX, minY, maxY;
    getBinRange(box.min.x, box.max.x, minX, maxX);
    getBinRange(box.min.y, box.max.y, minY, maxY);
-   smCurrSeqKey++;
    for (i = minY; i <= maxY; i++) {
       U32 insertY = i % csmNumBins;
       U32 base    = insertY * csmNumBins;
@@ -1097,8 +1207,8 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
 
          SceneObjectRef* chain = mBinArray[base + insertX].nextInBin;
          while (chain) {
-            if (chain->object->getContainerSeqKey() != smCurrSeqKey) {
-               chain->object->setContainerSeqKey(smCurrSeqKey);
+            if (chain->object->getContainerSeqKey(slot) != seqKey) {
+               chain->object->setContainerSeqKey(seqKey, slot);
 
                if ((chain->object->getType() & mask) != 0 &&
                    chain->object->isCollisionEnabled()) {
@@ -1113,8 +1223,8 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
    }
    SceneObjectRef* chain = mOverflowBin.nextInBin;
    while (chain) {
-      if (chain->object->getContainerSeqKey() != smCurrSeqKey) {
-         chain->object->setContainerSeqKey(smCurrSeqKey);
+      if (chain->object->getContainerSeqKey(slot) != seqKey) {
+         chain->object->setContainerSeqKey(seqKey, slot);
 
          if ((chain->object->getType() & mask) != 0 &&
              chain->object->isCollisionEnabled()) {
@@ -1141,17 +1251,23 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
 //             rasterizer for anti-aliased lines that will serve better than what
 //             we have below.
 //
-bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info)
+bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info,
+                        ContainerQueryContext* context)
 {
+   if (!context)
+      context = ContainerQueryContext::getCurrent();
+   ContainerQueryContext::Scope scope(context);
+   const U32 slot   = context->getSlot();
+   const U32 seqKey = context->nextSeqKey();
+
    PROFILE_START(ContainerCastRay);
    F32 currentT = 2.0;
-   smCurrSeqKey++;
 
    SceneObjectRef* chain = mOverflowBin.nextInBin;
    while (chain) {
       SceneObject* ptr = chain->object;
-      if (ptr->getContainerSeqKey() != smCurrSeqKey) {
-         ptr->setContainerSeqKey(smCurrSeqKey);
+      if (ptr->getContainerSeqKey(slot) != seqKey) {
+         ptr->setContainerSeqKey(seqKey, slot);
 
          // In the overflow bin, the world box is always going to intersect the line,
          //  so we can omit that test...
@@ -1221,8 +1337,8 @@ bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayI
          SceneObjectRef* chain = mBinArray[(checkY * csmNumBins) + checkX].nextInBin;
          while (chain) {
             SceneObject* ptr = chain->object;
-            if (ptr->getContainerSeqKey() != smCurrSeqKey) {
-               ptr->setContainerSeqKey(smCurrSeqKey);
+            if (ptr->getContainerSeqKey(slot) != seqKey) {
+               ptr->setContainerSeqKey(seqKey, slot);
 
                if ((ptr->getType() & mask) != 0      &&
                    ptr->isCollisionEnabled() == true) {
@@ -1293,8 +1409,8 @@ bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayI
                SceneObjectRef* chain = mBinArray[(checkY * csmNumBins) + checkX].nextInBin;
                while (chain) {
                   SceneObject* ptr = chain->object;
-                  if (ptr->getContainerSeqKey() != smCurrSeqKey) {
-                     ptr->setContainerSeqKey(smCurrSeqKey);
+                  if (ptr->getContainerSeqKey(slot) != seqKey) {
+                     ptr->setContainerSeqKey(seqKey, slot);
 
                      if ((ptr->getType() & mask) != 0      &&
                          ptr->isCollisionEnabled() == true) {
@@ -1373,7 +1489,8 @@ static void buildCallback(SceneObject* object,S32 key)
 
 //----------------------------------------------------------------------------
 
-bool Container::buildPolyList(const Box3F& box, U32 mask, AbstractPolyList* polyList,FindCallback callback,S32 key)
+bool Container::buildPolyList(const Box3F& box, U32 mask, AbstractPolyList* polyList,FindCallback callback,S32 key,
+                              ContainerQueryContext* context)
 {
    CallbackInfo info;
    info.boundingBox = box;
@@ -1385,8 +1502,9 @@ bool Container::buildPolyList(const Box3F& box, U32 mask, AbstractPolyList* poly
    VectorF bv = box.max - info.boundingSphere.center;
    info.boundingSphere.radius = bv.len();
 
-   sPolyList = polyList;
-   findObjects(box,mask,callback? callback: buildCallback,S32(&info));
+   PROFILE_START(ContainerBuildPolyList);
+   findObjects(box,mask,callback? callback: buildCallback,S32(&info),context);
+   PROFILE_END();
    return !polyList->isEmpty();
 }
 
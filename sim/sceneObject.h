@@ -32,6 +32,15 @@
 #ifndef _LIGHTMANAGER_H_
 #include "scenegraph/lightManager.h"
 #endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+#ifndef _BROADPHASE_H_
+#include "collision/broadPhase.h"
+#endif
+#ifndef _SWEEPBATCH_H_
+#include "collision/sweepBatch.h"
+#endif
 
 //-------------------------------------- Forward declarations...
 class SceneObject;
@@ -84,9 +93,67 @@ class ScopeFrustum
 };
 
 
+//----------------------------------------------------------------------------
+// Per query state for the container.  Every context owns a slot in the
+// objects' sequence key arrays, so queries running on different threads
+// don't clear each other's visited marks.  The main context (slot 0) is
+// used whenever a query isn't given one.
+//
+// Queries off the main thread are read only: nothing may add, remove or
+// move scene objects while they run.  Contexts are created and deleted on
+// the main thread, and used by one thread at a time.
+class ContainerQueryContext
+{
+  public:
+   enum Constants {
+      MaxContexts = 8,
+   };
+
+  private:
+   U32        mSlot;
+   U32        mSeqKey;
+   Vector<U8> mScratch;
+
+   static U32 smSlotsInUse;
+   static U32 smSlotSeqKeys[MaxContexts];   // carried over when a slot is reused
+   static ContainerQueryContext smMainContext;
+   static THREAD_LOCAL ContainerQueryContext* smCurrent;
+
+   ContainerQueryContext(U32 slot);
+
+  public:
+   ~ContainerQueryContext();
+
+   // Returns NULL if all the slots are taken.
+   static ContainerQueryContext* create();
+
+   U32  getSlot() const       { return mSlot;       }
+   U32  nextSeqKey()          { return ++mSeqKey;   }
+   bool isMainContext() const { return mSlot == 0;  }
+
+   // Scratch memory for the object queries, good until the next call.
+   U8* getScratch(U32 size);
+
+   // The context of the query running on this thread.
+   static ContainerQueryContext* getMain()    { return &smMainContext; }
+   static ContainerQueryContext* getCurrent() { return smCurrent ? smCurrent : &smMainContext; }
+
+   // Makes a context current on this thread for the length of a query.
+   class Scope
+   {
+      ContainerQueryContext* mPrev;
+     public:
+      Scope(ContainerQueryContext* context) { mPrev = smCurrent; smCurrent = context; }
+      ~Scope()                              { smCurrent = mPrev; }
+   };
+};
+
+
 //----------------------------------------------------------------------------
 class Container
 {
+   friend class SweepBatch;
+
   public:
    struct Link
    {
@@ -108,34 +175,49 @@ class Container
    static const F32 csmBinSize;
    static const F32 csmTotalBinSize;
    static const U32 csmRefPoolBlockSize;
-   static U32       smCurrSeqKey;
 
   private:
    Link mStart,mEnd;
 
    SceneObjectRef*         mFreeRefPool;
+   SceneObjectRef*         mDeferredRefs;       // out of the bins, not free yet
    Vector<SceneObjectRef*> mRefPoolBlocks;
 
    SceneObjectRef* mBinArray;
    SceneObjectRef  mOverflowBin;
 
+   CollisionBroadPhase mBroadPhase;
+   SweepBatch          mSweepBatch;
+
   public:
    Container();
    ~Container();
 
-   // Basic database operations
+   // Persistent working sets of the moving objects in this container
+   CollisionBroadPhase* getBroadPhase() { return &mBroadPhase; }
+   // Segment casts gathered before a tick
+   SweepBatch* getSweepBatch() { return &mSweepBatch; }
+
+   // Basic database operations.  The box, polyhedron, ray and poly list
+   //  queries take an optional context, which lets them run concurrently
+   //  (see ContainerQueryContext).  They don't take the shared lock, only
+   //  adding, removing and rebinning objects does.
    typedef void (*FindCallback)(SceneObject*,S32 key);
    void findObjects(U32 mask, FindCallback, S32 key = 0);
-   void findObjects(const Box3F& box, U32 mask, FindCallback, S32 key = 0);
+   void findObjects(const Box3F& box, U32 mask, FindCallback, S32 key = 0,
+                    ContainerQueryContext* context = NULL);
    void polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask,
-                              FindCallback, S32 key = 0);
+                              FindCallback, S32 key = 0,
+                              ContainerQueryContext* context = NULL);
 
    // Line intersection
-   bool castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
+   bool castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info,
+                ContainerQueryContext* context = NULL);
    bool collideBox(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
 
    // Poly list
-   bool buildPolyList(const Box3F& box, U32 mask, AbstractPolyList*,FindCallback=0,S32 key = 0);
+   bool buildPolyList(const Box3F& box, U32 mask, AbstractPolyList*,FindCallback=0,S32 key = 0,
+                      ContainerQueryContext* context = NULL);
    bool buildCollisionList(const Box3F& box, const Point3F& start, const Point3F& end, const VectorF& velocity,
       U32 mask,CollisionList* collisionList,FindCallback = 0,S32 key = 0,const Box3F *queryExpansion = 0);
    bool buildCollisionList(const Polyhedron& polyhedron,
@@ -159,6 +241,10 @@ class Container
    //  the ranges twice.
    void checkBins(SceneObject*);
    void insertIntoBins(SceneObject*, U32, U32, U32, U32);
+
+   // Frees the refs rebinning took out of the bins during a parallel
+   //  section.  Main thread, once the section is over.
+   void releaseDeferredRefs();
    
    // Object searches to support console querying of the database.  ONLY WORKS ON SERVER
   private:
@@ -200,6 +286,7 @@ class SceneObject : public NetObject, public Container::Link
 {
    typedef NetObject Parent;
    friend class Container;
+   friend class SweepBatch;
    friend class SceneGraph;
    friend class SceneState;
 
@@ -381,9 +468,9 @@ class SceneObject : public NetObject, public Container::Link
    U32 mBinMinY;
    U32 mBinMaxY;
 
-   U32  mContainerSeqKey;
-   U32  getContainerSeqKey() const        { return mContainerSeqKey; }
-   void setContainerSeqKey(const U32 key) { mContainerSeqKey = key;  }
+   U32  mContainerSeqKeys[ContainerQueryContext::MaxContexts];
+   U32  getContainerSeqKey(const U32 slot = 0) const        { return mContainerSeqKeys[slot]; }
+   void setContainerSeqKey(const U32 key, const U32 slot = 0) { mContainerSeqKeys[slot] = key;  }
 
 public:
    Container* getContainer()         { return mContainer;       }
@@ -7,9 +7,11 @@ V12.AI=\
 	ai/aiObjective.cc \
 	ai/aiStep.cc \
 	ai/aiTask.cc \
+	ai/aiThink.cc \
 	ai/graph.cc \
 	ai/graphBase.cc \
 	ai/graphBridge.cc \
+	ai/graphBuild.cc \
 	ai/graphBuildLOS.cc \
 	ai/graphConjoin.cc \
 	ai/graphData.cc \
@@ -21,6 +23,7 @@ V12.AI=\
 	ai/graphForceField.cc \
 	ai/graphGenUtils.cc \
 	ai/graphGroundPlan.cc \
+	ai/graphHierarchy.cc \
 	ai/graphIndoors.cc \
 	ai/graphIsland.cc \
 	ai/graphJetting.cc \
@@ -31,11 +34,14 @@ V12.AI=\
 	ai/graphOutdoors.cc \
 	ai/graphPartition.cc \
 	ai/graphPath.cc \
+	ai/graphPathCache.cc \
+	ai/graphPathQueue.cc \
 	ai/graphQueries.cc \
 	ai/graphRender.cc \
 	ai/graphSearchLOS.cc \
 	ai/graphSmooth.cc \
 	ai/graphSpawn.cc \
+	ai/graphThreadPool.cc \
 	ai/graphThreats.cc \
 	ai/graphTransient.cc \
 	ai/graphVolume.cc 
@@ -50,6 +56,7 @@ V12.AUDIO=\
 	audio/audioCodec.cc \
 	audio/audioCodecMiles.cc \
 	audio/bufferQueue.cc \
+	audio/voiceKernels.cc \
 
 #	audio/audioCodecGSM.cc \
 
@@ -57,6 +64,8 @@ V12.AUDIO=\
 V12.COLLISION=\
 	collision/abstractPolyList.cc \
 	collision/boxConvex.cc \
+	collision/boxTree.cc \
+	collision/broadPhase.cc \
 	collision/clippedPolyList.cc \
 	collision/convex.cc \
 	collision/depthSortList.cc \
@@ -65,7 +74,8 @@ V12.COLLISION=\
 	collision/gjk.cc \
 	collision/planeExtractor.cc \
 	collision/polyhedron.cc \
-	collision/polytope.cc 
+	collision/polytope.cc \
+	collision/sweepBatch.cc 
 
 V12.CONSOLE=\
 	console/compiledEval.cc \
@@ -81,6 +91,7 @@ V12.CONSOLE=\
 	console/simBase.cc \
 	console/simDictionary.cc \
 	console/simManager.cc \
+	console/simParallel.cc \
 	console/telnetConsole.cc \
 	console/telnetDebugger.cc 
 	
@@ -211,6 +222,7 @@ V12.INTERIOR=\
 	interior/forceField.cc \
 	interior/itfdump.asm \
 	interior/interior.cc \
+	interior/interiorBVH.cc \
 	interior/interiorCollision.cc \
 	interior/interiorDebug.cc \
 	interior/interiorIO.cc \
@@ -308,6 +320,7 @@ V12.SHELL=\
 V12.SIM=\
 	sim/actionMap.cc \
 	sim/cannedChatDataBlock.cc \
+	sim/containerStress.cc \
 	sim/decalManager.cc \
 	sim/frameAllocator.cc \
 	sim/netConnection.cc \
@@ -320,9 +333,12 @@ V12.SIM=\
 	sim/simPath.cc 
 
 V12.GAME=\
+	game/benchmark.cc \
 	game/debris.cc \
 	game/debugView.cc \
 	game/gameFunctions.cc \
+	game/projectileManager.cc \
+	game/proximityIndex.cc \
 	game/stationFXPersonal.cc \
 	game/stationFXVehicle.cc \
 	game/ambientAudioManager.cc \
@@ -454,12 +470,14 @@ V12.TERRAIN=\
 	terrain/terrCollision.cc \
 	terrain/terrData.cc \
 	terrain/terrLighting.cc \
+	terrain/terrRayBatch.cc \
 	terrain/terrRender.cc \
 	terrain/terrRender2.cc \
 	terrain/waterBlock.cc 
 
 V12.TS=\
 	ts/tsAnimate.cc \
+	ts/tsAnimateBatch.cc \
 	ts/tsCollision.cc \
 	ts/tsDecal.cc \
 	ts/tsDump.cc \
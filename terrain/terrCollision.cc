@@ -6,6 +6,7 @@
 //-----------------------------------------------------------------------------
 
 #include "terrain/terrData.h"
+#include "platform/platformThread.h"
 #include "dgl/dgl.h"
 #include "Editor/editor.h"
 
@@ -122,24 +123,7 @@ Box3F TerrainConvex::getBoundingBox(const MatrixF&, const Point3F& ) const
 
 Point3F TerrainConvex::support(const VectorF& v) const
 {
-   S32 *vp;
-   if (halfA)
-      vp = square ? sVertexList[(split45 << 1) | 1]: sVertexList[4];
-   else
-      vp = square ? sVertexList[(split45 << 1)]    : sVertexList[4];
-      
-   S32 *ve = vp + vp[0] + 1;
-   const Point3F *bp = &point[vp[1]];
-   F32 bd = mDot(*bp,v);
-   for (vp += 2; vp < ve; vp++) {
-      const Point3F* cp = &point[*vp];
-      F32 dd = mDot(*cp,v);
-      if (dd > bd) {
-         bd = dd;
-         bp = cp;
-      }
-   }
-   return *bp;
+   return supportInline(v);
 }
 
 inline bool isOnPlane(Point3F& p,PlaneF& plane)
@@ -211,8 +195,7 @@ void TerrainConvex::getPolyList(AbstractPolyList* list)
    list->setObject(mObject);
 
    // Emit vertices
-   U32 array[4];
-   U32 curr = 0;
+   Point3F points[4];
 
    S32 numVerts;
    S32* vertsStart;
@@ -229,28 +212,27 @@ void TerrainConvex::getPolyList(AbstractPolyList* list)
 
    S32 pointMask = 0;
    for (U32 i = 0; i < numVerts; i++) {
-      const Point3F& cp = point[vertsStart[i]];
-      array[curr++] = list->addPoint(cp);
+      points[i] = point[vertsStart[i]];
       pointMask |= (1 << vertsStart[i]);
    }
+   U32 base = list->addPoints(points, numVerts);
 
+   // And the faces, in one go
    S32  numFaces  = split45 ?  sFaceList45[pointMask][0] :  sFaceList135[pointMask][0];
    S32* faceStart = split45 ? &sFaceList45[pointMask][1] : &sFaceList135[pointMask][1];
+   U32 numFaceVerts[2], vertices[6], planes[2], surfaceKeys[2];
+   AssertFatal(numFaces <= 2, "TerrainConvex::getPolyList: too many faces");
    for (U32 j = 0; j < numFaces; j++) {
-      S32 plane = faceStart[0];
-      S32 v0    = faceStart[1];
-      S32 v1    = faceStart[2];
-      S32 v2    = faceStart[3];
-
-      list->begin(0, plane);
-      list->vertex(array[v0]);
-      list->vertex(array[v1]);
-      list->vertex(array[v2]);
-      list->plane(array[v0], array[v1], array[v2]);
-      list->end();
-
+      numFaceVerts[j]     = 3;
+      planes[j]           = AbstractPolyList::PlaneFromVerts;
+      surfaceKeys[j]      = faceStart[0];
+      vertices[j * 3 + 0] = base + faceStart[1];
+      vertices[j * 3 + 1] = base + faceStart[2];
+      vertices[j * 3 + 2] = base + faceStart[3];
       faceStart += 4;
    }
+   if (numFaces)
+      list->addPolys(0, numFaces, numFaceVerts, vertices, planes, surfaceKeys);
 }
 
 
@@ -412,8 +394,9 @@ bool TerrainBlock::buildPolyList(AbstractPolyList* polyList, const Box3F &box, c
    if (xExt > MaxExtent)
       xExt = MaxExtent;
 
-   mHeightMax = floatToFixed(osBox.max.z);
-   mHeightMin = (osBox.min.z < 0)? 0: floatToFixed(osBox.min.z);
+   // Locals rather than mHeightMin/Max so concurrent queries don't share them
+   S32 heightMax = floatToFixed(osBox.max.z);
+   S32 heightMin = (osBox.min.z < 0)? 0: floatToFixed(osBox.min.z);
 
    // Index of shared points
    U32 bp[(MaxExtent + 1) * 2],*vb[2];
@@ -434,7 +417,7 @@ bool TerrainBlock::buildPolyList(AbstractPolyList* polyList, const Box3F &box, c
 
          // holes only in the primary terrain block
          if (((gs->flags & GridSquare::Empty) && x == xi && y == yi) ||
-             gs->minHeight > mHeightMax || gs->maxHeight < mHeightMin)
+             gs->minHeight > heightMax || gs->maxHeight < heightMin)
             continue;
          emitted = true;
 
@@ -644,43 +627,9 @@ static F32 calcInterceptNone(F32, F32, F32)
    return MAX_FLOAT;
 }
 
-static F32 (*calcInterceptX)(F32, F32, F32);
-static F32 (*calcInterceptY)(F32, F32, F32);
-
-static U32 lineCount;
-static Point3F lineStart, lineEnd;
-
-static void drawLineTest(F32 startT, F32 endT, bool collide)
-{
-   glEnable(GL_DEPTH_TEST);
-   if(lineCount & 1)
-   {
-      if(collide)
-         glColor3f(1, 0, 0);
-      else   
-         glColor3f(1, 1, 1);
-   }
-   else
-   {
-      if(collide)
-         glColor3f(0, 1, 0);
-      else   
-         glColor3f(0, 0, 0);
-   }
-   lineCount++;
-   glBegin(GL_LINES);
-   Point3F pt;
-   pt.interpolate(lineStart, lineEnd, startT);
-   glVertex3fv(pt);
-   pt.interpolate(lineStart, lineEnd, endT);
-   glVertex3fv(pt);
-   Point3F ptUp = pt;
-   ptUp.z += 4;
-   glVertex3fv(pt);
-   glVertex3fv(ptUp);
-   
-   glEnd();
-}
+// Per thread, castRayI sets them up for castRayBlock
+static THREAD_LOCAL F32 (*calcInterceptX)(F32, F32, F32);
+static THREAD_LOCAL F32 (*calcInterceptY)(F32, F32, F32);
 
 bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *info)
 {
@@ -689,10 +638,6 @@ bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *in
 
 bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *info, bool collideEmpty)
 {
-   lineCount = 0;
-   lineStart = start;
-   lineEnd = end;
-
    info->object = this;
       
    if(start.x == end.x && start.y == end.y)
@@ -798,11 +743,94 @@ struct TerrLOSStackNode
    U32 level;
 };
 
+// Tests the ray against the two triangles of a level 0 square, over the
+// [startT, endT] part of the ray that crosses it.  Block space, like
+// castRayBlock.
+bool TerrainBlock::castRaySquare(const Point3F &pStart, const Point3F &pEnd, const Point2I &blockPos, const GridSquare *sq, F32 startT, F32 endT, RayInfo *info)
+{
+   F32 invBlockSize = 1 / F32(BlockSquareWidth);
+
+   F32 xs = blockPos.x * invBlockSize;
+   F32 ys = blockPos.y * invBlockSize;
+
+   F32 zBottomLeft = fixedToFloat(getHeight(blockPos.x, blockPos.y));
+   F32 zBottomRight= fixedToFloat(getHeight(blockPos.x + 1, blockPos.y));
+   F32 zTopLeft =    fixedToFloat(getHeight(blockPos.x, blockPos.y + 1));
+   F32 zTopRight =   fixedToFloat(getHeight(blockPos.x + 1, blockPos.y + 1));
+
+   PlaneF p1, p2;
+   PlaneF divider;
+   Point3F planePoint;
+
+   if(sq->flags & GridSquare::Split45)
+   {
+      p1.set(zBottomLeft - zBottomRight, zBottomRight - zTopRight, invBlockSize);
+      p2.set(zTopLeft - zTopRight, zBottomLeft - zTopLeft, invBlockSize);
+      planePoint.set(xs, ys, zBottomLeft);
+      divider.x = 1;
+      divider.y = -1;
+      divider.z = 0;
+   }
+   else
+   {
+      p1.set(zTopLeft - zTopRight, zBottomRight - zTopRight, invBlockSize);
+      p2.set(zBottomLeft - zBottomRight, zBottomLeft - zTopLeft, invBlockSize);
+      planePoint.set(xs + invBlockSize, ys, zBottomRight);
+      divider.x = 1;
+      divider.y = 1;
+      divider.z = 0;
+   }
+   p1.setPoint(planePoint);
+   p2.setPoint(planePoint);
+   divider.setPoint(planePoint);
+
+   F32 t1 = p1.intersect(pStart, pEnd);
+   F32 t2 = p2.intersect(pStart, pEnd);
+   F32 td = divider.intersect(pStart, pEnd);
+   
+   F32 dStart = divider.distToPlane(pStart);
+   F32 dEnd = divider.distToPlane(pEnd);
+   
+   // see if the line crosses the divider
+   if((dStart >= 0 && dEnd < 0) || (dStart < 0 && dEnd >= 0))
+   {
+      if(dStart < 0)
+      {
+         F32 temp = t1;
+         t1 = t2;
+         t2 = temp;
+      }
+      if(t1 >= startT && t1 && t1 <= td && t1 <= endT)
+      {
+         info->t = t1;
+         info->normal = p1;
+         return true;
+      }
+      if(t2 >= td && t2 >= startT && t2 <= endT)
+      {
+         info->t = t2;
+         info->normal = p2;
+         return true;
+      }
+   }
+   else
+   {
+      F32 t = dStart >= 0 ? t1 : t2;
+      if(t >= startT && t <= endT)
+      {
+         info->t = t;
+         info->normal = dStart >= 0 ? p1 : p2;
+         return true;
+      }
+   }
+   return false;
+}
+
 bool TerrainBlock::castRayBlock(const Point3F &pStart, const Point3F &pEnd, Point2I aBlockPos, U32 aLevel, F32 invDeltaX, F32 invDeltaY, F32 aStartT, F32 aEndT, RayInfo *info, bool collideEmpty)
 {
    F32 invBlockSize = 1 / F32(BlockSquareWidth);
 
-   static TerrLOSStackNode stack[BlockShift * 3 + 1];
+   TerrLOSStackNode stack[BlockShift * 3 + 1];
    U32 stackSize = 1;
    
    stack[0].startT = aStartT;
@@ -826,103 +854,22 @@ bool TerrainBlock::castRayBlock(const Point3F &pStart, const Point3F &pEnd, Poin
       F32 minHeight = fixedToFloat(sq->minHeight);
       if(startZ <= minHeight && endZ <= minHeight)
       {
-         //drawLineTest(startT, sn->endT, false);
          continue;
       }
       F32 maxHeight = fixedToFloat(sq->maxHeight);
       if(startZ >= maxHeight && endZ >= maxHeight)
       {
-         //drawLineTest(startT, endT, false);
          continue;
       }
       if (!collideEmpty && (sq->flags & GridSquare::Empty) &&
       	  blockPos.x == (blockPos.x & BlockMask) && blockPos.y == (blockPos.y & BlockMask))
       {
-         //drawLineTest(startT, endT, false);
          continue;
       }
       if(level == 0)
       {
-         F32 xs = blockPos.x * invBlockSize;
-         F32 ys = blockPos.y * invBlockSize;
-      
-         F32 zBottomLeft = fixedToFloat(getHeight(blockPos.x, blockPos.y));
-         F32 zBottomRight= fixedToFloat(getHeight(blockPos.x + 1, blockPos.y));
-         F32 zTopLeft =    fixedToFloat(getHeight(blockPos.x, blockPos.y + 1));
-         F32 zTopRight =   fixedToFloat(getHeight(blockPos.x + 1, blockPos.y + 1));
-      
-         PlaneF p1, p2;
-         PlaneF divider;
-         Point3F planePoint;
-      
-         if(sq->flags & GridSquare::Split45)
-         {
-            p1.set(zBottomLeft - zBottomRight, zBottomRight - zTopRight, invBlockSize);
-            p2.set(zTopLeft - zTopRight, zBottomLeft - zTopLeft, invBlockSize);
-            planePoint.set(xs, ys, zBottomLeft);
-            divider.x = 1;
-            divider.y = -1;
-            divider.z = 0;
-         }
-         else
-         {
-            p1.set(zTopLeft - zTopRight, zBottomRight - zTopRight, invBlockSize);
-            p2.set(zBottomLeft - zBottomRight, zBottomLeft - zTopLeft, invBlockSize);
-            planePoint.set(xs + invBlockSize, ys, zBottomRight);
-            divider.x = 1;
-            divider.y = 1;
-            divider.z = 0;
-         }
-         p1.setPoint(planePoint);
-         p2.setPoint(planePoint);
-         divider.setPoint(planePoint);
-      
-         F32 t1 = p1.intersect(pStart, pEnd);
-         F32 t2 = p2.intersect(pStart, pEnd);
-         F32 td = divider.intersect(pStart, pEnd);
-         
-         F32 dStart = divider.distToPlane(pStart);
-         F32 dEnd = divider.distToPlane(pEnd);
-         
-         // see if the line crosses the divider
-         if((dStart >= 0 && dEnd < 0) || (dStart < 0 && dEnd >= 0))
-         {
-            if(dStart < 0)
-            {
-               F32 temp = t1;
-               t1 = t2;
-               t2 = temp;
-            }
-            if(t1 >= startT && t1 && t1 <= td && t1 <= endT)
-            {
-               info->t = t1;
-               info->normal = p1;
-               return true;
-            }
-            if(t2 >= td && t2 >= startT && t2 <= endT)
-            {
-               info->t = t2;
-               info->normal = p2;
-               return true;
-            }
-         }
-         else
-         {
-            F32 t;
-            if(dStart >= 0) {
-               t = t1;
-               info->normal = p1;
-            }
-            else {
-               t = t2;
-               info->normal = p2;
-            }
-            if(t >= startT && t <= endT)
-            {
-               info->t = t;
-               return true;
-            }
-         }
+         if(castRaySquare(pStart, pEnd, blockPos, sq, startT, endT, info))
+            return true;
          continue;
       }
       int squareWidth = 1 << level;
@@ -40,6 +40,9 @@ class Blender;
 
 //--------------------------------------------------------------------------
 
+// Number of vertices followed by point index, for each half square
+extern S32 sVertexList[5][5];
+
 class TerrainConvex: public Convex
 {
    friend class TerrainBlock;
@@ -75,10 +78,38 @@ class TerrainConvex: public Convex
    Point3F support(const VectorF& v) const;
    void getFeatures(const MatrixF& mat,const VectorF& n, ConvexFeature* cf);
    void getPolyList(AbstractPolyList* list);
+
+   // Non virtual, for the GJK loops specialized on terrain convexes
+   inline Point3F supportInline(const VectorF& v) const;
 };
 
+inline Point3F TerrainConvex::supportInline(const VectorF& v) const
+{
+   const S32 *vp;
+   if (halfA)
+      vp = square ? sVertexList[(split45 << 1) | 1]: sVertexList[4];
+   else
+      vp = square ? sVertexList[(split45 << 1)]    : sVertexList[4];
+
+   const S32 *ve = vp + vp[0] + 1;
+   const Point3F *bp = &point[vp[1]];
+   F32 bd = mDot(*bp,v);
+   for (vp += 2; vp < ve; vp++) {
+      const Point3F* cp = &point[*vp];
+      F32 dd = mDot(*cp,v);
+      if (dd > bd) {
+         bd = dd;
+         bp = cp;
+      }
+   }
+   return *bp;
+}
 
 
+
+struct TerrRayPacket;
+struct TerrPacketNode;
+
 //--------------------------------------------------------------------------
 struct GridSquare
 {
@@ -269,6 +300,19 @@ class TerrainBlock : public SceneObject
    bool castRay(const Point3F &start, const Point3F &end, RayInfo* info);
    bool castRayI(const Point3F &start, const Point3F &end, RayInfo* info, bool emptyCollide);
    bool castRayBlock(const Point3F &pStart, const Point3F &pEnd, Point2I blockPos, U32 level, F32 invDeltaX, F32 invDeltaY, F32 startT, F32 endT, RayInfo *info, bool);
+
+   // Batch ray cast (terrRayBatch.cc).  Casts count object space rays, four
+   //  at a time down the grid square min/max tree, and returns the number
+   //  that hit.  hits[i] and infos[i] get what castRay would have returned
+   //  for ray i.  Rays that are close together go faster.
+   U32 castRays(U32 count, const Point3F *starts, const Point3F *ends, RayInfo *infos, bool *hits);
+   static void installRayKernels(U32 properties = 0);
+   static const char *getRayKernelName();
+  private:
+   bool castRaySquare(const Point3F &pStart, const Point3F &pEnd, const Point2I &blockPos, const GridSquare *sq, F32 startT, F32 endT, RayInfo *info);
+   void castRayPacket(TerrRayPacket &packet);
+   U32 flushRayPacket(TerrRayPacket &packet, U32 lane, RayInfo *infos, bool *hits, F32 normalScale);
+   void castRayPacketBlock(TerrRayPacket &packet, TerrPacketNode &root);
   private:
    BSPNode *buildSquareTree(S32 y, S32 x);
    BSPNode *buildXTree(S32 y, S32 xStart, S32 xEnd);
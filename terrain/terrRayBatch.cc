@@ -0,0 +1,501 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "terrain/terrData.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "sceneGraph/sceneGraph.h"
+
+#if defined(__SSE__) || (defined(_MSC_VER) && (_MSC_VER >= 1300))
+#define TERRAIN_RAY_SSE
+#include <xmmintrin.h>
+#endif
+
+#define MAX_FLOAT 1e20f
+
+//--------------------------------------------------------------------------
+// Packet ray casting.  Four rays go down the grid square tree together, in
+// the same block space castRayI works in.  Each ray keeps its own [startT,
+// endT] range per node and a lane mask says which rays are still in it.
+// Nodes aren't visited front to back for every ray, so each ray keeps its
+// closest hit so far and clips everything after it.  The level 0 square
+// test is castRaySquare, the same one castRay uses.
+
+struct TerrRayPacket
+{
+   enum {
+      Size = 4,
+   };
+   F32 sx[Size], sy[Size], sz[Size];
+   F32 ex[Size], ey[Size], dz[Size];
+   F32 invDx[Size], invDy[Size];
+   S32 dirX[Size], dirY[Size];
+   F32 bestT[Size];
+   Point3F pStart[Size], pEnd[Size];
+   Point3F normal[Size];
+   U32 index[Size];
+   U32 mask;   // lanes in use
+   U32 hits;   // lanes that have hit something
+};
+
+struct TerrPacketNode
+{
+   F32 startT[TerrRayPacket::Size];
+   F32 endT[TerrRayPacket::Size];
+   Point2I blockPos;
+   U32 level;
+   U32 mask;
+};
+
+//--------------------------------------------------------------------------
+// Lane kernels
+//
+// cull: lanes whose [startT, min(endT, bestT)] is non empty and whose z
+//    range over it overlaps [minHeight, maxHeight] (same test as
+//    castRayBlock).
+// clip: out = [max(startT, lo0, lo1), min(endT, hi0, hi1, bestT)], returns
+//    the lanes where that is non empty.
+
+static U32 terrPacketCull_C(const F32 *startT, const F32 *endT, const F32 *bestT,
+                            const F32 *sz, const F32 *dz, F32 minHeight, F32 maxHeight)
+{
+   U32 mask = 0;
+   for(U32 i = 0; i < TerrRayPacket::Size; i++)
+   {
+      F32 endTime = endT[i] < bestT[i] ? endT[i] : bestT[i];
+      if(startT[i] > endTime)
+         continue;
+      F32 startZ = startT[i] * dz[i] + sz[i];
+      F32 endZ = endTime * dz[i] + sz[i];
+      if(startZ <= minHeight && endZ <= minHeight)
+         continue;
+      if(startZ >= maxHeight && endZ >= maxHeight)
+         continue;
+      mask |= 1 << i;
+   }
+   return mask;
+}
+
+static U32 terrPacketClip_C(F32 *outStart, F32 *outEnd, const F32 *startT, const F32 *endT,
+                            const F32 *lo0, const F32 *hi0, const F32 *lo1, const F32 *hi1,
+                            const F32 *bestT)
+{
+   U32 mask = 0;
+   for(U32 i = 0; i < TerrRayPacket::Size; i++)
+   {
+      F32 s = getMax(startT[i], getMax(lo0[i], lo1[i]));
+      F32 e = getMin(getMin(endT[i], bestT[i]), getMin(hi0[i], hi1[i]));
+      outStart[i] = s;
+      outEnd[i] = e;
+      if(s <= e)
+         mask |= 1 << i;
+   }
+   return mask;
+}
+
+#ifdef TERRAIN_RAY_SSE
+static U32 terrPacketCull_SSE(const F32 *startT, const F32 *endT, const F32 *bestT,
+                              const F32 *sz, const F32 *dz, F32 minHeight, F32 maxHeight)
+{
+   __m128 s = _mm_loadu_ps(startT);
+   __m128 e = _mm_min_ps(_mm_loadu_ps(endT), _mm_loadu_ps(bestT));
+   __m128 z = _mm_loadu_ps(sz);
+   __m128 d = _mm_loadu_ps(dz);
+   __m128 startZ = _mm_add_ps(_mm_mul_ps(s, d), z);
+   __m128 endZ = _mm_add_ps(_mm_mul_ps(e, d), z);
+
+   __m128 minH = _mm_set1_ps(minHeight);
+   __m128 maxH = _mm_set1_ps(maxHeight);
+   __m128 below = _mm_and_ps(_mm_cmple_ps(startZ, minH), _mm_cmple_ps(endZ, minH));
+   __m128 above = _mm_and_ps(_mm_cmpge_ps(startZ, maxH), _mm_cmpge_ps(endZ, maxH));
+   __m128 live = _mm_andnot_ps(_mm_or_ps(below, above), _mm_cmple_ps(s, e));
+   return U32(_mm_movemask_ps(live));
+}
+
+static U32 terrPacketClip_SSE(F32 *outStart, F32 *outEnd, const F32 *startT, const F32 *endT,
+                              const F32 *lo0, const F32 *hi0, const F32 *lo1, const F32 *hi1,
+                              const F32 *bestT)
+{
+   __m128 s = _mm_max_ps(_mm_loadu_ps(startT), _mm_max_ps(_mm_loadu_ps(lo0), _mm_loadu_ps(lo1)));
+   __m128 e = _mm_min_ps(_mm_min_ps(_mm_loadu_ps(endT), _mm_loadu_ps(bestT)),
+                         _mm_min_ps(_mm_loadu_ps(hi0), _mm_loadu_ps(hi1)));
+   _mm_storeu_ps(outStart, s);
+   _mm_storeu_ps(outEnd, e);
+   return U32(_mm_movemask_ps(_mm_cmple_ps(s, e)));
+}
+#endif
+
+static U32 (*terrPacketCull)(const F32 *, const F32 *, const F32 *, const F32 *, const F32 *, F32, F32) = terrPacketCull_C;
+static U32 (*terrPacketClip)(F32 *, F32 *, const F32 *, const F32 *, const F32 *, const F32 *, const F32 *, const F32 *, const F32 *) = terrPacketClip_C;
+static const char *sRayKernelName = "C";
+
+void TerrainBlock::installRayKernels(U32 properties)
+{
+   if(!properties)
+      properties = Platform::SystemInfo.processor.properties;
+   else
+      properties &= Platform::SystemInfo.processor.properties;
+
+   terrPacketCull = terrPacketCull_C;
+   terrPacketClip = terrPacketClip_C;
+   sRayKernelName = "C";
+
+#ifdef TERRAIN_RAY_SSE
+   if(properties & CPU_PROP_SSE)
+   {
+      terrPacketCull = terrPacketCull_SSE;
+      terrPacketClip = terrPacketClip_SSE;
+      sRayKernelName = "SSE";
+   }
+#endif
+}
+
+const char *TerrainBlock::getRayKernelName()
+{
+   return sRayKernelName;
+}
+
+//--------------------------------------------------------------------------
+// [lo, hi] is the part of each ray (in t) between v = low and v = high,
+// with v the block space x or y.  Empty ranges come out as lo > hi.
+static void slabRange(const F32 *start, const F32 *invDelta, const S32 *dir,
+                      F32 low, F32 high, F32 *lo, F32 *hi)
+{
+   for(U32 i = 0; i < TerrRayPacket::Size; i++)
+   {
+      if(dir[i] > 0)
+      {
+         lo[i] = (low - start[i]) * invDelta[i];
+         hi[i] = (high - start[i]) * invDelta[i];
+      }
+      else if(dir[i] < 0)
+      {
+         lo[i] = (high - start[i]) * invDelta[i];
+         hi[i] = (low - start[i]) * invDelta[i];
+      }
+      else if(start[i] >= low && start[i] < high)
+      {
+         lo[i] = -MAX_FLOAT;
+         hi[i] = MAX_FLOAT;
+      }
+      else
+      {
+         lo[i] = MAX_FLOAT;
+         hi[i] = -MAX_FLOAT;
+      }
+   }
+}
+
+// Child ranges for a split at mid: [lo[0], hi[0]] is the low side, [lo[1],
+// hi[1]] the high side.  Same intercept as castRayBlock, a ray sitting on
+// the split line goes to the low side.
+static void splitRange(const F32 *start, const F32 *invDelta, const S32 *dir, F32 mid,
+                       F32 lo[2][TerrRayPacket::Size], F32 hi[2][TerrRayPacket::Size])
+{
+   for(U32 i = 0; i < TerrRayPacket::Size; i++)
+   {
+      F32 t = (mid - start[i]) * invDelta[i];
+      if(dir[i] > 0)
+      {
+         lo[0][i] = -MAX_FLOAT;  hi[0][i] = t;
+         lo[1][i] = t;           hi[1][i] = MAX_FLOAT;
+      }
+      else if(dir[i] < 0)
+      {
+         lo[0][i] = t;           hi[0][i] = MAX_FLOAT;
+         lo[1][i] = -MAX_FLOAT;  hi[1][i] = t;
+      }
+      else
+      {
+         U32 side = start[i] > mid;
+         lo[side][i] = -MAX_FLOAT;    hi[side][i] = MAX_FLOAT;
+         lo[!side][i] = MAX_FLOAT;    hi[!side][i] = -MAX_FLOAT;
+      }
+   }
+}
+
+void TerrainBlock::castRayPacketBlock(TerrRayPacket &packet, TerrPacketNode &root)
+{
+   F32 invBlockSize = 1 / F32(BlockSquareWidth);
+
+   TerrPacketNode stack[BlockShift * 3 + 1];
+   U32 stackSize = 1;
+   stack[0] = root;
+
+   // push the children far side first so the near ones come off the stack
+   // first; it only matters for how soon the rays get clipped
+   U32 lead = 0;
+   while(!(packet.mask & (1 << lead)))
+      lead++;
+   U32 nearX = packet.dirX[lead] < 0;
+   U32 nearY = packet.dirY[lead] < 0;
+
+   while(stackSize--)
+   {
+      TerrPacketNode node = stack[stackSize];
+      Point2I blockPos = node.blockPos;
+      GridSquare *sq = findSquare(node.level, Point2I(blockPos.x & BlockMask, blockPos.y & BlockMask));
+
+      U32 mask = node.mask & packet.mask &
+                 terrPacketCull(node.startT, node.endT, packet.bestT, packet.sz, packet.dz,
+                                fixedToFloat(sq->minHeight), fixedToFloat(sq->maxHeight));
+      if(!mask)
+         continue;
+      if((sq->flags & GridSquare::Empty) &&
+         blockPos.x == (blockPos.x & BlockMask) && blockPos.y == (blockPos.y & BlockMask))
+         continue;
+
+      if(node.level == 0)
+      {
+         for(U32 i = 0; i < TerrRayPacket::Size; i++)
+         {
+            if(!(mask & (1 << i)))
+               continue;
+            RayInfo info;
+            if(castRaySquare(packet.pStart[i], packet.pEnd[i], blockPos, sq, node.startT[i], node.endT[i], &info) &&
+               (!(packet.hits & (1 << i)) || info.t < packet.bestT[i]))
+            {
+               packet.bestT[i] = info.t;
+               packet.normal[i] = info.normal;
+               packet.hits |= 1 << i;
+            }
+         }
+         continue;
+      }
+
+      S32 subSqWidth = 1 << (node.level - 1);
+      F32 loX[2][TerrRayPacket::Size], hiX[2][TerrRayPacket::Size];
+      F32 loY[2][TerrRayPacket::Size], hiY[2][TerrRayPacket::Size];
+      splitRange(packet.sx, packet.invDx, packet.dirX, (blockPos.x + subSqWidth) * invBlockSize, loX, hiX);
+      splitRange(packet.sy, packet.invDy, packet.dirY, (blockPos.y + subSqWidth) * invBlockSize, loY, hiY);
+
+      for(U32 j = 0; j < 4; j++)
+      {
+         U32 qx = (j & 1) ^ nearX ^ 1;
+         U32 qy = (j >> 1) ^ nearY ^ 1;
+         TerrPacketNode &child = stack[stackSize];
+         child.mask = mask & terrPacketClip(child.startT, child.endT, node.startT, node.endT,
+                                            loX[qx], hiX[qx], loY[qy], hiY[qy], packet.bestT);
+         if(!child.mask)
+            continue;
+         child.blockPos.set(blockPos.x + qx * subSqWidth, blockPos.y + qy * subSqWidth);
+         child.level = node.level - 1;
+         stackSize++;
+      }
+   }
+}
+
+void TerrainBlock::castRayPacket(TerrRayPacket &packet)
+{
+   // every block any of the rays cross...
+   F32 minX = MAX_FLOAT, maxX = -MAX_FLOAT;
+   F32 minY = MAX_FLOAT, maxY = -MAX_FLOAT;
+   U32 i;
+   for(i = 0; i < TerrRayPacket::Size; i++)
+   {
+      if(!(packet.mask & (1 << i)))
+         continue;
+      minX = getMin(minX, getMin(packet.sx[i], packet.ex[i]));
+      maxX = getMax(maxX, getMax(packet.sx[i], packet.ex[i]));
+      minY = getMin(minY, getMin(packet.sy[i], packet.ey[i]));
+      maxY = getMax(maxY, getMax(packet.sy[i], packet.ey[i]));
+   }
+
+   static const F32 zero[TerrRayPacket::Size] = { 0, 0, 0, 0 };
+   static const F32 one[TerrRayPacket::Size] = { 1, 1, 1, 1 };
+
+   // ...gets walked with the part of each ray inside it
+   S32 blockXEnd = (S32)mFloor(maxX), blockYEnd = (S32)mFloor(maxY);
+   for(S32 blockY = (S32)mFloor(minY); blockY <= blockYEnd; blockY++)
+   {
+      for(S32 blockX = (S32)mFloor(minX); blockX <= blockXEnd; blockX++)
+      {
+         F32 loX[TerrRayPacket::Size], hiX[TerrRayPacket::Size];
+         F32 loY[TerrRayPacket::Size], hiY[TerrRayPacket::Size];
+         slabRange(packet.sx, packet.invDx, packet.dirX, F32(blockX), F32(blockX + 1), loX, hiX);
+         slabRange(packet.sy, packet.invDy, packet.dirY, F32(blockY), F32(blockY + 1), loY, hiY);
+
+         TerrPacketNode root;
+         root.mask = packet.mask & terrPacketClip(root.startT, root.endT, zero, one,
+                                                  loX, hiX, loY, hiY, one);
+         if(!root.mask)
+            continue;
+         root.blockPos.set(blockX * BlockSquareWidth, blockY * BlockSquareWidth);
+         root.level = BlockShift;
+         castRayPacketBlock(packet, root);
+      }
+   }
+}
+
+// Casts a filled (or partly filled) packet and writes out its lanes.
+U32 TerrainBlock::flushRayPacket(TerrRayPacket &packet, U32 lane, RayInfo *infos, bool *hits, F32 normalScale)
+{
+   // unused lanes still go through the kernels, keep them harmless
+   for(; lane < TerrRayPacket::Size; lane++)
+   {
+      packet.sx[lane] = packet.sy[lane] = packet.sz[lane] = 0;
+      packet.ex[lane] = packet.ey[lane] = packet.dz[lane] = 0;
+      packet.invDx[lane] = packet.invDy[lane] = 0;
+      packet.dirX[lane] = packet.dirY[lane] = 0;
+      packet.bestT[lane] = 1;
+   }
+
+   packet.hits = 0;
+   castRayPacket(packet);
+
+   U32 numHits = 0;
+   for(U32 i = 0; i < TerrRayPacket::Size; i++)
+   {
+      if(!(packet.mask & (1 << i)))
+         continue;
+      RayInfo &info = infos[packet.index[i]];
+      info.object = this;
+      hits[packet.index[i]] = (packet.hits & (1 << i)) != 0;
+      if(!hits[packet.index[i]])
+         continue;
+      info.t = packet.bestT[i];
+      info.normal = packet.normal[i];
+      info.normal.z *= normalScale;
+      info.normal.normalize();
+      numHits++;
+   }
+   packet.mask = 0;
+   return numHits;
+}
+
+U32 TerrainBlock::castRays(U32 count, const Point3F *starts, const Point3F *ends, RayInfo *infos, bool *hits)
+{
+   F32 invBlockWorldSize = 1 / F32(squareSize * BlockSquareWidth);
+   F32 normalScale = F32(BlockSquareWidth * squareSize);
+   U32 numHits = 0;
+
+   TerrRayPacket packet;
+   packet.mask = 0;
+   U32 lane = 0;
+   for(U32 r = 0; r < count; r++)
+   {
+      const Point3F &start = starts[r];
+      const Point3F &end = ends[r];
+
+      // straight up and down is a height lookup, not worth a lane
+      if(start.x == end.x && start.y == end.y)
+      {
+         hits[r] = castRayI(start, end, &infos[r], false);
+         numHits += hits[r];
+         continue;
+      }
+
+      Point3F pStart(start.x * invBlockWorldSize, start.y * invBlockWorldSize, start.z);
+      Point3F pEnd(end.x * invBlockWorldSize, end.y * invBlockWorldSize, end.z);
+      packet.pStart[lane] = pStart;
+      packet.pEnd[lane] = pEnd;
+      packet.sx[lane] = pStart.x;
+      packet.sy[lane] = pStart.y;
+      packet.sz[lane] = pStart.z;
+      packet.ex[lane] = pEnd.x;
+      packet.ey[lane] = pEnd.y;
+      packet.dz[lane] = pEnd.z - pStart.z;
+      packet.dirX[lane] = pEnd.x == pStart.x ? 0 : (pEnd.x < pStart.x ? -1 : 1);
+      packet.dirY[lane] = pEnd.y == pStart.y ? 0 : (pEnd.y < pStart.y ? -1 : 1);
+      packet.invDx[lane] = packet.dirX[lane] ? 1 / (pEnd.x - pStart.x) : 0;
+      packet.invDy[lane] = packet.dirY[lane] ? 1 / (pEnd.y - pStart.y) : 0;
+      packet.bestT[lane] = 1;
+      packet.index[lane] = r;
+      packet.mask |= 1 << lane;
+
+      if(++lane < TerrRayPacket::Size)
+         continue;
+      numHits += flushRayPacket(packet, lane, infos, hits, normalScale);
+      lane = 0;
+   }
+
+   // whatever is left, even if the last rays were vertical ones
+   if(lane)
+      numHits += flushRayPacket(packet, lane, infos, hits, normalScale);
+   return numHits;
+}
+
+//--------------------------------------------------------------------------
+// Benchmark: the same rays through castRay and castRays.  Random rays are
+// spread over the whole block, coherent ones fan out from a few points the
+// way LOS checks from a node do.
+
+ConsoleFunction(terrainRayBenchmark, void, 1, 3, "terrainRayBenchmark(<numRays>, <coherent>);")
+{
+   TerrainBlock *terrain = gServerSceneGraph ? gServerSceneGraph->getCurrentTerrain() : NULL;
+   if(!terrain)
+   {
+      Con::errorf(ConsoleLogEntry::General, "terrainRayBenchmark: no terrain loaded.");
+      return;
+   }
+
+   U32 count = argc > 1 ? dAtoi(argv[1]) : 100000;
+   bool coherent = argc > 2 && dAtob(argv[2]);
+   if(!count)
+      return;
+
+   F32 worldSize = F32(terrain->getSquareSize() * TerrainBlock::BlockSquareWidth);
+   MRandomLCG random(0x7e44a1);
+   Vector<Point3F> starts, ends;
+   starts.setSize(count);
+   ends.setSize(count);
+   U32 i;
+   Point3F eye;
+   for(i = 0; i < count; i++)
+   {
+      if(!coherent)
+      {
+         starts[i].set(random.randF(0, worldSize), random.randF(0, worldSize), random.randF(0, 300));
+         ends[i] = starts[i] + Point3F(random.randF(-400, 400), random.randF(-400, 400), random.randF(-300, 100));
+      }
+      else
+      {
+         // 64 rays per eye point, sweeping around it
+         if((i & 63) == 0)
+            eye.set(random.randF(0, worldSize), random.randF(0, worldSize), random.randF(50, 300));
+         F32 angle = F32(i & 63) * (M_2PI / 64);
+         starts[i] = eye;
+         ends[i] = eye + Point3F(mCos(angle) * 400, mSin(angle) * 400, -200);
+      }
+   }
+
+   Vector<RayInfo> scalarInfo, batchInfo;
+   Vector<bool> scalarHits, batchHits;
+   scalarInfo.setSize(count);
+   batchInfo.setSize(count);
+   scalarHits.setSize(count);
+   batchHits.setSize(count);
+
+   U32 startTime = Platform::getRealMilliseconds();
+   for(i = 0; i < count; i++)
+      scalarHits[i] = terrain->castRay(starts[i], ends[i], &scalarInfo[i]);
+   U32 scalarTime = Platform::getRealMilliseconds() - startTime;
+
+   startTime = Platform::getRealMilliseconds();
+   U32 numHits = terrain->castRays(count, starts.address(), ends.address(), batchInfo.address(), batchHits.address());
+   U32 batchTime = Platform::getRealMilliseconds() - startTime;
+
+   U32 mismatches = 0;
+   F32 maxDelta = 0;
+   for(i = 0; i < count; i++)
+   {
+      if(scalarHits[i] != batchHits[i])
+         mismatches++;
+      else if(scalarHits[i])
+      {
+         F32 delta = mFabs(scalarInfo[i].t - batchInfo[i].t);
+         maxDelta = getMax(maxDelta, delta);
+         // the same hit to float precision, a different one otherwise
+         if(delta > 1e-4 || mDot(scalarInfo[i].normal, batchInfo[i].normal) < 0.999f)
+            mismatches++;
+      }
+   }
+
+   Con::printf("terrainRayBenchmark: %d %s rays, %d hits, %d mismatches, max t delta %g",
+               count, coherent ? "coherent" : "random", numHits, mismatches, maxDelta);
+   Con::printf("   castRay: %d ms, castRays (%s): %d ms", scalarTime, TerrainBlock::getRayKernelName(), batchTime);
+}
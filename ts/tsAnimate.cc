@@ -47,10 +47,11 @@ void TSShapeInstance::animateNodes(S32 ss)
       return;
 
    // temporary storage for node transforms
-   smNodeCurrentRotations.setSize(mShape->nodes.size());
-   smNodeCurrentTranslations.setSize(mShape->nodes.size());
-   smRotationThreads.setSize(mShape->nodes.size());
-   smTranslationThreads.setSize(mShape->nodes.size());
+   NodeScratch & scratch = getNodeScratch();
+   scratch.mRotations.setSize(mShape->nodes.size());
+   scratch.mTranslations.setSize(mShape->nodes.size());
+   scratch.mRotationThreads.setSize(mShape->nodes.size());
+   scratch.mTranslationThreads.setSize(mShape->nodes.size());
 
    TSIntegerSet rotBeenSet;
    TSIntegerSet tranBeenSet;
@@ -96,13 +97,13 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       if (rotBeenSet.test(i))
       {
-         mShape->defaultRotations[i].getQuatF(&smNodeCurrentRotations[i]);
-         smRotationThreads[i] = NULL;
+         mShape->defaultRotations[i].getQuatF(&scratch.mRotations[i]);
+         scratch.mRotationThreads[i] = NULL;
       }
       if (tranBeenSet.test(i))
       {
-         smNodeCurrentTranslations[i] = mShape->defaultTranslations[i];
-         smTranslationThreads[i] = NULL;
+         scratch.mTranslations[i] = mShape->defaultTranslations[i];
+         scratch.mTranslationThreads[i] = NULL;
       }
    }
 
@@ -135,9 +136,9 @@ void TSShapeInstance::animateNodes(S32 ss)
             QuatF q1,q2;
             mShape->getRotation(*th->sequence,th->keyNum1,j,&q1);
             mShape->getRotation(*th->sequence,th->keyNum2,j,&q2);
-            TSTransform::interpolate(q1,q2,th->keyPos,&smNodeCurrentRotations[nodeIndex]);
+            TSTransform::interpolate(q1,q2,th->keyPos,&scratch.mRotations[nodeIndex]);
             rotBeenSet.set(nodeIndex);
-            smRotationThreads[nodeIndex] = th;
+            scratch.mRotationThreads[nodeIndex] = th;
          }
       }
 
@@ -156,8 +157,8 @@ void TSShapeInstance::animateNodes(S32 ss)
             {
                const Point3F & p1 = mShape->getTranslation(*th->sequence,th->keyNum1,j);
                const Point3F & p2 = mShape->getTranslation(*th->sequence,th->keyNum2,j);
-               TSTransform::interpolate(p1,p2,th->keyPos,&smNodeCurrentTranslations[nodeIndex]);
-               smTranslationThreads[nodeIndex] = th;
+               TSTransform::interpolate(p1,p2,th->keyPos,&scratch.mTranslations[nodeIndex]);
+               scratch.mTranslationThreads[nodeIndex] = th;
             }
             tranBeenSet.set(nodeIndex);
          }
@@ -174,7 +175,7 @@ void TSShapeInstance::animateNodes(S32 ss)
    // compute transforms
    for (i=a; i<b; i++)
       if (!mHandsOffNodes.test(i))
-         TSTransform::setMatrix(smNodeCurrentRotations[i],smNodeCurrentTranslations[i],&mNodeTransforms[i]);
+         TSTransform::setMatrix(scratch.mRotations[i],scratch.mTranslations[i],&mNodeTransforms[i]);
 
    // add scale onto transforms
    if (scaleCurrentlyAnimated())
@@ -210,40 +211,42 @@ void TSShapeInstance::animateNodes(S32 ss)
 
 void TSShapeInstance::handleDefaultScale(S32 a, S32 b, TSIntegerSet & scaleBeenSet)
 {
+   NodeScratch & scratch = getNodeScratch();
+
    // set default scale values (i.e., identity) and do any initialization
    // relating to animated scale (since scale normally not animated)
 
-   smScaleThreads.setSize(mShape->nodes.size());
+   scratch.mScaleThreads.setSize(mShape->nodes.size());
    scaleBeenSet.takeAway(mCallbackNodes);
    scaleBeenSet.takeAway(mHandsOffNodes);
    if (animatesUniformScale())
    {
-      smNodeCurrentUniformScales.setSize(mShape->nodes.size());
+      scratch.mUniformScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentUniformScales[i] = 1.0f;
-            smScaleThreads[i] = NULL;
+            scratch.mUniformScales[i] = 1.0f;
+            scratch.mScaleThreads[i] = NULL;
          }
    }
    else if (animatesAlignedScale())
    {
-      smNodeCurrentAlignedScales.setSize(mShape->nodes.size());
+      scratch.mAlignedScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentAlignedScales[i].set(1.0f,1.0f,1.0f);
-            smScaleThreads[i] = NULL;
+            scratch.mAlignedScales[i].set(1.0f,1.0f,1.0f);
+            scratch.mScaleThreads[i] = NULL;
          }
    }
    else
    {
-      smNodeCurrentArbitraryScales.setSize(mShape->nodes.size());
+      scratch.mArbitraryScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentArbitraryScales[i].identity();
-            smScaleThreads[i] = NULL;
+            scratch.mArbitraryScales[i].identity();
+            scratch.mScaleThreads[i] = NULL;
          }
    }
       
@@ -253,6 +256,8 @@ void TSShapeInstance::handleDefaultScale(S32 a, S32 b, TSIntegerSet & scaleBeenS
 
 void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
 {
+   NodeScratch & scratch = getNodeScratch();
+
    // handle transitions
    S32 nodeIndex;
    S32 start = mTransitionRotationNodes.start();
@@ -261,7 +266,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    {
       if (nodeIndex<a)
          continue;
-      TSThread * thread = smRotationThreads[nodeIndex];
+      TSThread * thread = scratch.mRotationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -279,7 +284,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          AssertFatal(thread,"TSShapeInstance::handleRotTransitionNodes (rotation)");
       }
       QuatF tmpQ;
-      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),smNodeCurrentRotations[nodeIndex],thread->transitionData.pos,&smNodeCurrentRotations[nodeIndex]);
+      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),scratch.mRotations[nodeIndex],thread->transitionData.pos,&scratch.mRotations[nodeIndex]);
    }
 
    // then translation
@@ -287,7 +292,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    end   = b;
    for (nodeIndex=start; nodeIndex<end; mTransitionTranslationNodes.next(nodeIndex))
    {
-      TSThread * thread = smTranslationThreads[nodeIndex];
+      TSThread * thread = scratch.mTranslationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -304,7 +309,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          }
          AssertFatal(thread,"TSShapeInstance::handleTransitionNodes (translation).");
       }
-      Point3F & p = smNodeCurrentTranslations[nodeIndex];
+      Point3F & p = scratch.mTranslations[nodeIndex];
       Point3F & p1 = mNodeReferenceTranslations[nodeIndex];
       Point3F & p2 = p;
       F32 k = thread->transitionData.pos;
@@ -320,7 +325,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
       end   = b;
       for (nodeIndex=start; nodeIndex<end; mTransitionScaleNodes.next(nodeIndex))
       {
-         TSThread * thread = smScaleThreads[nodeIndex];
+         TSThread * thread = scratch.mScaleThreads[nodeIndex];
          thread = thread && thread->transitionData.inTransition ? thread : NULL;
          if (!thread)
          {
@@ -338,14 +343,14 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
             AssertFatal(thread,"TSShapeInstance::handleTransitionNodes (scale).");
          }
          if (animatesUniformScale())
-            smNodeCurrentUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-smNodeCurrentUniformScales[nodeIndex]);
+            scratch.mUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-scratch.mUniformScales[nodeIndex]);
          else if (animatesAlignedScale())
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentAlignedScales[nodeIndex],thread->transitionData.pos,&smNodeCurrentAlignedScales[nodeIndex]);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],scratch.mAlignedScales[nodeIndex],thread->transitionData.pos,&scratch.mAlignedScales[nodeIndex]);
          else
          {
             QuatF q;
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mScale);
-            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),smNodeCurrentArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mRotate);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],scratch.mArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&scratch.mArbitraryScales[nodeIndex].mScale);
+            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),scratch.mArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&scratch.mArbitraryScales[nodeIndex].mRotate);
          }
       }
    }
@@ -353,28 +358,32 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
 
 void TSShapeInstance::handleNodeScale(S32 a, S32 b)
 {
+   NodeScratch & scratch = getNodeScratch();
+
    if (animatesUniformScale())
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentUniformScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(scratch.mUniformScales[i],&mNodeTransforms[i]);
    }
    else if (animatesAlignedScale())
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentAlignedScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(scratch.mAlignedScales[i],&mNodeTransforms[i]);
    }
    else
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentArbitraryScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(scratch.mArbitraryScales[i],&mNodeTransforms[i]);
    }
 }
 
 void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSIntegerSet & scaleBeenSet)
 {
+   NodeScratch & scratch = getNodeScratch();
+
    S32 j=0;
    S32 start = thread->sequence->scaleMatters.start();
    S32 end   = b;
@@ -438,28 +447,28 @@ void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSInt
          {
             case 0: // uniform -> uniform
             {
-               smNodeCurrentUniformScales[nodeIndex] = uniformScale;
+               scratch.mUniformScales[nodeIndex] = uniformScale;
                break;
             }
             case 1: // uniform -> aligned
             case 4: // aligned -> aligned
-               smNodeCurrentAlignedScales[nodeIndex] = alignedScale;
+               scratch.mAlignedScales[nodeIndex] = alignedScale;
                break;
             case 2: // uniform -> arbitrary
             case 5: // aligned -> arbitrary
             {
-               smNodeCurrentArbitraryScales[nodeIndex].identity();
-               smNodeCurrentArbitraryScales[nodeIndex].mScale = alignedScale;
+               scratch.mArbitraryScales[nodeIndex].identity();
+               scratch.mArbitraryScales[nodeIndex].mScale = alignedScale;
                break;
             }
             case 8: // arbitrary -> arbitary
             {
-               smNodeCurrentArbitraryScales[nodeIndex] = arbitraryScale;
+               scratch.mArbitraryScales[nodeIndex] = arbitraryScale;
                break;
             }
             default: AssertFatal(0,"TSShapeInstance::handleAnimatedScale"); break;
          }
-         smScaleThreads[nodeIndex] = thread;
+         scratch.mScaleThreads[nodeIndex] = thread;
          scaleBeenSet.set(nodeIndex);
       }
    }
@@ -467,19 +476,21 @@ void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSInt
 
 void TSShapeInstance::handleMaskedPositionNode(TSThread * th, S32 nodeIndex, S32 offset)
 {
+   NodeScratch & scratch = getNodeScratch();
+
    const Point3F & p1 = mShape->getTranslation(*th->sequence,th->keyNum1,offset);
    const Point3F & p2 = mShape->getTranslation(*th->sequence,th->keyNum2,offset);
    Point3F p;
    TSTransform::interpolate(p1,p2,th->keyPos,&p);
 
    if (!mMaskPosXNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].x = p.x;
+      scratch.mTranslations[nodeIndex].x = p.x;
 
    if (!mMaskPosYNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].y = p.y;
+      scratch.mTranslations[nodeIndex].y = p.y;
 
    if (!mMaskPosZNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].z = p.z;
+      scratch.mTranslations[nodeIndex].z = p.z;
 }
 
 void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
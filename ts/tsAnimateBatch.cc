@@ -0,0 +1,212 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ts/tsAnimateBatch.h"
+#include "ts/tsShapeInstance.h"
+#include "console/console.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "platform/profiler.h"
+#include "sim/sceneObject.h"
+
+TSAnimateBatch gTSAnimateBatch;
+
+//--------------------------------------------------------------------------
+
+class TSAnimateThread : public Thread
+{
+   TSAnimateBatch*        mBatch;
+   ContainerQueryContext* mContext;
+   void*                  mWakeSemaphore;
+   volatile bool          mStopping;
+   S32                    mIndex;
+
+public:
+   TSAnimateThread(TSAnimateBatch* batch, ContainerQueryContext* context, S32 index);
+   ~TSAnimateThread();
+
+   void wake() { Semaphore::releaseSemaphore(mWakeSemaphore); }
+   void stop();
+   void run(S32);
+};
+
+TSAnimateThread::TSAnimateThread(TSAnimateBatch* batch, ContainerQueryContext* context, S32 index)
+   : Thread(0, index, false)
+{
+   mBatch = batch;
+   mContext = context;
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mStopping = false;
+   mIndex = index;
+
+   // Now that the semaphore is created, start up the thread
+   start();
+}
+
+TSAnimateThread::~TSAnimateThread()
+{
+   Semaphore::destroySemaphore(mWakeSemaphore);
+   delete mContext;
+}
+
+void TSAnimateThread::stop()
+{
+   if (!isAlive())
+      return;
+
+   mStopping = true;
+   wake();
+   join();
+}
+
+// The context's slot picks the node scratch the thread animates with.
+void TSAnimateThread::run(S32)
+{
+   if (gProfiler) {
+      char name[32];
+      dSprintf(name, sizeof(name), "Animate %d", mIndex);
+      gProfiler->setThreadName(name);
+   }
+
+   ContainerQueryContext::Scope scope(mContext);
+   while (1) {
+      Semaphore::acquireSemaphore(mWakeSemaphore);
+      if (mStopping)
+         return;
+
+      mBatch->animateInstances();
+      Semaphore::releaseSemaphore(mBatch->mDone);
+   }
+}
+
+
+//--------------------------------------------------------------------------
+
+TSAnimateBatch::TSAnimateBatch()
+{
+   mNumThreads = 0;
+   mMutex = NULL;
+   mDone = NULL;
+   mNextInstance = 0;
+   mStats.clear();
+}
+
+TSAnimateBatch::~TSAnimateBatch()
+{
+   stopThreads();
+}
+
+void TSAnimateBatch::startThreads(U32 count)
+{
+   stopThreads();
+   count = getMin(count, U32(MaxThreads));
+   if (!count)
+      return;
+
+   mMutex = Mutex::createMutex();
+   mDone = Semaphore::createSemaphore(0);
+   for (U32 i = 0; i < count; i++) {
+      // the container queries of other systems may hold some of the contexts
+      ContainerQueryContext* context = ContainerQueryContext::create();
+      if (!context)
+         break;
+      mThreads[mNumThreads] = new TSAnimateThread(this, context, mNumThreads);
+      mNumThreads++;
+   }
+   if (mNumThreads < count)
+      Con::warnf("TSAnimateBatch::startThreads: only %d of %d threads started", mNumThreads, count);
+}
+
+void TSAnimateBatch::stopThreads()
+{
+   for (U32 i = 0; i < mNumThreads; i++) {
+      mThreads[i]->stop();
+      delete mThreads[i];
+   }
+   mNumThreads = 0;
+
+   if (mMutex) {
+      Mutex::destroyMutex(mMutex);
+      mMutex = NULL;
+   }
+   if (mDone) {
+      Semaphore::destroySemaphore(mDone);
+      mDone = NULL;
+   }
+}
+
+//--------------------------------------------------------------------------
+
+void TSAnimateBatch::animateInstances()
+{
+   while (1) {
+      Mutex::lockMutex(mMutex);
+      S32 index = mNextInstance < mInstances.size() ? mNextInstance++ : -1;
+      Mutex::unlockMutex(mMutex);
+      if (index < 0)
+         return;
+
+      mInstances[index]->animate();
+   }
+}
+
+// The main thread takes instances too, and only as many threads are woken as
+// there are instances left over for them.
+void TSAnimateBatch::run()
+{
+   if (mInstances.empty())
+      return;
+   if (!mNumThreads) {
+      mInstances.clear();
+      return;
+   }
+
+   PROFILE_START(TSAnimateBatch);
+   U32 start[2];
+   startHighResolutionTimer(start);
+
+   U32 i, wake = getMin(mNumThreads, U32(mInstances.size() - 1));
+   mNextInstance = 0;
+   for (i = 0; i < wake; i++)
+      mThreads[i]->wake();
+   animateInstances();
+   for (i = 0; i < wake; i++)
+      Semaphore::acquireSemaphore(mDone);
+
+   mStats.batches++;
+   mStats.instances += mInstances.size();
+   mStats.time += endHighResolutionTimer(start);
+   mInstances.clear();
+   PROFILE_END();
+}
+
+//--------------------------------------------------------------------------
+
+void TSAnimateBatch::dumpStats(bool reset)
+{
+   Con::printf("Animation threads: %d", mNumThreads);
+   U32 batches = getMax(mStats.batches, U32(1));
+   F64 ticksPerMs = Platform::SystemInfo.processor.mhz * 1000.0;
+   Con::printf("   batches: %d, instances per batch: %.1f", mStats.batches,
+               F32(mStats.instances) / batches);
+   if (ticksPerMs > 0)
+      Con::printf("   batch avg: %.3f ms", F32(mStats.time / ticksPerMs / batches));
+
+   if (reset)
+      mStats.clear();
+}
+
+ConsoleFunction(setAnimateThreads, void, 2, 2, "setAnimateThreads(count);")
+{
+   gTSAnimateBatch.startThreads(U32(getMax(dAtoi(argv[1]), 0)));
+}
+
+ConsoleFunction(animateBatchStats, void, 1, 2, "animateBatchStats(<reset>);")
+{
+   gTSAnimateBatch.dumpStats(argc > 1 && dAtob(argv[1]));
+}
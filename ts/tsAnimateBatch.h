@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// V12 Engine
+// 
+// Copyright (c) 2001 GarageGames.Com
+// Portions Copyright (c) 2001 by Sierra Online, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEBATCH_H_
+#define _TSANIMATEBATCH_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class TSShapeInstance;
+class TSAnimateThread;
+
+//--------------------------------------------------------------------------
+// Animates a batch of shape instances on the animation threads and the
+// main thread.  Each instance is animated at its current detail, exactly as
+// animate() would, so the later animate() call when it renders finds
+// nothing dirty.  The scene graph fills a batch with every shape the detail
+// manager picked a detail for this frame (DetailManager::animateCurrent).
+// An instance may only be in the batch once, and nothing else may touch
+// the instances until run() returns.  With no threads started nothing is
+// batched.
+
+class TSAnimateBatch
+{
+  public:
+   enum {
+      // each thread needs a query context of its own
+      MaxThreads = 7,
+   };
+
+  private:
+   friend class TSAnimateThread;
+
+   struct Stats {
+      U32 batches;
+      U32 instances;
+      F64 time;                     // processor ticks
+      void clear() { dMemset(this, 0, sizeof(*this)); }
+   };
+
+   Vector<TSShapeInstance*> mInstances;
+   TSAnimateThread*         mThreads[MaxThreads];
+   U32                      mNumThreads;
+   void*                    mMutex;
+   void*                    mDone;
+   S32                      mNextInstance;
+   Stats                    mStats;
+
+   void animateInstances();
+
+  public:
+   TSAnimateBatch();
+   ~TSAnimateBatch();
+
+   void startThreads(U32 count);
+   void stopThreads();
+   U32  getNumThreads() const { return mNumThreads; }
+
+   void add(TSShapeInstance* si) { mInstances.push_back(si); }
+   void run();
+
+   void dumpStats(bool reset);
+};
+
+extern TSAnimateBatch gTSAnimateBatch;
+
+#endif
@@ -12,7 +12,7 @@
 // Collision methods
 //-------------------------------------------------------------------------------------
 
-bool TSShapeInstance::buildPolyList(AbstractPolyList * polyList, S32 dl)
+bool TSShapeInstance::buildPolyList(AbstractPolyList * polyList, S32 dl, const Box3F * box)
 {
    // if dl==-1, nothing to do
    if (dl==-1)
@@ -26,7 +26,7 @@ bool TSShapeInstance::buildPolyList(AbstractPolyList * polyList, S32 dl)
    S32 od = detail->objectDetailNum;
 
    // set up static data
-   setStatics(dl);
+   bool locked = setCollisionStatics(dl);
 
    // nothing emitted yet...
    bool emitted = false;
@@ -52,6 +52,16 @@ bool TSShapeInstance::buildPolyList(AbstractPolyList * polyList, S32 dl)
       mat.mul(*previousMat);
       polyList->setTransform(&mat,Point3F(1, 1, 1));
 
+      // and the box in the node's space
+      Box3F meshBox;
+      if (box)
+      {
+         meshBox = *box;
+         MatrixF invMat = *previousMat;
+         invMat.inverse();
+         invMat.mul(meshBox);
+      }
+
       // run through objects and collide
       for (S32 i=start; i<end; i++)
       {
@@ -63,16 +73,26 @@ bool TSShapeInstance::buildPolyList(AbstractPolyList * polyList, S32 dl)
             mat.mul(initialMat,scaleMat);
             mat.mul(*previousMat);
             polyList->setTransform(&mat,Point3F(1, 1, 1));
+            if (box)
+            {
+               meshBox = *box;
+               MatrixF invMat = *previousMat;
+               invMat.inverse();
+               invMat.mul(meshBox);
+            }
          }
          // collide...
-         emitted |= mesh->buildPolyList(od,polyList,surfaceKey);
+         if (box)
+            emitted |= mesh->buildPolyList(od,polyList,surfaceKey,meshBox);
+         else
+            emitted |= mesh->buildPolyList(od,polyList,surfaceKey);
       }
 
       // restore original transform...
       polyList->setTransform(&initialMat,initialScale);
    }
 
-   clearStatics();
+   clearCollisionStatics(locked);
 
    return emitted;
 }
@@ -136,7 +156,7 @@ bool TSShapeInstance::castRay(const Point3F & a, const Point3F & b, RayInfo * ra
    S32 od = detail->objectDetailNum;
 
    // set up static data
-   setStatics(dl);
+   bool locked = setCollisionStatics(dl);
 
    S32 start = mShape->subShapeFirstObject[ss];
    S32 end   = mShape->subShapeNumObjects[ss] + start;
@@ -174,7 +194,7 @@ bool TSShapeInstance::castRay(const Point3F & a, const Point3F & b, RayInfo * ra
          {
             if (!rayInfo)
             {
-               clearStatics();
+               clearCollisionStatics(locked);
                return true;
             }
             if (rayInfo->t <= saveRay.t)
@@ -199,7 +219,7 @@ bool TSShapeInstance::castRay(const Point3F & a, const Point3F & b, RayInfo * ra
       rayInfo->point *= rayInfo->t;
       rayInfo->point += a;
    }
-   clearStatics();
+   clearCollisionStatics(locked);
    return found;
 }
 
@@ -343,6 +363,14 @@ bool TSShapeInstance::MeshObjectInstance::buildPolyList(S32 objectDetail, Abstra
    return false;
 }
 
+bool TSShapeInstance::MeshObjectInstance::buildPolyList(S32 objectDetail, AbstractPolyList * polyList, U32 & surfaceKey, const Box3F & box)
+{
+   TSMesh * mesh = getMesh(objectDetail);
+   if (mesh && visible>0.01f)
+      return mesh->buildBoxPolyList(frame,polyList,surfaceKey,box);
+   return false;
+}
+
 bool TSShapeInstance::MeshObjectInstance::getFeatures(S32 objectDetail, const MatrixF& mat, const Point3F& n, ConvexFeature* cf, U32& surfaceKey)
 {
    TSMesh* mesh = getMesh(objectDetail);
@@ -18,6 +18,9 @@
 #include "collision/convex.h"
 #include "sim/frameAllocator.h"
 #include "platform/profiler.h"
+#include "platform/platformMutex.h"
+#include "core/tSPSCQueue.h"
+#include "collision/boxTree.h"
 
 // Not worth the effort, much less the effort to comment, but if the draw types
 // are consecutive use addition rather than a table to go from index to command value...
@@ -36,6 +39,8 @@ Vector<U8*>      TSMesh::smEncodedNormsList;
 Vector<Point2F*> TSMesh::smTVertsList;
 Vector<bool>     TSMesh::smDataCopied;
 
+void *           TSMesh::smConvexHullMutex = NULL;
+bool             TSMesh::smUseCollisionTrees = true;
 Vector<Point3F>  TSMesh::smSaveVerts; 
 Vector<Point3F>  TSMesh::smSaveNorms; 
 Vector<Point2F>  TSMesh::smSaveTVerts;
@@ -1462,6 +1467,143 @@ bool TSMesh::buildPolyList(S32 frame, AbstractPolyList * polyList, U32 & surface
    return true;
 }
 
+//-----------------------------------------------------
+// TSMesh collision tree
+//-----------------------------------------------------
+
+struct TSMesh::CollisionTree
+{
+   BoxTree     tree;
+   Vector<U16> tris;        // three verts per triangle, in buildPolyList order
+   Vector<U32> materials;   // one per triangle
+};
+
+// Triangle boxes are grown by this much for the ray early out
+static const F32 sCollisionTreeRayPadding = 0.05f;
+
+static S32 QSORT_CALLBACK cmpTriIndex(const void* a, const void* b)
+{
+   return S32(*(const U16*)a) - S32(*(const U16*)b);
+}
+
+void TSMesh::buildCollisionTree()
+{
+   // Skinned, sorted and animated meshes move their verts around, and
+   // merge verts get swapped in while colliding.  They keep the full path.
+   if (collisionTree != NULL || getMeshType() != StandardMeshType ||
+       numFrames != 1 || vertsPerFrame == 0 || mergeIndices.size() != 0)
+      return;
+
+   CollisionTree * tree = new CollisionTree;
+   VECTOR_SET_ASSOCIATION(tree->tris);
+   VECTOR_SET_ASSOCIATION(tree->materials);
+
+   // same triangles, same order as buildPolyList...
+   S32 i;
+   for (i=0; i<primitives.size(); i++)
+   {
+      TSDrawPrimitive & draw = primitives[i];
+      U32 start = draw.start;
+      U32 material = draw.matIndex & TSDrawPrimitive::MaterialMask;
+
+      if ( (draw.matIndex & TSDrawPrimitive::TypeMask) == TSDrawPrimitive::Triangles)
+      {
+         for (S32 j=0; j<draw.numElements; j+=3)
+         {
+            tree->tris.push_back(indices[start + j + 0]);
+            tree->tris.push_back(indices[start + j + 1]);
+            tree->tris.push_back(indices[start + j + 2]);
+            tree->materials.push_back(material);
+         }
+      }
+      else
+      {
+         U16 idx0 = indices[start + 0];
+         U16 idx1 = indices[start + 1];
+         for (S32 j=2; j<draw.numElements; j++)
+         {
+            U16 idx2 = indices[start + j];
+            if (idx0 != idx1 && idx0 != idx2 && idx1 != idx2)
+            {
+               // odd triangles are flipped to keep the winding
+               tree->tris.push_back((j & 1) ? idx1 : idx0);
+               tree->tris.push_back((j & 1) ? idx0 : idx1);
+               tree->tris.push_back(idx2);
+               tree->materials.push_back(material);
+            }
+            idx0 = idx1;
+            idx1 = idx2;
+         }
+      }
+   }
+
+   if (tree->materials.size() == 0 || tree->materials.size() > 65536)
+   {
+      delete tree;
+      return;
+   }
+
+   Vector<Box3F> boxes;
+   VECTOR_SET_ASSOCIATION(boxes);
+   boxes.setSize(tree->materials.size());
+   for (i=0; i<boxes.size(); i++)
+   {
+      const Point3F & v0 = verts[tree->tris[i*3+0]];
+      const Point3F & v1 = verts[tree->tris[i*3+1]];
+      const Point3F & v2 = verts[tree->tris[i*3+2]];
+      boxes[i].min.set(getMin(v0.x,getMin(v1.x,v2.x)),getMin(v0.y,getMin(v1.y,v2.y)),getMin(v0.z,getMin(v1.z,v2.z)));
+      boxes[i].max.set(getMax(v0.x,getMax(v1.x,v2.x)),getMax(v0.y,getMax(v1.y,v2.y)),getMax(v0.z,getMax(v1.z,v2.z)));
+   }
+   tree->tree.build(boxes);
+
+   collisionTree = tree;
+}
+
+bool TSMesh::buildBoxPolyList(S32 frame, AbstractPolyList * polyList, U32 & surfaceKey, const Box3F & box)
+{
+   if (collisionTree == NULL || !smUseCollisionTrees)
+      return buildPolyList(frame,polyList,surfaceKey);
+
+   AssertFatal(frame==0,"TSMesh::buildBoxPolyList: collision tree on an animated mesh");
+   const CollisionTree & rTree = *collisionTree;
+   U32 numTris = rTree.materials.size();
+
+   // found triangles, then a map from mesh verts to poly list verts
+   U32 hitBytes = (numTris * sizeof(U16) + 3) & ~3;
+   U8 * scratch = ContainerQueryContext::getCurrent()->getScratch(hitBytes + vertsPerFrame * sizeof(U32));
+   U16 * hits = (U16*) scratch;
+   U32 * vertMap = (U32*) (scratch + hitBytes);
+
+   U32 numHits = rTree.tree.findBoxes(box,hits);
+   if (numHits)
+   {
+      // emit in the same order, and with the same keys, as buildPolyList
+      dQsort(hits,numHits,sizeof(U16),cmpTriIndex);
+      dMemset(vertMap,0xFF,vertsPerFrame * sizeof(U32));
+
+      for (U32 i=0; i<numHits; i++)
+      {
+         U32 tri = hits[i];
+         U32 idx[3];
+         for (U32 k=0; k<3; k++)
+         {
+            U32 vert = rTree.tris[tri*3+k];
+            if (vertMap[vert] == 0xFFFFFFFF)
+               vertMap[vert] = polyList->addPoint(verts[vert]);
+            idx[k] = vertMap[vert];
+         }
+         polyList->begin(rTree.materials[tri],surfaceKey + tri);
+         polyList->vertex(idx[0]);
+         polyList->vertex(idx[1]);
+         polyList->vertex(idx[2]);
+         polyList->plane(idx[0],idx[1],idx[2]);
+         polyList->end();
+      }
+   }
+   surfaceKey += numTris;
+   return true;
+}
+
 bool TSMesh::getFeatures(S32 frame, const MatrixF& mat, const Point3F& /*n*/, ConvexFeature* cf, U32& /*surfaceKey*/)
 {
    // DMM NOTE! Do not change without talking to Dave Moore.  ShapeBase assumes that
@@ -1645,9 +1787,28 @@ void TSMesh::support(S32 frame, const Point3F& v, F32* currMaxDP, Point3F* currS
 
 bool TSMesh::castRay(S32 frame, const Point3F & start, const Point3F & end, RayInfo * rayInfo)
 {
-   if (planeNormals.empty())
-      // if haven't done it yet...
-      buildConvexHull();
+   // collision meshes are convex, so a ray that gets into the hull has to
+   // cross one of the triangles
+   if (collisionTree && smUseCollisionTrees &&
+       !collisionTree->tree.touchesSegment(start,end,sCollisionTreeRayPadding))
+      return false;
+
+   if (!convexHullBuilt)
+   {
+      // if haven't done it yet...rays may be cast at this mesh from more
+      // than one thread, so build under the lock and publish with the flag
+      if (smConvexHullMutex)
+         Mutex::lockMutex(smConvexHullMutex);
+      if (!convexHullBuilt)
+      {
+         buildConvexHull();
+         SPSC_FENCE();
+         convexHullBuilt = true;
+      }
+      if (smConvexHullMutex)
+         Mutex::unlockMutex(smConvexHullMutex);
+   }
+   SPSC_FENCE();
 
    // Keep track of startTime and endTime.  They start out at just under 0 and just over 1, respectively.
    // As we check against each plane, prune start and end times back to represent current intersection of
@@ -1980,6 +2141,7 @@ S32 TSMesh::getNumPolys()
 
 TSMesh::~TSMesh()
 {
+   delete collisionTree;
 }
 
 //-----------------------------------------------------
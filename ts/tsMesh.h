@@ -127,6 +127,14 @@ class TSMesh
    Vector<F32>     planeConstants;
    Vector<U32>     planeMaterials;
    S32 planesPerFrame;
+   volatile bool convexHullBuilt;   // set (under the lock) once castRay has built the planes
+   static void * smConvexHullMutex;
+
+   // box tree over the triangles, only for meshes that don't deform
+   // (see TSShape::buildCollisionTrees)
+   struct CollisionTree;
+   CollisionTree * collisionTree;
+   static bool smUseCollisionTrees;
 	S32 vbOffset;
    U32 mergeBufferStart;
 
@@ -160,6 +168,8 @@ class TSMesh
    virtual bool castRay(S32 frame, const Point3F & start, const Point3F & end, RayInfo * rayInfo);
    virtual bool buildConvexHull(); // returns false if not convex (still builds planes)
    bool addToHull(U32 idx0, U32 idx1, U32 idx2);
+   void buildCollisionTree();
+   bool buildBoxPolyList(S32 frame, AbstractPolyList * polyList, U32 & surfaceKey, const Box3F & box);
 
    // calculate and get bounding information...
    void computeBounds();
@@ -225,6 +235,8 @@ class TSMesh
       VECTOR_SET_ASSOCIATION(planeConstants);
       VECTOR_SET_ASSOCIATION(planeMaterials);
       parentMesh = -1;
+      convexHullBuilt = false;
+      collisionTree = NULL;
    }
    virtual ~TSMesh();
 };
@@ -91,6 +91,7 @@ TSShape::~TSShape()
       if (accel != NULL) {
          delete [] accel->vertexList;
          delete [] accel->normalList;
+         delete [] accel->soaVerts;
          for (U32 j = 0; j < accel->numVerts; j++)
             delete [] accel->emitStrings[j];
          delete [] accel->emitStrings;
@@ -342,6 +343,7 @@ void TSShape::init()
          if (accel != NULL) {
             delete [] accel->vertexList;
             delete [] accel->normalList;
+            delete [] accel->soaVerts;
             for (U32 j = 0; j < accel->numVerts; j++)
                delete [] accel->emitStrings[j];
             delete [] accel->emitStrings;
@@ -1430,6 +1432,31 @@ TSShape::ConvexHullAccelerator* TSShape::getAccelerator(S32 dl)
 }
 
 
+void TSShape::buildCollisionTrees(S32 dl)
+{
+   AssertFatal(dl < details.size(), "Error, bad detail level!");
+   if (dl == -1)
+      return;
+
+   // Triangle trees for the meshes that can have one (see TSMesh::buildCollisionTree)
+   const TSDetail* detail = &details[dl];
+   S32 ss = detail->subShapeNum;
+   S32 od = detail->objectDetailNum;
+
+   S32 start = subShapeFirstObject[ss];
+   S32 end   = subShapeNumObjects[ss] + start;
+   for (S32 i = start; i < end; i++)
+   {
+      const TSObject* obj = &objects[i];
+      if (obj->numMeshes && od < obj->numMeshes) {
+         TSMesh* mesh = meshes[obj->startMeshIndex + od];
+         if (mesh)
+            mesh->buildCollisionTree();
+      }
+   }
+}
+
+
 void TSShape::computeAccelerator(S32 dl)
 {
    AssertFatal(dl < details.size(), "Error, bad detail level!");
@@ -1438,6 +1465,8 @@ void TSShape::computeAccelerator(S32 dl)
    if (detailCollisionAccelerators[dl] != NULL)
       return;
 
+   buildCollisionTrees(dl);
+
    // Create a bogus features list...
    ConvexFeature cf;
    MatrixF mat(true);
@@ -1520,6 +1549,16 @@ void TSShape::computeAccelerator(S32 dl)
    accel->vertexList  = new Point3F[accel->numVerts];
    dMemcpy(accel->vertexList, cf.mVertexList.address(), sizeof(Point3F) * accel->numVerts);
 
+   // Padded with the last vertex, which never wins over the real one
+   accel->numPaddedVerts = (accel->numVerts + 3) & ~3;
+   accel->soaVerts = accel->numVerts ? new F32[accel->numPaddedVerts * 3] : NULL;
+   for (i = 0; i < accel->numPaddedVerts; i++) {
+      const Point3F& vert = accel->vertexList[getMin(i, accel->numVerts - 1)];
+      accel->soaVerts[i] = vert.x;
+      accel->soaVerts[i + accel->numPaddedVerts] = vert.y;
+      accel->soaVerts[i + accel->numPaddedVerts * 2] = vert.z;
+   }
+
    accel->normalList = new PlaneF[cf.mFaceList.size()];
    for (i = 0; i < cf.mFaceList.size(); i++)
       accel->normalList[i] = cf.mFaceList[i].normal;
@@ -214,6 +214,10 @@ class TSShape : public ResourceInstance
       Point3F* vertexList;
       Point3F* normalList;
       U8**     emitStrings;
+
+      // vertexList again as structure of arrays, for gjkSupportIndex
+      U32      numPaddedVerts;
+      F32*     soaVerts;
    };
    ConvexHullAccelerator* getAccelerator(S32 dl);
    
@@ -318,6 +322,7 @@ class TSShape : public ResourceInstance
    
    // build LOS collision detail
    void computeAccelerator(S32 dl);
+   void buildCollisionTrees(S32 dl);
    bool buildConvexHull(S32 dl) const;
    void computeBounds(S32 dl, Box3F & bounds) const; // uses default transforms to compute bounding box around a detail level
                                                      // see like named method on shapeInstance if you want to use animated transforms
@@ -12,9 +12,12 @@
 #include "ts/tsDecal.h"
 #include "platform/profiler.h"
 #include "sim/frameAllocator.h"
+#include "platform/platformMutex.h"
+#include "sim/sceneObject.h"
 
 TSShapeInstance::RenderData   TSShapeInstance::smRenderData;
-MatrixF *                     TSShapeInstance::ObjectInstance::smTransforms = NULL;
+THREAD_LOCAL MatrixF *        TSShapeInstance::ObjectInstance::smTransforms = NULL;
+void *                        TSShapeInstance::smCollisionMutex = NULL;
 S32                           TSShapeInstance::smMaxSnapshotScale = 2;
 bool                          TSShapeInstance::smNoRenderTranslucent = false;
 bool                          TSShapeInstance::smNoRenderNonTranslucent = false;
@@ -24,15 +27,14 @@ S32                           TSShapeInstance::smNumSkipRenderDetails = 0;
 bool                          TSShapeInstance::smSkipFirstFog = false;
 bool                          TSShapeInstance::smSkipFog = false;
 
-Vector<QuatF>                 TSShapeInstance::smNodeCurrentRotations(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentTranslations(__FILE__, __LINE__);
-Vector<F32>                   TSShapeInstance::smNodeCurrentUniformScales(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentAlignedScales(__FILE__, __LINE__);
-Vector<TSScale>               TSShapeInstance::smNodeCurrentArbitraryScales(__FILE__, __LINE__);
+static TSShapeInstance::NodeScratch sNodeScratch[ContainerQueryContext::MaxContexts];
 
-Vector<TSThread*>             TSShapeInstance::smRotationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smTranslationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smScaleThreads(__FILE__, __LINE__);
+// Each thread that animates (the main thread, process islands, the animation
+// batch) has a query context of its own.
+TSShapeInstance::NodeScratch & TSShapeInstance::getNodeScratch()
+{
+   return sNodeScratch[ContainerQueryContext::getCurrent()->getSlot()];
+}
 
 namespace {
 
@@ -127,11 +129,20 @@ void TSShapeInstance::init()
    Con::addVariable("$pref::TS::skipRenderDLs", TypeS32, &smNumSkipRenderDetails);
    Con::addVariable("$pref::TS::skipFirstFog", TypeBool, &smSkipFirstFog);
    Con::addVariable("$pref::TS::screenError", TypeF32, &smScreenError);
+   Con::addVariable("TS::useCollisionTrees", TypeBool, &TSMesh::smUseCollisionTrees);
+
+   smCollisionMutex = Mutex::createMutex();
+   TSMesh::smConvexHullMutex = Mutex::createMutex();
 }
 
 void TSShapeInstance::destroy()
 {
    delete smRenderData.fogHandle;
+
+   Mutex::destroyMutex(smCollisionMutex);
+   smCollisionMutex = NULL;
+   Mutex::destroyMutex(TSMesh::smConvexHullMutex);
+   TSMesh::smConvexHullMutex = NULL;
 }        
 
 void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
@@ -692,6 +703,46 @@ void TSShapeInstance::setStatics(S32 dl, F32 intraDL, const Point3F * objectScal
    }
 }
 
+bool TSShapeInstance::setCollisionStatics(S32 dl)
+{
+   // merge verts are collapsed in place on the meshes and skins are built
+   // in shared buffers, anything else only needs the node transforms
+   bool shared = mShape->mMergeBufferSize != 0;
+   S32 ss = mShape->details[dl].subShapeNum;
+   S32 od = mShape->details[dl].objectDetailNum;
+   S32 start = mShape->subShapeFirstObject[ss];
+   S32 end   = mShape->subShapeNumObjects[ss] + start;
+   for (S32 i=start; i<end && !shared; i++)
+   {
+      TSMesh * mesh = mMeshObjects[i].getMesh(od);
+      shared = mesh && mesh->getMeshType() == TSMesh::SkinMeshType;
+   }
+
+   if (!shared)
+   {
+      ObjectInstance::smTransforms = mNodeTransforms.address();
+      return false;
+   }
+
+   if (smCollisionMutex)
+      Mutex::lockMutex(smCollisionMutex);
+   setStatics(dl);
+   return true;
+}
+
+void TSShapeInstance::clearCollisionStatics(bool locked)
+{
+   if (!locked)
+   {
+      ObjectInstance::smTransforms = NULL;
+      return;
+   }
+
+   clearStatics();
+   if (smCollisionMutex)
+      Mutex::unlockMutex(smCollisionMutex);
+}
+
 void TSShapeInstance::clearStatics()
 {
    ObjectInstance::smTransforms = NULL;
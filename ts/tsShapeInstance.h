@@ -23,6 +23,9 @@
 #ifndef _GBITMAP_H_
 #include "dgl/gBitmap.h"
 #endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
 
 class RenderItem;
 class TSThread;
@@ -55,7 +58,8 @@ class TSShapeInstance
    {
       // this needs to be set before using an objectInstance...tells us where to
       // look for the transforms...gets set be shape instance 'setStatics' method
-      static MatrixF * smTransforms;
+      // (per thread, so collision queries can run concurrently)
+      static THREAD_LOCAL MatrixF * smTransforms;
 
       S32 nodeIndex;
       MatrixF * getTransform();
@@ -94,6 +98,7 @@ class TSShapeInstance
 
       // collision routines...
       bool buildPolyList(S32 objectDetail, AbstractPolyList *, U32 & surfaceKey);
+      bool buildPolyList(S32 objectDetail, AbstractPolyList *, U32 & surfaceKey, const Box3F & box);
       bool getFeatures(S32 objectDetail, const MatrixF& mat, const Point3F& n, ConvexFeature*, U32 & surfaceKey);
       void support(S32 od, const Point3F& v, F32* currMaxDP, Point3F* currSupport);
       bool castRay(S32 objectDetail, const Point3F & start, const Point3F & end, RayInfo *);
@@ -146,17 +151,22 @@ class TSShapeInstance
    Vector<Point3F>        mNodeReferenceScaleFactors;
    Vector<Quat16>         mNodeReferenceArbitraryScaleRots;
 
-   // workspace for node transforms
-   static Vector<QuatF>   smNodeCurrentRotations;
-   static Vector<Point3F> smNodeCurrentTranslations;
-   static Vector<F32>     smNodeCurrentUniformScales;
-   static Vector<Point3F> smNodeCurrentAlignedScales;
-   static Vector<TSScale> smNodeCurrentArbitraryScales;
-
-   // keep track of who controls what on currently animating shape
-   static Vector<TSThread*> smRotationThreads;
-   static Vector<TSThread*> smTranslationThreads;
-   static Vector<TSThread*> smScaleThreads;
+   // workspace for node transforms, one per container query context so
+   // shapes can animate on several threads at once (see getNodeScratch)
+   struct NodeScratch
+   {
+      Vector<QuatF>   mRotations;
+      Vector<Point3F> mTranslations;
+      Vector<F32>     mUniformScales;
+      Vector<Point3F> mAlignedScales;
+      Vector<TSScale> mArbitraryScales;
+
+      // keep track of who controls what on currently animating shape
+      Vector<TSThread*> mRotationThreads;
+      Vector<TSThread*> mTranslationThreads;
+      Vector<TSThread*> mScaleThreads;
+   };
+   static NodeScratch & getNodeScratch();
 
 //-------------------------------------------------------------------------------------
 // Misc.
@@ -249,6 +259,17 @@ class TSShapeInstance
    void setStatics(S32 dl = 0, F32 interDL = 0.0f, const Point3F * shapeScale = NULL);
    void clearStatics();
 
+   protected:
+   // castRay and buildPolyList may run on several threads at once.  They
+   // only need the node transforms, unless the detail has merge verts or
+   // skins (which write to the meshes), in which case the full statics are
+   // set up under smCollisionMutex.  Returns whether the lock was taken.
+   static void * smCollisionMutex;
+   bool setCollisionStatics(S32 dl);
+   void clearCollisionStatics(bool locked);
+
+   public:
+
    TSMaterialList* getMaterialList() { return mMaterialList; }
    void setMaterialList(TSMaterialList*); // we won't own the material list unless we clone it (see below)
    void cloneMaterialList(); // call this to own the material list -- i.e., we'll make a copy of the currently
@@ -500,7 +521,7 @@ class TSShapeInstance
 
    public:
 
-   bool buildPolyList(AbstractPolyList *, S32 dl);
+   bool buildPolyList(AbstractPolyList *, S32 dl, const Box3F * box = NULL); // box in shape space, NULL for everything
    bool getFeatures(const MatrixF& mat, const Point3F& n, ConvexFeature*, S32 dl);
    bool castRay(const Point3F & start, const Point3F & end, RayInfo *,S32 dl);
    bool quickLOS(const Point3F & start, const Point3F & end, S32 dl) { return castRay(start,end,NULL,dl); }
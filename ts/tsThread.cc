@@ -633,15 +633,19 @@ void TSShapeInstance::updateTransitions()
    if (mTransitionThreads.empty())
       return;
 
+   // the node scratch still holds this shape's nodes, transitionToSequence and
+   // friends animate them on this thread first
+   NodeScratch & scratch = getNodeScratch();
+
    S32 i;
    mNodeReferenceRotations.setSize(mShape->nodes.size());
    mNodeReferenceTranslations.setSize(mShape->nodes.size());
    for (i=0; i<mShape->nodes.size(); i++)
    {
       if (mTransitionRotationNodes.test(i))
-         mNodeReferenceRotations[i].set(smNodeCurrentRotations[i]);
+         mNodeReferenceRotations[i].set(scratch.mRotations[i]);
       if (mTransitionTranslationNodes.test(i))
-         mNodeReferenceTranslations[i] = smNodeCurrentTranslations[i];
+         mNodeReferenceTranslations[i] = scratch.mTranslations[i];
    }
 
    if (animatesScale())
@@ -652,7 +656,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceUniformScales[i] = smNodeCurrentUniformScales[i];
+               mNodeReferenceUniformScales[i] = scratch.mUniformScales[i];
          }
       }
       else if (animatesAlignedScale())
@@ -661,7 +665,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceScaleFactors[i] = smNodeCurrentAlignedScales[i];
+               mNodeReferenceScaleFactors[i] = scratch.mAlignedScales[i];
          }
       }
       else
@@ -672,8 +676,8 @@ void TSShapeInstance::updateTransitions()
          {
             if (mTransitionScaleNodes.test(i))
             {
-               mNodeReferenceScaleFactors[i] = smNodeCurrentArbitraryScales[i].mScale;
-               mNodeReferenceArbitraryScaleRots[i].set(smNodeCurrentArbitraryScales[i].mRotate);
+               mNodeReferenceScaleFactors[i] = scratch.mArbitraryScales[i].mScale;
+               mNodeReferenceArbitraryScaleRots[i].set(scratch.mArbitraryScales[i].mRotate);
             }
          }
       }
@@ -221,6 +221,21 @@ SOURCE=.\ai\aiTask.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\aiThink.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graph.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -266,6 +281,21 @@ SOURCE=.\ai\graphBridge.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphBuild.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphBuildLOS.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -431,6 +461,21 @@ SOURCE=.\ai\graphGroundPlan.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphHierarchy.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphIndoors.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -581,6 +626,36 @@ SOURCE=.\ai\graphPath.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphPathCache.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
+SOURCE=.\ai\graphPathQueue.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphQueries.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -656,6 +731,21 @@ SOURCE=.\ai\graphSpawn.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphThreadPool.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ai"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ai"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphThreats.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -837,6 +927,21 @@ SOURCE=.\audio\bufferQueue.cc
 
 !ENDIF 
 
+# End Source File
+# Begin Source File
+
+SOURCE=.\audio\voiceKernels.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/audio"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/audio"
+
+!ENDIF 
+
 # End Source File
 # End Group
 # Begin Group "collision"
@@ -874,6 +979,36 @@ SOURCE=.\collision\boxConvex.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\collision\boxTree.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/collision"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/collision"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
+SOURCE=.\collision\broadPhase.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/collision"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/collision"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\collision\clippedPolyList.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -1006,6 +1141,21 @@ SOURCE=.\collision\polytope.cc
 
 !ENDIF 
 
+# End Source File
+# Begin Source File
+
+SOURCE=.\collision\sweepBatch.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/collision"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/collision"
+
+!ENDIF 
+
 # End Source File
 # End Group
 # Begin Group "console"
@@ -1208,6 +1358,21 @@ SOURCE=.\console\simManager.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\console\simParallel.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/console"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/console"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\console\telnetConsole.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -2143,6 +2308,21 @@ SOURCE=.\game\banList.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\benchmark.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/game"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/game"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\bombSight.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -2758,6 +2938,21 @@ SOURCE=.\game\projectile.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\projectileManager.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/game"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/game"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\projELF.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -2923,6 +3118,21 @@ SOURCE=.\game\projTracer.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\proximityIndex.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/game"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/game"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\rigid.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -4120,6 +4330,21 @@ SOURCE=.\interior\interior.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\interior\interiorBVH.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/interior"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/interior"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\interior\interiorCollision.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -5288,6 +5513,21 @@ SOURCE=.\sim\cannedChatDataBlock.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\sim\containerStress.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/sim"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/sim"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\sim\decalManager.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -5592,6 +5832,21 @@ SOURCE=.\terrain\terrLighting.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\terrain\terrRayBatch.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/terrain"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/terrain"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\terrain\terrRender.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -5656,6 +5911,21 @@ SOURCE=.\ts\tsAnimate.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\ts\tsAnimateBatch.cc
+
+!IF  "$(CFG)" == "v12 Engine - Win32 Release"
+
+# PROP Intermediate_Dir "out.VC6.RELEASE/ts"
+
+!ELSEIF  "$(CFG)" == "v12 Engine - Win32 Debug"
+
+# PROP Intermediate_Dir "out.VC6.DEBUG/ts"
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=.\ts\tsCollision.cc
 
 !IF  "$(CFG)" == "v12 Engine - Win32 Release"
@@ -5928,6 +6198,10 @@ SOURCE=.\ai\aiTask.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\aiThink.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graph.h
 # End Source File
 # Begin Source File
@@ -5944,6 +6218,10 @@ SOURCE=.\ai\graphBSP.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphBuild.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphData.h
 # End Source File
 # Begin Source File
@@ -5972,6 +6250,10 @@ SOURCE=.\ai\graphGroundVisit.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphHierarchy.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphJetting.h
 # End Source File
 # Begin Source File
@@ -6000,10 +6282,22 @@ SOURCE=.\ai\graphPath.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphPathCache.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\ai\graphPathQueue.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphSearches.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\ai\graphThreadPool.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ai\graphThreats.h
 # End Source File
 # Begin Source File
@@ -6022,6 +6316,10 @@ SOURCE=.\ai\tBinHeap.h
 
 SOURCE=.\ai\texturePreload.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\ai\tQuadHeap.h
+# End Source File
 # End Group
 # Begin Group "audio headers"
 
@@ -6062,6 +6360,10 @@ SOURCE=.\audio\audioThread.h
 
 SOURCE=.\audio\bufferQueue.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\audio\voiceKernels.h
+# End Source File
 # End Group
 # Begin Group "collision headers"
 
@@ -6076,6 +6378,10 @@ SOURCE=.\collision\boxConvex.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\collision\boxTree.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\collision\clippedPolyList.h
 # End Source File
 # Begin Source File
@@ -6114,6 +6420,10 @@ SOURCE=.\collision\polyhedron.h
 
 SOURCE=.\collision\polytope.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\collision\sweepBatch.h
+# End Source File
 # End Group
 # Begin Group "console headers"
 
@@ -6284,6 +6594,10 @@ SOURCE=.\core\tSparseArray.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\core\tSPSCQueue.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\core\tVector.h
 # End Source File
 # Begin Source File
@@ -6440,6 +6754,10 @@ SOURCE=.\game\banList.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\benchmark.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\bombSight.h
 # End Source File
 # Begin Source File
@@ -6588,6 +6906,10 @@ SOURCE=.\game\projectile.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\projectileManager.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\projELF.h
 # End Source File
 # Begin Source File
@@ -6632,6 +6954,10 @@ SOURCE=.\game\projTracer.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\game\proximityIndex.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\game\resource.h
 # End Source File
 # Begin Source File
@@ -7284,6 +7610,10 @@ SOURCE=.\terrain\waterBlock.h
 # PROP Default_Filter "h"
 # Begin Source File
 
+SOURCE=.\ts\tsAnimateBatch.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\ts\tsDecal.h
 # End Source File
 # Begin Source File